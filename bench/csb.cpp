@@ -0,0 +1,231 @@
+// Coders strike back (the nn trainer's simulation): simFrame over states
+// taken from the middle of races, in each precision csb-physics.hpp is built
+// for and as csb-physics-sse.hpp's SoaRace (which has to match the float one
+// to the bit on every frame first), steering and stepping them one at a time
+// and all together in a RaceBatch, the engine's table trig against libm's,
+// and the network's inference, a layer at a time and as the whole of
+// Agent::race.
+//
+//   bench-csb [options]   (see include/bench.hpp)
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/bench.hpp"
+#include "../include/csb-batch.hpp"
+#include "../include/csb-physics-sse.hpp"
+#include "../include/fixed-point.hpp"
+#include "../include/rng.hpp"
+#include "../bot-programming/coders-strike-back/nn/nn.h"
+#include "../bot-programming/coders-strike-back/nn/sim.h"
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+constexpr int num_fields = 15;          // nn/fields/1.txt to 15.txt
+constexpr int frames_per_race = 100;    // states kept from each field
+constexpr u64 seed = 40;
+
+/*****************************************************************************/
+
+vector<pair<Field, SimState>> loadFields() {
+  vector<pair<Field, SimState>> fields;
+  for (int field_id = 1; field_id <= num_fields; ++field_id) {
+    string path = string(CSB_FIELDS_DIR "/") + to_string(field_id) + ".txt";
+    ifstream in(path);
+    Field field;
+    SimState state;
+    if (!(in >> field >> state)) {
+      cerr << "can't read " << path << '\n';
+      exit(1);
+    }
+    fields.emplace_back(field, state);
+  }
+  return fields;
+}
+
+// each pod heads for its next checkpoint at full thrust
+void steer(const Field& field, SimState& state) {
+  for (Pod& pod : state.pods) {
+    pod.applyTarget(field.checkpoints[pod.next_cp], 100);
+  }
+}
+
+// the same frames in another precision
+template <class T>
+void benchSimFrame(BenchRunner& bench, const string& name, const vector<pair<Field, SimState>>& fields,
+                   const vector<pair<const Field*, SimState>>& frames) {
+  vector<BasicField<T>> converted_fields;
+  for (const auto& field : fields) converted_fields.emplace_back(field.first);
+  vector<pair<const BasicField<T>*, BasicRace<T>>> converted;
+  for (const auto& [field, state] : frames) {
+    size_t field_idx = 0;
+    while (&fields[field_idx].first != field) ++field_idx;
+    converted.emplace_back(&converted_fields[field_idx], BasicRace<T>(state));
+  }
+  bench.run(name, [&] {
+    for (const auto& [field, before] : converted) {
+      BasicRace<T> state = before;
+      state.simFrame(*field);
+      doNotOptimize(state);
+    }
+  }, converted.size());
+}
+
+float uniformWeight(Pcg32& rng) { return 2 * uniformFloat(rng) - 1; }
+
+int main(int argc, char** argv) {
+  BenchRunner bench("csb", argc, argv);
+  const vector<pair<Field, SimState>> fields = loadFields();
+
+  // the states just before each simFrame of a few races, so the benchmark
+  // sees the collisions and checkpoints that real ones do
+  vector<pair<const Field*, SimState>> frames;
+  for (const auto& [field, start] : fields) {
+    SimState state = start;
+    for (int frame = 0; frame < frames_per_race; ++frame) {
+      steer(field, state);
+      frames.emplace_back(&field, state);
+      state.simFrame(field);
+    }
+  }
+  bench.run("simFrame float", [&] {
+    for (const auto& [field, before] : frames) {
+      SimState state = before;
+      state.simFrame(*field);
+      doNotOptimize(state);
+    }
+  }, frames.size());
+  benchSimFrame<double>(bench, "simFrame double", fields, frames);
+
+  // SoaRace has to give exactly what the scalar code does before its time
+  // means anything
+  vector<pair<const Field*, SoaRace>> soa_frames;
+  for (const auto& [field, before] : frames) {
+    SimState scalar = before;
+    scalar.simFrame(*field);
+    SoaRace soa(before);
+    soa.simFrame(*field);
+    SoaRace expected(scalar);
+    if (memcmp(soa.xs, expected.xs, sizeof(float) * 20) != 0 || memcmp(soa.next_cps, expected.next_cps, sizeof(int) * 12) != 0
+        || soa.timeouts != expected.timeouts) {
+      cerr << "SoaRace::simFrame differs from SimState::simFrame on frame " << soa_frames.size() << '\n';
+      return 1;
+    }
+    soa_frames.emplace_back(field, SoaRace(before));
+  }
+  bench.run("simFrame float SoA", [&] {
+    for (const auto& [field, before] : soa_frames) {
+      SoaRace state = before;
+      state.simFrame(*field);
+      doNotOptimize(state);
+    }
+  }, soa_frames.size());
+  benchSimFrame<Fixed<20>>(bench, "simFrame Fixed<20>", fields, frames);
+  bench.run("steer + simFrame", [&] {
+    for (const auto& [field, before] : frames) {
+      SimState state = before;
+      steer(*field, state);
+      state.simFrame(*field);
+      doNotOptimize(state);
+    }
+  }, frames.size());
+
+  // the same, every frame's state a game of one RaceBatch stepped a frame on
+  // one thread, checked against the scalar code first; the policy can only
+  // hand back turns, so the first frame of each race (no facing yet) is left out
+  vector<pair<const Field*, SimState>> faced;
+  for (const auto& frame : frames) {
+    if (all_of(begin(frame.second.pods), end(frame.second.pods), [](const Pod& pod) { return pod.angle >= 0; })) {
+      faced.push_back(frame);
+    }
+  }
+  RaceBatch batch;
+  for (const auto& [field, before] : faced) batch.add(*field, before);
+  auto steer_batch = [](const RaceBatch& batch) {
+    return [&batch](size_t game, const SimState& state, Move* moves) {
+      for (int idx = 0; idx < 4; ++idx) {
+        const Pod& pod = state.pods[idx];
+        moves[idx] = { 100, Pod::turnBetween(pod.angle, pod.angleTo(batch.field(game).checkpoints[pod.next_cp])) };
+      }
+    };
+  };
+  RaceBatch stepped = batch;
+  stepped.step(steer_batch(stepped));
+  for (size_t game = 0; game < faced.size(); ++game) {
+    SimState scalar = faced[game].second;
+    steer(*faced[game].first, scalar);
+    scalar.simFrame(*faced[game].first);
+    SoaRace lhs(scalar), rhs(stepped.race(game));
+    if (memcmp(lhs.xs, rhs.xs, sizeof(float) * 20) != 0 || memcmp(lhs.next_cps, rhs.next_cps, sizeof(int) * 12) != 0
+        || lhs.timeouts != rhs.timeouts) {
+      cerr << "RaceBatch differs from steer + SimState::simFrame on frame " << game << '\n';
+      return 1;
+    }
+  }
+  bench.run("steer + simFrame RaceBatch", [&] {
+    RaceBatch state = batch;
+    state.step(steer_batch(state));
+    doNotOptimize(state);
+  }, faced.size());
+
+  // the trig heading() and angleTo() do, from the tables and from libm, on
+  // every pod's angle turned part of a turn and its vector to its checkpoint
+  Pcg32 turn_rng(seed);
+  vector<float> angles;
+  vector<Vec2_xy> to_cps;
+  for (const auto& [field, state] : faced) {
+    for (const Pod& pod : state.pods) {
+      angles.push_back(fmod(pod.angle + uniformFloat(turn_rng, 0.f, 18.f), 360.f));
+      to_cps.push_back(field->checkpoints[pod.next_cp] - pod.pos);
+    }
+  }
+  bench.run("unitVector", [&] {
+    for (float angle : angles) doNotOptimize(unitVector(angle));
+  }, angles.size());
+  bench.run("unitVector, libm", [&] {
+    for (float angle : angles) {
+      float rad = angle * float(M_PI) / 180.f;
+      doNotOptimize(Vec2_xy(cos(rad), sin(rad)));
+    }
+  }, angles.size());
+  bench.run("fastAtan2", [&] {
+    for (const Vec2_xy& d : to_cps) doNotOptimize(fastAtan2(d.y, d.x));
+  }, to_cps.size());
+  bench.run("fastAtan2, libm", [&] {
+    for (const Vec2_xy& d : to_cps) doNotOptimize(atan2(d.y, d.x));
+  }, to_cps.size());
+
+  Pcg32 rng(seed);
+  Agent agent;
+  for (auto& node : agent.brain.weights) for (float& weight : node) weight = uniformWeight(rng);
+  for (float& bias : agent.brain.biases) bias = uniformWeight(rng);
+  for (auto& node : agent.out_layer.weights) for (float& weight : node) weight = uniformWeight(rng);
+  for (float& bias : agent.out_layer.biases) bias = uniformWeight(rng);
+  array<float, 34> input;
+  for (float& value : input) value = uniformWeight(rng);
+
+  bench.run("LinearLayer<34, 16>", [&] {
+    doNotOptimize(input);
+    doNotOptimize(agent.brain(input));
+  });
+  bench.run("LinearLayer<16, 8> + tanh", [&] {
+    doNotOptimize(agent.brain.output);
+    doNotOptimize(agent.out_layer(agent.brain));
+  });
+  bench.run("Agent::race", [&] {
+    for (const auto& [field, state] : frames) doNotOptimize(agent.race(*field, state, true));
+  }, frames.size());
+
+  cout << "\nframes/sec:";
+  for (const BenchResult& result : bench.getResults()) {
+    if (result.name.find("simFrame") != string::npos) cout << "  " << result.name << " " << unsigned(1e9 / result.median);
+  }
+  cout << '\n';
+  return bench.finish();
+}
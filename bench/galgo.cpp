@@ -0,0 +1,51 @@
+// galgo: whole generations of the genetic algorithm (evaluate, select, cross
+// over, mutate) on Rosenbrock's function, and on a ten-parameter sphere for
+// a population that's more like the one the nn trainer evolves.
+//
+//   bench-galgo [options]   (see include/bench.hpp)
+#include <cmath>
+#include <vector>
+
+#include "../include/bench.hpp"
+#include "../bot-programming/coders-strike-back/nn/galgo/Galgo.hpp"
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+constexpr int num_generations = 20;   // per call; the first population is built once per call too
+constexpr u64 seed = 40;
+
+/*****************************************************************************/
+
+// galgo maximises, so these are negated
+vector<double> rosenbrock(const vector<double>& x) {
+  return { -(pow(1 - x[0], 2) + 100 * pow(x[1] - x[0] * x[0], 2)) };
+}
+vector<double> sphere(const vector<double>& x) {
+  double sum = 0;
+  for (double value : x) sum += value * value;
+  return { -sum };
+}
+
+int main(int argc, char** argv) {
+  BenchRunner bench("galgo", argc, argv);
+  galgo::rng.seed(seed);
+
+  galgo::Parameter<double> x({ 0.0, 1.0 }), y({ 0.0, 13.0 });
+  bench.run("generation, 2 params x 100", [&] {
+    galgo::GeneticAlgorithm<double> ga(rosenbrock, 100, num_generations, false, x, y);
+    ga.run();
+    doNotOptimize(ga.result());
+  }, num_generations);
+
+  galgo::Parameter<double> p({ -5.0, 5.0 });
+  bench.run("generation, 10 params x 200", [&] {
+    galgo::GeneticAlgorithm<double> ga(sphere, 200, num_generations, false, p, p, p, p, p, p, p, p, p, p);
+    ga.run();
+    doNotOptimize(ga.result());
+  }, num_generations);
+
+  return bench.finish();
+}
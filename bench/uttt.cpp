@@ -0,0 +1,59 @@
+// Ultimate tic-tac-toe: move generation over a spread of positions, and a
+// rollout from the empty board with each rollout policy.
+//
+//   bench-uttt [options]   (see include/bench.hpp)
+#include "../include/bench.hpp"
+
+#define main uttt_main
+#include "../bot-programming/ultimate-tic-tac-toe/ultimate-tic-tac-toe.cpp"
+#undef main
+
+/***************************** User  Variables *******************************/
+
+constexpr int num_positions = 256;   // for the move generation benchmarks
+constexpr u64 seed = 40;
+
+/*****************************************************************************/
+
+// positions from random games, anywhere from the first move to the last
+vector<UltimateBoard> randomPositions() {
+  Pcg32 rng(seed);
+  vector<UltimateBoard> positions;
+  MoveVector moves;
+  while (positions.size() < num_positions) {
+    UltimateBoard board;
+    int plies = bounded(rng, 60);
+    for (int ply = 0; ply < plies; ++ply) {
+      board.getMoves(moves);
+      if (moves.empty()) break;
+      board.mark(globalIdxToLocalIdx_idx(moves[bounded(rng, moves.size())]));
+    }
+    board.getMoves(moves);
+    if (!moves.empty()) positions.push_back(board);
+  }
+  return positions;
+}
+
+int main(int argc, char** argv) {
+  BenchRunner bench("uttt", argc, argv);
+
+  const vector<UltimateBoard> positions = randomPositions();
+  MoveVector moves;
+  bench.run("getMoves", [&] {
+    for (const UltimateBoard& board : positions) {
+      board.getMoves(moves);
+      doNotOptimize(moves);
+    }
+  }, num_positions);
+  bench.run("getNumMoves", [&] {
+    for (const UltimateBoard& board : positions) doNotOptimize(board.getNumMoves());
+  }, num_positions);
+
+  MonteCarlo heavy(UltimateBoard(), heavy_playout), uniform(UltimateBoard(), random_playout);
+  heavy.seed(seed);
+  uniform.seed(seed);
+  bench.run("rollout heavy", [&] { doNotOptimize(heavy.rolloutFromRoot()); });
+  bench.run("rollout random", [&] { doNotOptimize(uniform.rolloutFromRoot()); });
+
+  return bench.finish();
+}
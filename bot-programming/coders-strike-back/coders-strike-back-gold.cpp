@@ -5,15 +5,1189 @@
 #  pragma GCC optimize("unroll-loops")
 #endif
 
+#define SEARCH Rhea         // the bot's search: Rhea or Smitsimax
+#define SEARCH_MS 70        // of the 75 the referee allows a turn
+#define FIRST_TURN_MS 950   // of its 1000 for the first
+
+#define ARENA 0             // race Rhea against Smitsimax locally instead of talking to the referee
+#define ARENA_GAMES 20      // each on its own random map, both searches taking each side once
+#define ARENA_MOVE_MS 10
+
+#define INSTRUMENT 0        // per-turn timers, counters and histograms on stderr (instrument.hpp)
+#define LOG_LEVEL 2         // 0 silent, 1 errors, 2 and the search's line a turn, 3 and hot-loop debug
+
 #include <algorithm>
 #include <array>
+#include <cerrno>
+#include <charconv>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <istream>
+#include <limits>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// typedefs.hpp
+namespace kel {
+  typedef uint8_t u8;
+  typedef int8_t i8;
+  typedef uint16_t u16;
+  typedef int16_t i16;
+  typedef uint32_t u32;
+  typedef int32_t i32;
+  typedef uint64_t u64;
+  typedef int64_t i64;
+
+  typedef unsigned int uint;
+  typedef unsigned long ulong;
+  typedef unsigned long long ull;
+}
+
+
+// rng.hpp
+namespace kel {
+  // Small, fast, deterministic generators. They're all standard
+  // UniformRandomBitGenerators (so std::shuffle and <random>'s distributions
+  // take them), but the helpers below are a lot cheaper than the
+  // distributions: bounded() is Lemire's nearly-divisionless method, one
+  // multiply and almost never a division, instead of rng() % n.
+  //
+  // Every generator is constexpr, seeds from a single u64, and has a way to
+  // hand out independent streams (one per thread, per game, ...):
+  //   Xoshiro256ss: jump() skips 2^128 outputs, longJump() 2^192
+  //   Pcg32:        a stream number picks one of 2^63 sequences, advance(n) skips n
+  //   WyRand:       split() seeds a new generator from this one's output
+
+  // Only used to expand one u64 seed into a bigger state: consecutive seeds
+  // give unrelated states.
+  struct SplitMix64 {
+    using result_type = u64;
+    u64 state;
+
+    constexpr explicit SplitMix64(u64 seed = 0) noexcept : state(seed) {}
+    constexpr u64 operator()() noexcept {
+      u64 z = (state += 0x9e3779b97f4a7c15);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      return z ^ (z >> 31);
+    }
+    static constexpr u64 min() noexcept { return 0; }
+    static constexpr u64 max() noexcept { return ~u64(0); }
+  };
+
+  // xoshiro256** (Blackman & Vigna): 256 bits of state, period 2^256 - 1,
+  // good in every bit of the output
+  class Xoshiro256ss {
+  public:
+    using result_type = u64;
+
+    constexpr explicit Xoshiro256ss(u64 seed = 0x5eed5eed5eed5eed) noexcept : s() { this->seed(seed); }
+    constexpr void seed(u64 seed) noexcept {
+      SplitMix64 expand(seed);
+      for (u64& word : s) word = expand();
+    }
+
+    constexpr u64 operator()() noexcept {
+      const u64 out = rotl(s[1] * 5, 7) * 9;
+      const u64 t = s[1] << 17;
+      s[2] ^= s[0];
+      s[3] ^= s[1];
+      s[1] ^= s[2];
+      s[0] ^= s[3];
+      s[2] ^= t;
+      s[3] = rotl(s[3], 45);
+      return out;
+    }
+    static constexpr u64 min() noexcept { return 0; }
+    static constexpr u64 max() noexcept { return ~u64(0); }
+
+    // the same as 2^128 calls; gives 2^128 non-overlapping streams of 2^128
+    constexpr void jump() noexcept {
+      constexpr u64 poly[4] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+      jumpBy(poly);
+    }
+    // the same as 2^192 calls
+    constexpr void longJump() noexcept {
+      constexpr u64 poly[4] = { 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 };
+      jumpBy(poly);
+    }
+    // a copy of this generator, which then jumps ahead past everything the copy will use
+    constexpr Xoshiro256ss split() noexcept {
+      Xoshiro256ss child = *this;
+      jump();
+      return child;
+    }
+
+  private:
+    u64 s[4];
+
+    static constexpr u64 rotl(u64 x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+    constexpr void jumpBy(const u64 (&poly)[4]) noexcept {
+      u64 t[4] = { 0, 0, 0, 0 };
+      for (u64 word : poly) {
+        for (int b = 0; b < 64; ++b) {
+          if (word & (u64(1) << b)) for (int i = 0; i < 4; ++i) t[i] ^= s[i];
+          (*this)();
+        }
+      }
+      for (int i = 0; i < 4; ++i) s[i] = t[i];
+    }
+  };
+
+  // wyrand (Wang Yi): one add and one 64x64->128 multiply per output, 64 bits
+  // of state, period 2^64
+  class WyRand {
+  public:
+    using result_type = u64;
+
+    constexpr explicit WyRand(u64 seed = 0x5eed5eed5eed5eed) noexcept : state(seed) {}
+    constexpr void seed(u64 seed) noexcept { state = seed; }
+
+    constexpr u64 operator()() noexcept {
+      state += 0xa0761d6478bd642f;
+      unsigned __int128 t = static_cast<unsigned __int128>(state) * (state ^ 0xe7037ed1a0b428db);
+      return static_cast<u64>(t >> 64) ^ static_cast<u64>(t);
+    }
+    static constexpr u64 min() noexcept { return 0; }
+    static constexpr u64 max() noexcept { return ~u64(0); }
+
+    // a new generator seeded from this one; no guarantee the streams never
+    // overlap, but with a 2^64 period they're vanishingly unlikely to
+    constexpr WyRand split() noexcept { return WyRand(SplitMix64((*this)())()); }
+
+  private:
+    u64 state;
+  };
+
+  // PCG32 (O'Neill), XSH-RR: 64-bit LCG state, 32-bit output, period 2^64.
+  // Each `stream` is a different sequence.
+  class Pcg32 {
+  public:
+    using result_type = u32;
+
+    constexpr explicit Pcg32(u64 seed = 0x5eed5eed5eed5eed, u64 stream = 0xda3e39cb94b95bdb) noexcept
+      : state(0), inc((stream << 1) | 1) {
+      (*this)();
+      state += seed;
+      (*this)();
+    }
+    // restart at `seed`, staying on the same stream
+    constexpr void seed(u64 seed) noexcept { *this = Pcg32(seed, inc >> 1); }
+
+    constexpr u32 operator()() noexcept {
+      const u64 old = state;
+      state = old * mult + inc;
+      const u32 xorshifted = static_cast<u32>(((old >> 18) ^ old) >> 27);
+      const int rot = static_cast<int>(old >> 59);
+      return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+    static constexpr u32 min() noexcept { return 0; }
+    static constexpr u32 max() noexcept { return ~u32(0); }
+
+    // the same as `delta` calls, in O(log delta)
+    constexpr void advance(u64 delta) noexcept {
+      u64 acc_mult = 1, acc_plus = 0, cur_mult = mult, cur_plus = inc;
+      for (; delta; delta >>= 1) {
+        if (delta & 1) {
+          acc_mult *= cur_mult;
+          acc_plus = acc_plus * cur_mult + cur_plus;
+        }
+        cur_plus *= cur_mult + 1;
+        cur_mult *= cur_mult;
+      }
+      state = acc_mult * state + acc_plus;
+    }
+    // a generator on another stream, seeded from this one
+    constexpr Pcg32 split() noexcept {
+      u64 seed = (u64((*this)()) << 32) | (*this)();
+      u64 stream = (u64((*this)()) << 32) | (*this)();
+      return Pcg32(seed, stream);
+    }
+
+  private:
+    static constexpr u64 mult = 6364136223846793005;
+    u64 state, inc;
+  };
+
+
+  // [0, range), without the bias or the division of rng() % range
+  template <class Rng>
+  constexpr u32 bounded(Rng& rng, u32 range) noexcept {
+    if constexpr (sizeof(typename Rng::result_type) >= 8) {
+      unsigned __int128 m = static_cast<unsigned __int128>(static_cast<u64>(rng())) * range;
+      u64 low = static_cast<u64>(m);
+      if (low < range) {
+        const u64 threshold = (0 - u64(range)) % range;
+        while (low < threshold) {
+          m = static_cast<unsigned __int128>(static_cast<u64>(rng())) * range;
+          low = static_cast<u64>(m);
+        }
+      }
+      return static_cast<u32>(m >> 64);
+    }
+    else {
+      u64 m = u64(static_cast<u32>(rng())) * range;
+      u32 low = static_cast<u32>(m);
+      if (low < range) {
+        const u32 threshold = (0 - range) % range;
+        while (low < threshold) {
+          m = u64(static_cast<u32>(rng())) * range;
+          low = static_cast<u32>(m);
+        }
+      }
+      return static_cast<u32>(m >> 32);
+    }
+  }
+  // 64 random bits, from two calls if the generator only gives 32
+  template <class Rng>
+  constexpr u64 bits64(Rng& rng) noexcept {
+    if constexpr (sizeof(typename Rng::result_type) >= 8) return static_cast<u64>(rng());
+    else {
+      u64 high = static_cast<u32>(rng());
+      return (high << 32) | static_cast<u32>(rng());
+    }
+  }
+  // [0, range) for ranges that don't fit in 32 bits
+  template <class Rng>
+  constexpr u64 bounded64(Rng& rng, u64 range) noexcept {
+    unsigned __int128 m = static_cast<unsigned __int128>(bits64(rng)) * range;
+    u64 low = static_cast<u64>(m);
+    if (low < range) {
+      const u64 threshold = (0 - range) % range;
+      while (low < threshold) {
+        m = static_cast<unsigned __int128>(bits64(rng)) * range;
+        low = static_cast<u64>(m);
+      }
+    }
+    return static_cast<u64>(m >> 64);
+  }
+  // [lo, hi], both ends included
+  template <class Rng>
+  constexpr int uniformInt(Rng& rng, int lo, int hi) noexcept {
+    const u64 range = u64(i64(hi) - lo) + 1;
+    return static_cast<int>(lo + i64((range <= 0xffffffff) ? bounded(rng, u32(range)) : bounded64(rng, range)));
+  }
+
+  // [0, 1) in steps of 2^-24 (float) or 2^-53 (double), so every step is equally likely
+  template <class Rng>
+  constexpr float uniformFloat(Rng& rng) noexcept {
+    if constexpr (sizeof(typename Rng::result_type) >= 8) return float(static_cast<u64>(rng()) >> 40) * 0x1.0p-24f;
+    else return float(static_cast<u32>(rng()) >> 8) * 0x1.0p-24f;
+  }
+  template <class Rng>
+  constexpr double uniformDouble(Rng& rng) noexcept {
+    return double(bits64(rng) >> 11) * 0x1.0p-53;
+  }
+  // [lo, hi)
+  template <class Rng>
+  constexpr float uniformFloat(Rng& rng, float lo, float hi) noexcept {
+    return lo + uniformFloat(rng) * (hi - lo);
+  }
+  template <class Rng>
+  constexpr double uniformDouble(Rng& rng, double lo, double hi) noexcept {
+    return lo + uniformDouble(rng) * (hi - lo);
+  }
+
+  // true with probability `p`
+  template <class Rng>
+  constexpr bool chance(Rng& rng, float p) noexcept {
+    return uniformFloat(rng) < p;
+  }
+  template <class Rng>
+  constexpr bool coinFlip(Rng& rng) noexcept {
+    return static_cast<typename Rng::result_type>(rng()) >> (std::numeric_limits<typename Rng::result_type>::digits - 1);
+  }
+}
+
+// fast-io.hpp
+namespace kel {
+  // Referee I/O without iostreams. FdReader pulls whatever's available from
+  // a file descriptor with read(2) into its buffer and parses straight out of
+  // it; FdWriter collects a turn's output and hands it to write(2) in one go
+  // when flush() is called (and once more at exit, for whatever's left).
+  // Neither allocates unless you read a std::string.
+  //
+  //   fast_in >> x >> y;                  // whitespace and newlines are skipped, no ignore() needed
+  //   std::string_view row = fast_in.readToken();
+  //   fast_out << x << ' ' << y << '\n';
+  //   fast_out.flush();                   // once per turn, instead of endl per line
+  //
+  // Don't mix these with cin/cout on the same descriptor: each side buffers
+  // what the other can't see.
+
+  class FdReader {
+  public:
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    explicit FdReader(int fd = STDIN_FILENO) noexcept : fd(fd) { buf[0] = '\0'; }
+    FdReader(const FdReader&) = delete;
+    FdReader& operator=(const FdReader&) = delete;
+
+    // true once there's nothing left but whitespace; waits for more input to
+    // find out, so it's for reading files, not for asking between turns
+    bool eof() {
+      skipSpace();
+      return pos == end;
+    }
+
+    template <class Int>
+    Int readInt() {
+      static_assert(std::is_integral<Int>::value, "readInt: not an integer type");
+      skipSpace();
+      bool negative = false;
+      if constexpr (std::is_signed<Int>::value) {
+        negative = (buf[pos] == '-');
+        pos += negative;
+      }
+      // make unsigned so overflow past the end of the number wraps harmlessly
+      using U = std::make_unsigned_t<Int>;
+      U value = 0;
+      while (true) {
+        // the '\0' sentinel at buf[end] stops the loop without a bounds check
+        unsigned digit;
+        while ((digit = unsigned(buf[pos]) - '0') < 10) {
+          value = U(value * 10 + digit);
+          ++pos;
+        }
+        if (pos < end || !refill()) break;   // a number split across two reads carries on
+      }
+      return negative ? Int(U(0) - value) : Int(value);
+    }
+    double readDouble() {
+      std::string_view token = readToken();
+      double value = 0;
+      std::from_chars(token.data(), token.data() + token.size(), value);
+      return value;
+    }
+    // the next character that isn't whitespace ('\0' at the end of input)
+    char readChar() {
+      skipSpace();
+      return (pos < end) ? buf[pos++] : '\0';
+    }
+    // The next whitespace-separated word. It points into the buffer, so it's
+    // only good until the next read.
+    std::string_view readToken() {
+      skipSpace();
+      size_t start = pos;
+      while (true) {
+        while (buf[pos] > ' ') ++pos;
+        if (pos < end) break;
+        size_t len = pos - start;
+        compact(start);
+        start = 0;
+        pos = len;
+        if (!fill()) break;
+      }
+      return std::string_view(buf + start, pos - start);
+    }
+    // The rest of the current line, without the newline (or a '\r' before
+    // it). Also only good until the next read.
+    std::string_view readLine() {
+      size_t start = pos;
+      while (true) {
+        const void* newline = std::memchr(buf + pos, '\n', end - pos);
+        if (newline) {
+          pos = static_cast<const char*>(newline) - buf;
+          break;
+        }
+        size_t len = end - start;
+        compact(start);
+        start = 0;
+        pos = len;
+        if (!fill()) break;
+      }
+      size_t stop = pos;
+      if (pos < end) ++pos;
+      if (stop > start && buf[stop - 1] == '\r') --stop;
+      return std::string_view(buf + start, stop - start);
+    }
+    void skipLine() { readLine(); }
+
+    template <class T>
+    FdReader& operator>>(T& value) {
+      if constexpr (std::is_same<T, bool>::value) value = readInt<int>() != 0;
+      else if constexpr (std::is_same<T, char>::value) value = readChar();
+      else if constexpr (std::is_integral<T>::value) value = readInt<T>();
+      else if constexpr (std::is_floating_point<T>::value) value = static_cast<T>(readDouble());
+      else if constexpr (std::is_same<T, std::string_view>::value) value = readToken();
+      else if constexpr (std::is_same<T, std::string>::value) value.assign(readToken());
+      else static_assert(!sizeof(T*), "FdReader: can't read this type");
+      return *this;
+    }
+
+  private:
+    char buf[capacity + 1];   // one more for the '\0' after the last byte read
+    size_t pos = 0, end = 0;
+    int fd;
+
+    void skipSpace() {
+      while (true) {
+        while (pos < end && buf[pos] <= ' ') ++pos;
+        if (pos < end || !refill()) return;
+      }
+    }
+    // move [from, end) to the front of the buffer
+    void compact(size_t from) noexcept {
+      std::memmove(buf, buf + from, end - from);
+      end -= from;
+      pos -= from;
+      buf[end] = '\0';
+    }
+    // everything's been used: start over at the front
+    bool refill() {
+      pos = end = 0;
+      return fill();
+    }
+    // read more after `end`; blocks until something's there, false at the end of input
+    bool fill() {
+      if (end == capacity) return false;    // a single token bigger than the buffer
+      ssize_t got;
+      do got = ::read(fd, buf + end, capacity - end);
+      while (got < 0 && errno == EINTR);
+      if (got <= 0) {
+        buf[end] = '\0';
+        return false;
+      }
+      end += size_t(got);
+      buf[end] = '\0';
+      return true;
+    }
+  };
+
+  class FdWriter {
+  public:
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    explicit FdWriter(int fd = STDOUT_FILENO) noexcept : fd(fd) {}
+    FdWriter(const FdWriter&) = delete;
+    FdWriter& operator=(const FdWriter&) = delete;
+    ~FdWriter() { flush(); }
+
+    void write(char c) {
+      if (used == capacity) flush();
+      buf[used++] = c;
+    }
+    void write(std::string_view str) {
+      if (str.size() > capacity - used) {
+        flush();
+        if (str.size() > capacity) return writeAll(str.data(), str.size());
+      }
+      std::memcpy(buf + used, str.data(), str.size());
+      used += str.size();
+    }
+    template <class T>
+    void writeNumber(T value) {
+      // 24 is enough for any integer, and for the shortest round-trip form of a double
+      if (capacity - used < 24) flush();
+      used = std::to_chars(buf + used, buf + capacity, value).ptr - buf;
+    }
+    // hand everything written so far to the descriptor
+    void flush() {
+      writeAll(buf, used);
+      used = 0;
+    }
+
+    template <class T>
+    FdWriter& operator<<(const T& value) {
+      if constexpr (std::is_same<T, char>::value) write(value);
+      else if constexpr (std::is_same<T, bool>::value) write(value ? '1' : '0');
+      else if constexpr (std::is_arithmetic<T>::value) writeNumber(value);
+      else write(std::string_view(value));
+      return *this;
+    }
+
+  private:
+    char buf[capacity];
+    size_t used = 0;
+    int fd;
+
+    void writeAll(const char* data, size_t len) {
+      while (len > 0) {
+        ssize_t put = ::write(fd, data, len);
+        if (put <= 0) return;     // nowhere to send it: the referee's gone
+        data += put;
+        len -= size_t(put);
+      }
+    }
+  };
+
+  inline FdReader fast_in(STDIN_FILENO);
+  inline FdWriter fast_out(STDOUT_FILENO);
+}
+
+// instrument.hpp
+namespace kel {
+  // Diagnostics that cost nothing unless they're switched on:
+  //   timeScope("expand");            time from here to the end of the scope (rdtsc)
+  //   countEvent("nodes popped");     add 1 to a named counter
+  //   countAdd("plies", n);           add n
+  //   histogramAdd("depth", depth);   record a value; shown in power-of-2 buckets
+  //   logInfo("best " << move);       a line of log, anything cerr can print
+  //   logDebug(...) / logError(...)   the same at the other levels
+  //   instrTurnEnd();                 once a turn, after the answer's flushed
+  // Everything is collected over the turn and written to stderr in one go by
+  // instrTurnEnd(), then reset; what's left at exit is written then. Errors
+  // are the exception: they go out straight away, in case the bot's about to
+  // die. With INSTRUMENT 0 and LOG_LEVEL 0 every macro is ((void)0), and
+  // the arguments aren't evaluated at all.
+#if INSTRUMENT || LOG_LEVEL > 0
+  namespace instr {
+    // the cycle counter where there is one, steady_clock nanoseconds otherwise
+    inline uint64_t ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    struct TimerStat {
+      const char* name;
+      uint64_t calls, ticks;
+    };
+    struct CounterStat {
+      const char* name;
+      int64_t value;
+    };
+    struct HistogramStat {
+      const char* name;
+      uint64_t samples;
+      int64_t min, max, sum;
+      uint64_t buckets[65];   // 0 for values <= 0, then n for [2^(n-1), 2^n)
+    };
+
+    class Registry {
+    public:
+      static constexpr size_t max_stats = 64;   // of each kind; more than that are dropped
+
+      Registry() : start_ticks(ticks()), start_time(std::chrono::steady_clock::now()) {}
+      ~Registry() { if (pending || hasStats()) endTurn(); }
+
+      // Looked up by name once per call site (see the macros), so several
+      // sites with the same name add up.
+      TimerStat& timer(const char* name) noexcept { return find(timers, num_timers, name); }
+      CounterStat& counter(const char* name) noexcept { return find(counters, num_counters, name); }
+      HistogramStat& histogram(const char* name) noexcept {
+        HistogramStat& stat = find(histograms, num_histograms, name);
+        if (stat.samples == 0) resetHistogram(stat);
+        return stat;
+      }
+      void add(HistogramStat& stat, int64_t value) noexcept {
+        if (value < stat.min) stat.min = value;
+        if (value > stat.max) stat.max = value;
+        stat.sum += value;
+        ++stat.samples;
+        ++stat.buckets[(value <= 0) ? 0 : 64 - __builtin_clzll(uint64_t(value))];
+      }
+
+      std::ostream& log() noexcept {
+        pending = true;
+        return log_lines;
+      }
+      void logNow(const std::string& line) noexcept { writeAll(line.data(), line.size()); }
+
+      void endTurn() {
+        if (!pending && !hasStats()) {
+          ++turn;
+          return;
+        }
+        std::ostringstream out;
+        out << "-- turn " << turn++ << " --\n" << log_lines.str();
+        const double ticks_per_us = ticksPerMicro();
+        out << std::fixed << std::setprecision(2);
+        for (size_t idx = 0; idx < num_timers; ++idx) {
+          TimerStat& stat = timers[idx];
+          if (stat.calls == 0) continue;
+          const double total_us = stat.ticks / ticks_per_us;
+          out << "time  " << std::left << std::setw(24) << stat.name << std::right
+              << std::setw(10) << stat.calls << " calls " << std::setw(12) << total_us << " us "
+              << std::setw(10) << total_us / stat.calls << " us/call\n";
+          stat.calls = stat.ticks = 0;
+        }
+        for (size_t idx = 0; idx < num_counters; ++idx) {
+          CounterStat& stat = counters[idx];
+          if (stat.value == 0) continue;
+          out << "count " << std::left << std::setw(24) << stat.name << std::right << std::setw(10) << stat.value << '\n';
+          stat.value = 0;
+        }
+        for (size_t idx = 0; idx < num_histograms; ++idx) {
+          HistogramStat& stat = histograms[idx];
+          if (stat.samples == 0) continue;
+          out << "hist  " << std::left << std::setw(24) << stat.name << std::right
+              << " n " << stat.samples << ", min " << stat.min << ", mean " << double(stat.sum) / stat.samples
+              << ", max " << stat.max << "\n     ";
+          for (int bucket = 0; bucket < 65; ++bucket) {
+            if (stat.buckets[bucket] == 0) continue;
+            if (bucket == 0) out << " <=0:";
+            else if (bucket == 1) out << " 1:";
+            else out << ' ' << (uint64_t(1) << (bucket - 1)) << '-' << (uint64_t(1) << bucket) - 1 << ':';
+            out << stat.buckets[bucket];
+          }
+          out << '\n';
+          resetHistogram(stat);
+        }
+        const std::string text = out.str();
+        writeAll(text.data(), text.size());
+        log_lines.str(std::string());
+        pending = false;
+      }
+
+    private:
+      TimerStat timers[max_stats] = {};
+      CounterStat counters[max_stats] = {};
+      HistogramStat histograms[max_stats] = {};
+      size_t num_timers = 0, num_counters = 0, num_histograms = 0;
+      std::ostringstream log_lines;
+      int turn = 0;
+      bool pending = false;
+      uint64_t start_ticks;
+      std::chrono::steady_clock::time_point start_time;
+
+      bool hasStats() const noexcept {
+        for (size_t idx = 0; idx < num_timers; ++idx) if (timers[idx].calls) return true;
+        for (size_t idx = 0; idx < num_counters; ++idx) if (counters[idx].value) return true;
+        for (size_t idx = 0; idx < num_histograms; ++idx) if (histograms[idx].samples) return true;
+        return false;
+      }
+      template <class Stat>
+      Stat& find(Stat (&stats)[max_stats], size_t& count, const char* name) noexcept {
+        for (size_t idx = 0; idx < count; ++idx) {
+          if (std::strcmp(stats[idx].name, name) == 0) return stats[idx];
+        }
+        if (count == max_stats) {
+          static Stat overflow;   // counted, but never shown
+          return overflow;
+        }
+        stats[count].name = name;
+        return stats[count++];
+      }
+      static void resetHistogram(HistogramStat& stat) noexcept {
+        const char* name = stat.name;
+        stat = HistogramStat();
+        stat.name = name;
+        stat.min = INT64_MAX;
+        stat.max = INT64_MIN;
+      }
+      // calibrated against steady_clock over everything since startup
+      double ticksPerMicro() const noexcept {
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+        return (us > 0) ? (ticks() - start_ticks) / us : 1.0;
+      }
+      static void writeAll(const char* data, size_t len) noexcept {
+        while (len > 0) {
+          ssize_t put = ::write(STDERR_FILENO, data, len);
+          if (put <= 0) return;
+          data += put;
+          len -= size_t(put);
+        }
+      }
+    };
+
+    inline Registry& registry() {
+      static Registry reg;
+      return reg;
+    }
+
+    class ScopedTimer {
+    public:
+      explicit ScopedTimer(TimerStat& stat) noexcept : stat(stat), start(ticks()) {}
+      ~ScopedTimer() {
+        stat.ticks += ticks() - start;
+        ++stat.calls;
+      }
+    private:
+      TimerStat& stat;
+      uint64_t start;
+    };
+  }
+#endif
+
+#define _instrCat2(a, b) a##b
+#define _instrCat(a, b) _instrCat2(a, b)
+#define _instrSite(kind, name)                                                 \
+  static auto& _instrCat(_instr_stat_, __LINE__) = ::kel::instr::registry().kind(name)
+
+#if INSTRUMENT
+#define timeScope(name)                                                        \
+  _instrSite(timer, name);                                                     \
+  ::kel::instr::ScopedTimer _instrCat(_instr_timer_, __LINE__)(_instrCat(_instr_stat_, __LINE__))
+#define countAdd(name, n)                                                      \
+  do {                                                                         \
+    _instrSite(counter, name);                                                 \
+    _instrCat(_instr_stat_, __LINE__).value += (n);                            \
+  } while (0)
+#define countEvent(name) countAdd(name, 1)
+#define histogramAdd(name, value)                                              \
+  do {                                                                         \
+    _instrSite(histogram, name);                                               \
+    ::kel::instr::registry().add(_instrCat(_instr_stat_, __LINE__), (value));  \
+  } while (0)
+#else
+#define timeScope(name) ((void)0)
+#define countAdd(name, n) ((void)0)
+#define countEvent(name) ((void)0)
+#define histogramAdd(name, value) ((void)0)
+#endif
+
+#if LOG_LEVEL >= 1
+#define logError(...)                                                          \
+  do {                                                                         \
+    std::ostringstream _instr_line;                                            \
+    _instr_line << "error: " << __VA_ARGS__ << '\n';                           \
+    ::kel::instr::registry().logNow(_instr_line.str());                        \
+  } while (0)
+#else
+#define logError(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 2
+#define logInfo(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logInfo(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 3
+#define logDebug(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logDebug(...) ((void)0)
+#endif
+
+#if INSTRUMENT || LOG_LEVEL >= 2
+#define instrTurnEnd() ::kel::instr::registry().endTurn()
+#else
+#define instrTurnEnd() ((void)0)
+#endif
+}
+
+// csb-physics.hpp
+namespace kel {
+  // Coders Strike Back's physics the way the referee runs them, templated on
+  // the scalar they're done in: the bot searches in double, the nn trainer
+  // plays its races in float, and a Fixed<> gives the same answer whatever
+  // the compiler does with floating point. Everything that does maths on a T
+  // calls it unqualified (sqrt(x), not std::sqrt(x)), so a scalar type can
+  // bring its own through ADL.
+  //
+  // A turn is apply() (or applyTarget()) for each pod, then simFrame(), which
+  // moves all four, bounces pods off each other and passes checkpoints in the
+  // order they happen, and ends with the referee's friction and rounding.
+  //
+  // Angles are in degrees, like the game's input: 0 is east, 90 is south,
+  // and a pod's facing is kept in [0, 360) once it has one.
+
+  template <class T>
+  struct BasicVec2 {
+    T x, y;
+    constexpr BasicVec2() : x(), y() {}
+    constexpr BasicVec2(T x, T y) : x(x), y(y) {}
+    template <class U>
+    explicit constexpr BasicVec2(const BasicVec2<U>& other) : x(T(other.x)), y(T(other.y)) {}
+
+    constexpr T r2() const { return x * x + y * y; }
+    T r() const {
+      using std::sqrt;
+      return sqrt(r2());
+    }
+
+    constexpr bool operator==(const BasicVec2& other) const { return x == other.x && y == other.y; }
+    constexpr bool operator!=(const BasicVec2& other) const { return !(*this == other); }
+
+    constexpr BasicVec2 operator+(const BasicVec2& other) const { return { x + other.x, y + other.y }; }
+    constexpr BasicVec2 operator-(const BasicVec2& other) const { return { x - other.x, y - other.y }; }
+    constexpr BasicVec2 operator*(T d) const { return { x * d, y * d }; }
+    constexpr BasicVec2 operator/(T d) const { return { x / d, y / d }; }
+    constexpr BasicVec2 operator-() const { return { -x, -y }; }
+    constexpr BasicVec2& operator+=(const BasicVec2& other) { x += other.x; y += other.y; return *this; }
+    constexpr BasicVec2& operator-=(const BasicVec2& other) { x -= other.x; y -= other.y; return *this; }
+    constexpr BasicVec2& operator*=(T d) { x *= d; y *= d; return *this; }
+  };
+  template <class T>
+  constexpr T dot(const BasicVec2<T>& lhs, const BasicVec2<T>& rhs) { return lhs.x * rhs.x + lhs.y * rhs.y; }
+
+  // The referee's Math.round: to the nearest whole number, halves toward
+  // +inf. std::round takes halves away from zero instead, which sends
+  // -2.5 to -3 where the referee has -2. x - floor(x) is exact, so unlike
+  // floor(x + 0.5) this never rounds up something just under a half.
+  template <class T>
+  T roundHalfUp(T x) {
+    using std::floor;
+    T whole = floor(x);
+    return (x - whole >= T(0.5)) ? whole + T(1) : whole;
+  }
+
+  // Trig without libm. A facing is a whole number of degrees at the start
+  // of every turn and moves by at most 18 in it, so a pod's heading is the
+  // table entry for the whole degree, rotated by the fraction through the
+  // angle-sum formulas with short series (exact at whole degrees, where the
+  // fraction is 0). atan2 is a table of atan(k / 64) and the series for
+  // what's left, which is under 1/128. Both are as close as libm's in float
+  // and double (tools-csb-parity measures it), with no call that can't be
+  // inlined, and they come out the same in a Fixed<> on any machine.
+  namespace trig {
+    // at compile time, so only ever for the tables
+    constexpr long double pi = 3.141592653589793238462643383279502884L;
+    constexpr long double sinSeries(long double x) {
+      long double sum = 0, term = x;
+      for (int n = 1; n < 30; n += 2) {
+        sum += term;
+        term *= -x * x / ((n + 1) * (n + 2));
+      }
+      return sum;
+    }
+    constexpr long double sinDegree(int deg) {
+      deg %= 360;
+      if (deg >= 180) return -sinDegree(deg - 180);
+      if (deg > 90) deg = 180 - deg;
+      return sinSeries(deg * pi / 180);
+    }
+    // Euler's series, which converges for any x
+    constexpr long double atanSeries(long double x) {
+      long double ratio = x * x / (1 + x * x), sum = 0, term = x / (1 + x * x);
+      for (int n = 1; n < 120; ++n) {
+        sum += term;
+        term *= ratio * (2 * n) / (2 * n + 1);
+      }
+      return sum;
+    }
+
+    constexpr int atan_steps = 64;
+    template <class T>
+    struct Tables {
+      // sin of every whole degree up to 450, so cos(deg) is sines[deg + 90]
+      static constexpr std::array<T, 451> sines = [] {
+        std::array<T, 451> ret{};
+        for (int deg = 0; deg <= 450; ++deg) ret[deg] = T(double(sinDegree(deg)));
+        return ret;
+      }();
+      static constexpr std::array<T, atan_steps + 1> atans = [] {
+        std::array<T, atan_steps + 1> ret{};
+        for (int k = 0; k <= atan_steps; ++k) ret[k] = T(double(atanSeries((long double)k / atan_steps)));
+        return ret;
+      }();
+    };
+  }
+
+  // (cos, sin) of an angle in [0, 360) degrees
+  template <class T>
+  BasicVec2<T> unitVector(T degrees) {
+    using Tables = trig::Tables<T>;
+    int whole = int(degrees);
+    T frac = (degrees - T(whole)) * T(M_PI) / T(180);
+    T frac2 = frac * frac;
+    T sin_frac = frac * (T(1) - frac2 * (T(1.0 / 6) - frac2 * T(1.0 / 120)));
+    T cos_frac = T(1) - frac2 * (T(0.5) - frac2 * (T(1.0 / 24) - frac2 * T(1.0 / 720)));
+    T sin_whole = Tables::sines[whole], cos_whole = Tables::sines[whole + 90];
+    return { cos_whole * cos_frac - sin_whole * sin_frac, sin_whole * cos_frac + cos_whole * sin_frac };
+  }
+  // std::atan2, in radians in [-pi, pi]
+  template <class T>
+  T fastAtan2(T y, T x) {
+    using std::abs;
+    using Tables = trig::Tables<T>;
+    T abs_x = abs(x), abs_y = abs(y);
+    if (abs_x == T(0) && abs_y == T(0)) return T(0);
+    bool steep = abs_y > abs_x;
+    T ratio = steep ? abs_x / abs_y : abs_y / abs_x;
+    int step = int(ratio * T(trig::atan_steps) + T(0.5));
+    T at_step = T(step) / T(trig::atan_steps);
+    // atan(ratio) - atan(at_step)
+    T rest = (ratio - at_step) / (T(1) + ratio * at_step);
+    T rest2 = rest * rest;
+    T ret = Tables::atans[step] + rest * (T(1) - rest2 * (T(1.0 / 3) - rest2 * T(0.2)));
+    if (steep) ret = T(M_PI / 2) - ret;
+    if (x < T(0)) ret = T(M_PI) - ret;
+    return (y < T(0)) ? -ret : ret;
+  }
+
+  enum SpecialThrust : int { SHIELD = -1, BOOST = 650 };
+
+  // one pod's command for a turn: thrust is 0 to 100, SHIELD or BOOST, and
+  // turn is how far to rotate first, in degrees (clamped to max_turn)
+  template <class T>
+  struct BasicMove {
+    int thrust;
+    T turn;
+  };
+
+  template <class T>
+  struct BasicPod {
+    static constexpr int radius = 400;
+    static constexpr int max_turn = 18;
+    // the turn a shield goes up counts, then 3 more without thrust
+    static constexpr int shield_turns = 4;
+
+    BasicVec2<T> pos, vel;
+    T angle;            // facing; negative until the first turn sets it
+    int next_cp;        // index of the checkpoint it's heading for
+    int laps;           // times it has passed checkpoint 0
+    bool can_boost;
+    int shield_frames;  // turns left before it can thrust again
+
+    BasicPod() : pos(), vel(), angle(-1), next_cp(1), laps(0), can_boost(true), shield_frames(0) {}
+    template <class U>
+    explicit BasicPod(const BasicPod<U>& other)
+      : pos(other.pos), vel(other.vel), angle(T(other.angle)), next_cp(other.next_cp),
+        laps(other.laps), can_boost(other.can_boost), shield_frames(other.shield_frames) {}
+
+    T mass() const { return T((shield_frames == shield_turns) ? 10 : 1); }
+
+    BasicVec2<T> heading() const { return unitVector(angle); }
+    // the absolute angle from here to target
+    T angleTo(const BasicVec2<T>& target) const {
+      BasicVec2<T> d = target - pos;
+      T deg = fastAtan2(d.y, d.x) * T(180) / T(M_PI);
+      return (deg < T(0)) ? deg + T(360) : deg;
+    }
+    // how far to turn from `from` to face `to`, in (-180, 180]
+    static T turnBetween(T from, T to) {
+      T turn = to - from;
+      if (turn > T(180)) turn -= T(360);
+      else if (turn <= T(-180)) turn += T(360);
+      return turn;
+    }
+
+    void apply(int thrust, T turn) {
+      angle += std::clamp(turn, T(-max_turn), T(max_turn));
+      if (angle >= T(360)) angle -= T(360);
+      else if (angle < T(0)) angle += T(360);
+
+      if (thrust == SHIELD) {
+        shield_frames = shield_turns;
+        return;
+      }
+      if (shield_frames > 0) return;
+      if (thrust == BOOST) {
+        // a second boost is just full thrust
+        if (can_boost) can_boost = false;
+        else thrust = 100;
+      }
+      vel += heading() * T(thrust);
+    }
+    void apply(const BasicMove<T>& move) { apply(move.thrust, move.turn); }
+    // what the game's "x y thrust" does: turn toward target, all the way on
+    // the first turn, then thrust
+    void applyTarget(const BasicVec2<T>& target, int thrust) {
+      T want = angleTo(target);
+      if (angle < T(0)) angle = want;
+      apply(thrust, turnBetween(angle, want));
+    }
+
+    void move(T t) { pos += vel * t; }
+
+    // friction, then the rounding the referee sends back as integers: a
+    // Math.round of the position and facing, and a cast to int (toward
+    // zero) of the velocity
+    void endFrame() {
+      using std::trunc;
+      pos = { roundHalfUp(pos.x), roundHalfUp(pos.y) };
+      vel = { trunc(vel.x * T(0.85)), trunc(vel.y * T(0.85)) };
+      angle = roundHalfUp(angle);
+      if (angle >= T(360)) angle -= T(360);
+      if (shield_frames > 0) --shield_frames;
+    }
+
+    // When, within a frame of now, this pod first touches `other`. Pods that
+    // already overlap only count while they're still closing on each other,
+    // which keeps a bounce from being found again at the same instant.
+    bool collisionTime(const BasicPod& other, T& time) const {
+      return contactTime(pos - other.pos, vel - other.vel, T(2 * radius), time);
+    }
+    // When, within a frame, this pod's centre enters the checkpoint at cp.
+    bool checkpointTime(const BasicVec2<T>& cp, int cp_radius, T& time) const {
+      if ((pos - cp).r2() <= T(cp_radius) * T(cp_radius)) {
+        time = T(0);
+        return true;
+      }
+      return contactTime(pos - cp, vel, T(cp_radius), time);
+    }
+
+    // The referee's elastic collision: the impulse that swaps the pods'
+    // velocities along the line between them (weighted by mass), applied
+    // once, then again scaled up to at least 120.
+    void bounce(BasicPod& other) {
+      T m1 = mass(), m2 = other.mass();
+      BasicVec2<T> normal = pos - other.pos;
+      T dist2 = normal.r2();
+      if (dist2 == T(0)) return;
+      BasicVec2<T> force = normal * (dot(normal, vel - other.vel) * m1 * m2 / ((m1 + m2) * dist2));
+      vel -= force / m1;
+      other.vel += force / m2;
+
+      T impulse = force.r();
+      if (impulse > T(0) && impulse < T(120)) force *= T(120) / impulse;
+      vel -= force / m1;
+      other.vel += force / m2;
+    }
+
+  private:
+    // Earliest time in [0, 1] that |d + dv t| comes down to `reach`, for a d
+    // that's closing (d.dv < 0). Written in terms of the closest approach
+    // rather than the raw quadratic so no intermediate gets much bigger than
+    // a squared distance, which a Fixed<> has room for. None of it depends
+    // on how much of the frame is left, so every pair can be worked out at
+    // once (csb-physics-sse.hpp does) and the earliest picked after.
+    static bool contactTime(const BasicVec2<T>& d, const BasicVec2<T>& dv, T reach, T& time) {
+      using std::sqrt;
+      T closing = dot(d, dv);
+      if (!(closing < T(0))) return false;
+      T gap = d.r2() - reach * reach;
+      if (gap <= T(0)) {
+        time = T(0);
+        return true;
+      }
+      // gap = -2 closing t - |dv|^2 t^2 at contact, so it can't come before
+      // gap / (-2 closing), and that has to be inside the frame
+      if (gap > T(-2) * closing) return false;
+      T speed2 = dv.r2();
+      T closest_at = -closing / speed2;
+      T half_chord2 = -closing * closest_at - gap;  // reach^2 - (closest distance)^2
+      if (half_chord2 < T(0)) return false;
+      time = std::max(T(0), closest_at - sqrt(half_chord2 / speed2));
+      return true;
+    }
+  };
+
+  template <class T>
+  struct BasicField {
+    static constexpr int checkpoint_radius = 600;
+    static constexpr int max_checkpoints = 8;
+
+    int num_laps, num_checkpoints;
+    std::array<BasicVec2<T>, max_checkpoints> checkpoints;
+
+    BasicField() : num_laps(), num_checkpoints(), checkpoints() {}
+    template <class U>
+    explicit BasicField(const BasicField<U>& other) : num_laps(other.num_laps), num_checkpoints(other.num_checkpoints) {
+      for (int idx = 0; idx < max_checkpoints; ++idx) checkpoints[idx] = BasicVec2<T>(other.checkpoints[idx]);
+    }
+
+    // the game's initialisation input
+    friend std::istream& operator>>(std::istream& is, BasicField& field) {
+      is >> field.num_laps >> field.num_checkpoints;
+      field.num_checkpoints = std::clamp(field.num_checkpoints, 0, max_checkpoints);
+      for (int idx = 0; idx < field.num_checkpoints; ++idx) {
+        int x, y;
+        is >> x >> y;
+        field.checkpoints[idx] = { T(x), T(y) };
+      }
+      return is;
+    }
+  };
+
+  template <class T>
+  struct BasicRace {
+    static constexpr int timeout_turns = 100;
+
+    std::array<BasicPod<T>, 4> pods;  // team 0's two, then team 1's
+    std::array<int, 2> timeouts;      // turns each team has left to reach a checkpoint
+
+    BasicRace() : pods(), timeouts{ timeout_turns, timeout_turns } {}
+    template <class U>
+    explicit BasicRace(const BasicRace<U>& other) : timeouts(other.timeouts) {
+      for (int idx = 0; idx < 4; ++idx) pods[idx] = BasicPod<T>(other.pods[idx]);
+    }
+
+    BasicPod<T>& pod(int team, int idx) { return pods[2 * team + idx]; }
+    const BasicPod<T>& pod(int team, int idx) const { return pods[2 * team + idx]; }
+
+    // Points every pod without a facing at its next checkpoint, which is
+    // what its first turn does anyway for a bot that aims at it. Only needed
+    // before steering with relative turns.
+    void faceCheckpoints(const BasicField<T>& field) {
+      for (BasicPod<T>& p : pods) {
+        if (p.angle < T(0)) p.angle = p.angleTo(field.checkpoints[p.next_cp]);
+      }
+    }
+
+    // 0 if ongoing
+    // 1 if team 0 has won, 2 if team 1 has won
+    int outcome(const BasicField<T>& field) const {
+      for (int team = 0; team < 2; ++team) {
+        if (pod(team, 0).laps >= field.num_laps || pod(team, 1).laps >= field.num_laps) return 1 + team;
+      }
+      for (int team = 0; team < 2; ++team) {
+        if (timeouts[team] <= 0) return 2 - team;
+      }
+      return 0;
+    }
+
+    void simFrame(const BasicField<T>& field) {
+      --timeouts[0];
+      --timeouts[1];
+      T t = T(0);
+      while (t < T(1)) {
+        // the first thing to happen in what's left of the frame: a pair of
+        // pods touching, or a pod (hit_with == -1) reaching its checkpoint
+        T first = T(1) - t, time;
+        int hit = -1, hit_with = -1;
+        for (int idx = 0; idx < 4; ++idx) {
+          for (int other = idx + 1; other < 4; ++other) {
+            if (pods[idx].collisionTime(pods[other], time) && time < first) {
+              first = time;
+              hit = idx;
+              hit_with = other;
+            }
+          }
+        }
+        for (int idx = 0; idx < 4; ++idx) {
+          const BasicVec2<T>& cp = field.checkpoints[pods[idx].next_cp];
+          if (pods[idx].checkpointTime(cp, field.checkpoint_radius, time) && time < first) {
+            first = time;
+            hit = idx;
+            hit_with = -1;
+          }
+        }
+
+        for (BasicPod<T>& p : pods) p.move(first);
+        t += first;
+        if (hit < 0) break;
+        if (hit_with >= 0) pods[hit].bounce(pods[hit_with]);
+        else passCheckpoint(field, hit);
+      }
+      for (BasicPod<T>& p : pods) p.endFrame();
+    }
+
+    BasicRace next(const BasicField<T>& field) const {
+      BasicRace ret = *this;
+      ret.simFrame(field);
+      return ret;
+    }
+
+    // a turn's input: four lines of "x y vx vy angle next_cp", the reader's
+    // two pods first
+    friend std::istream& operator>>(std::istream& is, BasicRace& race) {
+      for (BasicPod<T>& p : race.pods) {
+        int x, y, vx, vy, angle;
+        is >> x >> y >> vx >> vy >> angle >> p.next_cp;
+        p.pos = { T(x), T(y) };
+        p.vel = { T(vx), T(vy) };
+        p.angle = T(angle);
+      }
+      return is;
+    }
+
+  private:
+    void passCheckpoint(const BasicField<T>& field, int idx) {
+      BasicPod<T>& p = pods[idx];
+      if (p.next_cp == 0) ++p.laps;
+      p.next_cp = (p.next_cp + 1) % field.num_checkpoints;
+      timeouts[idx / 2] = timeout_turns;
+    }
+  };
+}
 
 using namespace std;
+using namespace kel;
 
 using Timer = chrono::steady_clock;
 using chrono::milliseconds;
@@ -95,332 +1269,455 @@ I/O Format Info from Coders Strike Back Gold:
 */
 
 
-struct Vec2_xy;
-struct Vec2_pol;
-using Cartesian = Vec2_xy;
-using Polar = Vec2_pol;
+using Vec2 = BasicVec2<double>;
+using Pod = BasicPod<double>;
+using Move = BasicMove<double>;
+using Field = BasicField<double>;
+using GameState = BasicRace<double>;  // pods 0 and 1 are ours
 
-constexpr double degrees(double radians) { return radians * (180.0 / M_PI); }
-constexpr double radians(double degrees) { return degrees * (M_PI / 180.0); }
-
-double dot(Vec2_xy a, Vec2_xy b) { return a.x * b.x + a.y * b.y; }
-double dot(Vec2_pol a, Vec2_pol b) { return a.r * b.r * cos(a.theta - b.theta); }
-
-struct Vec2_xy {
-  double x, y;
-  Vec2_xy(double x, double y) : x(x), y(y) {}
-  explicit operator Vec2_pol() const { return polar(); }
-
-  double r() const { return sqrt(x * x + y * y); }
-  double r2() const { return x * x + y * y; }
-
-  double theta() const { return atan2(y, x); }
-
-  Vec2_pol polar() const { return { r(), theta() }; }
-
-  bool operator==(const Vec2_xy& other) const { return x == other.x && y == other.y; }
-  bool operator!=(const Vec2_xy& other) const { return x != other.x || y != other.y; }
-
-  Vec2_xy operator*(double d) const { return { x * d, y * d }; }
-  Vec2_xy& operator*=(double d) { x *= d; y *= d; return *this; }
-
-  Vec2_xy operator+(const Vec2_xy& other) const { return { x + other.x, y + other.y }; }
-  Vec2_xy operator-(const Vec2_xy& other) const { return { x - other.x, y - other.y }; }
-  Vec2_xy& operator+=(const Vec2_xy& other) { x += other.x; y += other.y; return *this; }
-  Vec2_xy& operator-=(const Vec2_xy& other) { x -= other.x; y -= other.y; return *this; }
-
-  Vec2_xy operator-() const { return { -x, -y }; }
-};
-struct Vec2_pol {
-  double r, theta;
-  Vec2_pol(double r, double theta) : r(r), theta(theta) {}
-  operator Vec2_xy() const { return { x(), y() }; }
-
-  double x() const { return r * cos(theta); }
-  double y() const { return r * sin(theta); }
-
-  Vec2_xy xy() const { return { x(), y() }; }
-
-  void fixAngle() { theta = fmod(theta, M_2_PI); }
+Field map;
 
-  double diffAngle(const Vec2_pol& other) const {
-    double da = theta - other.theta;
-    if (da > M_PI) da -= M_PI;
-    if (da < -M_PI) da += M_PI;
-    return da;
+// How far along the race a pod is. A checkpoint is worth more than any
+// distance on the map, so passing one always counts for more than getting
+// closer to the next.
+double progress(const Pod& pod) {
+  int passed = pod.laps * map.num_checkpoints + (pod.next_cp + map.num_checkpoints - 1) % map.num_checkpoints;
+  return passed * 30000.0 - (map.checkpoints[pod.next_cp] - pod.pos).r();
+}
+
+// which of a team's pods (0 or 1) is further along
+int leader(const GameState& state, int team) {
+  return (progress(state.pod(team, 0)) >= progress(state.pod(team, 1))) ? 0 : 1;
+}
+
+// Full thrust at the next checkpoint, aiming off it by three turns of
+// velocity to cut the drift.
+void steerToCheckpoint(Pod& pod) { pod.applyTarget(map.checkpoints[pod.next_cp] - pod.vel * 3.0, 100); }
+
+// what the opponent is expected to do
+void predictOpponent(GameState& state) {
+  for (int idx = 0; idx < 2; ++idx) steerToCheckpoint(state.pod(1, idx));
+}
+
+// The game gives a team a single boost: once either pod has used it,
+// neither can.
+void shareBoost(GameState& state, int team) {
+  Pod& first = state.pod(team, 0);
+  Pod& second = state.pod(team, 1);
+  if (!first.can_boost || !second.can_boost) first.can_boost = second.can_boost = false;
+}
+void applyTeam(GameState& state, int team, const array<Move, 2>& moves) {
+  state.pod(team, 0).apply(moves[0]);
+  state.pod(team, 1).apply(moves[1]);
+  shareBoost(state, team);
+}
+
+// From our side: a win is worth more than anything, sooner is better; short
+// of that, the runner's lead over their best pod, and the blocker sitting
+// across their runner's path to its checkpoint, facing it.
+double evaluate(const GameState& state, int runner, int steps) {
+  if (int outcome = state.outcome(map)) return ((outcome == 1) ? 1.0 : -1.0) * (1e9 - steps);
+  const Pod& ours = state.pod(0, runner);
+  const Pod& blocker = state.pod(0, 1 - runner);
+  const Pod& theirs = state.pod(1, leader(state, 1));
+  double score = progress(ours) - progress(theirs);
+  Vec2 their_cp = map.checkpoints[theirs.next_cp];
+  score -= 0.5 * (blocker.pos - their_cp).r();
+  score -= 0.25 * (blocker.pos - theirs.pos).r();
+  score -= 20.0 * abs(Pod::turnBetween(blocker.angle, blocker.angleTo(theirs.pos)));
+  return score;
+}
+
+// Rolling horizon evolution: a population of plans, each `depth` turns
+// of moves for both our pods, scored by playing them out with simFrame
+// against predictOpponent and evaluating where they end. Every generation
+// breeds one child (the better of two random plans, mutated) and puts it in
+// place of the worst plan if it beats it. After a turn the plans all move
+// on by one, so the best so far is where the next search starts.
+class Rhea {
+public:
+  static constexpr const char* name = "rhea";
+  static constexpr int depth = 6;
+  static constexpr int population_size = 8;
+  using Plan = array<array<Move, 2>, depth>;
+
+  explicit Rhea(u64 seed = 47) : rng(seed) {
+    for (Plan& plan : plans) {
+      for (auto& turn : plan) turn = { randomMove(), randomMove() };
+    }
   }
 
-  Vec2_pol operator*(double d) const { return { r * d, theta }; }
-  Vec2_pol& operator*=(double d) { r *= d; return *this; }
-
-  Vec2_pol operator-() const { return { -r, theta }; }
-};
-
-
-/* The checkpoints work as follows:
- *  The checkpoints are circular, with a radius of 600 units.
- *  Checkpoints are numbered from 0 to N where 0 is the start and N-1 is the last checkpoint.
- *  The disposition of the checkpoints is selected randomly for each race.
-*/
-struct Checkpoint : Vec2_xy {
-  constexpr static double radius = 600.0;
-};
-
-/* The pods work as follows:
-    To pass a checkpoint, the center of a pod must be inside the radius of the checkpoint.
-    To move a pod, you must print a target destination point followed by a thrust value.
-      Details of the protocol can be found further down.
-    The thrust value of a pod is its acceleration and must be between 0 and 100.
-    The pod will pivot to face the destination point by a maximum of 18 degrees per turn
-      and will then accelerate in that direction.
-    You can use 1 acceleration boost in the race, you only need to replace the thrust value by the BOOST keyword.
-    You may activate a pod's shields with the SHIELD command instead of accelerating.
-      This will give the pod much more weight if it collides with another.
-      However, the pod will not be able to accelerate for the next 3 turns.
-    The pods have a circular force-field around their center, with a radius of 400 units,
-      which activates in case of collisions with other pods.
-    The pods may move normally outside the game area.
-    If none of your pods make it to their next checkpoint in under 100 turns,
-      you are eliminated and lose the game. Only one pod need to complete the race.
-  Each pod is represented by 6 integers:
-    * x & y for the position. 
-    * vx & vy for the speed vector. 
-    * angle for the rotation angle in degrees. 
-    * nextCheckPointId for the number of the next checkpoint the pod must go through.
-*/
-struct Pod {
-  constexpr static double radius = 400.0;
-  Vec2_xy pos;        // position of the pod
-  Vec2_xy vel;        // velocity vector
-  Vec2_pol dir;       // direction vector (rotation angle)
-  size_t next_cp;     // next checkpoint
-
-  int laps;           // number of completed laps
-  bool can_boost;     // whether the pod can still activate its boost
-  int shield_frames;  // how many frames before the pod can accelerate or shield again
-  int timeout;
-  Pod() : pos(0.0, 0.0), vel(0.0, 0.0), dir(1.0, 0.0), next_cp(0),
-    laps(0), can_boost(true), shield_frames(0), timeout(100) {}
-
-  double mass() const { return (shield_frames == 4) ? 10.0 : 1.0; }
-
-  enum SpecialThrust : int { SHIELD = -1, BOOST = 650 };
-  void apply(int thrust, double angle_rad) {
-    constexpr static double max_turn = radians(18.0);
-    angle_rad = clamp(angle_rad, -max_turn, max_turn);
-    dir.theta += angle_rad;
-    dir.fixAngle();
-
-    if (thrust == SHIELD) shield_frames = 4;
-    else if (shield_frames > 0) return;
-    else vel += dir * thrust;
+  // Searches from state until deadline; returns the number of playouts.
+  int runSearch(const GameState& state, Timer::time_point deadline) {
+    root = state;
+    runner = leader(root, 0);
+    // the last turn's plans were scored from a state that's gone
+    for (int idx = 0; idx < population_size; ++idx) scores[idx] = score(plans[idx]);
+    int rollouts = population_size;
+    for (; Timer::now() < deadline; ++rollouts) {
+      Plan child = plans[tournament()];
+      mutate(child);
+      double child_score = score(child);
+      int worst = int(min_element(scores.begin(), scores.end()) - scores.begin());
+      if (child_score > scores[worst]) {
+        plans[worst] = child;
+        scores[worst] = child_score;
+      }
+    }
+    return rollouts;
   }
-
-  void move(double t) { pos += vel * t; }
-
-  void endFrame() {
-    pos = { round(pos.x), round(pos.y) };
-    vel = { trunc(vel.x * 0.85), trunc(vel.y * 0.85) };
-
-    if (shield_frames > 0) --shield_frames;
+  array<Move, 2> getBest() const { return plans[best()][0]; }
+  double getBestScore() const { return scores[best()]; }
+  // Drops the turn that was just played from every plan.
+  void advance() {
+    for (Plan& plan : plans) {
+      rotate(plan.begin(), plan.begin() + 1, plan.end());
+      plan.back() = { randomMove(), randomMove() };
+    }
   }
-  
-  double timeToCollision(const Pod& other) const {
-    constexpr static inline double sr2 = radius * radius;
-
-    if (vel == other.vel) return INFINITY;  // no relative velocity
-
-    // solve the quadratic equation for collision time
-    Vec2_xy d_pos = pos - other.pos;
-    double dist2 = d_pos.r2();
-    Vec2_xy d_v = vel - other.vel;
-    double dv2 = d_v.r2();
-
-    if (dv2 < dist2) return INFINITY;       // not moving fast enough
-    
-    double dot_prod = dot(d_pos, d_v);
-    if (dot_prod < 0.0) return INFINITY;    // moving away from each other
-
-    double neg_b = -2.0 * dot_prod;
-    double disc = neg_b*neg_b - 4.0 * dv2 * (dist2 - sr2);
 
-    if (disc < 0.0) return INFINITY;        // collision is imaginary
-
-    double t = (neg_b - sqrt(disc)) / (2.0 * dv2);
-
-    if (t <= 0.0) return INFINITY;          // collision happened last frame
-    else return t;
+private:
+  array<Plan, population_size> plans;
+  array<double, population_size> scores{};
+  GameState root;
+  int runner = 0;
+  Pcg32 rng;
+
+  int best() const { return int(max_element(scores.begin(), scores.end()) - scores.begin()); }
+  int tournament() {
+    int lhs = uniformInt(rng, 0, population_size - 1), rhs = uniformInt(rng, 0, population_size - 1);
+    return (scores[lhs] >= scores[rhs]) ? lhs : rhs;
   }
-  double timeToCollision(const Checkpoint& cp) const {
-    constexpr inline static double sr2 = cp.radius * cp.radius;
-
-    if (vel.x == 0.0 && vel.y == 0.0) return INFINITY;
-
-    // solve the quadratic equation for collision time
-    Vec2_xy d_pos = pos - cp;
-    double dist2 = d_pos.r2();
-    double dv2 = vel.r2();
-
-    if (dv2 < dist2) return INFINITY;       // not moving fast enough
-    
-    double dot_prod = dot(d_pos, vel);
-    if (dot_prod < 0.0) return INFINITY;    // moving away from each other
-
-    double neg_b = -2.0 * dot_prod;
-    double disc = neg_b*neg_b - 4.0 * dv2 * (dist2 - sr2);
 
-    if (disc < 0.0) return INFINITY;        // collision is imaginary
-
-    double t = (neg_b - sqrt(disc)) / (2.0 * dv2);
-
-    if (t <= 0.0) return INFINITY;          // collision happened last frame
-    else return t;
+  Move randomMove() {
+    int roll = uniformInt(rng, 0, 99);
+    int thrust = (roll < 2) ? SHIELD : (roll < 4) ? BOOST : (roll < 40) ? 100 : uniformInt(rng, 0, 100);
+    return { thrust, uniformDouble(rng, -Pod::max_turn, Pod::max_turn) };
+  }
+  // one move somewhere in the plan: a new turn, a new thrust, or both
+  void mutate(Plan& plan) {
+    Move& move = plan[uniformInt(rng, 0, depth - 1)][uniformInt(rng, 0, 1)];
+    Move fresh = randomMove();
+    int what = uniformInt(rng, 0, 2);
+    // part of the way to a random turn, so small changes are the common ones
+    if (what != 1) move.turn += uniformDouble(rng) * (fresh.turn - move.turn);
+    if (what != 0) move.thrust = fresh.thrust;
   }
 
-  void collide(Pod& other) {
-    double m1 = mass(), m2 = other.mass();
-    double mcoeff = (m1 * m2) / (m1 + m2);
-
-    Vec2_xy d_pos = pos - other.pos;
-    Vec2_xy d_v = vel - other.vel;
-
-    Vec2_xy force = d_pos * (mcoeff * dot(d_pos, d_v) / d_pos.r2());
-
-    Vec2_xy f1 = force * (1.0 / m1), f2 = force * (1.0 / m2);
-
-    vel -= f1;
-    other.vel += f2;
-
-    double impulse = force.r();
-    if (impulse < 120.0) {
-      force *= 120.0 / impulse;
+  double score(const Plan& plan) const {
+    GameState state = root;
+    for (int step = 0; step < depth; ++step) {
+      applyTeam(state, 0, plan[step]);
+      predictOpponent(state);
+      state.simFrame(map);
+      if (state.outcome(map) != 0) return evaluate(state, runner, step);
     }
-
-    vel -= f1;
-    other.vel += f2;
+    return evaluate(state, runner, depth);
   }
 };
 
-
-struct Field {
-  int num_laps;
-  int num_checkpoints;
-  vector<Checkpoint> checkpoints;
-};
-
-Field map;
-
-
-struct PodCollision {
-  Pod *p1 = nullptr, *p2 = nullptr;
-  double time = INFINITY;
-};
-struct CheckpointCollision {
-  Pod *pod = nullptr;
-  double time = INFINITY;
-};
-
-
-struct GameState {
-  union {
-    array<Pod, 4> pods;
-    struct {
-      array<Pod, 2> my_pods;
-      array<Pod, 2> their_pods;
-    };
+// Smitsimax: simultaneous-move MCTS with a tree for each of the four pods.
+// Every iteration walks all four trees down together from one GameState,
+// each pod picking its own action by UCB1 in its own tree, the four moves
+// going into the same simFrame. It goes `depth` turns (a pod that falls off
+// the bottom of its tree steers for its checkpoint from there on),
+// and the evaluation of where it ends is backed up each pod's path: from
+// our side for our pods, the other for theirs. So the opponent is searched
+// like we are instead of being predicted.
+//
+// Nodes come out of one pool allocated up front and emptied every turn; a
+// node's children are num_actions consecutive entries, found by the index
+// of the first, and which action a child stands for is its offset.
+class Smitsimax {
+public:
+  static constexpr const char* name = "smitsimax";
+  static constexpr int depth = 6;
+  static constexpr double exploration = 0.7;
+  static constexpr size_t pool_size = size_t(1) << 23;  // nodes, 96 MB
+
+  // the moves a tree chooses between
+  static constexpr int num_actions = 10;
+  static constexpr array<Move, num_actions> actions = { {
+    { 100, -18 }, { 100, -9 }, { 100, 0 }, { 100, 9 }, { 100, 18 },
+    { 0, -18 }, { 0, 0 }, { 0, 18 },
+    { SHIELD, 0 }, { BOOST, 0 },
+  } };
+
+  explicit Smitsimax(u64 seed = 48) : pool(pool_size), rng(seed) {}
+
+  // Searches from state until deadline; returns the number of playouts.
+  int runSearch(const GameState& state, Timer::time_point deadline) {
+    root = state;
+    runner = leader(root, 0);
+    used = 0;
+    for (u32& tree : trees) tree = allocate(1);
+    int playouts = 0;
+    // room for every tree to grow a level on each playout
+    while (Timer::now() < deadline && used + 4 * num_actions <= pool.size()) {
+      playout();
+      ++playouts;
+    }
+    return playouts;
+  }
+  array<Move, 2> getBest() const { return { actions[bestAction(0)], actions[bestAction(1)] }; }
+  // the average evaluation (0 to 1) behind our first pod's move
+  double getBestScore() const {
+    const Node& tree = pool[trees[0]];
+    if (tree.children == 0) return 0.5;
+    const Node& child = pool[tree.children + bestAction(0)];
+    return (child.visits > 0) ? child.total / child.visits : 0.5;
+  }
+  // every search starts from an empty tree
+  void advance() {}
+
+private:
+  struct Node {
+    u32 children;   // index of the first of num_actions, 0 until it's expanded
+    u32 visits;
+    float total;    // sum of the evaluations backed up through here
   };
+  static constexpr u32 off_tree = ~u32(0);
+
+  vector<Node> pool;
+  size_t used = 0;
+  array<u32, 4> trees{};
+  GameState root;
+  int runner = 0;
+  Pcg32 rng;
+
+  u32 allocate(int count) {
+    u32 first = u32(used);
+    for (int idx = 0; idx < count; ++idx) pool[used++] = Node{ 0, 0, 0.f };
+    return first;
+  }
+  // the most visited of a pod's first moves; straight ahead if there are none
+  int bestAction(int pod) const {
+    const Node& tree = pool[trees[pod]];
+    if (tree.children == 0) return 2;
+    int best = 0;
+    for (int action = 1; action < num_actions; ++action) {
+      if (pool[tree.children + action].visits > pool[tree.children + best].visits) best = action;
+    }
+    return best;
+  }
+  // UCB1; children nobody's tried yet come first, in order
+  int select(const Node& node) const {
+    double log_visits = log(double(node.visits));
+    int best = 0;
+    double best_ucb = -1;
+    for (int action = 0; action < num_actions; ++action) {
+      const Node& child = pool[node.children + action];
+      if (child.visits == 0) return action;
+      double ucb = child.total / child.visits + exploration * sqrt(log_visits / child.visits);
+      if (ucb > best_ucb) {
+        best_ucb = ucb;
+        best = action;
+      }
+    }
+    return best;
+  }
 
-  void simFrame() {
-    double t = 0.0;
-    do {
-      // detect pod-on-pod collisions
-      PodCollision pod_col;
-      double col_time;
-      for (auto it = pods.begin(); it != pods.end(); ++it) {
-        for (auto it2 = it; it2 != pods.end(); ++it2) {
-          col_time = it->timeToCollision(*it2);
-          if (col_time < pod_col.time) {
-            pod_col.p1 = it;
-            pod_col.p2 = it2;
-            pod_col.time = col_time;
+  void playout() {
+    GameState state = root;
+    array<array<u32, depth + 1>, 4> paths;
+    array<int, 4> path_len;
+    array<u32, 4> at = trees;
+    for (int idx = 0; idx < 4; ++idx) {
+      paths[idx][0] = trees[idx];
+      path_len[idx] = 1;
+    }
+
+    int steps = 0;
+    while (steps < depth) {
+      for (int idx = 0; idx < 4; ++idx) {
+        if (at[idx] != off_tree) {
+          // a node's children are made the second time it's reached, so
+          // leaves that are only ever seen once cost nothing
+          if (pool[at[idx]].children == 0 && pool[at[idx]].visits > 0) {
+            u32 children = allocate(num_actions);
+            pool[at[idx]].children = children;
           }
+          const Node& node = pool[at[idx]];
+          if (node.children != 0) {
+            int action = select(node);
+            at[idx] = node.children + action;
+            paths[idx][path_len[idx]++] = at[idx];
+            state.pods[idx].apply(actions[action]);
+            continue;
+          }
+          at[idx] = off_tree;
         }
+        steerToCheckpoint(state.pods[idx]);
       }
-      // detect pod-on-checkpoint collisions
-      for (Pod& p : pods) {
-        col_time = p.timeToCollision(map.checkpoints[p.next_cp]);
-        if (col_time < pod_col.time) {
-          p.next_cp = (p.next_cp) % map.num_checkpoints;
-        }
-      }
+      shareBoost(state, 0);
+      shareBoost(state, 1);
+      state.simFrame(map);
+      ++steps;
+      if (state.outcome(map) != 0) break;
+    }
 
-      if (pod_col.time < 1.0 - t) {
-        for (Pod& p : pods) { p.move(pod_col.time); }
-        pod_col.p1->collide(*pod_col.p2);
-        t += pod_col.time;
+    // squashed into (0, 1), a clear lead counting nearly as much as a win
+    double score = evaluate(state, runner, steps) / 20000.0;
+    float ours = float(0.5 + 0.5 * score / (1 + abs(score)));
+    for (int idx = 0; idx < 4; ++idx) {
+      float value = (idx < 2) ? ours : 1.f - ours;
+      for (int step = 0; step < path_len[idx]; ++step) {
+        Node& node = pool[paths[idx][step]];
+        ++node.visits;
+        node.total += value;
       }
-      else {
-        col_time = 1.0 - t;
-        for (Pod& p : pods) { p.move(col_time); }
-        t = 1.0;
-      }
-    } while (t < 1.0);
-
-    for (Pod& p : pods) { p.endFrame(); }
+    }
   }
+};
 
-  GameState next() const {
-    GameState ret = *this;
-    ret.simFrame();
-    return ret;
+// The referee's "x y thrust" for a move: a point far out along the facing
+// the turn leaves the pod with.
+void writeMove(const Pod& pod, const Move& move) {
+  double angle = pod.angle + move.turn;
+  if (angle >= 360) angle -= 360;
+  else if (angle < 0) angle += 360;
+  Vec2 target = pod.pos + unitVector(angle) * 10000.0;
+  fast_out << int(round(target.x)) << ' ' << int(round(target.y)) << ' ';
+  if (move.thrust == SHIELD) fast_out << "SHIELD";
+  else if (move.thrust == BOOST) fast_out << "BOOST";
+  else fast_out << move.thrust;
+  fast_out << '\n';
+}
+
+#if ARENA
+
+// A map like the referee's: 3 laps of 3 to 6 checkpoints, none closer than
+// 2500 to another, and the pods in a line across the start.
+GameState randomRace(Pcg32& rng) {
+  map.num_laps = 3;
+  map.num_checkpoints = uniformInt(rng, 3, 6);
+  for (int idx = 0; idx < map.num_checkpoints; ++idx) {
+    bool spaced;
+    do {
+      map.checkpoints[idx] = { double(uniformInt(rng, 1000, 15000)), double(uniformInt(rng, 1000, 8000)) };
+      spaced = true;
+      for (int other = 0; other < idx; ++other) spaced &= (map.checkpoints[idx] - map.checkpoints[other]).r() >= 2500;
+    } while (!spaced);
   }
-};
+  GameState state;
+  Vec2 along = map.checkpoints[1] - map.checkpoints[0];
+  Vec2 across = Vec2(-along.y, along.x) / along.r();
+  constexpr double offsets[4] = { 500, -500, 1500, -1500 };
+  for (int idx = 0; idx < 4; ++idx) {
+    Vec2 pos = map.checkpoints[0] + across * offsets[idx];
+    state.pods[idx].pos = { round(pos.x), round(pos.y) };
+  }
+  return state;
+}
+
+// the same race with the teams swapped, for a search playing team 1
+GameState flipped(GameState state) {
+  swap(state.pods[0], state.pods[2]);
+  swap(state.pods[1], state.pods[3]);
+  swap(state.timeouts[0], state.timeouts[1]);
+  return state;
+}
+
+// Rhea against Smitsimax at ARENA_MOVE_MS a turn each. Every map is raced
+// twice so each search has each side once. Reports the wins and how many
+// playouts and simFrames each search manages a turn. As set here (20 maps,
+// 40 races, 10ms) Rhea wins 40-0, at about 20k playouts (120k sims) a turn
+// to Smitsimax's 8.4k (50k).
+int main() {
+  Pcg32 map_rng(48);
+  Smitsimax smitsimax;   // its pool is big; every search empties it anyway
+  int wins[2] = { 0, 0 };
+  long playouts[2] = { 0, 0 }, turns = 0;
+  for (int game = 0; game < ARENA_GAMES; ++game) {
+    GameState start = randomRace(map_rng);
+    for (int rhea_team = 0; rhea_team < 2; ++rhea_team) {
+      Rhea rhea(game);
+      GameState state = start;
+      state.faceCheckpoints(map);
+      while (state.outcome(map) == 0) {
+        array<array<Move, 2>, 2> moves;
+        for (int team = 0; team < 2; ++team) {
+          GameState view = (team == 0) ? state : flipped(state);
+          Timer::time_point deadline = Timer::now() + milliseconds(ARENA_MOVE_MS);
+          if (team == rhea_team) {
+            playouts[0] += rhea.runSearch(view, deadline);
+            moves[team] = rhea.getBest();
+          }
+          else {
+            playouts[1] += smitsimax.runSearch(view, deadline);
+            moves[team] = smitsimax.getBest();
+          }
+        }
+        applyTeam(state, 0, moves[0]);
+        applyTeam(state, 1, moves[1]);
+        state.simFrame(map);
+        rhea.advance();
+        ++turns;
+      }
+      ++wins[(state.outcome(map) - 1 == rhea_team) ? 0 : 1];
+    }
+  }
+  cout << "rhea vs smitsimax, " << 2 * ARENA_GAMES << " races at " << ARENA_MOVE_MS << "ms/turn\n"
+    << "  rhea wins: " << wins[0] << ", smitsimax wins: " << wins[1] << '\n'
+    << "  rhea:      " << playouts[0] / turns << " playouts/turn, " << playouts[0] * Rhea::depth / turns << " sims/turn\n"
+    << "  smitsimax: " << playouts[1] / turns << " playouts/turn, " << playouts[1] * Smitsimax::depth / turns << " sims/turn" << endl;
+  return 0;
+}
 
+#else
 
 int main()
 {
-  ios::sync_with_stdio(false);
-  
-  cin >> map.num_laps; cin.ignore();
-  int checkpoint_count;
-  cin >> map.num_checkpoints; cin.ignore();
-  map.checkpoints.reserve(checkpoint_count);
-  for (int i = 0; i < checkpoint_count; i++) {
+  fast_in >> map.num_laps;
+  fast_in >> map.num_checkpoints;
+  for (int i = 0; i < map.num_checkpoints; i++) {
     int checkpoint_x;
     int checkpoint_y;
-    cin >> checkpoint_x >> checkpoint_y; cin.ignore();
-    map.checkpoints.push_back({ checkpoint_x, checkpoint_y });
+    fast_in >> checkpoint_x >> checkpoint_y;
+    map.checkpoints[i] = { double(checkpoint_x), double(checkpoint_y) };
   }
+  GameState state;
+  SEARCH search;
 
   // game loop
-  while (true) {
-    for (int i = 0; i < 2; i++) {
-      int x; // x position of your pod
-      int y; // y position of your pod
-      int vx; // x speed of your pod
-      int vy; // y speed of your pod
-      int angle; // angle of your pod
-      int next_check_point_id; // next check point id of your pod
-      cin >> x >> y >> vx >> vy >> angle >> next_check_point_id; cin.ignore();
-    }
-    for (int i = 0; i < 2; i++) {
-      int x_2; // x position of the opponent's pod
-      int y_2; // y position of the opponent's pod
-      int vx_2; // x speed of the opponent's pod
-      int vy_2; // y speed of the opponent's pod
-      int angle_2; // angle of the opponent's pod
-      int next_check_point_id_2; // next check point id of the opponent's pod
-      cin >> x_2 >> y_2 >> vx_2 >> vy_2 >> angle_2 >> next_check_point_id_2; cin.ignore();
-    }
-
-    // Write an action using cout. DON'T FORGET THE "<< endl"
-    // To debug: cerr << "Debug messages..." << endl;
-
-
-    // You have to output the target position
-    // followed by the power (0 <= thrust <= 100)
-    // i.e.: "x y thrust"
-    cout << "8000 4500 100" << endl;
-    cout << "8000 4500 100" << endl;
-  }
-}
\ No newline at end of file
+  for (int turn = 0;; ++turn) {
+    // ours, then the opponent's
+    array<bool, 2> passed = { false, false };
+    for (int idx = 0; idx < 4; ++idx) {
+      Pod& pod = state.pods[idx];
+      int x, y, vx, vy, angle, next_check_point_id;
+      fast_in >> x >> y >> vx >> vy >> angle >> next_check_point_id;
+      pod.pos = { double(x), double(y) };
+      pod.vel = { double(vx), double(vy) };
+      pod.angle = angle;
+      // the input doesn't say, but moving on from checkpoint 0 finishes a lap
+      if (pod.next_cp == 0 && next_check_point_id != 0) ++pod.laps;
+      if (pod.next_cp != next_check_point_id) passed[idx / 2] = true;
+      pod.next_cp = next_check_point_id;
+    }
+    Timer::time_point start = Timer::now();
+    // the first turn's angles are -1: every pod can face wherever it likes
+    state.faceCheckpoints(map);
+    for (int team = 0; team < 2; ++team) {
+      if (passed[team]) state.timeouts[team] = GameState::timeout_turns;
+      else if (turn > 0) --state.timeouts[team];
+    }
+
+    int playouts = search.runSearch(state, start + milliseconds((turn == 0) ? FIRST_TURN_MS : SEARCH_MS));
+    array<Move, 2> moves = search.getBest();
+    logInfo(search.name << ": " << playouts << " playouts, " << playouts * search.depth
+      << " sims in " << chrono::duration<double, milli>(Timer::now() - start).count() << " ms, best " << search.getBestScore());
+    for (int idx = 0; idx < 2; ++idx) writeMove(state.pods[idx], moves[idx]);
+    fast_out.flush();
+    instrTurnEnd();
+
+    // what the input won't say about our pods next turn: shields and the boost
+    applyTeam(state, 0, moves);
+    for (int idx = 0; idx < 2; ++idx) {
+      if (state.pods[idx].shield_frames > 0) --state.pods[idx].shield_frames;
+    }
+    search.advance();
+  }
+}
+
+#endif
@@ -28,6 +28,15 @@
 #include <cmath>
 #include <cstring>
 
+#include <arena.hpp>
+
+// What Population allocates its chromosomes with: std::allocator, or
+// kel::PoolAllocator to take them (and their shared_ptr control blocks) from
+// arena.hpp's pools. Define it before including Galgo.hpp to change it.
+#ifndef GALGO_ALLOCATOR
+#define GALGO_ALLOCATOR std::allocator
+#endif
+
 /*-------------------------------------------------------------------------------------------------*/
 
 namespace galgo {
@@ -52,6 +61,16 @@ class Chromosome;
 template <typename T>
 using CHR = std::shared_ptr<Chromosome<T>>;
 
+template <typename T>
+using ChromosomeAllocator = GALGO_ALLOCATOR<Chromosome<T>>;
+
+// a new chromosome, from ChromosomeAllocator
+template <typename T, typename... Args>
+CHR<T> makeChromosome(Args&&... args)
+{
+   return std::allocate_shared<Chromosome<T>>(ChromosomeAllocator<T>(), std::forward<Args>(args)...);
+}
+
 template <typename T>
 using PAR = std::unique_ptr<BaseParameter<T>>;
 
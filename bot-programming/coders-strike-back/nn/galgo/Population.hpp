@@ -102,7 +102,7 @@ void Population<T>::creation()
    int start = 0;
    // initializing first chromosome
    if (!ptr->initialSet.empty()) {
-      curpop[0] = std::make_shared<Chromosome<T>>(*ptr);
+      curpop[0] = makeChromosome<T>(*ptr);
       curpop[0]->initialize();
       curpop[0]->evaluate();
       start++;
@@ -112,7 +112,7 @@ void Population<T>::creation()
    #pragma omp parallel for num_threads(MAX_THREADS)
    #endif
    for (int i = start; i < ptr->popsize; ++i) {
-      curpop[i] = std::make_shared<Chromosome<T>>(*ptr);
+      curpop[i] = makeChromosome<T>(*ptr);
       curpop[i]->create();
       curpop[i]->evaluate();
    }
@@ -153,7 +153,7 @@ void Population<T>::elitism()
 
    if (ptr->elitpop > 0) {
       // copying elit chromosomes into new population
-      std::transform(curpop.cbegin(), curpop.cend(), newpop.begin(), [](const CHR<T>& chr)->CHR<T>{return std::make_shared<Chromosome<T>>(*chr);});
+      std::transform(curpop.cbegin(), curpop.cend(), newpop.begin(), [](const CHR<T>& chr)->CHR<T>{return makeChromosome<T>(*chr);});
    }
 }
 
@@ -169,8 +169,8 @@ void Population<T>::recombination()
    #endif
    for (int i = ptr->elitpop; i < nbrcrov; i = i + 2) {      
       // initializing 2 new chromosome
-      newpop[i] = std::make_shared<Chromosome<T>>(*ptr);
-      newpop[i+1] = std::make_shared<Chromosome<T>>(*ptr);
+      newpop[i] = makeChromosome<T>(*ptr);
+      newpop[i+1] = makeChromosome<T>(*ptr);
       // crossing-over mating population to create 2 new chromosomes
       ptr->CrossOver(*this, newpop[i], newpop[i+1]);
       // mutating new chromosomes
@@ -193,7 +193,7 @@ void Population<T>::completion()
    #endif
    for (int i = nbrcrov; i < ptr->popsize; ++i) {
       // selecting chromosome randomly from mating population
-      newpop[i] = std::make_shared<Chromosome<T>>(*matpop[uniform<int>(0, ptr->matsize)]);
+      newpop[i] = makeChromosome<T>(*matpop[uniform<int>(0, ptr->matsize)]);
       // mutating chromosome
       ptr->Mutation(newpop[i]);
       // evaluating chromosome
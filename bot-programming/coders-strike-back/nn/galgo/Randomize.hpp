@@ -5,6 +5,8 @@
 #ifndef RANDOMIZE_H
 #define RANDOMIZE_H
 
+#include <rng.hpp>
+
 namespace galgo {
 
 //=================================================================================================
@@ -25,12 +27,15 @@ struct MAXVALUE<0>
 
 /*-------------------------------------------------------------------------------------------------*/
 
-// Mersenne Twister 19937 pseudo-random number generator
+// xoshiro256** pseudo-random number generator (see include/rng.hpp)
 std::random_device rand_dev;
-std::mt19937_64 rng(rand_dev());
+kel::Xoshiro256ss rng(rand_dev());
 
 // generate uniform random probability in range [0,1)
-std::uniform_real_distribution<> proba(0, 1);
+struct UniformProba
+{
+   double operator()(kel::Xoshiro256ss& gen) const { return kel::uniformDouble(gen); }
+} proba;
 
 /*-------------------------------------------------------------------------------------------------*/
 
@@ -61,9 +66,8 @@ public:
 
    // generating random unsigned long long integer on [0,MAXVAL]
    static uint64_t generate() {
-      // class constructor only called once for each different N
-      static std::uniform_int_distribution<uint64_t> udistrib(0,MAXVAL);
-      return udistrib(rng);
+      // MAXVAL is 2^N - 1, so the top N bits are exactly uniform on it
+      return rng() >> (64 - N);
    }
 };
 
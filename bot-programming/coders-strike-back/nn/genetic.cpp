@@ -3,20 +3,22 @@
 #include <array>
 #include <random>
 
+#include <rng.hpp>
+
 using namespace std;
 
 random_device dev;
-mt19937 gen;
+kel::Xoshiro256ss gen;
 
 void initRandom() { gen.seed(dev()); }
 
-int randint(int a, int b) { return uniform_int_distribution(a, b)(gen); }
+int randint(int a, int b) { return kel::uniformInt(gen, a, b); }
 
-bool eventHappens(float p) { return (static_cast<float>(gen()) / UINT32_MAX) < p; }
-bool coinFlip() { return uniform_int_distribution(0, 1)(gen); }
+bool eventHappens(float p) { return kel::chance(gen, p); }
+bool coinFlip() { return kel::coinFlip(gen); }
 
 Chromosome randomChromosome() {
-  float r = uniform_real_distribution<float>(-1.f, 1.f)(gen);
+  float r = kel::uniformFloat(gen, -1.f, 1.f);
   return *reinterpret_cast<int32_t*>(&r);
 }
 
@@ -25,7 +27,7 @@ Chromosome makeBaby(Chromosome a, Chromosome b) {
   float& parent_f = reinterpret_cast<float&>(parent);
 
   if (eventHappens(p_mutate)) {
-    parent_f += uniform_real_distribution<float>(-0.1f, 0.1f)(gen);
+    parent_f += kel::uniformFloat(gen, -0.1f, 0.1f);
     parent_f = clamp(parent_f, -1.f, 1.f);
   }
 
@@ -19,6 +19,9 @@ array<float, out_size>& LinearLayer<in_size, out_size>::operator()(const array<f
 
   return output;
 }
+// the layers Agent uses, so other files (bench/csb.cpp) can call them too
+template struct LinearLayer<34, 16>;
+template struct LinearLayer<16, 8>;
 
 
 array<Move, 2> Agent::race(const Field& map, const SimState& state, bool mine) {
@@ -27,35 +30,36 @@ array<Move, 2> Agent::race(const Field& map, const SimState& state, bool mine) {
   const Pod& their_p1 = (mine) ? state.pods[2] : state.pods[0];
   const Pod& their_p2 = (mine) ? state.pods[3] : state.pods[1];
 
-  Vec2_pol p1_vel = my_p1.vel.polar(), p2_vel = my_p2.vel.polar();
-  Vec2_pol p1_cp = (map.checkpoints[my_p1.next_cp] - my_p1.pos).polar();
-  Vec2_pol p2_cp = (map.checkpoints[my_p2.next_cp] - my_p2.pos).polar();
+  Vec2_pol p1_vel = polar(my_p1.vel), p2_vel = polar(my_p2.vel);
+  Vec2_pol p1_cp = polar(map.checkpoints[my_p1.next_cp] - my_p1.pos);
+  Vec2_pol p2_cp = polar(map.checkpoints[my_p2.next_cp] - my_p2.pos);
   float p1_boost_av = my_p1.can_boost, p2_boost_av = my_p2.can_boost;
   float p1_shield_countdown = my_p1.shield_frames, p2_shield_countdown = my_p2.shield_frames;
-  float p1_timeout = my_p1.timeout, p2_timeout = my_p2.timeout;
-  Vec2_pol p1_p2 = (my_p2.pos - my_p1.pos).polar();
-  Vec2_pol p2_p1 = (my_p1.pos - my_p2.pos).polar();
-  Vec2_pol p1_e1 = (their_p1.pos - my_p1.pos).polar();
-  Vec2_pol p1_e2 = (their_p2.pos - my_p1.pos).polar();
-  Vec2_pol p2_e1 = (their_p1.pos - my_p2.pos).polar();
-  Vec2_pol p2_e2 = (their_p2.pos - my_p2.pos).polar();
-  Vec2_pol p1_e1_vel = their_p1.vel.polar(), p1_e2_vel = their_p2.vel.polar();
-  Vec2_pol p2_e1_vel = their_p1.vel.polar(), p2_e2_vel = their_p2.vel.polar();
+  float p1_timeout = state.timeouts[mine ? 0 : 1], p2_timeout = p1_timeout;
+  float p1_facing = radians(my_p1.angle), p2_facing = radians(my_p2.angle);
+  Vec2_pol p1_p2 = polar(my_p2.pos - my_p1.pos);
+  Vec2_pol p2_p1 = polar(my_p1.pos - my_p2.pos);
+  Vec2_pol p1_e1 = polar(their_p1.pos - my_p1.pos);
+  Vec2_pol p1_e2 = polar(their_p2.pos - my_p1.pos);
+  Vec2_pol p2_e1 = polar(their_p1.pos - my_p2.pos);
+  Vec2_pol p2_e2 = polar(their_p2.pos - my_p2.pos);
+  Vec2_pol p1_e1_vel = polar(their_p1.vel), p1_e2_vel = polar(their_p2.vel);
+  Vec2_pol p2_e1_vel = polar(their_p1.vel), p2_e2_vel = polar(their_p2.vel);
 
-  p1_vel.theta -= my_p1.dir.theta; p1_vel.fixAngle();
-  p2_vel.theta -= my_p2.dir.theta; p2_vel.fixAngle();
-  p1_cp.theta -= my_p1.dir.theta; p1_cp.fixAngle();
-  p2_cp.theta -= my_p2.dir.theta; p2_cp.fixAngle();
-  p1_p2.theta -= my_p1.dir.theta; p1_p2.fixAngle();
-  p2_p1.theta -= my_p2.dir.theta; p2_p1.fixAngle();
-  p1_e1.theta -= my_p1.dir.theta; p1_e1.fixAngle();
-  p1_e2.theta -= my_p1.dir.theta; p1_e2.fixAngle();
-  p2_e1.theta -= my_p2.dir.theta; p2_e1.fixAngle();
-  p2_e2.theta -= my_p2.dir.theta; p2_e2.fixAngle();
-  p1_e1_vel.theta -= my_p1.dir.theta; p1_e1_vel.fixAngle();
-  p1_e2_vel.theta -= my_p1.dir.theta; p1_e2_vel.fixAngle();
-  p2_e1_vel.theta -= my_p2.dir.theta; p2_e1_vel.fixAngle();
-  p2_e2_vel.theta -= my_p2.dir.theta; p2_e2_vel.fixAngle();
+  p1_vel.theta -= p1_facing; p1_vel.fixAngle();
+  p2_vel.theta -= p2_facing; p2_vel.fixAngle();
+  p1_cp.theta -= p1_facing; p1_cp.fixAngle();
+  p2_cp.theta -= p2_facing; p2_cp.fixAngle();
+  p1_p2.theta -= p1_facing; p1_p2.fixAngle();
+  p2_p1.theta -= p2_facing; p2_p1.fixAngle();
+  p1_e1.theta -= p1_facing; p1_e1.fixAngle();
+  p1_e2.theta -= p1_facing; p1_e2.fixAngle();
+  p2_e1.theta -= p2_facing; p2_e1.fixAngle();
+  p2_e2.theta -= p2_facing; p2_e2.fixAngle();
+  p1_e1_vel.theta -= p1_facing; p1_e1_vel.fixAngle();
+  p1_e2_vel.theta -= p1_facing; p1_e2_vel.fixAngle();
+  p2_e1_vel.theta -= p2_facing; p2_e1_vel.fixAngle();
+  p2_e2_vel.theta -= p2_facing; p2_e2_vel.fixAngle();
   array<float, 34> input = {
     p1_vel.r, p1_vel.theta, p1_cp.r, p1_cp.theta,
     p1_boost_av, p1_shield_countdown, p1_timeout,
@@ -75,7 +79,7 @@ array<Move, 2> Agent::race(const Field& map, const SimState& state, bool mine) {
   float p1_thrust = out_layer.output[1], p2_thrust = out_layer.output[5];
   bool p1_boost = out_layer.output[2], p2_boost = out_layer.output[6];
   bool p1_shield = out_layer.output[3], p2_shield = out_layer.output[7];
-  p1_angle = radians(18.f) * tanh(p1_angle); p2_angle = radians(18.f) * tanh(p2_angle);
+  p1_angle = 18.f * tanh(p1_angle); p2_angle = 18.f * tanh(p2_angle);
   p1_thrust = 50.f * tanh(p1_thrust) + 50.f; p2_thrust = 50.f * tanh(p2_thrust) + 50.f;
 
   if (!isfinite(p1_thrust)) p1_thrust = 0.f;
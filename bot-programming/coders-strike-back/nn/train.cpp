@@ -2,8 +2,15 @@
 #include "nn.h"
 #include "genetic.h"
 
+#include <csb-batch.hpp>
+
 #include <algorithm>
+#include <array>
 #include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -16,39 +23,44 @@ void loadRaces() {
     Field field;
     SimState state;
     ifs >> field >> state;
+    state.faceCheckpoints(field);
     races.push_back(make_pair(field, state));
     ifs.close();
   }
 }
 
-double compete(Agent& agent1, Agent& agent2) {
-  double score = 0.f;
-  for (int i = 0; i < 5; ++i) {
-    auto& race = races[randint(1, 15) - 1];
-    Field& field = race.first;
-    SimState state = race.second;
-
-    do {
-      array<Move, 2> move1 = agent1.race(field, state, true);
-      array<Move, 2> move2 = agent2.race(field, state, false);
-
-      for (size_t i = 0; i < 2; ++i) state.pods[0 + i].apply(move1[i]);
-      for (size_t i = 0; i < 2; ++i) state.pods[2 + i].apply(move2[i]);
-
-      state.simFrame(field);
-    } while (state.outcome(field) == 0);
-
-    // completion percentage
-    double completion = 0.0;
-    for (size_t i = 0; i < 4; ++i) {
-      double sign = (i / 2 == 0) ? 1.0 : -1.0;
-      if (state.pods[i].laps > 0) completion += sign * state.pods[i].laps * field.num_checkpoints;
-      if (state.pods[i].next_cp > 0) completion += sign * (float)state.pods[i].next_cp;
+// Plays each matchup's 5 races (random fields) in one batch and scores them
+// from the first agent's side, all of a population's games going at once.
+vector<double> competeAll(const vector<pair<const Agent*, const Agent*>>& matchups) {
+  constexpr int races_per_matchup = 5;
+  kel::RaceBatch batch;
+  // Agent::race writes to its layers, so every game gets copies of its own
+  vector<array<Agent, 2>> players;
+  for (auto& matchup : matchups) {
+    for (int i = 0; i < races_per_matchup; ++i) {
+      auto& race = races[randint(1, 15) - 1];
+      batch.add(race.first, race.second);
+      players.push_back({ *matchup.first, *matchup.second });
     }
-    completion /= field.num_checkpoints * field.num_laps;
+  }
+
+  batch.run([&](size_t game, const SimState& state, Move* moves) {
+    const Field& field = batch.field(game);
+    array<Move, 2> move1 = players[game][0].race(field, state, true);
+    array<Move, 2> move2 = players[game][1].race(field, state, false);
+    for (size_t i = 0; i < 2; ++i) moves[0 + i] = move1[i];
+    for (size_t i = 0; i < 2; ++i) moves[2 + i] = move2[i];
+  });
+
+  vector<double> scores(matchups.size(), 0.0);
+  for (size_t game = 0; game < batch.size(); ++game) {
+    double& score = scores[game / races_per_matchup];
+    double completion = batch.completion(game);
     score += round(completion * 10000.0);  // completion weight
 
     if (completion == 0.0) {
+      const Field& field = batch.field(game);
+      SimState state = batch.race(game);
       for (size_t i = 0; i < 4; ++i) {
         double sign = (i / 2 == 0) ? 1.0 : -1.0;
         double dist2cp = (state.pods[i].pos - field.checkpoints[state.pods[i].next_cp]).r();
@@ -59,88 +71,50 @@ double compete(Agent& agent1, Agent& agent2) {
       }
     }
   }
-
-  return score / 5.0;
+  for (double& score : scores) score /= races_per_matchup;
+  return scores;
 }
 
-bool operator>(Genome& a, Genome& b) {
-  return compete(agent(a), agent(b)) > 0;
+double compete(Agent& agent1, Agent& agent2) {
+  return competeAll({ { &agent1, &agent2 } })[0];
 }
 
-class MergeSort {
-  vector<Genome> aux;
-  vector<Genome> *in, *out;
-public:
-  vector<Genome> sort(vector<Genome>& arr) {
-    if (arr.size() <= 1) return arr;
-    aux = vector<Genome>(arr.size());
-    in = &arr;
-    out = &aux;
-    size_t half = 1;
-    while (half < arr.size()) {
-      size_t chunk_sz = half * 2;
-      size_t chunk = 0;
-      do {
-        size_t mid = chunk + half;
-        if (mid >= arr.size()) {
-          do {
-            (*out)[chunk]
-              = (*in)[chunk];
-            ++chunk;
-          } while (chunk < arr.size());
-          break;
-        }
-        size_t end = min(
-          chunk + chunk_sz,
-          arr.size()
-        );
-        merge(chunk, end, mid);
-        chunk = end;
-      } while (chunk < arr.size());
-      swap(in, out);
-      half = chunk_sz;
-    }
-    return *in;
-  }
-  
-private:
-  void merge(size_t ptr, size_t end, size_t mid) {
-    size_t iL = ptr;
-    size_t iR = mid;
-    while (ptr < end) {
-      if (iL >= mid) {
-        (*out)[ptr++] = (*in)[iR++];
-      }
-      else if (iR >= end) {
-        (*out)[ptr++] = (*in)[iL++];
-      }
-      else {
-        if ((*in)[iL] > (*in)[iR]) {
-          (*out)[ptr++] = (*in)[iL++];
-        } else {
-          (*out)[ptr++] = (*in)[iR++];
-        }
-      }
-    }
-  }
-};
+// Best first, by how each genome does against the current best (which
+// scores itself 0); one batch for the whole population.
+void rankPopulation(vector<Genome>& population) {
+  vector<pair<const Agent*, const Agent*>> matchups;
+  for (Genome& g : population) matchups.push_back({ &agent(g), &agent(population[0]) });
+  vector<double> scores = competeAll(matchups);
+  scores[0] = 0.0;
+
+  vector<size_t> order(population.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) { return scores[lhs] > scores[rhs]; });
+  vector<Genome> ranked;
+  for (size_t i : order) ranked.push_back(population[i]);
+  population = move(ranked);
+}
 
 Genome& train(size_t population_size, size_t num_generations) {
   vector<Genome> population = createPopulation(population_size);
-  MergeSort sorter;
 
-  sorter.sort(population);
+  rankPopulation(population);
   cout << "Gen " << 0 << ", best: ";
   cout << compete(agent(population[0]), agent(population[1])) << endl;
   for (size_t generation = 1; generation < num_generations; ++generation) {
     makeBabies(population, true);
     
-    sorter.sort(population);
+    rankPopulation(population);
 
+    vector<double> report = competeAll({
+      { &agent(population[0]), &agent(population[0]) },
+      { &agent(population[0]), &agent(population[1]) },
+      { &agent(population.front()), &agent(population.back()) },
+    });
     cout << "Gen " << generation;
-    cout << ", self play: " << abs(compete(agent(population[0]), agent(population[0])));
-    cout << ", best 2: " << compete(agent(population[0]), agent(population[1]));
-    cout << ", spread: " << compete(agent(population.front()), agent(population.back()));
+    cout << ", self play: " << abs(report[0]);
+    cout << ", best 2: " << report[1];
+    cout << ", spread: " << report[2];
     cout << endl;
   }
   return population[0];
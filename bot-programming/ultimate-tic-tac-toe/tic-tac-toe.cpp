@@ -1,14 +1,725 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
 #include <limits>
-#include <stack>
+#include <sstream>
 #include <string>
-#include <vector>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 #define INTERACTIBLE true
+#define CONTAINER_CHECKS 0    // bounds-check the fixed-capacity containers; 1 while debugging
+#define INSTRUMENT 0          // per-turn timers, counters and histograms on stderr (instrument.hpp)
+#define LOG_LEVEL 1           // 0 silent, 1 errors, 2 and a few lines a turn, 3 and hot-loop debug
 
+// typedefs.hpp
+namespace kel {
+  typedef uint8_t u8;
+  typedef int8_t i8;
+  typedef uint16_t u16;
+  typedef int16_t i16;
+  typedef uint32_t u32;
+  typedef int32_t i32;
+  typedef uint64_t u64;
+  typedef int64_t i64;
+}
+
+// bit-fiddling.hpp
+namespace kel {
+  template <class T = unsigned long long>
+  constexpr T pow2(int power) noexcept {
+    return static_cast<T>(T(1) << power);
+  }
+}
+
+// fixed-containers.hpp
+namespace kel {
+  // Containers with their capacity fixed at compile time and their elements
+  // stored inline, so they never allocate. The storage is a plain T[N]: T has
+  // to be default constructible, all N are constructed up front, and popped
+  // slots keep their old value until they're reused. In return a container
+  // of a trivially copyable T is itself trivially copyable.
+#if CONTAINER_CHECKS
+#define _containerCheck(cond, what)                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::fputs(what "\n", stderr);                                           \
+      std::abort();                                                            \
+    }                                                                          \
+  } while (0)
+#else
+#define _containerCheck(cond, what) ((void)0)
+#endif
+
+  template <class T, size_t N>
+  class static_vector {
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t capacity() noexcept { return N; }
+    constexpr size_t size() const noexcept { return count; }
+    constexpr bool empty() const noexcept { return count == 0; }
+    constexpr bool full() const noexcept { return count == N; }
+
+    constexpr T& operator[](size_t idx) noexcept {
+      _containerCheck(idx < count, "static_vector: index out of range");
+      return items[idx];
+    }
+    constexpr const T& operator[](size_t idx) const noexcept {
+      _containerCheck(idx < count, "static_vector: index out of range");
+      return items[idx];
+    }
+    constexpr T& front() noexcept { return (*this)[0]; }
+    constexpr const T& front() const noexcept { return (*this)[0]; }
+    constexpr T& back() noexcept { return (*this)[count - 1]; }
+    constexpr const T& back() const noexcept { return (*this)[count - 1]; }
+
+    constexpr T* data() noexcept { return items; }
+    constexpr const T* data() const noexcept { return items; }
+    constexpr T* begin() noexcept { return items; }
+    constexpr const T* begin() const noexcept { return items; }
+    constexpr T* end() noexcept { return items + count; }
+    constexpr const T* end() const noexcept { return items + count; }
+
+    constexpr void push_back(const T& value) noexcept(std::is_nothrow_copy_assignable<T>::value) {
+      _containerCheck(count < N, "static_vector: push_back past capacity");
+      items[count++] = value;
+    }
+    constexpr void push_back(T&& value) noexcept(std::is_nothrow_move_assignable<T>::value) {
+      _containerCheck(count < N, "static_vector: push_back past capacity");
+      items[count++] = std::move(value);
+    }
+    template <class... Args>
+    constexpr T& emplace_back(Args&&... args) {
+      _containerCheck(count < N, "static_vector: emplace_back past capacity");
+      return items[count++] = T(std::forward<Args>(args)...);
+    }
+    constexpr void pop_back() noexcept {
+      _containerCheck(count > 0, "static_vector: pop_back on empty");
+      --count;
+    }
+    constexpr void resize(size_t new_size) noexcept {
+      _containerCheck(new_size <= N, "static_vector: resize past capacity");
+      count = new_size;
+    }
+    constexpr void clear() noexcept { count = 0; }
+    // O(1): the last element takes its place, so the order isn't kept
+    constexpr void swapRemove(size_t idx) noexcept {
+      _containerCheck(idx < count, "static_vector: index out of range");
+      items[idx] = std::move(items[--count]);
+    }
+
+  private:
+    T items[N] = {};
+    size_t count = 0;
+  };
+
+  // LIFO, with std::stack's interface
+  template <class T, size_t N>
+  class inline_stack {
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using container_type = static_vector<T, N>;
+
+    static constexpr size_t capacity() noexcept { return N; }
+    constexpr size_t size() const noexcept { return items.size(); }
+    constexpr bool empty() const noexcept { return items.empty(); }
+    constexpr bool full() const noexcept { return items.full(); }
+
+    constexpr T& top() noexcept { return items.back(); }
+    constexpr const T& top() const noexcept { return items.back(); }
+    constexpr void push(const T& value) { items.push_back(value); }
+    constexpr void push(T&& value) { items.push_back(std::move(value)); }
+    template <class... Args>
+    constexpr T& emplace(Args&&... args) { return items.emplace_back(std::forward<Args>(args)...); }
+    constexpr void pop() noexcept { items.pop_back(); }
+    constexpr void clear() noexcept { items.clear(); }
+
+    // bottom to top
+    constexpr const T* begin() const noexcept { return items.begin(); }
+    constexpr const T* end() const noexcept { return items.end(); }
+
+  private:
+    container_type items;
+  };
+
+  static_assert(std::is_trivially_copyable<static_vector<int, 4>>::value
+    && std::is_trivially_copyable<inline_stack<int, 4>>::value,
+    "fixed containers of a trivially copyable type should be too");
+}
+
+
+// fast-io.hpp
+namespace kel {
+  // Referee I/O without iostreams. FdReader pulls whatever's available from
+  // a file descriptor with read(2) into its buffer and parses straight out of
+  // it; FdWriter collects a turn's output and hands it to write(2) in one go
+  // when flush() is called (and once more at exit, for whatever's left).
+  // Neither allocates unless you read a std::string.
+  //
+  //   fast_in >> x >> y;                  // whitespace and newlines are skipped, no ignore() needed
+  //   std::string_view row = fast_in.readToken();
+  //   fast_out << x << ' ' << y << '\n';
+  //   fast_out.flush();                   // once per turn, instead of endl per line
+  //
+  // Don't mix these with cin/cout on the same descriptor: each side buffers
+  // what the other can't see.
+
+  class FdReader {
+  public:
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    explicit FdReader(int fd = STDIN_FILENO) noexcept : fd(fd) { buf[0] = '\0'; }
+    FdReader(const FdReader&) = delete;
+    FdReader& operator=(const FdReader&) = delete;
+
+    // true once there's nothing left but whitespace; waits for more input to
+    // find out, so it's for reading files, not for asking between turns
+    bool eof() {
+      skipSpace();
+      return pos == end;
+    }
+
+    template <class Int>
+    Int readInt() {
+      static_assert(std::is_integral<Int>::value, "readInt: not an integer type");
+      skipSpace();
+      bool negative = false;
+      if constexpr (std::is_signed<Int>::value) {
+        negative = (buf[pos] == '-');
+        pos += negative;
+      }
+      // make unsigned so overflow past the end of the number wraps harmlessly
+      using U = std::make_unsigned_t<Int>;
+      U value = 0;
+      while (true) {
+        // the '\0' sentinel at buf[end] stops the loop without a bounds check
+        unsigned digit;
+        while ((digit = unsigned(buf[pos]) - '0') < 10) {
+          value = U(value * 10 + digit);
+          ++pos;
+        }
+        if (pos < end || !refill()) break;   // a number split across two reads carries on
+      }
+      return negative ? Int(U(0) - value) : Int(value);
+    }
+    double readDouble() {
+      std::string_view token = readToken();
+      double value = 0;
+      std::from_chars(token.data(), token.data() + token.size(), value);
+      return value;
+    }
+    // the next character that isn't whitespace ('\0' at the end of input)
+    char readChar() {
+      skipSpace();
+      return (pos < end) ? buf[pos++] : '\0';
+    }
+    // The next whitespace-separated word. It points into the buffer, so it's
+    // only good until the next read.
+    std::string_view readToken() {
+      skipSpace();
+      size_t start = pos;
+      while (true) {
+        while (buf[pos] > ' ') ++pos;
+        if (pos < end) break;
+        size_t len = pos - start;
+        compact(start);
+        start = 0;
+        pos = len;
+        if (!fill()) break;
+      }
+      return std::string_view(buf + start, pos - start);
+    }
+    // The rest of the current line, without the newline (or a '\r' before
+    // it). Also only good until the next read.
+    std::string_view readLine() {
+      size_t start = pos;
+      while (true) {
+        const void* newline = std::memchr(buf + pos, '\n', end - pos);
+        if (newline) {
+          pos = static_cast<const char*>(newline) - buf;
+          break;
+        }
+        size_t len = end - start;
+        compact(start);
+        start = 0;
+        pos = len;
+        if (!fill()) break;
+      }
+      size_t stop = pos;
+      if (pos < end) ++pos;
+      if (stop > start && buf[stop - 1] == '\r') --stop;
+      return std::string_view(buf + start, stop - start);
+    }
+    void skipLine() { readLine(); }
+
+    template <class T>
+    FdReader& operator>>(T& value) {
+      if constexpr (std::is_same<T, bool>::value) value = readInt<int>() != 0;
+      else if constexpr (std::is_same<T, char>::value) value = readChar();
+      else if constexpr (std::is_integral<T>::value) value = readInt<T>();
+      else if constexpr (std::is_floating_point<T>::value) value = static_cast<T>(readDouble());
+      else if constexpr (std::is_same<T, std::string_view>::value) value = readToken();
+      else if constexpr (std::is_same<T, std::string>::value) value.assign(readToken());
+      else static_assert(!sizeof(T*), "FdReader: can't read this type");
+      return *this;
+    }
+
+  private:
+    char buf[capacity + 1];   // one more for the '\0' after the last byte read
+    size_t pos = 0, end = 0;
+    int fd;
+
+    void skipSpace() {
+      while (true) {
+        while (pos < end && buf[pos] <= ' ') ++pos;
+        if (pos < end || !refill()) return;
+      }
+    }
+    // move [from, end) to the front of the buffer
+    void compact(size_t from) noexcept {
+      std::memmove(buf, buf + from, end - from);
+      end -= from;
+      pos -= from;
+      buf[end] = '\0';
+    }
+    // everything's been used: start over at the front
+    bool refill() {
+      pos = end = 0;
+      return fill();
+    }
+    // read more after `end`; blocks until something's there, false at the end of input
+    bool fill() {
+      if (end == capacity) return false;    // a single token bigger than the buffer
+      ssize_t got;
+      do got = ::read(fd, buf + end, capacity - end);
+      while (got < 0 && errno == EINTR);
+      if (got <= 0) {
+        buf[end] = '\0';
+        return false;
+      }
+      end += size_t(got);
+      buf[end] = '\0';
+      return true;
+    }
+  };
+
+  class FdWriter {
+  public:
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    explicit FdWriter(int fd = STDOUT_FILENO) noexcept : fd(fd) {}
+    FdWriter(const FdWriter&) = delete;
+    FdWriter& operator=(const FdWriter&) = delete;
+    ~FdWriter() { flush(); }
+
+    void write(char c) {
+      if (used == capacity) flush();
+      buf[used++] = c;
+    }
+    void write(std::string_view str) {
+      if (str.size() > capacity - used) {
+        flush();
+        if (str.size() > capacity) return writeAll(str.data(), str.size());
+      }
+      std::memcpy(buf + used, str.data(), str.size());
+      used += str.size();
+    }
+    template <class T>
+    void writeNumber(T value) {
+      // 24 is enough for any integer, and for the shortest round-trip form of a double
+      if (capacity - used < 24) flush();
+      used = std::to_chars(buf + used, buf + capacity, value).ptr - buf;
+    }
+    // hand everything written so far to the descriptor
+    void flush() {
+      writeAll(buf, used);
+      used = 0;
+    }
+
+    template <class T>
+    FdWriter& operator<<(const T& value) {
+      if constexpr (std::is_same<T, char>::value) write(value);
+      else if constexpr (std::is_same<T, bool>::value) write(value ? '1' : '0');
+      else if constexpr (std::is_arithmetic<T>::value) writeNumber(value);
+      else write(std::string_view(value));
+      return *this;
+    }
+
+  private:
+    char buf[capacity];
+    size_t used = 0;
+    int fd;
+
+    void writeAll(const char* data, size_t len) {
+      while (len > 0) {
+        ssize_t put = ::write(fd, data, len);
+        if (put <= 0) return;     // nowhere to send it: the referee's gone
+        data += put;
+        len -= size_t(put);
+      }
+    }
+  };
+
+  inline FdReader fast_in(STDIN_FILENO);
+  inline FdWriter fast_out(STDOUT_FILENO);
+}
+
+// instrument.hpp
+namespace kel {
+  // Diagnostics that cost nothing unless they're switched on:
+  //   timeScope("expand");            time from here to the end of the scope (rdtsc)
+  //   countEvent("nodes popped");     add 1 to a named counter
+  //   countAdd("plies", n);           add n
+  //   histogramAdd("depth", depth);   record a value; shown in power-of-2 buckets
+  //   logInfo("best " << move);       a line of log, anything cerr can print
+  //   logDebug(...) / logError(...)   the same at the other levels
+  //   instrTurnEnd();                 once a turn, after the answer's flushed
+  // Everything is collected over the turn and written to stderr in one go by
+  // instrTurnEnd(), then reset; what's left at exit is written then. Errors
+  // are the exception: they go out straight away, in case the bot's about to
+  // die. With INSTRUMENT 0 and LOG_LEVEL 0 every macro is ((void)0), and
+  // the arguments aren't evaluated at all.
+#if INSTRUMENT || LOG_LEVEL > 0
+  namespace instr {
+    // the cycle counter where there is one, steady_clock nanoseconds otherwise
+    inline uint64_t ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    struct TimerStat {
+      const char* name;
+      uint64_t calls, ticks;
+    };
+    struct CounterStat {
+      const char* name;
+      int64_t value;
+    };
+    struct HistogramStat {
+      const char* name;
+      uint64_t samples;
+      int64_t min, max, sum;
+      uint64_t buckets[65];   // 0 for values <= 0, then n for [2^(n-1), 2^n)
+    };
+
+    class Registry {
+    public:
+      static constexpr size_t max_stats = 64;   // of each kind; more than that are dropped
+
+      Registry() : start_ticks(ticks()), start_time(std::chrono::steady_clock::now()) {}
+      ~Registry() { if (pending || hasStats()) endTurn(); }
+
+      // Looked up by name once per call site (see the macros), so several
+      // sites with the same name add up.
+      TimerStat& timer(const char* name) noexcept { return find(timers, num_timers, name); }
+      CounterStat& counter(const char* name) noexcept { return find(counters, num_counters, name); }
+      HistogramStat& histogram(const char* name) noexcept {
+        HistogramStat& stat = find(histograms, num_histograms, name);
+        if (stat.samples == 0) resetHistogram(stat);
+        return stat;
+      }
+      void add(HistogramStat& stat, int64_t value) noexcept {
+        if (value < stat.min) stat.min = value;
+        if (value > stat.max) stat.max = value;
+        stat.sum += value;
+        ++stat.samples;
+        ++stat.buckets[(value <= 0) ? 0 : 64 - __builtin_clzll(uint64_t(value))];
+      }
+
+      std::ostream& log() noexcept {
+        pending = true;
+        return log_lines;
+      }
+      void logNow(const std::string& line) noexcept { writeAll(line.data(), line.size()); }
+
+      void endTurn() {
+        if (!pending && !hasStats()) {
+          ++turn;
+          return;
+        }
+        std::ostringstream out;
+        out << "-- turn " << turn++ << " --\n" << log_lines.str();
+        const double ticks_per_us = ticksPerMicro();
+        out << std::fixed << std::setprecision(2);
+        for (size_t idx = 0; idx < num_timers; ++idx) {
+          TimerStat& stat = timers[idx];
+          if (stat.calls == 0) continue;
+          const double total_us = stat.ticks / ticks_per_us;
+          out << "time  " << std::left << std::setw(24) << stat.name << std::right
+              << std::setw(10) << stat.calls << " calls " << std::setw(12) << total_us << " us "
+              << std::setw(10) << total_us / stat.calls << " us/call\n";
+          stat.calls = stat.ticks = 0;
+        }
+        for (size_t idx = 0; idx < num_counters; ++idx) {
+          CounterStat& stat = counters[idx];
+          if (stat.value == 0) continue;
+          out << "count " << std::left << std::setw(24) << stat.name << std::right << std::setw(10) << stat.value << '\n';
+          stat.value = 0;
+        }
+        for (size_t idx = 0; idx < num_histograms; ++idx) {
+          HistogramStat& stat = histograms[idx];
+          if (stat.samples == 0) continue;
+          out << "hist  " << std::left << std::setw(24) << stat.name << std::right
+              << " n " << stat.samples << ", min " << stat.min << ", mean " << double(stat.sum) / stat.samples
+              << ", max " << stat.max << "\n     ";
+          for (int bucket = 0; bucket < 65; ++bucket) {
+            if (stat.buckets[bucket] == 0) continue;
+            if (bucket == 0) out << " <=0:";
+            else if (bucket == 1) out << " 1:";
+            else out << ' ' << (uint64_t(1) << (bucket - 1)) << '-' << (uint64_t(1) << bucket) - 1 << ':';
+            out << stat.buckets[bucket];
+          }
+          out << '\n';
+          resetHistogram(stat);
+        }
+        const std::string text = out.str();
+        writeAll(text.data(), text.size());
+        log_lines.str(std::string());
+        pending = false;
+      }
+
+    private:
+      TimerStat timers[max_stats] = {};
+      CounterStat counters[max_stats] = {};
+      HistogramStat histograms[max_stats] = {};
+      size_t num_timers = 0, num_counters = 0, num_histograms = 0;
+      std::ostringstream log_lines;
+      int turn = 0;
+      bool pending = false;
+      uint64_t start_ticks;
+      std::chrono::steady_clock::time_point start_time;
+
+      bool hasStats() const noexcept {
+        for (size_t idx = 0; idx < num_timers; ++idx) if (timers[idx].calls) return true;
+        for (size_t idx = 0; idx < num_counters; ++idx) if (counters[idx].value) return true;
+        for (size_t idx = 0; idx < num_histograms; ++idx) if (histograms[idx].samples) return true;
+        return false;
+      }
+      template <class Stat>
+      Stat& find(Stat (&stats)[max_stats], size_t& count, const char* name) noexcept {
+        for (size_t idx = 0; idx < count; ++idx) {
+          if (std::strcmp(stats[idx].name, name) == 0) return stats[idx];
+        }
+        if (count == max_stats) {
+          static Stat overflow;   // counted, but never shown
+          return overflow;
+        }
+        stats[count].name = name;
+        return stats[count++];
+      }
+      static void resetHistogram(HistogramStat& stat) noexcept {
+        const char* name = stat.name;
+        stat = HistogramStat();
+        stat.name = name;
+        stat.min = INT64_MAX;
+        stat.max = INT64_MIN;
+      }
+      // calibrated against steady_clock over everything since startup
+      double ticksPerMicro() const noexcept {
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+        return (us > 0) ? (ticks() - start_ticks) / us : 1.0;
+      }
+      static void writeAll(const char* data, size_t len) noexcept {
+        while (len > 0) {
+          ssize_t put = ::write(STDERR_FILENO, data, len);
+          if (put <= 0) return;
+          data += put;
+          len -= size_t(put);
+        }
+      }
+    };
+
+    inline Registry& registry() {
+      static Registry reg;
+      return reg;
+    }
+
+    class ScopedTimer {
+    public:
+      explicit ScopedTimer(TimerStat& stat) noexcept : stat(stat), start(ticks()) {}
+      ~ScopedTimer() {
+        stat.ticks += ticks() - start;
+        ++stat.calls;
+      }
+    private:
+      TimerStat& stat;
+      uint64_t start;
+    };
+  }
+#endif
+
+#define _instrCat2(a, b) a##b
+#define _instrCat(a, b) _instrCat2(a, b)
+#define _instrSite(kind, name)                                                 \
+  static auto& _instrCat(_instr_stat_, __LINE__) = ::kel::instr::registry().kind(name)
+
+#if INSTRUMENT
+#define timeScope(name)                                                        \
+  _instrSite(timer, name);                                                     \
+  ::kel::instr::ScopedTimer _instrCat(_instr_timer_, __LINE__)(_instrCat(_instr_stat_, __LINE__))
+#define countAdd(name, n)                                                      \
+  do {                                                                         \
+    _instrSite(counter, name);                                                 \
+    _instrCat(_instr_stat_, __LINE__).value += (n);                            \
+  } while (0)
+#define countEvent(name) countAdd(name, 1)
+#define histogramAdd(name, value)                                              \
+  do {                                                                         \
+    _instrSite(histogram, name);                                               \
+    ::kel::instr::registry().add(_instrCat(_instr_stat_, __LINE__), (value));  \
+  } while (0)
+#else
+#define timeScope(name) ((void)0)
+#define countAdd(name, n) ((void)0)
+#define countEvent(name) ((void)0)
+#define histogramAdd(name, value) ((void)0)
+#endif
+
+#if LOG_LEVEL >= 1
+#define logError(...)                                                          \
+  do {                                                                         \
+    std::ostringstream _instr_line;                                            \
+    _instr_line << "error: " << __VA_ARGS__ << '\n';                           \
+    ::kel::instr::registry().logNow(_instr_line.str());                        \
+  } while (0)
+#else
+#define logError(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 2
+#define logInfo(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logInfo(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 3
+#define logDebug(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logDebug(...) ((void)0)
+#endif
+
+#if INSTRUMENT || LOG_LEVEL >= 2
+#define instrTurnEnd() ::kel::instr::registry().endTurn()
+#else
+#define instrTurnEnd() ((void)0)
+#endif
+}
+
+// lookup-tables.hpp
+namespace kel {
+#define rtype(fn) decltype(fn::eval(std::declval<size_t>()))
+
+  // Tables are filled by plain constexpr loops instead of expanding an
+  // index_sequence into one initializer with an element per entry. GCC gives
+  // every constant expression a budget (-fconstexpr-loop-limit,
+  // -fconstexpr-ops-limit), so tables up to lut_flat_max entries are filled in
+  // one go into a flat std::array, and bigger ones are split into chunks of
+  // lut_chunk entries that each get their own budget.
+  constexpr size_t lut_chunk = 1 << 12;
+  constexpr size_t lut_flat_max = 1 << 16;
+
+  // not constexpr on purpose: reaching it while filling a table is a compile error
+  inline void lookupValueDoesntFitElementType() noexcept {}
+
+  // A plain array with just enough of std::array's interface. Indexing is a
+  // builtin subscript rather than a call to std::array::operator[], which
+  // matters when tables are built out of other tables at compile time.
+  template <class T, size_t N>
+  struct LookupTable {
+    T values[N];
+
+    constexpr const T& operator[](size_t idx) const noexcept { return values[idx]; }
+    static constexpr size_t size() noexcept { return N; }
+    constexpr const T* begin() const noexcept { return values; }
+    constexpr const T* end() const noexcept { return values + N; }
+  };
+
+  // entries [Begin, min(Begin + Len, N)) of the table, as T
+  template <class T, class GenFn, size_t N, size_t Begin, size_t Len>
+  static constexpr LookupTable<T, Len> fillLutChunk() noexcept {
+    constexpr size_t end = std::min(Len, N - Begin);
+    LookupTable<T, Len> chunk{};
+    for (size_t start = 0; start < end; start += lut_chunk) {
+      const size_t stop = std::min(end, start + lut_chunk);
+      for (size_t idx = start; idx < stop; ++idx) {
+        const auto value = GenFn::eval(Begin + idx);
+        chunk.values[idx] = static_cast<T>(value);
+        if constexpr (!std::is_same_v<T, std::remove_const_t<decltype(value)>>) {
+          if (static_cast<decltype(value)>(chunk.values[idx]) != value) lookupValueDoesntFitElementType();
+        }
+      }
+    }
+    return chunk;
+  }
+
+  // a table too big to fill flat; indexing costs a shift and a mask more
+  template <class T, size_t N>
+  struct ChunkedLookupTable {
+    static constexpr size_t num_chunks = (N + lut_chunk - 1) / lut_chunk;
+    LookupTable<T, lut_chunk> chunks[num_chunks];
+
+    constexpr const T& operator[](size_t idx) const noexcept {
+      return chunks[idx / lut_chunk].values[idx % lut_chunk];
+    }
+    static constexpr size_t size() noexcept { return N; }
+  };
+  template <class T, class GenFn, size_t N, size_t... Chunks>
+  static constexpr ChunkedLookupTable<T, N> fillChunkedLookupTable(std::index_sequence<Chunks...>) noexcept {
+    return {{ fillLutChunk<T, GenFn, N, Chunks * lut_chunk, lut_chunk>()... }};
+  }
+
+  template <class T, class GenFn, size_t N>
+  static constexpr auto fillLookupTable() noexcept {
+    if constexpr (N <= lut_flat_max) return fillLutChunk<T, GenFn, N, 0, N>();
+    else return fillChunkedLookupTable<T, GenFn, N>(
+      std::make_index_sequence<ChunkedLookupTable<T, N>::num_chunks>{});
+  }
+  template <class GenFn, size_t N>
+  static constexpr auto makeLookupTable() noexcept {
+    return fillLookupTable<rtype(GenFn), GenFn, N>();
+  }
+
+#define genLookupTable(gen_fn, size)                                           \
+  struct gen_##gen_fn                                                          \
+  {                                                                            \
+    static constexpr auto eval(size_t input) noexcept                          \
+    {                                                                          \
+      return gen_fn(input);                                                    \
+    }                                                                          \
+  };                                                                           \
+  constexpr auto lut_##gen_fn = kel::makeLookupTable<gen_##gen_fn, size>()
+#define lookup(gen_fn, index) (lut_##gen_fn[index])
+
+#undef rtype
+}
+
+using namespace kel;
 using namespace std;
 
 enum GridSquare : char
@@ -25,14 +736,91 @@ enum GameState : char
   draw,
 };
 
+// squares are numbered x + 3 * y; a bitboard has bit n set for square n
+static constexpr bool isWon(size_t bitboard) noexcept
+{
+  constexpr size_t lines[8] = {
+    0007, 0070, 0700,   // rows
+    0111, 0222, 0444,   // columns
+    0421, 0124,         // diagonals
+  };
+  for (size_t line : lines)
+  {
+    if ((bitboard & line) == line)
+      return true;
+  }
+  return false;
+}
+genLookupTable(isWon, pow2(9));
+
+// Every position is numbered in base 3, one digit per square
+// (0 = blank, 1 = X, 2 = O), so marking square n adds 3^n or 2 * 3^n.
+constexpr int num_positions = 19683; // 3^9
+constexpr int pow3[9] = { 1, 3, 9, 27, 81, 243, 729, 2187, 6561 };
+
+struct Solution
+{
+  i8 move;  // best square for the side to play, -1 if the game is over or the position can't happen
+  i8 score; // > 0 win, 0 draw, < 0 loss for the side to play; faster wins and slower losses score higher
+};
+
+// Solves every position at compile time.
+// Marking a square only ever increases the position number, so walking the
+// positions from the top down means every child is solved before its parent.
+// Not a genLookupTable: a generator there sees one index at a time and only
+// tables that are already finished, never the one it's filling, so it would
+// take a table per number of marks, each over all 3^9 positions. That gives
+// the same table and takes GCC about 8 times as long to compile.
+static constexpr array<Solution, num_positions> solveAll() noexcept
+{
+  constexpr int move_order[9] = { 4, 0, 2, 6, 8, 1, 3, 5, 7 }; // break ties toward the center, then corners
+  array<Solution, num_positions> table{};
+  for (int pos = num_positions - 1; pos >= 0; --pos)
+  {
+    size_t x_bb = 0, o_bb = 0;
+    int x_count = 0, o_count = 0;
+    for (int sq = 0, digits = pos; sq < 9; ++sq, digits /= 3)
+    {
+      if (digits % 3 == 1) { x_bb |= pow2(sq); ++x_count; }
+      else if (digits % 3 == 2) { o_bb |= pow2(sq); ++o_count; }
+    }
+    int empties = 9 - x_count - o_count;
+    Solution& sol = table[pos];
+    sol.move = -1;
+    sol.score = 0;
+    if (x_count != o_count && x_count != o_count + 1)
+      continue; // unreachable
+    if (lookup(isWon, x_bb) || lookup(isWon, o_bb))
+    {
+      sol.score = static_cast<i8>(-1 - empties); // the player who just moved has won
+      continue;
+    }
+    int mark = (x_count == o_count) ? 1 : 2;
+    for (int sq : move_order)
+    {
+      if ((x_bb | o_bb) & pow2(sq))
+        continue;
+      int score = -table[pos + mark * pow3[sq]].score;
+      if (sol.move == -1 || score > sol.score)
+      {
+        sol.move = static_cast<i8>(sq);
+        sol.score = static_cast<i8>(score);
+      }
+    }
+  }
+  return table;
+}
+constexpr auto solutions = solveAll();
+
 class TicTacToeBoard {
 public:
-  TicTacToeBoard() : board(), moves(), x_to_play(true) { board.fill(blank); }
+  TicTacToeBoard() : board(), moves(), x_to_play(true), position(0) { board.fill(blank); }
 
   struct Move
   {
     int x, y;
   };
+  using MoveList = static_vector<Move, 9>;
 
   GridSquare& at(int x, int y)
   {
@@ -46,8 +834,8 @@ public:
   void clear()
   {
     board.fill(blank);
-    while (!moves.empty())
-      moves.pop();
+    position = 0;
+    moves.clear();
   }
 
   GridSquare getNextPlayer() const
@@ -59,32 +847,24 @@ public:
     return (x_to_play) ? o : x;
   }
 
-  vector<Move> getMoves() const
+  MoveList getMoves() const
   {
-    // cerr << "generating moves";
     if (gameState() != ongoing)
       return {};
-    // cerr << '.';
     GridSquare p = getNextPlayer();
-    vector<Move> ret;
-    ret.reserve(5);
+    MoveList ret;
     for (int i = 0; i < board.size(); ++i)
     {
-      // cerr << '.';
       if (board[i] == blank)
         ret.push_back({ i % 3, i / 3 });
     }
-    // cerr << endl;
     return ret;
   }
 
   GameState gameState() const
   {
-    // cerr << "Checking game state:\n";
-    // cerr << "\nChecking verticals";
     for (int x = 0; x < 3; ++x)
     {
-      // cerr << '.';
       //  vertial line
       auto top = at(x, 0);
       if (top != blank && top == at(x, 1) && top == at(x, 2))
@@ -92,24 +872,19 @@ public:
         return static_cast<GameState>(top);
       }
     }
-    // cerr << "\nChecking horizontals";
     for (int y = 0; y < 3; ++y)
     {
-      // cerr << '.';
       //  horizontal line
       if (at(0, y) != blank && at(0, y) == at(1, y) && at(1, y) == at(2, y))
       {
         return static_cast<GameState>(at(0, y));
       }
     }
-    // cerr << "\nChecking diagonals";
     //  diagonals
-    // cerr << '.';
     if (at(0, 0) != blank && at(0, 0) == at(1, 1) && at(1, 1) == at(2, 2))
     {
       return static_cast<GameState>(at(0, 0));
     }
-    // cerr << '.';
     if (at(2, 0) != blank && at(2, 0) == at(1, 1) && at(1, 1) == at(0, 2))
     {
       return static_cast<GameState>(at(2, 0));
@@ -117,6 +892,12 @@ public:
     return (moves.size() == 9) ? draw : ongoing;
   }
 
+  // this position's index into `solutions`
+  int getPosition() const
+  {
+    return position;
+  }
+
   bool pushMove(const Move& move)
   {
     GridSquare& sq = at(move.x, move.y);
@@ -124,6 +905,7 @@ public:
       return false;
     moves.push(move);
     sq = getNextPlayer();
+    position += ((x_to_play) ? 1 : 2) * pow3[3 * move.y + move.x];
     x_to_play = !x_to_play;
     return true;
   }
@@ -133,6 +915,7 @@ public:
     moves.pop();
     at(move.x, move.y) = blank;
     x_to_play = !x_to_play;
+    position -= ((x_to_play) ? 1 : 2) * pow3[3 * move.y + move.x];
   }
 
   friend ostream& operator<<(ostream& os, TicTacToeBoard& board)
@@ -152,61 +935,17 @@ public:
 
 private:
   array<GridSquare, 9> board;
-  stack<Move> moves;
+  inline_stack<Move, 9> moves;
   bool x_to_play;
+  int position;
 };
 
-int negamax(TicTacToeBoard& board, int depth = 0)
+TicTacToeBoard::Move bestMove(const TicTacToeBoard& board)
 {
-  // cerr << "depth " << depth << endl;
-  if (depth == 8)
-    cerr << board << endl
-    << endl;
-  GameState state = board.gameState();
-  switch (state)
-  {
-  case draw:
-    return 0;
-  case x_won:
-  case o_won:
-    return -1;
-  case ongoing:
-    break;
-  }
-  TicTacToeBoard::Move best;
-  int best_score = -2;
-  for (const auto& move : board.getMoves())
-  {
-    board.pushMove(move);
-    int score = -negamax(board, depth + 1);
-    if (score > best_score)
-    {
-      best = move;
-      best_score = score;
-    }
-    board.popMove();
-  }
-  return best_score;
-}
-
-TicTacToeBoard::Move bestMove(TicTacToeBoard& board)
-{
-  if (board.getMoves().size() == 9)
-    return { 1, 1 };
-  TicTacToeBoard::Move best;
-  int best_score = -2;
-  for (const auto& move : board.getMoves())
-  {
-    board.pushMove(move);
-    int score = -negamax(board);
-    if (score > best_score)
-    {
-      best = move;
-      best_score = score;
-    }
-    board.popMove();
-  }
-  return best;
+  int sq = solutions[board.getPosition()].move;
+  if (sq == -1)
+    return { -1, -1 };
+  return { sq % 3, sq / 3 };
 }
 
 #ifdef INTERACTIBLE
@@ -320,7 +1059,6 @@ int main()
       break;
     }
     bool user_satisfied;
-    auto moves = board.getMoves();
     while (true)
     {
       TicTacToeBoard::Move move;
@@ -360,7 +1098,7 @@ int main()
       }
       if (!user_satisfied)
         board.popMove();
-      else
+      else if (board.gameState() == ongoing)
         board.pushMove(bestMove(board));
     }
   }
@@ -378,32 +1116,30 @@ int main()
   {
     int opponent_row;
     int opponent_col;
-    cin >> opponent_row >> opponent_col;
-    cin.ignore();
-    cerr << opponent_row << ' ' << opponent_col;
+    fast_in >> opponent_row >> opponent_col;
+    logInfo("opponent played " << opponent_row << ' ' << opponent_col);
     if (opponent_row != -1 && opponent_col != -1)
     {
       board.pushMove({ opponent_col, opponent_row });
     }
-    cerr << board << endl;
+    logInfo(board);
     int valid_action_count;
-    cin >> valid_action_count;
-    cin.ignore();
-    cerr << valid_action_count << " should == ";
-    cerr << board.getMoves().size() << endl;
+    fast_in >> valid_action_count;
+    logInfo(valid_action_count << " valid moves, " << board.getMoves().size() << " generated");
     for (int i = 0; i < valid_action_count; i++)
     {
       int row;
       int col;
-      cin >> row >> col;
-      cin.ignore();
+      fast_in >> row >> col;
     }
 
-    // Write an action using cout. DON'T FORGET THE "<< endl"
-    // To debug: cerr << "Debug messages..." << endl;
+    // Write an action with fast_out and flush() it at the end of the turn.
+    // To debug: logInfo("Debug messages...");
     auto best_move = bestMove(board);
     board.pushMove(best_move);
-    cout << best_move.y << ' ' << best_move.x << endl;
+    fast_out << best_move.y << ' ' << best_move.x << '\n';
+    fast_out.flush();
+    instrTurnEnd();
   }
 }
 
@@ -1,20 +1,76 @@
+// popcnt/BMI2 for bit-fiddling.hpp, picked at compile time: 1 only once the
+// judge's CPU is known to have them (without, the bot dies of SIGILL), and
+// pdep/pext are microcoded and slow on AMD before Zen 3
+#define BIT_INSTRUCTIONS 0
+#if BIT_INSTRUCTIONS
+#pragma GCC target("popcnt,bmi,bmi2")
+#endif
+
 #include <algorithm>
 #include <array>
+#include <cerrno>
+#include <charconv>
 #include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
-#include <random>
 #include <set>
-#include <stack>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
-#define USE_LOOKUP 1
-#define USE_2D_LOOKUP 0
+// where each lookup table lives: compile_time, startup or compute (see
+// lookup-tables.hpp); these are what tools/lut-policy-bench picked. Not all
+// independent: a compile_time table can only read tables the compiler can
+// too (compile_time or compute), and WIN_STATE reads IS_WON while IS_ONGOING
+// and IS_TERMINAL read WIN_STATE
+#define IS_WON_LUT compute
+#define WINNING_SQUARES_LUT startup
+#define WIN_STATE_LUT startup
+#define IS_ONGOING_LUT compute
+#define IS_TERMINAL_LUT startup
 
 #define NUM_ROLLOUTS 2
+#define NODE_ALLOCATOR PoolAllocator  // where tree nodes live: PoolAllocator (arena.hpp) or std::allocator
+
+#define ARENA 0             // play heavy vs. random rollouts locally instead of talking to the referee
+#define ARENA_GAMES 100
+#define ARENA_MOVE_MS 10
+
+#define TELEMETRY 0         // per-turn search stats as JSON lines; leave at 0 for submission
+#define TELEMETRY_FILE ""   // write the JSON lines to this file instead of stderr
+
+#define CONTAINER_CHECKS 0  // bounds-check the fixed-capacity containers; 1 while debugging
+
+#define INSTRUMENT 0        // per-turn timers, counters and histograms on stderr (instrument.hpp)
+#define LOG_LEVEL 1         // 0 silent, 1 errors, 2 and a few lines a turn, 3 and hot-loop debug
+
+#if TELEMETRY
+#include <fstream>
+#endif
 
 // typedefs.hpp
 namespace kel {
@@ -34,34 +90,1333 @@ namespace kel {
 
 // bit-fiddling.hpp
 namespace kel {
-#define pow2(power) (1ull << (power))
-#define ones(num) (pow2(num) - 1ull)
-#define bitRange(nbits, start, stop) (ones(nbits, stop) & (~ones(nbits, start)))
+  // Typed constexpr bit tricks for any unsigned type up to unsigned __int128.
+  // Each one compiles to a single instruction when the target has it:
+  // popcount wants -mpopcnt and pdep/pext/selectBit want -mbmi2 (or a
+  // `#pragma GCC target`). Without those flags, and always at compile time,
+  // portable versions are used instead. Note that pdep/pext are microcoded,
+  // and slow, on AMD before Zen 3.
+  using u128 = unsigned __int128;
+
+  template <class T>
+  constexpr bool is_mask_v = std::is_same<T, u128>::value
+    || (std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value);
+  template <class T>
+  constexpr int mask_bits = int(sizeof(T) * CHAR_BIT);
+
+  // smallest unsigned type with at least `Bits` bits
+  template <int Bits>
+  using mask_t = std::conditional_t<(Bits <= 8), u8,
+    std::conditional_t<(Bits <= 16), u16,
+    std::conditional_t<(Bits <= 32), u32,
+    std::conditional_t<(Bits <= 64), u64, u128>>>>;
+
+  template <class T = ull>
+  constexpr T pow2(int power) noexcept {
+    return static_cast<T>(T(1) << power);
+  }
+  // the lowest `num` bits; ones<u64>(64) is all of them
+  template <class T = ull>
+  constexpr T ones(int num) noexcept {
+    return (num >= mask_bits<T>) ? static_cast<T>(~T(0)) : static_cast<T>(pow2<T>(num) - 1);
+  }
+  // bits start, start + 1, ..., stop - 1
+  template <class T = ull>
+  constexpr T bitRange(int start, int stop) noexcept {
+    return static_cast<T>(ones<T>(stop) & ~ones<T>(start));
+  }
+
+  template <class T>
+  constexpr T getLS1B(T mask) noexcept {
+    return static_cast<T>(mask & (~mask + 1));
+  }
+  // clears the lowest set bit of `mask` and returns what's left,
+  // so `do { ... } while (clearLS1B(mask));` visits every set bit
+  template <class T>
+  constexpr T clearLS1B(T& mask) noexcept {
+    return mask = static_cast<T>(mask & (mask - 1));
+  }
+
+  template <class T>
+  constexpr int popcount(T mask) noexcept {
+    static_assert(is_mask_v<T>, "popcount: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      return popcount(u64(mask)) + popcount(u64(mask >> 64));
+    }
+    else {
+#if defined(__POPCNT__)
+      return __builtin_popcountll(mask);
+#else
+      // without popcnt the builtin is a call into libgcc; this is about as fast inline
+      u64 x = mask;
+      x = x - ((x >> 1) & 0x5555555555555555);
+      x = (x & 0x3333333333333333) + ((x >> 2) & 0x3333333333333333);
+      x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0f;
+      if constexpr (mask_bits<T> <= 8) return int(x);
+      else return int((x * 0x0101010101010101) >> 56);
+#endif
+    }
+  }
+
+  // index of the lowest/highest set bit; `mask` can't be 0
+  template <class T>
+  constexpr int indexLS1B(T mask) noexcept {
+    static_assert(is_mask_v<T>, "indexLS1B: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      return u64(mask) ? __builtin_ctzll(u64(mask)) : 64 + __builtin_ctzll(u64(mask >> 64));
+    }
+    else return __builtin_ctzll(mask);
+  }
+  template <class T>
+  constexpr int indexMS1B(T mask) noexcept {
+    static_assert(is_mask_v<T>, "indexMS1B: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      return u64(mask >> 64) ? 127 - __builtin_clzll(u64(mask >> 64)) : 63 - __builtin_clzll(u64(mask));
+    }
+    else return 63 - __builtin_clzll(mask);
+  }
+  // trailing/leading zeros, all of them for 0 (like C++20's countr_zero/countl_zero)
+  template <class T>
+  constexpr int ctz(T mask) noexcept {
+    return mask ? indexLS1B(mask) : mask_bits<T>;
+  }
+  template <class T>
+  constexpr int clz(T mask) noexcept {
+    return mask ? mask_bits<T> - 1 - indexMS1B(mask) : mask_bits<T>;
+  }
+
+  // deposit the low bits of `src` into the set bits of `mask`, in order
+  template <class T>
+  constexpr T pdep(T src, T mask) noexcept {
+    static_assert(is_mask_v<T>, "pdep: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      u64 lo = u64(mask), hi = u64(mask >> 64);
+      return T(pdep(u64(src), lo)) | T(pdep(u64(src >> popcount(lo)), hi)) << 64;
+    }
+    else {
+#if defined(__BMI2__)
+      if (!__builtin_is_constant_evaluated()) return static_cast<T>(_pdep_u64(src, mask));
+#endif
+      T out = 0;
+      for (; mask; src >>= 1) {
+        out |= static_cast<T>(getLS1B(mask) & (T(0) - (src & 1)));
+        clearLS1B(mask);
+      }
+      return out;
+    }
+  }
+  // gather the bits of `src` under the set bits of `mask` into the low bits
+  template <class T>
+  constexpr T pext(T src, T mask) noexcept {
+    static_assert(is_mask_v<T>, "pext: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      u64 lo = u64(mask), hi = u64(mask >> 64);
+      return T(pext(u64(src), lo)) | T(pext(u64(src >> 64), hi)) << popcount(lo);
+    }
+    else {
+#if defined(__BMI2__)
+      if (!__builtin_is_constant_evaluated()) return static_cast<T>(_pext_u64(src, mask));
+#endif
+      T out = 0;
+      for (int count = 0; mask; ++count) {
+        out |= static_cast<T>(T((src >> indexLS1B(mask)) & 1) << count);
+        clearLS1B(mask);
+      }
+      return out;
+    }
+  }
+
+  // index of set bit number `n` (0 is the lowest); `mask` needs more than n set bits
+  template <class T>
+  constexpr int selectBit(T mask, int n) noexcept {
+    static_assert(is_mask_v<T>, "selectBit: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      int lo = popcount(u64(mask));
+      return (n < lo) ? selectBit(u64(mask), n) : 64 + selectBit(u64(mask >> 64), n - lo);
+    }
+    else {
+#if defined(__BMI2__)
+      if (!__builtin_is_constant_evaluated()) return indexLS1B(_pdep_u64(u64(1) << n, mask));
+#endif
+      u64 x = mask;
+      int base = 0;
+      if constexpr (mask_bits<T> > 16) {
+        // Running popcount up to every byte, then skip the bytes whose count is
+        // still <= n: (n | 0x80) - count keeps its top bit exactly for those.
+        constexpr u64 lsbs = 0x0101010101010101, msbs = 0x8080808080808080;
+        u64 bytes = x - ((x >> 1) & 0x5555555555555555);
+        bytes = (bytes & 0x3333333333333333) + ((bytes >> 2) & 0x3333333333333333);
+        bytes = ((bytes + (bytes >> 4)) & 0x0f0f0f0f0f0f0f0f) * lsbs;
+        base = int((((((u64(n) * lsbs) | msbs) - bytes) & msbs) >> 7) * lsbs >> 56) * 8;
+        n -= int((bytes << 8 >> base) & 0xff);
+        x >>= base;
+      }
+      for (; n > 0; --n) clearLS1B(x);
+      return base + indexLS1B(x);
+    }
+  }
+
+  // `for (int idx : setBits(mask))` visits the index of every set bit, lowest first
+  template <class T>
+  struct SetBits {
+    T mask;
+
+    struct iterator {
+      T mask;
+      constexpr int operator*() const noexcept { return indexLS1B(mask); }
+      constexpr iterator& operator++() noexcept {
+        clearLS1B(mask);
+        return *this;
+      }
+      constexpr bool operator==(const iterator& other) const noexcept { return mask == other.mask; }
+      constexpr bool operator!=(const iterator& other) const noexcept { return mask != other.mask; }
+    };
+    constexpr iterator begin() const noexcept { return { mask }; }
+    constexpr iterator end() const noexcept { return { 0 }; }
+    constexpr int size() const noexcept { return popcount(mask); }
+    constexpr bool empty() const noexcept { return !mask; }
+  };
+  template <class T>
+  constexpr SetBits<T> setBits(T mask) noexcept {
+    static_assert(is_mask_v<T>, "setBits: not an unsigned type");
+    return { mask };
+  }
+}
+
+// rng.hpp
+namespace kel {
+  // PCG32 (O'Neill), XSH-RR: 64-bit LCG state, 32-bit output, period 2^64.
+  // Each `stream` is a different sequence.
+  class Pcg32 {
+  public:
+    using result_type = u32;
+
+    constexpr explicit Pcg32(u64 seed = 0x5eed5eed5eed5eed, u64 stream = 0xda3e39cb94b95bdb) noexcept
+      : state(0), inc((stream << 1) | 1) {
+      (*this)();
+      state += seed;
+      (*this)();
+    }
+    // restart at `seed`, staying on the same stream
+    constexpr void seed(u64 seed) noexcept { *this = Pcg32(seed, inc >> 1); }
 
-#define getLS1B(mask) ((mask) & -(mask))
-#define clearLS1B(mask) (mask &= (mask - 1))
+    constexpr u32 operator()() noexcept {
+      const u64 old = state;
+      state = old * mult + inc;
+      const u32 xorshifted = static_cast<u32>(((old >> 18) ^ old) >> 27);
+      const int rot = static_cast<int>(old >> 59);
+      return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+    static constexpr u32 min() noexcept { return 0; }
+    static constexpr u32 max() noexcept { return ~u32(0); }
+
+    // the same as `delta` calls, in O(log delta)
+    constexpr void advance(u64 delta) noexcept {
+      u64 acc_mult = 1, acc_plus = 0, cur_mult = mult, cur_plus = inc;
+      for (; delta; delta >>= 1) {
+        if (delta & 1) {
+          acc_mult *= cur_mult;
+          acc_plus = acc_plus * cur_mult + cur_plus;
+        }
+        cur_plus *= cur_mult + 1;
+        cur_mult *= cur_mult;
+      }
+      state = acc_mult * state + acc_plus;
+    }
+    // a generator on another stream, seeded from this one
+    constexpr Pcg32 split() noexcept {
+      u64 seed = (u64((*this)()) << 32) | (*this)();
+      u64 stream = (u64((*this)()) << 32) | (*this)();
+      return Pcg32(seed, stream);
+    }
+
+  private:
+    static constexpr u64 mult = 6364136223846793005;
+    u64 state, inc;
+  };
+
+  // [0, range), without the bias or the division of rng() % range
+  template <class Rng>
+  constexpr u32 bounded(Rng& rng, u32 range) noexcept {
+    if constexpr (sizeof(typename Rng::result_type) >= 8) {
+      unsigned __int128 m = static_cast<unsigned __int128>(static_cast<u64>(rng())) * range;
+      u64 low = static_cast<u64>(m);
+      if (low < range) {
+        const u64 threshold = (0 - u64(range)) % range;
+        while (low < threshold) {
+          m = static_cast<unsigned __int128>(static_cast<u64>(rng())) * range;
+          low = static_cast<u64>(m);
+        }
+      }
+      return static_cast<u32>(m >> 64);
+    }
+    else {
+      u64 m = u64(static_cast<u32>(rng())) * range;
+      u32 low = static_cast<u32>(m);
+      if (low < range) {
+        const u32 threshold = (0 - range) % range;
+        while (low < threshold) {
+          m = u64(static_cast<u32>(rng())) * range;
+          low = static_cast<u32>(m);
+        }
+      }
+      return static_cast<u32>(m >> 32);
+    }
+  }
+}
+
+// fixed-containers.hpp
+namespace kel {
+  // Containers with their capacity fixed at compile time and their elements
+  // stored inline, so they never allocate. The storage is a plain T[N]: T has
+  // to be default constructible, all N are constructed up front, and popped
+  // slots keep their old value until they're reused. In return a container
+  // of a trivially copyable T is itself trivially copyable.
+#if CONTAINER_CHECKS
+#define _containerCheck(cond, what)                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::fputs(what "\n", stderr);                                           \
+      std::abort();                                                            \
+    }                                                                          \
+  } while (0)
+#else
+#define _containerCheck(cond, what) ((void)0)
+#endif
+
+  template <class T, size_t N>
+  class static_vector {
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t capacity() noexcept { return N; }
+    constexpr size_t size() const noexcept { return count; }
+    constexpr bool empty() const noexcept { return count == 0; }
+    constexpr bool full() const noexcept { return count == N; }
+
+    constexpr T& operator[](size_t idx) noexcept {
+      _containerCheck(idx < count, "static_vector: index out of range");
+      return items[idx];
+    }
+    constexpr const T& operator[](size_t idx) const noexcept {
+      _containerCheck(idx < count, "static_vector: index out of range");
+      return items[idx];
+    }
+    constexpr T& front() noexcept { return (*this)[0]; }
+    constexpr const T& front() const noexcept { return (*this)[0]; }
+    constexpr T& back() noexcept { return (*this)[count - 1]; }
+    constexpr const T& back() const noexcept { return (*this)[count - 1]; }
+
+    constexpr T* data() noexcept { return items; }
+    constexpr const T* data() const noexcept { return items; }
+    constexpr T* begin() noexcept { return items; }
+    constexpr const T* begin() const noexcept { return items; }
+    constexpr T* end() noexcept { return items + count; }
+    constexpr const T* end() const noexcept { return items + count; }
+
+    constexpr void push_back(const T& value) noexcept(std::is_nothrow_copy_assignable<T>::value) {
+      _containerCheck(count < N, "static_vector: push_back past capacity");
+      items[count++] = value;
+    }
+    constexpr void push_back(T&& value) noexcept(std::is_nothrow_move_assignable<T>::value) {
+      _containerCheck(count < N, "static_vector: push_back past capacity");
+      items[count++] = std::move(value);
+    }
+    template <class... Args>
+    constexpr T& emplace_back(Args&&... args) {
+      _containerCheck(count < N, "static_vector: emplace_back past capacity");
+      return items[count++] = T(std::forward<Args>(args)...);
+    }
+    constexpr void pop_back() noexcept {
+      _containerCheck(count > 0, "static_vector: pop_back on empty");
+      --count;
+    }
+    constexpr void resize(size_t new_size) noexcept {
+      _containerCheck(new_size <= N, "static_vector: resize past capacity");
+      count = new_size;
+    }
+    constexpr void clear() noexcept { count = 0; }
+    // O(1): the last element takes its place, so the order isn't kept
+    constexpr void swapRemove(size_t idx) noexcept {
+      _containerCheck(idx < count, "static_vector: index out of range");
+      items[idx] = std::move(items[--count]);
+    }
+
+  private:
+    T items[N] = {};
+    size_t count = 0;
+  };
+
+  // FIFO over a circular buffer: push at the back, pop from the front
+  template <class T, size_t N>
+  class ring_queue {
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+
+    static constexpr size_t capacity() noexcept { return N; }
+    constexpr size_t size() const noexcept { return count; }
+    constexpr bool empty() const noexcept { return count == 0; }
+    constexpr bool full() const noexcept { return count == N; }
+
+    constexpr T& front() noexcept {
+      _containerCheck(count > 0, "ring_queue: front on empty");
+      return items[head];
+    }
+    constexpr const T& front() const noexcept {
+      _containerCheck(count > 0, "ring_queue: front on empty");
+      return items[head];
+    }
+    constexpr T& back() noexcept {
+      _containerCheck(count > 0, "ring_queue: back on empty");
+      return items[wrap(head + count - 1)];
+    }
+    constexpr const T& back() const noexcept {
+      _containerCheck(count > 0, "ring_queue: back on empty");
+      return items[wrap(head + count - 1)];
+    }
+    // 0 is the front
+    constexpr T& operator[](size_t idx) noexcept {
+      _containerCheck(idx < count, "ring_queue: index out of range");
+      return items[wrap(head + idx)];
+    }
+    constexpr const T& operator[](size_t idx) const noexcept {
+      _containerCheck(idx < count, "ring_queue: index out of range");
+      return items[wrap(head + idx)];
+    }
+
+    constexpr void push(const T& value) noexcept(std::is_nothrow_copy_assignable<T>::value) {
+      _containerCheck(count < N, "ring_queue: push past capacity");
+      items[wrap(head + count++)] = value;
+    }
+    constexpr void push(T&& value) noexcept(std::is_nothrow_move_assignable<T>::value) {
+      _containerCheck(count < N, "ring_queue: push past capacity");
+      items[wrap(head + count++)] = std::move(value);
+    }
+    constexpr void pop() noexcept {
+      _containerCheck(count > 0, "ring_queue: pop on empty");
+      head = wrap(head + 1);
+      --count;
+    }
+    constexpr void clear() noexcept { head = count = 0; }
+
+  private:
+    T items[N] = {};
+    size_t head = 0, count = 0;
+
+    // indices never get past 2N - 2, so one compare is enough
+    static constexpr size_t wrap(size_t idx) noexcept { return (idx >= N) ? idx - N : idx; }
+  };
+
+  // LIFO, with std::stack's interface
+  template <class T, size_t N>
+  class inline_stack {
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using container_type = static_vector<T, N>;
+
+    static constexpr size_t capacity() noexcept { return N; }
+    constexpr size_t size() const noexcept { return items.size(); }
+    constexpr bool empty() const noexcept { return items.empty(); }
+    constexpr bool full() const noexcept { return items.full(); }
+
+    constexpr T& top() noexcept { return items.back(); }
+    constexpr const T& top() const noexcept { return items.back(); }
+    constexpr void push(const T& value) { items.push_back(value); }
+    constexpr void push(T&& value) { items.push_back(std::move(value)); }
+    template <class... Args>
+    constexpr T& emplace(Args&&... args) { return items.emplace_back(std::forward<Args>(args)...); }
+    constexpr void pop() noexcept { items.pop_back(); }
+    constexpr void clear() noexcept { items.clear(); }
+
+    // bottom to top
+    constexpr const T* begin() const noexcept { return items.begin(); }
+    constexpr const T* end() const noexcept { return items.end(); }
+
+  private:
+    container_type items;
+  };
+
+  static_assert(std::is_trivially_copyable<static_vector<int, 4>>::value
+    && std::is_trivially_copyable<ring_queue<int, 4>>::value
+    && std::is_trivially_copyable<inline_stack<int, 4>>::value,
+    "fixed containers of a trivially copyable type should be too");
+}
+
+
+// arena.hpp
+namespace kel {
+  // Allocators for lots of small objects that are made and thrown away
+  // together (search trees, graphs, populations):
+  //   Arena          bump allocation out of big chunks, freed all at once
+  //   BlockPool      fixed-size blocks with a free list, carved from an Arena
+  //   PoolAllocator  an STL allocator over per-thread BlockPools, one per
+  //                  size class; pass it as a container's allocator (or as
+  //                  the `Allocator` template parameter of a bot's tree) to
+  //                  keep its nodes together and off malloc
+
+  enum class PageBacking {
+    heap,         // plain malloc'd chunks
+    huge_pages,   // 2 MiB aligned chunks with transparent huge pages asked for (Linux); fewer TLB misses in big trees
+  };
+
+  constexpr size_t huge_page_bytes = size_t(2) << 20;
+
+  inline void* allocatePages(size_t bytes, PageBacking backing) {
+    if (backing == PageBacking::huge_pages) {
+      bytes = (bytes + huge_page_bytes - 1) & ~(huge_page_bytes - 1);
+      void* ptr = std::aligned_alloc(huge_page_bytes, bytes);
+      if (!ptr) throw std::bad_alloc();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+      madvise(ptr, bytes, MADV_HUGEPAGE);   // only a hint; without THP these are still normal pages
+#endif
+      return ptr;
+    }
+    void* ptr = std::malloc(bytes);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+  }
+
+  // Bump allocator: each allocation is a pointer increment into the current
+  // chunk, and nothing is freed until reset() or release().
+  class Arena {
+  public:
+    explicit Arena(size_t chunk_bytes = size_t(1) << 20, PageBacking backing = PageBacking::heap) noexcept
+      : chunk_bytes(chunk_bytes), backing(backing) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() { release(); }
+
+    // `align` has to be a power of 2
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+      size_t start = alignedOffset(align);
+      if (!head || start + bytes > head->size) {
+        grow(bytes + align);
+        start = alignedOffset(align);
+      }
+      used = start + bytes;
+      return reinterpret_cast<char*>(head) + start;
+    }
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+      return ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // forget everything allocated so far, but keep the first chunk to reuse
+    void reset() noexcept {
+      while (head && head->next) {
+        Chunk* next = head->next;
+        std::free(head);
+        head = next;
+      }
+      used = sizeof(Chunk);
+    }
+    // give every chunk back
+    void release() noexcept {
+      while (head) {
+        Chunk* next = head->next;
+        std::free(head);
+        head = next;
+      }
+      used = 0;
+    }
+    // for chunks allocated from now on
+    void setBacking(PageBacking new_backing) noexcept { backing = new_backing; }
+
+    size_t bytesReserved() const noexcept {
+      size_t total = 0;
+      for (Chunk* chunk = head; chunk; chunk = chunk->next) total += chunk->size;
+      return total;
+    }
+
+  private:
+    struct alignas(std::max_align_t) Chunk {
+      Chunk* next;
+      size_t size;
+    };
+    Chunk* head = nullptr;
+    size_t used = 0;          // bytes of head in use, its header included
+    size_t chunk_bytes;
+    PageBacking backing;
+
+    size_t alignedOffset(size_t align) const noexcept {
+      const size_t base = reinterpret_cast<size_t>(head);
+      return ((base + used + align - 1) & ~(align - 1)) - base;
+    }
+    void grow(size_t min_bytes) {
+      size_t size = sizeof(Chunk) + min_bytes;
+      if (size < chunk_bytes) size = chunk_bytes;
+      if (backing == PageBacking::huge_pages) size = (size + huge_page_bytes - 1) & ~(huge_page_bytes - 1);
+      Chunk* chunk = static_cast<Chunk*>(allocatePages(size, backing));
+      chunk->next = head;
+      chunk->size = size;
+      head = chunk;
+      used = sizeof(Chunk);
+    }
+  };
+
+  // Fixed-size blocks: freed ones go on an intrusive free list and come back
+  // out first, so a pool that's churning stays the size of its peak.
+  class BlockPool {
+  public:
+    explicit BlockPool(size_t block_bytes, size_t chunk_bytes = size_t(1) << 20, PageBacking backing = PageBacking::heap) noexcept
+      : arena(chunk_bytes, backing), block_bytes(block_bytes < sizeof(FreeBlock) ? sizeof(FreeBlock) : block_bytes) {}
+
+    void* allocate() {
+      if (free_list) {
+        FreeBlock* block = free_list;
+        free_list = block->next;
+        return block;
+      }
+      return arena.allocate(block_bytes, alignof(std::max_align_t));
+    }
+    void deallocate(void* ptr) noexcept {
+      FreeBlock* block = static_cast<FreeBlock*>(ptr);
+      block->next = free_list;
+      free_list = block;
+    }
+    // every block is free again; whatever was in them isn't destroyed
+    void reset() noexcept {
+      free_list = nullptr;
+      arena.reset();
+    }
+    size_t blockBytes() const noexcept { return block_bytes; }
+    Arena& backingArena() noexcept { return arena; }
+
+  private:
+    struct FreeBlock {
+      FreeBlock* next;
+    };
+    Arena arena;
+    FreeBlock* free_list = nullptr;
+    size_t block_bytes;
+  };
+
+  // One BlockPool per 16-byte size class up to max_bytes; bigger requests go
+  // to operator new.
+  class SizeClassPools {
+  public:
+    static constexpr size_t granularity = 16, max_bytes = 1024;
+
+    SizeClassPools() : SizeClassPools(std::make_index_sequence<num_classes>()) {}
+
+    static constexpr bool pooled(size_t bytes) noexcept { return bytes <= max_bytes; }
+    void* allocate(size_t bytes) {
+      if (!pooled(bytes)) return ::operator new(bytes);
+      return pool(bytes).allocate();
+    }
+    void deallocate(void* ptr, size_t bytes) noexcept {
+      if (!pooled(bytes)) ::operator delete(ptr);
+      else pool(bytes).deallocate(ptr);
+    }
+    // for chunks allocated from now on, in every size class
+    void setBacking(PageBacking backing) noexcept {
+      for (BlockPool& p : pools) p.backingArena().setBacking(backing);
+    }
+
+  private:
+    static constexpr size_t num_classes = max_bytes / granularity;
+    BlockPool pools[num_classes];
+
+    // BlockPool has no default constructor, so each class gets its block size here
+    template <size_t... Idx>
+    explicit SizeClassPools(std::index_sequence<Idx...>) : pools{ BlockPool((Idx + 1) * granularity, size_t(64) << 10)... } {}
+    BlockPool& pool(size_t bytes) noexcept { return pools[(bytes ? bytes - 1 : 0) / granularity]; }
+  };
+
+  // This thread's pools. They're never destroyed, on purpose: a block can
+  // outlive its thread (freed by another one) or be freed by a static's
+  // destructor after this one would have run.
+  inline SizeClassPools& threadPools() {
+    thread_local SizeClassPools* pools = new SizeClassPools();
+    return *pools;
+  }
+
+  // Stateless, so every PoolAllocator compares equal and containers need no
+  // constructor arguments to use it. Blocks go back to whichever thread frees
+  // them.
+  template <class T>
+  struct PoolAllocator {
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <class U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+      if constexpr (alignof(T) > alignof(std::max_align_t)) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+      }
+      else return static_cast<T*>(threadPools().allocate(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) noexcept {
+      if constexpr (alignof(T) > alignof(std::max_align_t)) {
+        ::operator delete(ptr, std::align_val_t(alignof(T)));
+      }
+      else threadPools().deallocate(ptr, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template <class U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+  };
+}
+
+// fast-io.hpp
+namespace kel {
+  // Referee I/O without iostreams. FdReader pulls whatever's available from
+  // a file descriptor with read(2) into its buffer and parses straight out of
+  // it; FdWriter collects a turn's output and hands it to write(2) in one go
+  // when flush() is called (and once more at exit, for whatever's left).
+  // Neither allocates unless you read a std::string.
+  //
+  //   fast_in >> x >> y;                  // whitespace and newlines are skipped, no ignore() needed
+  //   std::string_view row = fast_in.readToken();
+  //   fast_out << x << ' ' << y << '\n';
+  //   fast_out.flush();                   // once per turn, instead of endl per line
+  //
+  // Don't mix these with cin/cout on the same descriptor: each side buffers
+  // what the other can't see.
+
+  class FdReader {
+  public:
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    explicit FdReader(int fd = STDIN_FILENO) noexcept : fd(fd) { buf[0] = '\0'; }
+    FdReader(const FdReader&) = delete;
+    FdReader& operator=(const FdReader&) = delete;
+
+    // true once there's nothing left but whitespace; waits for more input to
+    // find out, so it's for reading files, not for asking between turns
+    bool eof() {
+      skipSpace();
+      return pos == end;
+    }
+
+    template <class Int>
+    Int readInt() {
+      static_assert(std::is_integral<Int>::value, "readInt: not an integer type");
+      skipSpace();
+      bool negative = false;
+      if constexpr (std::is_signed<Int>::value) {
+        negative = (buf[pos] == '-');
+        pos += negative;
+      }
+      // make unsigned so overflow past the end of the number wraps harmlessly
+      using U = std::make_unsigned_t<Int>;
+      U value = 0;
+      while (true) {
+        // the '\0' sentinel at buf[end] stops the loop without a bounds check
+        unsigned digit;
+        while ((digit = unsigned(buf[pos]) - '0') < 10) {
+          value = U(value * 10 + digit);
+          ++pos;
+        }
+        if (pos < end || !refill()) break;   // a number split across two reads carries on
+      }
+      return negative ? Int(U(0) - value) : Int(value);
+    }
+    double readDouble() {
+      std::string_view token = readToken();
+      double value = 0;
+      std::from_chars(token.data(), token.data() + token.size(), value);
+      return value;
+    }
+    // the next character that isn't whitespace ('\0' at the end of input)
+    char readChar() {
+      skipSpace();
+      return (pos < end) ? buf[pos++] : '\0';
+    }
+    // The next whitespace-separated word. It points into the buffer, so it's
+    // only good until the next read.
+    std::string_view readToken() {
+      skipSpace();
+      size_t start = pos;
+      while (true) {
+        while (buf[pos] > ' ') ++pos;
+        if (pos < end) break;
+        size_t len = pos - start;
+        compact(start);
+        start = 0;
+        pos = len;
+        if (!fill()) break;
+      }
+      return std::string_view(buf + start, pos - start);
+    }
+    // The rest of the current line, without the newline (or a '\r' before
+    // it). Also only good until the next read.
+    std::string_view readLine() {
+      size_t start = pos;
+      while (true) {
+        const void* newline = std::memchr(buf + pos, '\n', end - pos);
+        if (newline) {
+          pos = static_cast<const char*>(newline) - buf;
+          break;
+        }
+        size_t len = end - start;
+        compact(start);
+        start = 0;
+        pos = len;
+        if (!fill()) break;
+      }
+      size_t stop = pos;
+      if (pos < end) ++pos;
+      if (stop > start && buf[stop - 1] == '\r') --stop;
+      return std::string_view(buf + start, stop - start);
+    }
+    void skipLine() { readLine(); }
+
+    template <class T>
+    FdReader& operator>>(T& value) {
+      if constexpr (std::is_same<T, bool>::value) value = readInt<int>() != 0;
+      else if constexpr (std::is_same<T, char>::value) value = readChar();
+      else if constexpr (std::is_integral<T>::value) value = readInt<T>();
+      else if constexpr (std::is_floating_point<T>::value) value = static_cast<T>(readDouble());
+      else if constexpr (std::is_same<T, std::string_view>::value) value = readToken();
+      else if constexpr (std::is_same<T, std::string>::value) value.assign(readToken());
+      else static_assert(!sizeof(T*), "FdReader: can't read this type");
+      return *this;
+    }
+
+  private:
+    char buf[capacity + 1];   // one more for the '\0' after the last byte read
+    size_t pos = 0, end = 0;
+    int fd;
+
+    void skipSpace() {
+      while (true) {
+        while (pos < end && buf[pos] <= ' ') ++pos;
+        if (pos < end || !refill()) return;
+      }
+    }
+    // move [from, end) to the front of the buffer
+    void compact(size_t from) noexcept {
+      std::memmove(buf, buf + from, end - from);
+      end -= from;
+      pos -= from;
+      buf[end] = '\0';
+    }
+    // everything's been used: start over at the front
+    bool refill() {
+      pos = end = 0;
+      return fill();
+    }
+    // read more after `end`; blocks until something's there, false at the end of input
+    bool fill() {
+      if (end == capacity) return false;    // a single token bigger than the buffer
+      ssize_t got;
+      do got = ::read(fd, buf + end, capacity - end);
+      while (got < 0 && errno == EINTR);
+      if (got <= 0) {
+        buf[end] = '\0';
+        return false;
+      }
+      end += size_t(got);
+      buf[end] = '\0';
+      return true;
+    }
+  };
+
+  class FdWriter {
+  public:
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    explicit FdWriter(int fd = STDOUT_FILENO) noexcept : fd(fd) {}
+    FdWriter(const FdWriter&) = delete;
+    FdWriter& operator=(const FdWriter&) = delete;
+    ~FdWriter() { flush(); }
+
+    void write(char c) {
+      if (used == capacity) flush();
+      buf[used++] = c;
+    }
+    void write(std::string_view str) {
+      if (str.size() > capacity - used) {
+        flush();
+        if (str.size() > capacity) return writeAll(str.data(), str.size());
+      }
+      std::memcpy(buf + used, str.data(), str.size());
+      used += str.size();
+    }
+    template <class T>
+    void writeNumber(T value) {
+      // 24 is enough for any integer, and for the shortest round-trip form of a double
+      if (capacity - used < 24) flush();
+      used = std::to_chars(buf + used, buf + capacity, value).ptr - buf;
+    }
+    // hand everything written so far to the descriptor
+    void flush() {
+      writeAll(buf, used);
+      used = 0;
+    }
+
+    template <class T>
+    FdWriter& operator<<(const T& value) {
+      if constexpr (std::is_same<T, char>::value) write(value);
+      else if constexpr (std::is_same<T, bool>::value) write(value ? '1' : '0');
+      else if constexpr (std::is_arithmetic<T>::value) writeNumber(value);
+      else write(std::string_view(value));
+      return *this;
+    }
+
+  private:
+    char buf[capacity];
+    size_t used = 0;
+    int fd;
+
+    void writeAll(const char* data, size_t len) {
+      while (len > 0) {
+        ssize_t put = ::write(fd, data, len);
+        if (put <= 0) return;     // nowhere to send it: the referee's gone
+        data += put;
+        len -= size_t(put);
+      }
+    }
+  };
+
+  inline FdReader fast_in(STDIN_FILENO);
+  inline FdWriter fast_out(STDOUT_FILENO);
+}
+
+// instrument.hpp
+namespace kel {
+  // Diagnostics that cost nothing unless they're switched on:
+  //   timeScope("expand");            time from here to the end of the scope (rdtsc)
+  //   countEvent("nodes popped");     add 1 to a named counter
+  //   countAdd("plies", n);           add n
+  //   histogramAdd("depth", depth);   record a value; shown in power-of-2 buckets
+  //   logInfo("best " << move);       a line of log, anything cerr can print
+  //   logDebug(...) / logError(...)   the same at the other levels
+  //   instrTurnEnd();                 once a turn, after the answer's flushed
+  // Everything is collected over the turn and written to stderr in one go by
+  // instrTurnEnd(), then reset; what's left at exit is written then. Errors
+  // are the exception: they go out straight away, in case the bot's about to
+  // die. With INSTRUMENT 0 and LOG_LEVEL 0 every macro is ((void)0), and
+  // the arguments aren't evaluated at all.
+#if INSTRUMENT || LOG_LEVEL > 0
+  namespace instr {
+    // the cycle counter where there is one, steady_clock nanoseconds otherwise
+    inline uint64_t ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    struct TimerStat {
+      const char* name;
+      uint64_t calls, ticks;
+    };
+    struct CounterStat {
+      const char* name;
+      int64_t value;
+    };
+    struct HistogramStat {
+      const char* name;
+      uint64_t samples;
+      int64_t min, max, sum;
+      uint64_t buckets[65];   // 0 for values <= 0, then n for [2^(n-1), 2^n)
+    };
+
+    class Registry {
+    public:
+      static constexpr size_t max_stats = 64;   // of each kind; more than that are dropped
+
+      Registry() : start_ticks(ticks()), start_time(std::chrono::steady_clock::now()) {}
+      ~Registry() { if (pending || hasStats()) endTurn(); }
+
+      // Looked up by name once per call site (see the macros), so several
+      // sites with the same name add up.
+      TimerStat& timer(const char* name) noexcept { return find(timers, num_timers, name); }
+      CounterStat& counter(const char* name) noexcept { return find(counters, num_counters, name); }
+      HistogramStat& histogram(const char* name) noexcept {
+        HistogramStat& stat = find(histograms, num_histograms, name);
+        if (stat.samples == 0) resetHistogram(stat);
+        return stat;
+      }
+      void add(HistogramStat& stat, int64_t value) noexcept {
+        if (value < stat.min) stat.min = value;
+        if (value > stat.max) stat.max = value;
+        stat.sum += value;
+        ++stat.samples;
+        ++stat.buckets[(value <= 0) ? 0 : 64 - __builtin_clzll(uint64_t(value))];
+      }
+
+      std::ostream& log() noexcept {
+        pending = true;
+        return log_lines;
+      }
+      void logNow(const std::string& line) noexcept { writeAll(line.data(), line.size()); }
+
+      void endTurn() {
+        if (!pending && !hasStats()) {
+          ++turn;
+          return;
+        }
+        std::ostringstream out;
+        out << "-- turn " << turn++ << " --\n" << log_lines.str();
+        const double ticks_per_us = ticksPerMicro();
+        out << std::fixed << std::setprecision(2);
+        for (size_t idx = 0; idx < num_timers; ++idx) {
+          TimerStat& stat = timers[idx];
+          if (stat.calls == 0) continue;
+          const double total_us = stat.ticks / ticks_per_us;
+          out << "time  " << std::left << std::setw(24) << stat.name << std::right
+              << std::setw(10) << stat.calls << " calls " << std::setw(12) << total_us << " us "
+              << std::setw(10) << total_us / stat.calls << " us/call\n";
+          stat.calls = stat.ticks = 0;
+        }
+        for (size_t idx = 0; idx < num_counters; ++idx) {
+          CounterStat& stat = counters[idx];
+          if (stat.value == 0) continue;
+          out << "count " << std::left << std::setw(24) << stat.name << std::right << std::setw(10) << stat.value << '\n';
+          stat.value = 0;
+        }
+        for (size_t idx = 0; idx < num_histograms; ++idx) {
+          HistogramStat& stat = histograms[idx];
+          if (stat.samples == 0) continue;
+          out << "hist  " << std::left << std::setw(24) << stat.name << std::right
+              << " n " << stat.samples << ", min " << stat.min << ", mean " << double(stat.sum) / stat.samples
+              << ", max " << stat.max << "\n     ";
+          for (int bucket = 0; bucket < 65; ++bucket) {
+            if (stat.buckets[bucket] == 0) continue;
+            if (bucket == 0) out << " <=0:";
+            else if (bucket == 1) out << " 1:";
+            else out << ' ' << (uint64_t(1) << (bucket - 1)) << '-' << (uint64_t(1) << bucket) - 1 << ':';
+            out << stat.buckets[bucket];
+          }
+          out << '\n';
+          resetHistogram(stat);
+        }
+        const std::string text = out.str();
+        writeAll(text.data(), text.size());
+        log_lines.str(std::string());
+        pending = false;
+      }
+
+    private:
+      TimerStat timers[max_stats] = {};
+      CounterStat counters[max_stats] = {};
+      HistogramStat histograms[max_stats] = {};
+      size_t num_timers = 0, num_counters = 0, num_histograms = 0;
+      std::ostringstream log_lines;
+      int turn = 0;
+      bool pending = false;
+      uint64_t start_ticks;
+      std::chrono::steady_clock::time_point start_time;
+
+      bool hasStats() const noexcept {
+        for (size_t idx = 0; idx < num_timers; ++idx) if (timers[idx].calls) return true;
+        for (size_t idx = 0; idx < num_counters; ++idx) if (counters[idx].value) return true;
+        for (size_t idx = 0; idx < num_histograms; ++idx) if (histograms[idx].samples) return true;
+        return false;
+      }
+      template <class Stat>
+      Stat& find(Stat (&stats)[max_stats], size_t& count, const char* name) noexcept {
+        for (size_t idx = 0; idx < count; ++idx) {
+          if (std::strcmp(stats[idx].name, name) == 0) return stats[idx];
+        }
+        if (count == max_stats) {
+          static Stat overflow;   // counted, but never shown
+          return overflow;
+        }
+        stats[count].name = name;
+        return stats[count++];
+      }
+      static void resetHistogram(HistogramStat& stat) noexcept {
+        const char* name = stat.name;
+        stat = HistogramStat();
+        stat.name = name;
+        stat.min = INT64_MAX;
+        stat.max = INT64_MIN;
+      }
+      // calibrated against steady_clock over everything since startup
+      double ticksPerMicro() const noexcept {
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+        return (us > 0) ? (ticks() - start_ticks) / us : 1.0;
+      }
+      static void writeAll(const char* data, size_t len) noexcept {
+        while (len > 0) {
+          ssize_t put = ::write(STDERR_FILENO, data, len);
+          if (put <= 0) return;
+          data += put;
+          len -= size_t(put);
+        }
+      }
+    };
+
+    inline Registry& registry() {
+      static Registry reg;
+      return reg;
+    }
+
+    class ScopedTimer {
+    public:
+      explicit ScopedTimer(TimerStat& stat) noexcept : stat(stat), start(ticks()) {}
+      ~ScopedTimer() {
+        stat.ticks += ticks() - start;
+        ++stat.calls;
+      }
+    private:
+      TimerStat& stat;
+      uint64_t start;
+    };
+  }
+#endif
+
+#define _instrCat2(a, b) a##b
+#define _instrCat(a, b) _instrCat2(a, b)
+#define _instrSite(kind, name)                                                 \
+  static auto& _instrCat(_instr_stat_, __LINE__) = ::kel::instr::registry().kind(name)
+
+#if INSTRUMENT
+#define timeScope(name)                                                        \
+  _instrSite(timer, name);                                                     \
+  ::kel::instr::ScopedTimer _instrCat(_instr_timer_, __LINE__)(_instrCat(_instr_stat_, __LINE__))
+#define countAdd(name, n)                                                      \
+  do {                                                                         \
+    _instrSite(counter, name);                                                 \
+    _instrCat(_instr_stat_, __LINE__).value += (n);                            \
+  } while (0)
+#define countEvent(name) countAdd(name, 1)
+#define histogramAdd(name, value)                                              \
+  do {                                                                         \
+    _instrSite(histogram, name);                                               \
+    ::kel::instr::registry().add(_instrCat(_instr_stat_, __LINE__), (value));  \
+  } while (0)
+#else
+#define timeScope(name) ((void)0)
+#define countAdd(name, n) ((void)0)
+#define countEvent(name) ((void)0)
+#define histogramAdd(name, value) ((void)0)
+#endif
+
+#if LOG_LEVEL >= 1
+#define logError(...)                                                          \
+  do {                                                                         \
+    std::ostringstream _instr_line;                                            \
+    _instr_line << "error: " << __VA_ARGS__ << '\n';                           \
+    ::kel::instr::registry().logNow(_instr_line.str());                        \
+  } while (0)
+#else
+#define logError(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 2
+#define logInfo(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logInfo(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 3
+#define logDebug(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logDebug(...) ((void)0)
+#endif
+
+#if INSTRUMENT || LOG_LEVEL >= 2
+#define instrTurnEnd() ::kel::instr::registry().endTurn()
+#else
+#define instrTurnEnd() ((void)0)
+#endif
 }
 
 // lookup-tables.hpp
 namespace kel {
 #define rtype(fn) decltype(fn::eval(std::declval<size_t>()))
-#define rtype2d(fn) decltype(fn::eval(std::declval<size_t>(), std::declval<size_t>()))
 
-  template <class GenFn, size_t N, size_t... Indexes>
-  static constexpr std::array<rtype(GenFn), N> 
-    _makeLookupTable(std::index_sequence<Indexes...>) noexcept {
-    constexpr std::array<rtype(GenFn), N> table{{GenFn::eval(Indexes)...}};
+  // Tables are filled by plain constexpr loops instead of expanding an
+  // index_sequence into one initializer with an element per entry. GCC gives
+  // every constant expression a budget (-fconstexpr-loop-limit,
+  // -fconstexpr-ops-limit), so tables up to lut_flat_max entries are filled in
+  // one go into a flat std::array, and bigger ones are split into chunks of
+  // lut_chunk entries that each get their own budget.
+  constexpr size_t lut_chunk = 1 << 12;
+  constexpr size_t lut_flat_max = 1 << 16;
+
+  // not constexpr on purpose: reaching it while filling a table is a compile error
+  inline void lookupValueDoesntFitElementType() noexcept {}
+
+  // A plain array with just enough of std::array's interface. Indexing is a
+  // builtin subscript rather than a call to std::array::operator[], which
+  // matters when tables are built out of other tables at compile time.
+  template <class T, size_t N>
+  struct LookupTable {
+    T values[N];
+
+    constexpr const T& operator[](size_t idx) const noexcept { return values[idx]; }
+    static constexpr size_t size() noexcept { return N; }
+    constexpr const T* begin() const noexcept { return values; }
+    constexpr const T* end() const noexcept { return values + N; }
+  };
+
+  // entries [Begin, min(Begin + Len, N)) of the table, as T
+  template <class T, class GenFn, size_t N, size_t Begin, size_t Len>
+  static constexpr LookupTable<T, Len> fillLutChunk() noexcept {
+    constexpr size_t end = std::min(Len, N - Begin);
+    LookupTable<T, Len> chunk{};
+    for (size_t start = 0; start < end; start += lut_chunk) {
+      const size_t stop = std::min(end, start + lut_chunk);
+      for (size_t idx = start; idx < stop; ++idx) {
+        const auto value = GenFn::eval(Begin + idx);
+        chunk.values[idx] = static_cast<T>(value);
+        if constexpr (!std::is_same_v<T, std::remove_const_t<decltype(value)>>) {
+          if (static_cast<decltype(value)>(chunk.values[idx]) != value) lookupValueDoesntFitElementType();
+        }
+      }
+    }
+    return chunk;
+  }
+
+  // a table too big to fill flat; indexing costs a shift and a mask more
+  template <class T, size_t N>
+  struct ChunkedLookupTable {
+    static constexpr size_t num_chunks = (N + lut_chunk - 1) / lut_chunk;
+    LookupTable<T, lut_chunk> chunks[num_chunks];
+
+    constexpr const T& operator[](size_t idx) const noexcept {
+      return chunks[idx / lut_chunk].values[idx % lut_chunk];
+    }
+    static constexpr size_t size() noexcept { return N; }
+  };
+  template <class T, class GenFn, size_t N, size_t... Chunks>
+  static constexpr ChunkedLookupTable<T, N> fillChunkedLookupTable(std::index_sequence<Chunks...>) noexcept {
+    return {{ fillLutChunk<T, GenFn, N, Chunks * lut_chunk, lut_chunk>()... }};
+  }
+
+  template <class T, class GenFn, size_t N>
+  static constexpr auto fillLookupTable() noexcept {
+    if constexpr (N <= lut_flat_max) return fillLutChunk<T, GenFn, N, 0, N>();
+    else return fillChunkedLookupTable<T, GenFn, N>(
+      std::make_index_sequence<ChunkedLookupTable<T, N>::num_chunks>{});
+  }
+  template <class GenFn, size_t N>
+  static constexpr auto makeLookupTable() noexcept {
+    return fillLookupTable<rtype(GenFn), GenFn, N>();
+  }
+  // Booleans (or small enums) packed Bits to an entry into u64 words, so a
+  // table of 2^18 flags is 32 KB instead of 256 KB. Bits has to divide 64, and
+  // every value has to survive being cut down to Bits bits.
+  template <class T, size_t Bits, size_t N>
+  struct BitLookupTable {
+    static_assert(Bits > 0 && 64 % Bits == 0, "BitLookupTable: Bits has to divide 64");
+    static constexpr size_t per_word = 64 / Bits;
+    static constexpr size_t num_words = (N + per_word - 1) / per_word;
+    static constexpr uint64_t mask = (Bits == 64) ? ~uint64_t(0) : (uint64_t(1) << (Bits % 64)) - 1;
+    LookupTable<uint64_t, num_words> words;
+
+    constexpr T operator[](size_t idx) const noexcept {
+      return static_cast<T>((words.values[idx / per_word] >> (idx % per_word * Bits)) & mask);
+    }
+    static constexpr size_t size() noexcept { return N; }
+  };
+
+  // words [Begin, Begin + Len) of a BitLookupTable
+  template <class Table, class GenFn, size_t Begin, size_t Len>
+  static constexpr LookupTable<uint64_t, Len> fillLutWords() noexcept {
+    constexpr size_t bits = 64 / Table::per_word;
+    LookupTable<uint64_t, Len> words{};
+    for (size_t word = 0; word < Len; ++word) {
+      for (size_t slot = 0; slot < Table::per_word; ++slot) {
+        const size_t idx = (Begin + word) * Table::per_word + slot;
+        if (idx >= Table::size()) break;
+        const auto value = GenFn::eval(idx);
+        const uint64_t packed = static_cast<uint64_t>(value) & Table::mask;
+        if (static_cast<decltype(value)>(packed) != value) lookupValueDoesntFitElementType();
+        words.values[word] |= packed << (slot * bits);
+      }
+    }
+    return words;
+  }
+  // Big tables are filled lut_chunk entries per constant expression like
+  // above, but the words are small enough to copy into one flat array after.
+  template <class Table, class GenFn, size_t... Chunks>
+  static constexpr Table fillBitLookupTable(std::index_sequence<Chunks...>) noexcept {
+    constexpr size_t chunk_words = lut_chunk / Table::per_word;
+    const LookupTable<uint64_t, chunk_words> chunks[] = {
+      fillLutWords<Table, GenFn, Chunks * chunk_words, chunk_words>()... };
+    Table table{};
+    for (size_t word = 0; word < Table::num_words; ++word) {
+      table.words.values[word] = chunks[word / chunk_words].values[word % chunk_words];
+    }
     return table;
   }
-  template <class GenFn, size_t N, size_t... Indexes>
-  static constexpr std::array<rtype(GenFn), N> makeLookupTable() noexcept {
-    return _makeLookupTable<GenFn, N>(std::make_index_sequence<N>{});
+  template <size_t Bits, class GenFn, size_t N>
+  static constexpr auto makeBitLookupTable() noexcept {
+    using Table = BitLookupTable<rtype(GenFn), Bits, N>;
+    if constexpr (N <= lut_flat_max) return Table{ fillLutWords<Table, GenFn, 0, Table::num_words>() };
+    else return fillBitLookupTable<Table, GenFn>(
+      std::make_index_sequence<(N + lut_chunk - 1) / lut_chunk>{});
   }
 
+  // Where a table lives. A 512-entry table sits in L1 and beats computing
+  // anything, while a 256 KB one can lose to a few ALU ops once a search tree
+  // is fighting it for cache, so this is picked per table (see
+  // tools/lut-policy-bench.cpp):
+  //   compile_time  constexpr table baked into the binary
+  //   startup       the same table, filled by a plain loop during static
+  //                 initialization; costs startup time instead of compile time
+  //                 and binary size. Tables are filled in declaration order, so
+  //                 a startup table may use the tables declared above it, but
+  //                 a compile_time table can't use a startup one.
+  //   compute       no table, every lookup calls the generator
+  enum class LutPolicy { compile_time, startup, compute };
+
+  template <class GenFn, size_t N>
+  struct ComputedLookupTable {
+    constexpr auto operator[](size_t idx) const noexcept { return GenFn::eval(idx); }
+    static constexpr size_t size() noexcept { return N; }
+  };
+
+  // not constexpr, so that a startup table really is filled at runtime
+  template <size_t Bits, class GenFn, size_t N>
+  static auto buildLookupTable() noexcept {
+    if constexpr (Bits == 0) {
+      LookupTable<rtype(GenFn), N> table{};
+      for (size_t idx = 0; idx < N; ++idx) table.values[idx] = GenFn::eval(idx);
+      return table;
+    } else {
+      using Table = BitLookupTable<rtype(GenFn), Bits, N>;
+      Table table{};
+      for (size_t idx = 0; idx < N; ++idx) {
+        const uint64_t packed = static_cast<uint64_t>(GenFn::eval(idx)) & Table::mask;
+        table.words.values[idx / Table::per_word] |= packed << (idx % Table::per_word * Bits);
+      }
+      return table;
+    }
+  }
 
-#if USE_LOOKUP
-#define for_lookup static constexpr
-#define genLookupTable(gen_fn, size)                                           \
+  // Bits == 0 stores whole values, anything else packs them like BitLookupTable
+  template <LutPolicy Policy, size_t Bits, class GenFn, size_t N>
+  static constexpr auto makeLookupTableWith() noexcept {
+    if constexpr (Policy == LutPolicy::compute) return ComputedLookupTable<GenFn, N>{};
+    else if constexpr (Policy == LutPolicy::startup) return buildLookupTable<Bits, GenFn, N>();
+    else if constexpr (Bits == 0) return makeLookupTable<GenFn, N>();
+    else return makeBitLookupTable<Bits, GenFn, N>();
+  }
+
+  // genLookupTableWith(policy, ...) and friends take one of the LutPolicy
+  // names as their first argument (a macro that expands to one works too);
+  // the versions without "With" are compile_time.
+#define lut_compile_time constexpr
+#define lut_startup const
+#define lut_compute constexpr
+#define _lutDeclare(policy, gen_fn, bits, size)                                \
+  lut_##policy auto lut_##gen_fn =                                             \
+    kel::makeLookupTableWith<kel::LutPolicy::policy, bits, gen_##gen_fn, size>()
+
+#define genLookupTableWith(policy, gen_fn, size)                               \
   struct gen_##gen_fn                                                          \
   {                                                                            \
     static constexpr auto eval(size_t input) noexcept                          \
@@ -69,17 +1424,11 @@ namespace kel {
       return gen_fn(input);                                                    \
     }                                                                          \
   };                                                                           \
-  constexpr auto lut_##gen_fn = kel::makeLookupTable<gen_##gen_fn, size>()
+  _lutDeclare(policy, gen_fn, 0, size)
+#define genLookupTable(gen_fn, size) genLookupTableWith(compile_time, gen_fn, size)
 #define lookup(gen_fn, index) (lut_##gen_fn[index])
-#else
-#define for_lookup inline
-#define genLookupTable(gen_fn, size)
-#define lookup(gen_fn, index) (gen_fn(index)))
-#endif
 
-#if USE_2D_LOOKUP
-#define for_lookup2d static constexpr
-#define genLookupTable2d(gen_fn, width, height)                                \
+#define genLookupTable2dWith(policy, gen_fn, width, height)                    \
   struct gen_##gen_fn                                                          \
   {                                                                            \
     static constexpr size_t w = width;                                         \
@@ -88,22 +1437,51 @@ namespace kel {
       return gen_fn(input % w, input / w);                                     \
     }                                                                          \
   };                                                                           \
-  constexpr auto lut_##gen_fn =                                                \
-    kel::makeLookupTable<gen_##gen_fn, width * height>()
+  _lutDeclare(policy, gen_fn, 0, width * height)
+#define genLookupTable2d(gen_fn, width, height)                                \
+  genLookupTable2dWith(compile_time, gen_fn, width, height)
 #define lookup2d(gen_fn, x, y) (lut_##gen_fn[x + gen_##gen_fn::w * y])
-#else
-#define for_lookup2d inline
-#define genLookupTable2d(gen_fn, width, height) void _____null()
-#define lookup2d(gen_fn, x, y) (gen_fn(x, y))
-#endif
+
+  // packed tables: genLookupTableBits(fn, 1, size) for a bool per bit
+#define genLookupTableBitsWith(policy, gen_fn, bits, size)                     \
+  struct gen_##gen_fn                                                          \
+  {                                                                            \
+    static constexpr auto eval(size_t input) noexcept                          \
+    {                                                                          \
+      return gen_fn(input);                                                    \
+    }                                                                          \
+  };                                                                           \
+  _lutDeclare(policy, gen_fn, bits, size)
+#define genLookupTableBits(gen_fn, bits, size)                                 \
+  genLookupTableBitsWith(compile_time, gen_fn, bits, size)
+#define lookupBit(gen_fn, index) (lut_##gen_fn[index])
+
+#define genLookupTableBits2dWith(policy, gen_fn, bits, width, height)          \
+  struct gen_##gen_fn                                                          \
+  {                                                                            \
+    static constexpr size_t w = width;                                         \
+    static constexpr auto eval(size_t input) noexcept                          \
+    {                                                                          \
+      return gen_fn(input % w, input / w);                                     \
+    }                                                                          \
+  };                                                                           \
+  _lutDeclare(policy, gen_fn, bits, width * height)
+#define genLookupTableBits2d(gen_fn, bits, width, height)                      \
+  genLookupTableBits2dWith(compile_time, gen_fn, bits, width, height)
+#define lookupBit2d(gen_fn, x, y) (lut_##gen_fn[x + gen_##gen_fn::w * y])
 
 #undef rtype
-#undef rtype2d
 }
 
 using namespace kel;
 using namespace std;
 
+#if TELEMETRY
+#define telemetry(...) do { __VA_ARGS__; } while (0)
+#else
+#define telemetry(...) do {} while (0)
+#endif
+
 using chrono::high_resolution_clock, chrono::milliseconds, chrono::steady_clock;
 using time_point = chrono::time_point<steady_clock>;
 
@@ -156,8 +1534,8 @@ enum Square : bb {
   bottom_right = localXyToBB(2, 2),
 };
 enum Row : bb {
-  diag_slash = top_left | center | bottom_right, // /
-  diag_back = top_right | center | bottom_left,  // \
+  diag_slash = top_left | center | bottom_right, // / diagonal
+  diag_back = top_right | center | bottom_left,  // \ diagonal
 
   col_left = top_left | middle_left | bottom_left,
   col_middle = top_middle | center | bottom_middle,
@@ -176,39 +1554,7 @@ enum WinState : char {
   invalid = '*'
 };
 
-enum EasyWin : char {
-  easy_x = 'X', easy_o = 'O', not_easy = ' '
-};
-
-for_lookup int popcnt(size_t mask) noexcept {
-#if USE_LOOKUP
-  int count = 0;
-  while (mask)   {
-    ++count;
-    mask &= mask - 1; // reset the LS1B
-  }
-  return count;
-#else
-  return __builtin_popcntll(mask);
-#endif
-}
-genLookupTable(popcnt, pow2(9));
-for_lookup int bsf(size_t mask) noexcept {
-  if (!mask) return -1;
-#if USE_LOOKUP
-  int count = 0;
-  while ((mask & 1) == 0) { // check if LSB is set
-    ++count;
-    mask /= 2; // right shift
-  }
-  return count;
-#else
-  return __builtin_ctzll(mask);
-#endif
-}
-genLookupTable(bsf, pow2(9));
-
-for_lookup bool isWon(size_t board) noexcept {
+static constexpr bool isWon(size_t board) noexcept {
 #define ALL_SET(mask) ((board & mask) == mask)
   return (
        ALL_SET(diag_slash)
@@ -221,54 +1567,46 @@ for_lookup bool isWon(size_t board) noexcept {
     || ALL_SET(row_bottom));
 #undef ALL_SET
 }
-genLookupTable(isWon, pow2(9));
+genLookupTableBitsWith(IS_WON_LUT, isWon, 1, pow2(9));
 
-for_lookup2d EasyWin easyWin(size_t x_b, size_t o_b) noexcept {
-#define ALMOST_X(mask) (popcnt(x_b & mask & ~o_b) == 1)
-#define ALMOST_O(mask) (popcnt(x_b & mask & ~o_b) == 1)
-  return (
-       ALMOST_X(diag_slash)
-    || ALMOST_X(diag_back)
-    || ALMOST_X(col_left)
-    || ALMOST_X(col_middle)
-    || ALMOST_X(col_right)
-    || ALMOST_X(row_top)
-    || ALMOST_X(row_middle)
-    || ALMOST_X(row_bottom)
-       ) ? easy_x : ((
-       ALMOST_O(diag_slash)
-    || ALMOST_O(diag_back)
-    || ALMOST_O(col_left)
-    || ALMOST_O(col_middle)
-    || ALMOST_O(col_right)
-    || ALMOST_O(row_top)
-    || ALMOST_O(row_middle)
-    || ALMOST_O(row_bottom)
-       ) ? easy_o : not_easy);
-#undef ALMOST_X
-#undef ALMOST_O
+// squares that would complete a row for whoever owns `board`
+// (the caller still has to mask out squares the opponent has taken)
+static constexpr bb winningSquares(size_t board) noexcept {
+  bb squares = 0;
+  for (int idx = 0; idx < 9; ++idx) {
+    if (!(board & localIdxToBB(idx)) && isWon(board | localIdxToBB(idx))) {
+      squares |= localIdxToBB(idx);
+    }
+  }
+  return squares;
 }
-genLookupTable2d(easyWin, pow2(9), pow2(9));
-for_lookup2d WinState winState(size_t x_b, size_t o_b) noexcept {
+genLookupTableWith(WINNING_SQUARES_LUT, winningSquares, pow2(9));
+static_assert(LutPolicy::WIN_STATE_LUT != LutPolicy::compile_time || LutPolicy::IS_WON_LUT != LutPolicy::startup,
+  "WIN_STATE_LUT compile_time reads the IS_WON_LUT table: make that compile_time or compute");
+static constexpr WinState winState(size_t x_b, size_t o_b) noexcept {
   if (x_b & o_b) return invalid;
-  else if (lookup(isWon, x_b)) return x_won;
-  else if (lookup(isWon, o_b)) return o_won;
-  else if (lookup(popcnt, (x_b | o_b) & ones(9)) == 9) return draw;
+  else if (lookupBit(isWon, x_b)) return x_won;
+  else if (lookupBit(isWon, o_b)) return o_won;
+  else if (popcount((x_b | o_b) & ones(9)) == 9) return draw;
   else return ongoing;
 }
-genLookupTable2d(winState, pow2(9), pow2(9));
-for_lookup2d bool isOngoing(size_t x_b, size_t o_b) noexcept {
+genLookupTable2dWith(WIN_STATE_LUT, winState, pow2(9), pow2(9));
+static_assert(LutPolicy::IS_ONGOING_LUT != LutPolicy::compile_time || LutPolicy::WIN_STATE_LUT != LutPolicy::startup,
+  "IS_ONGOING_LUT compile_time reads the WIN_STATE_LUT table: make that compile_time or compute");
+static_assert(LutPolicy::IS_TERMINAL_LUT != LutPolicy::compile_time || LutPolicy::WIN_STATE_LUT != LutPolicy::startup,
+  "IS_TERMINAL_LUT compile_time reads the WIN_STATE_LUT table: make that compile_time or compute");
+static constexpr bool isOngoing(size_t x_b, size_t o_b) noexcept {
   WinState w = lookup2d(winState, x_b, o_b);
   return w == ongoing && w != invalid;
 }
-genLookupTable2d(isOngoing, pow2(9), pow2(9));
-for_lookup2d bool isTerminal(size_t x_b, size_t o_b) noexcept {
+genLookupTableBits2dWith(IS_ONGOING_LUT, isOngoing, 1, pow2(9), pow2(9));
+static constexpr bool isTerminal(size_t x_b, size_t o_b) noexcept {
   WinState w = lookup2d(winState, x_b, o_b);
   return w != ongoing;
 }
-genLookupTable2d(isTerminal, pow2(9), pow2(9));
+genLookupTableBits2dWith(IS_TERMINAL_LUT, isTerminal, 1, pow2(9), pow2(9));
 
-using MoveVector = vector<int>;
+using MoveVector = static_vector<int, 81>;
 
 struct Board {
   bb x_board = 0, o_board = 0;
@@ -303,47 +1641,58 @@ public:
   void getMoves(MoveVector& moves) const {
     moves.clear();
     if (next != -1
-      && !lookup2d(isTerminal, locals[next].x_board, locals[next].o_board)) {
-      bb empty = ~(locals[next].x_board | locals[next].o_board);
-      empty &= ones(9);
-      do {
-        moves.push_back(localIdxToGlobalIdx_idx(lookup(bsf, empty), next));
-      } while (clearLS1B(empty));
+      && !lookupBit2d(isTerminal, locals[next].x_board, locals[next].o_board)) {
+      for (int idx : setBits(emptySquares(next))) {
+        moves.push_back(localIdxToGlobalIdx_idx(idx, next));
+      }
     }
     else {
-      Board global = getGlobal();
-      bb open_locals = ~(global.x_board | global.o_board) & ones(9);
-      if (open_locals) do {
-        int local_idx = lookup(bsf, open_locals);
-        bb empty = ~(locals[local_idx].x_board | locals[local_idx].o_board);
-        empty &= ones(9);
-        if (empty) do {
-          moves.push_back(localIdxToGlobalIdx_idx(lookup(bsf, empty), local_idx));
-        } while (clearLS1B(empty));
-      } while (clearLS1B(open_locals));
+      for (int local_idx : setBits(openLocals())) {
+        for (int idx : setBits(emptySquares(local_idx))) {
+          moves.push_back(localIdxToGlobalIdx_idx(idx, local_idx));
+        }
+      }
     }
   }
   int getNumMoves() const {
     if (next != -1
-      && !lookup2d(isTerminal, locals[next].x_board, locals[next].o_board)) {
-      return lookup(popcnt, ~(locals[next].x_board | locals[next].o_board) & ones(9));
+      && !lookupBit2d(isTerminal, locals[next].x_board, locals[next].o_board)) {
+      return popcount(emptySquares(next));
     }
     else {
-      Board global = getGlobal();
-      bb open_locals = ~(global.x_board | global.o_board) & ones(9);
       int num_moves = 0;
-      if (open_locals) do {
-        int local_idx = lookup(bsf, open_locals);
-        bb empty = ~(locals[local_idx].x_board | locals[local_idx].o_board) & ones(9);
-        num_moves += lookup(popcnt, empty);
-      } while (clearLS1B(open_locals));
+      for (int local_idx : setBits(openLocals())) num_moves += popcount(emptySquares(local_idx));
       return num_moves;
     }
   }
+  // what getMoves() would put at index `n`, without building the list
+  int getMove(int n) const {
+    if (next != -1
+      && !lookupBit2d(isTerminal, locals[next].x_board, locals[next].o_board)) {
+      return localIdxToGlobalIdx_idx(selectBit(emptySquares(next), n), next);
+    }
+    else {
+      for (int local_idx : setBits(openLocals())) {
+        bb empty = emptySquares(local_idx);
+        int count = popcount(empty);
+        if (n < count) return localIdxToGlobalIdx_idx(selectBit(empty, n), local_idx);
+        n -= count;
+      }
+      return -1;
+    }
+  }
+  bb emptySquares(int local_idx) const {
+    return ~(locals[local_idx].x_board | locals[local_idx].o_board) & ones(9);
+  }
+  // locals that nobody has won or drawn yet
+  bb openLocals() const {
+    Board global = getGlobal();
+    return ~(global.x_board | global.o_board) & ones(9);
+  }
   UltimateBoard& mark(int idx, int idx_of_local) {
     if (x_turn) locals[idx_of_local].x_board |= localIdxToBB(idx);
     else locals[idx_of_local].o_board |= localIdxToBB(idx);
-    next = (lookup2d(isTerminal, locals[idx].x_board, locals[idx].o_board))
+    next = (lookupBit2d(isTerminal, locals[idx].x_board, locals[idx].o_board))
       ? -1
       : idx;
     x_turn = !x_turn;
@@ -366,230 +1715,293 @@ public:
 
   struct hash {
     u64 operator()(const UltimateBoard& board) const noexcept {
-      constexpr static u64 z_x_board[pow2(9)] = {
-        0x276d46ec5066757c, 0x1ef454d54d15ba47, 0x2f2511163182666c, 0xe37e57d41d06f7fa,
-        0x5de1b7290c214e6e, 0x115008f6bd7cd864, 0x27a65d7f3db8ebf9, 0x252e75a46548a419,
-        0xa3a6f83b02597c05, 0x3c5a843ae8edcaf6, 0xa6601f21ce83d29a, 0x66d5c68d7d599608,
-        0x21b67ad9e0032637, 0xa5a222b8cfe650fe, 0x27e08bb900a5f5dd, 0xf7eaff077787db15,
-        0x1f307558cbcee970, 0xaf7703370debddb8, 0x8917f604609b2b42, 0x93a4e5a1c19b1ccd,
-        0x52ae4cd64347cea6, 0x979d4f7c544ea323, 0xabdddc0928bf9305, 0x936c57e27a8264cd,
-        0xa251d66785af44ac, 0x7243a6e1bc146ccf, 0x1534ec04cbb9a288, 0x536852f5c4eb33b2,
-        0xb8dce39650ad6dc1, 0xf0e0a4dd7e2217ed, 0x074c3e57e364890c, 0xc8706ef600241439,
-        0xf36bbf693def35ed, 0x60194f27643303a5, 0xd104177ff3649f4e, 0xdad52c6d2e487eaf,
-        0xe2d6245085d235df, 0x7023d0f723117169, 0x26096eabf743983c, 0xefa56ad0257ae486,
-        0xa02854bcfef6e0c3, 0xf79cf204b6ce83f9, 0x33554ac93634edea, 0x07ca57a187688dff,
-        0xfcc9aa9a0086b00f, 0x5c7ceeb2e68637da, 0x335cca98d8b16af2, 0x933c1067566af73d,
-        0x8061d266fddeed80, 0xffefb5678414486e, 0x384354b5b27e6d2e, 0xff5340c44f645bd0,
-        0x5ef7952fdbaaa9da, 0xc913a5c169be50dd, 0x0ca693033d375990, 0x2d1d6cd15d469b86,
-        0xc60a92b267760991, 0x53e53e43041c9b79, 0x8929c6a8ecc275a2, 0xd7f9282586fa8b66,
-        0x81ab9eb39b05ecfb, 0x873288acdf294575, 0x9ae3d056676c931d, 0x38ce3a42b983231e,
-        0x5ddff7237f2f0c61, 0x949a3ac905e8f9ab, 0xcd78a21158dede4a, 0x1e9b4cf67bddc51e,
-        0xfc0041bdbeda140c, 0x32afc70348dcf1ba, 0x31f6722a12678a99, 0xa25a7f8fb64f9e0c,
-        0x63c4119bbb40b9d6, 0x847c0ad0d75bcb1e, 0xbe893385ced51e70, 0x743d4b48ecd23beb,
-        0xfb1f7c66d551e2bd, 0xcb431f777c637b70, 0x260205c114245d33, 0xaed7975dce0c5e71,
-        0x3933e0a88a7a783b, 0xe3501334609ef553, 0xabf167ed49d4fab9, 0x5a147fa56bc169a3,
-        0x092324d4f831285f, 0x75ede03ae7199cb4, 0x27323e6b36f81a44, 0xa16aa692f9709d47,
-        0x2a7125618fda845b, 0x9f08dde81d79a5af, 0x5542474db7da3f95, 0x04afe8657f2e475f,
-        0x552227ea15c94481, 0x53f5c792a1b4019d, 0xb2e1b3081b6db5cb, 0x88b39e2c0bead770,
-        0xbd4cc6e4b2572b5b, 0x2209eba2ac275392, 0x21f9c18208695e01, 0x5a096b5031549880,
-        0x6c561a169b04cd79, 0xaf2b0e674cab00e3, 0xf9d0de283b966ca6, 0x0473038d49e4ad6f,
-        0x578df09a59458988, 0x2d78a837669d9f48, 0x4e4d05445417f0b0, 0xc12d89d273570009,
-        0xda0eae94732abf1b, 0xa460701dc5459289, 0x8542467209717049, 0x228d9b5aebba16bd,
-        0xd987eedd06d6784a, 0x56f33942e3b025b3, 0x3a247e484e27eed1, 0xf9404885096e4aa6,
-        0xf046af36e9e8ee01, 0xeff4a2ead5532be8, 0x65e83e7f162203e4, 0x6d50041b3213b7c8,
-        0x03125c271a22beb8, 0x9c91fc0ebde03926, 0x03d266353e002773, 0x2ed1df28db06e2dc,
-        0xb4f831ac21a4e59b, 0x11f60960b87bc28b, 0x5069ed2fda880f4e, 0x9a28fbced7ace68e,
-        0x055961b14e6ef4ef, 0xe8c92e765825032a, 0x6205043b9e647c7b, 0xdcfe9cdb987bbbeb,
-        0xc56f33ad279a8037, 0x91860a56b992a91e, 0x25ef433d58c9c5ad, 0xc2f3bc9d061639d3,
-        0x1c05b548dfa97cac, 0x424564e8c0a6799f, 0x2c5b00d53678838e, 0x48bfb86066f90c43,
-        0xe37c671ae78c26ce, 0x958f57e94d0c9b5d, 0xfb9c4a1db32df4a0, 0x8fecd9db2f45cbce,
-        0x8bafbcd54890b448, 0xadaac9cec8586169, 0x3b072d72a691d38f, 0xe5419ef8404b256e,
-        0x27baa30b28287c91, 0x2bcf0a4048911e5b, 0x1a44d4358c62668b, 0x05d00f316f0d74bb,
-        0x34b865c43da28e64, 0xab3199dcc9a5e071, 0x23a3467ac6c9d310, 0x3a3a5888236ba273,
-        0x97b84ac427eb9093, 0xa4eaa214d9e02896, 0x708396c641f4f520, 0xc559b9dead28462f,
-        0xaaaadee0979fe5c2, 0xe9465e544c10a91b, 0xe8eeee4227d539ed, 0xfb9ab8c044cb1adb,
-        0x6ce81f2faa9138b5, 0x8f3bb22b2d982d27, 0x8be7f93c7e4ecb47, 0x2c0f22e334a7f440,
-        0xa00ecd758f6273e8, 0x33f6d24823d72ada, 0xcfbe76a2090d7bb3, 0xe5822d57b1ff1c73,
-        0x72868b5db374a8d1, 0xd341d4b3e9e83376, 0x7d24f52bd6d478d8, 0x38a8054e7ff3665f,
-        0xa9738ac63157deb8, 0x245c40ae23f06c4a, 0x31c7cf248a05f32a, 0xddb004dee16d4411,
-        0x3cb67ec68bf982f4, 0xbe68f4cc24870331, 0x14d18830edd1fedc, 0x3a4a66f815c43dbd,
-        0xd8136251496d652f, 0x24028da1a59da23c, 0x527ebf827838d474, 0x35e7b40bb8257042,
-        0x616b7c24ddd7b5ce, 0x81d12758880f25b5, 0x04f40a11bb819de2, 0xb01d5877772a687e,
-        0x12568ad44b4772ad, 0xfab98b34104a0b38, 0x656387ca14ed39ff, 0x918cb23a984f99ab,
-        0xc0b4153e6d303813, 0xad050fac36ac67ab, 0xc5f3e6b220c3fac4, 0x9b67c227e139b52b,
-        0x7f4a98dd2cde579f, 0x20cd0c5018368b63, 0x39b19555b3561b5c, 0xcd4eab7e9e779869,
-        0x3b7820da5224a8d3, 0xa7c1922a8c148bc1, 0xfd6a387ab583ba22, 0x36821160586a6816,
-        0x5bc14375e3b9e00e, 0x591c2fefba1b6401, 0xc148c6986e09bfa0, 0x54ff401bf41a350f,
-        0xbcd2bc2ccc26197c, 0x192ca66177ae5039, 0x3a1ed539379167da, 0x4e7d6aab9c493b6b,
-        0x40fa9002abdacd47, 0xc930f87a5bf23cd0, 0xe0e7e2aec9b6f6df, 0x2c58fa1783ff9101,
-        0x23cc5cbda6298654, 0x8a784c1c22b93509, 0xb285234ff0221219, 0xa02262ef42e1c7f2,
-        0x8a01691f133ca004, 0x38b96ef33a92748f, 0xa128968ccb1746a8, 0x34094d0d708fa418,
-        0x0b486c7544b9243c, 0x20168a63d1944425, 0x1ffb5d6464378d45, 0x9fbb3770275326f6,
-        0x1e094f8988943bd4, 0xcf1261a897c37f1d, 0xe48eb3f6dae2f29e, 0x4b6dd9b6ee598f4f,
-        0xb3c61e834f4a7d89, 0x8fcc6924ff035de6, 0x73e4ac2c24d902dd, 0xd1585d66e235fb3c,
-        0xf548290680d11cd5, 0xc5573158ebc8a0ae, 0xdba3c9047c741034, 0x1f78c8b7b7b9689e,
-        0xc8d0ce16c7acf561, 0x1f0b96826a0d6e9d, 0xe64011bac0837c2b, 0x0581a608c001b2cc,
-        0xe4db8b11f4974a2a, 0xe9d69a9aa589e841, 0xbff2abb18d532ffc, 0x991b4fb1d60d2a5a,
-        0xd5600cf53015a3ab, 0xb859dc10a568d4a7, 0xd761f06c69c5330b, 0x60b05b8607ebd2f8,
-        0x35143ef6086402a8, 0x2b2852590f51423e, 0xa852a3b87ac3dcbe, 0x2e6547f363da5537,
-        0x4b19170442061ced, 0xcf3366a73fed893c, 0x09264f9614c01fe3, 0xef00905a569a5a7a,
-        0xeb09aa9e0fbf6dca, 0xa8f06ce57c6d0a81, 0xf6f1003ac4ae6713, 0xcbc162f49db7f942,
-        0xc337a9f6a52fd453, 0x38ebb16df44e67c1, 0xaffba4c57cf91a70, 0xd896afe63a2137f9,
-        0xbfb959de52302346, 0x489edb442609ba85, 0x8e421f84bea49fd3, 0x63e4d37ada76f68a,
-        0x56cad147fa018946, 0x41ab92543cd04850, 0x61f34cd11c253f4e, 0x39f57f1718ec48b0,
-        0xb460e479b305867b, 0xa6bb76fa775d29ec, 0x3367940580e83404, 0x481e297224272249,
-        0xe7db53d32d6881ca, 0x71cb870bfa4eff72, 0xd011a33d807d4710, 0x7843e655275d84fe,
-        0x42c6b8eb5a4fa9ff, 0x18dddad469c694bb, 0x5a6522ee84573584, 0x309c82048aed27c2,
-        0xb143f87b7a3ba0a1, 0x6cf120292a409e84, 0x140675766541c151, 0x6787308e3ead01fe,
-        0xcd19b2dc02064084, 0x5e52dfc056aab707, 0xac3670e397a297ee, 0x3abd81ca25a879a4,
-        0x799ddeb26e5e7fe7, 0xdaf6e5596aacdf1d, 0x892f5320a3a6e57e, 0xddbf5b06733339bd,
-        0x222730f0c763ee55, 0x57847e249a19b98a, 0x8d55f981478658ae, 0xcd04b10092515c77,
-        0xc18dae2edcd24e75, 0x10908ae32c63d4f9, 0xdd787dba5c183231, 0x71019e748ca56f7d,
-        0xce3ded0022e5cede, 0x951c53d97fbd49d6, 0xc93b61dd6375285a, 0x58e8b0c8ffb36438,
-        0x686876583d9e17f1, 0xf389392e74368b42, 0x0b144f15b2d60c52, 0xa51b0a4654069c75,
-        0x96241519dbd5d4c6, 0xfb64cc4adcb9453f, 0xdeb8d63512516ec8, 0xc5b439848087c050,
-        0x24a363ee69da6055, 0xaad8bf36ae2a0e0d, 0xb702467a552db34c, 0x6a2832260f896bf0,
-        0xc985d60f30056783, 0x5086351052c048e8, 0xf28cd2ee97fd9714, 0x4f3d82f6c483e698,
-        0xf85cdd656e5d0c89, 0x4a48901a87d9a521, 0x4276f05a2324ac43, 0xb41cac6da161f0ed,
-        0x0072ab766a4436d4, 0x66c5319024f07e64, 0x53eef0cd1b0df30f, 0x8ab90902f9610db1,
-        0x180a6259efc385f2, 0x8500eb7b80144db8, 0x96ff630422c6418c, 0xea339a64cfff2581,
-        0x5c8b3f7a3a26d219, 0xd9528bf53957777d, 0xee6eb3cb131f9711, 0x42150670fdca55c0,
-        0x0b2d827647c6797e, 0x18ef86f8d2263dd9, 0xba07be8ba41a954d, 0xf3ba1a9d605eb4fb,
-        0x43065be27fe076a1, 0xb0a1741a3cf4db85, 0x4db6bf25e54cbf25, 0x8ec6d197ea75a354,
-        0x8c0ba5d137801630, 0x122ff77f8efc151a, 0x2f60eef5997479c4, 0x37d6912e3da190c2,
-        0xff532631ab9e8b01, 0xd97aee154b7191fd, 0xa48d466b71feba35, 0x1604bc70e647e30a,
-        0x82b0d2aaaaafcd6b, 0x4eba4ae13c3eff4f, 0x38e1d4a699735e3f, 0xba7ad5e8b167c986,
-        0x99fbbdb167ac913c, 0xd004b21870b3e07f, 0x6e6e8913273d25c4, 0xdb4e6b24cdb14253,
-        0xba9fc6f285da7801, 0xf68d36aee1c8c58d, 0x06d9f219da2b4077, 0xd536391821672cb3,
-        0xab5d98ce08916eb8, 0xc45cde5e5543f0d6, 0xf05b11886406e991, 0x892da5647a789f96,
-        0x5eab7e6967505d9a, 0x5e2d1d152b44497e, 0xc4385c8676a0fabd, 0x6ddc2a182e8294ff,
-        0x93716d6f452e5b47, 0x74122474c28bd03a, 0xf4f948ff58a1cd85, 0x4745fbc6d878df5d,
-        0x054d76072463648f, 0xc6ffc1f6f4d412a4, 0x0a4f01f6b22cc15f, 0xdb796da42334e452,
-        0xb2f42bca3bbcc98e, 0x96297a3131276ddb, 0xc2ff98eb5e246f01, 0x8c825056da5c5c02,
-        0x10234c6a82f640c3, 0x261256f751fee555, 0x50dce99754f963aa, 0xbd8035a7e7a06aca,
-        0x6bb35e04abac64bf, 0x236134182e0584e8, 0xde858012f3b7695b, 0x98eb0beb8011ed35,
-        0x741bbd2aac92913b, 0xe67009e2fb0940fb, 0xdd109997fa527859, 0x90bb2cb315d7db55,
-        0x34d3f9b049f5f10c, 0xa5b2b7e450794c58
+      // generated by: tools-gen-tables zobrist:z_x_board:count=512 zobrist:z_o_board:count=512 zobrist:z_next:count=10 zobrist:z_turn:count=2 --indent=6
+      // z_x_board: 512 zobrist keys
+      constexpr static u64 z_x_board[512] = {
+        0x3ad5f158c923daca, 0xf5d848a14c6d67bb, 0x96ab877d66f97751, 0xdff09be4d87201f5,
+        0x5aa97ccbdfd1a035, 0xba74c243a69cd496, 0xc119678bbb035114, 0x8d0230f44194e2dc,
+        0xee1b9460bc1abd71, 0x249daeffa5932d6a, 0x424217df1c186fb1, 0xb18af327fc0bdbeb,
+        0x918f6034a59ac168, 0x3c8efd3f792fbe03, 0xeed13a409364eb7a, 0x22005ee54f289aa2,
+        0x22b30c11c86b09df, 0x2b24241c901ebb43, 0x9f0ab1bbedca3a66, 0x1b5c9d81867ed078,
+        0xfbe66d2cd810a16c, 0xe8e96b9db94fb396, 0x9ff20b87eca06f47, 0x2532773cb63ec128,
+        0x95db75be8c618215, 0x96f90e73e2eadae9, 0x6e7a03238bf8ab05, 0x7e510e333274141c,
+        0x9f6c07ed86d86939, 0x66c3d5bb4a776b07, 0xaa088729f0d425ce, 0xbde186513085d009,
+        0x1ab77778f59a177f, 0xac6e90d8bf66de11, 0x7f36a10a307819b4, 0xa8e120791b2bcd76,
+        0x7788d5e3b3623563, 0x6d13442d41c82b57, 0xab363062d0f0eff4, 0xf0783ffc0748aa8d,
+        0x5ac58ea78b2a38e7, 0x9569c32b22963a1e, 0x511c8e3cfbded51a, 0xa90bff5caaf38d7e,
+        0x80237dc462b9b3b9, 0xe88d9825b843a04e, 0xaeee6af12b890006, 0x25315a1a6e8e9ed8,
+        0x235987a40a3cbc96, 0xe3181be517358be8, 0xfc432a5a06a4639e, 0xbed3ecced9475e4b,
+        0xf8f4838823096f8b, 0xcf3bc399a226ea9c, 0x00aceed1788c78c7, 0x2fa65dfa2d2cf083,
+        0x112dd1dfaeab7307, 0x993fddec978c4294, 0x1e5511ee340810a2, 0x7c13c657c43ca167,
+        0x88e6bcd15f65ad13, 0xbeabb4d31b3f3079, 0x11ec90dea6adfbb6, 0xe89e19a7ae376225,
+        0x440bfd43368648d2, 0x791fb1fbe4250545, 0x2f1eff9ffdfb94a1, 0x9a46e80c3c9774c7,
+        0x15882812973232a3, 0x83287753665f9fbf, 0xd26558d162112d59, 0xd73eb79c542f736f,
+        0x0a0bd0ccae68d947, 0xac8538e4f692a19f, 0x0586202799d0aa46, 0x99954982e2d69e50,
+        0x2311171a9fcb48e0, 0x153dce9090962a78, 0x757e8657d656b4eb, 0xcbfdf7016decc95b,
+        0x0d141a132d4f113d, 0x84b3bbb14d5df580, 0x9aff035c194e6e2e, 0x037b5edab533c6fd,
+        0x5c92a45f32bbdfb9, 0x2b92eb53dddfd86a, 0xfd9b956f78292fcb, 0xeed3b66c442e795f,
+        0x912206979e91f14c, 0x01d3db47698091f6, 0x4c160e223cb1476f, 0x2ade611faabde537,
+        0x1bad37b07288ac19, 0xaf07fd01cbff8151, 0x9897f183179d5728, 0xb5b74b1f6b6a868d,
+        0x1936003b5ea7741e, 0xbcbf80e871ec0b7f, 0x0f1647a25413a0e4, 0x8c503451ae8428ef,
+        0x65f23995337a487d, 0x87b4c0699b2c98cc, 0x680601a742e4c431, 0x0d7605201fce5d79,
+        0x01ba80ae4baf880e, 0x75444e8742ea7d4e, 0x3f0dea15584f9338, 0x2b6b4741e9d094cb,
+        0x4c88c4ac40588bf0, 0x746ce290c11d01f9, 0x9cb6cd7925944410, 0x1a73f5a3af6ebcb6,
+        0xf63c9497e4b39853, 0xd53281185b30bfea, 0x667da00690012909, 0x6ed5c49fb955f1df,
+        0x004d5b413f569979, 0xdf0636d5da5f76ee, 0x9ca5d7143a2b7ae2, 0x8647de7bf9c7b30d,
+        0x6474dacf2e0dfccd, 0x73036ade41f08886, 0x9107b3fa9d6388d7, 0xd1f43189b4249eb5,
+        0x44bed289737be583, 0x2b46fcff949f7647, 0x9de2df505de50c53, 0x59df5fece90f889d,
+        0xd056db6fdd2a2ec5, 0x95e32dab9f47e7ea, 0xaf0e8a431dde2265, 0x916a27a69f21e5cd,
+        0xed030c91127665cb, 0x3c738a3ec2e4b393, 0x45b8336cbde12a9d, 0xaf091d614668f458,
+        0x7dbb1bf1aa646b5d, 0x100c896dbd35c1d1, 0x5a19046507ad7589, 0x4b8dfff6bc8156a9,
+        0x4946d857e6eb0420, 0xa6c2e4450df1d229, 0xb20915190ead931a, 0xacf44ff2cc9d03b7,
+        0x33c083c4e4bd373e, 0x2fa5a90cc30af1ce, 0x6b80f74673149449, 0x98e093c896a0df8a,
+        0x32bccd1231dc2ab2, 0x4cb7a5d4cf553e19, 0x92c9d7834c8f3228, 0x388d804349cd6982,
+        0x921b76b7d9700c2c, 0xe88226b4c425c2e0, 0xd85395909561dee8, 0x1853c46738035e60,
+        0x6e7f34dd36926aa2, 0x1affd843294c13d4, 0xd2bec1cf8d149170, 0x0dc14fe779cfa6ca,
+        0xb609a44eff4c906e, 0xde44244da5ee99f1, 0xa6c5a9f4422b49fe, 0xc4472a29b58827b9,
+        0x5662695b4f6b9a13, 0x9b1923b8e69b94b1, 0x7dcf66b059da0844, 0x857483aa9cad2b02,
+        0x70266caad9c7912c, 0x1ff04ead52ed2c6d, 0xc02f8b543ba4e7d4, 0x3b63844d0d8f659c,
+        0xf7ed056ef9f24370, 0xc99514433092f574, 0x61671fef16ab2112, 0xcdcf3f6c36889d4f,
+        0xfb2e33fc8a7ea969, 0xea617d58e6372c02, 0x27061886b87258c9, 0xfbe10c2f39e426c0,
+        0x687fd4e70f1e6478, 0x00be87df470868c1, 0xbaa574d8cee4cd91, 0x9b35ca149481c3e3,
+        0x1ded55b1e58f8a06, 0x7e3e67e5c383b6b3, 0x9710400469e91be9, 0xf76b9199d72dfdb6,
+        0x52f5b6d9a8ebfa4f, 0x4b7d8817fe584a69, 0xd2ac1e799e34aec7, 0x5c6e6b2aed74a778,
+        0x4ed02b9f9255be34, 0x7d038fb33213450c, 0x575c80132da333e6, 0x797d6df46843e829,
+        0x86ae6951cc9b922e, 0xc2a8a77e8438c649, 0x9823a5148395bfe2, 0x5beeb9b388c06fc3,
+        0x1a601aa6474fc7a9, 0x1310fe183b474eee, 0x30c017bced7828bb, 0xf9bfd2a01636958c,
+        0xbf25fffb53cff6c6, 0x80058d5b6d030544, 0x1ccf8325d9c93665, 0x9c5fea1d0d1454e6,
+        0x1ce95525e4026bdd, 0x7599043c7d16d6f6, 0x7bd371a7b13a8111, 0x6a8b22c5b1b204e5,
+        0xbec3b5e8e1cf0bf0, 0x602f80b9708fc9c4, 0x8ce59cc556206413, 0x59397ddd0e277ce4,
+        0x1071ac339bdcd018, 0xe985244e02017518, 0x3182fdc87925667a, 0x09db61e03fdc9df5,
+        0xc7fe9c7ee1305166, 0xdf7d6e626c85bd0f, 0x28860229f596c14d, 0x8d3b6c283c6bdb73,
+        0x4652523f53a171c6, 0xeb5b6b04f5a12996, 0x6ce3d9d21a20d13a, 0xac39f5069e5455a6,
+        0x20dd95c7b7cfc7ba, 0x877d584a2021292a, 0xf3353013ad06a17f, 0xc4661a3ece9d6200,
+        0xbfcb9bf1b0b9885c, 0xa9f9797983b9cb7d, 0x70fd59b1721be6c8, 0x85c325b4a535a1f6,
+        0x2a7299af79344b49, 0xc97d0fc868f47e12, 0x3ccdb25bf7424b9f, 0x719c4b6c73a753f7,
+        0x85d6a1fe2104ead4, 0x189608bd43910fc7, 0x08a4684f4642bc89, 0xf96897722eb7f395,
+        0xe75ff7ff1bf0caf6, 0xcfbb2bded4185bba, 0xa695ae4ce4110d17, 0x4896b5ee42bda87e,
+        0x6a89128f5cdb39b8, 0xc1e7801585af3ee9, 0xf6c898fa3cae0e6d, 0xf62711c6fd7f0ba6,
+        0xfdaea4a75f1e081d, 0x68ca07a87a5f084e, 0xe71099bc4f0d82df, 0x6d5db61dfee72060,
+        0x2b334d41264a6fe2, 0xbbb142dd0dc15892, 0xe46c66c3bc0d680f, 0x73592aa8888fecc1,
+        0x8f398d8ab0caf004, 0x93d201c19404caa7, 0x3cd3541ac55a345e, 0xb5a20518cfd92e06,
+        0xfb631dd88d010de0, 0x4ac2b8e49c7f20a9, 0xc8e7d53df885a6bc, 0xc03c8fb5d23136a1,
+        0xfd1e6578f2adac83, 0xe275e195539ed9db, 0x1b7c3c36d4193f34, 0x096fb746fd95ac5d,
+        0xa6303bf0e538520e, 0x5c973e91853710af, 0xbffd58dee07fd8f8, 0x30938e10a444f1ca,
+        0xf3f8925c60ea9aa4, 0xdab004fca8daede2, 0xbc55673f00e88eed, 0xc5cb372dcf7a87c6,
+        0x76738a6556fc1a71, 0x3044101f5b576724, 0xb14bfe9c71a70e49, 0xbdfbf3cc180a0ee3,
+        0xa14f6bc23b95cbc8, 0x676aed407c2fb4ae, 0x4c4e61d5f9d4dc48, 0x6ddd54701d2c5c3d,
+        0x8b39bd68034213bd, 0x778e53bc88973ce5, 0x7671d453f1a3cb89, 0x53337fabb944078b,
+        0x59778d66d05a1b9b, 0xa0ee28116a7f5b57, 0xeb6e6c3637765f00, 0x6cb83c97946063ac,
+        0x68fe927d671a1262, 0x923419636b83d670, 0x1b4a3eb4d4ffa54b, 0xcacfa9e3f744fe5d,
+        0xabacdcbc617fc9de, 0xd915d2b6f8297abf, 0xedd2c77729e3ae89, 0x7bb1ce4cee5ab72a,
+        0x75866b1e45cc88d7, 0x9f2b99d5b3d8798e, 0xa8867ba747be67db, 0xe8542cf089f7e417,
+        0x9b21f90eefa7ed3d, 0xa6950c23a35ac03a, 0xc1af9ff76defe490, 0x97cc969fa6a95397,
+        0x33694dc5387114a5, 0xeb058d011c880154, 0x0eb3e6b90caba719, 0xdb84920c253d29e1,
+        0x0a38763274f611a3, 0xe96a3b9319962f12, 0xf134969c94425ab7, 0xeea63bf917f41922,
+        0xe5a1c92589d66809, 0x0a8a4d0b72671b0c, 0x64703ec0c165dd63, 0xf729edd4636bccfb,
+        0x35c8d4622ef8c395, 0x0bdf7c0626807230, 0x0c1cc341cabf7e88, 0xe9f118273fe2f028,
+        0x5c42ce5d9db7f418, 0x5ebb2552f0718fe0, 0x8f904955b4a5c71f, 0xfa2b46df2a48a935,
+        0x04fb36a46a683c35, 0x203bf6d730b10d2b, 0x02e22feb4c23b791, 0xf3744279a219e941,
+        0x73412c76bb50646c, 0x1749dbb8f8db80bb, 0xcdf65f470d0ccb0e, 0x490f1d619e221471,
+        0x864831cf011c75ba, 0xa1ff2f6fcb65ea56, 0x6bb17c6ffb90ba6b, 0x4944c383e1cffe5a,
+        0x0e014f7027393e0e, 0x4f7102bb2ec680b0, 0xf657bec358dbf260, 0x0db8dd2c4e1f6528,
+        0x23a4bcdff6dd5a78, 0x66f75e3d9ed279dc, 0xaa930d008dca6791, 0x8653d06221af4efe,
+        0x7bcbcd087222265b, 0x633455ccc00c3f21, 0x29778a6831d5fb45, 0x1b99cad1d3f77840,
+        0x3b117594861ecd11, 0x9884ce083d74745f, 0xf37c78f9923f194b, 0x4cffa598ed36938b,
+        0x26c64452e18b1b63, 0x9b2597f20c76ff4e, 0x0eb39849e244d189, 0x83ddc877c32f05d6,
+        0x1a16794a4ccedb8b, 0x138ffb845e1dc92f, 0x57231409edd395f9, 0x55c50448ab3779eb,
+        0x6f3799f03620fd96, 0x83f03c9951b79009, 0x36b61c26e422bac1, 0x64dde697109cdbfa,
+        0xccc7df9761503036, 0x077c985aeaf0c0b7, 0xbe2aa842d49327e1, 0x99bdd8ecd730eef9,
+        0x04ed6b2a0133b38c, 0xab402be5da1f9949, 0xaa2ad78b751218ed, 0xc2cdcd077b74a905,
+        0x390506c7558c728f, 0xc13c21bbc754c405, 0x0c2d009bfaf912d5, 0x5bd054303495a175,
+        0xd4dcaf5b329b7999, 0xc613780657f305fd, 0x1aaf8ef3b9913f75, 0x99a1ba58bed96760,
+        0x593bca794c729bc7, 0x920f50bf494882c7, 0xf31189c4bf563aa4, 0x3d505d1799e0cd40,
+        0xceef272bf9103236, 0xbd061e059b2127a2, 0x7d0e873e9d35f681, 0x1087b2e798d3b9ca,
+        0xca2b41400b103788, 0xf90db65f5270ec01, 0x0ebd467ca2d2a5dd, 0x5565740b5b50b9ca,
+        0x87d092f428a7d1f5, 0xba7b8f7cc05de7e7, 0xfcf5ab0939fc673b, 0x6c00dbeccc2c6d9e,
+        0xb8d2a0c9e94137aa, 0x5b47a6703b459022, 0x8c1b2dd4438b8cdb, 0x2707ff1d815821db,
+        0xa3e5adce1733256e, 0xe4f3b17fcb58bdf6, 0x0d89342df87bc9e6, 0xd3b75e72e0fc936c,
+        0x1ee0324b83d5e5ad, 0xcc443cb74cbf5abe, 0x3c7470e0ecb4ab2c, 0x1c6f2d4ce7dd733e,
+        0x0ded6cfd86e15e1c, 0xb4d29ce6b1b89433, 0xe62ed216c2a66459, 0x781b2e55ae48d325,
+        0x83500780dce0c0d4, 0x4f454ed8fc97629b, 0xe19251dc19d3ccb4, 0xd1a36822cc140fe6,
+        0xc60a327b34cbfb9b, 0x6b5d829ba97fa371, 0xc4a2d82754e71ffd, 0x86fbde1cc51fa40b,
+        0x15e3ba536baa3d50, 0xea2d937d74b67a1b, 0x95df63a4995af8b4, 0x2dd504145691964e,
+        0xc4675d05fb7dde69, 0x66f759d287380e3f, 0x3937c293140a7e83, 0x3311741671f67885,
+        0xa8b4de50112fb171, 0x82c29ef459fd8edf, 0xdd903d2f60a783b9, 0x51a41ede89e25dbe,
+        0x1ba9f84401b132eb, 0x2b978dadda8ad50c, 0x4452e681eae72c1c, 0x237cfe0b9c6558fd,
+        0x86c3d55e1fd5db37, 0x79bfe51ef68adf96, 0x8921bb29006ef383, 0x2545cca4a61f9ca1,
+        0xf76dacc9b4c9d1cf, 0xd97b904062ff3138, 0xb969034dc6719e55, 0x4ec9f7da47f88ba4,
+        0x5bf24be04db0f00a, 0x3a117e02d605e7ae, 0x6f35068474f6a44c, 0x73f6d66d4a81c469,
+        0xb661ff4bf4cecbdf, 0x03f889c9946900d5, 0x0873685ccf4b4606, 0x00acd7fd5d89fb8c,
+        0x649862ca68231627, 0xa24ab8b013dda7cf, 0x31bf693f5441715d, 0x3e468f57da00aa7d,
+        0xe60a41290eb68dd8, 0xde67bb824c7b75c7, 0x4bb28ffb8c90bf42, 0xdbcbe50982b431df,
+        0xba2f2385a1aa1f8e, 0x2dff8f2d4df074cd, 0x46c2575d7cdf9bf6, 0x8c02c8a66416b621,
+        0x958e519b373717fb, 0x955d4567bc8035a1, 0xf3c1687398cfcda2, 0xad8ba0360d124418,
+        0x6caa0cbbe8a6dd11, 0x2562f9e6bee67733, 0xaee3abd275744525, 0xad041566011704f7,
+        0x1364192ea05df992, 0xc51fa90104ec9d77, 0xc1c2f00456c2dcf7, 0x7cb290ef22a7ac4d,
+        0x865d44030524b935, 0x3928615ac39be33b, 0x83c0f791b50210b7, 0xc06c100f3f57d7a1,
+        0x5adf90be709e671c, 0xc02f656293ff14e5, 0x10888ee7a3a628c8, 0x84dfa05e5878146d,
+        0xe6056a11810b6ca4, 0x2f2dcf71b5ec349f, 0x89a59d88cceb284e, 0x4d949d4c3b1d6370,
+        0xde5793a27d7d9929, 0x43a86ac8bc556aed, 0xe2e943d919505c00, 0xc41be3da8930909f,
+        0x6dbd284275dc6927, 0xf5d23a422fcc46b9, 0xcab66ffac90b0a25, 0x5b1cdc67d48a8652,
+        0x4dc476a9cb8b1163, 0x02f8b1e8b0cd74de, 0xac651f2111567d9b, 0xed927a7f97b442bb,
+        0xee3131d0145fd5e0, 0x0c1348c6a05bca27, 0x86707a58b764dbe3, 0xc8350ce96de4230e
       };
-      constexpr static u64 z_o_board[pow2(9)] = {
-        0x99579b5333b18ffc, 0x51d438471efc7f96, 0xc0cd0708517e39be, 0x17e950922b9f67b8,
-        0xe803726fc585c3b6, 0x7fdbc72cc09a9cd0, 0x0b037db7d8c40f59, 0x9d538e0575ef39de,
-        0xf705d13c3c32d079, 0x88533707ba30465a, 0x568861c765fd7949, 0xcbc33d63cecd49f8,
-        0x2fe3ce01fd01b3e0, 0x67ce9726fb460114, 0xb6d0274f28923ce4, 0xa5fc1bac83d88db2,
-        0xac1abe9c083cba0f, 0xab8d4270af5560bb, 0x455faf02a2d612f4, 0x16b0a4dcdea357be,
-        0x37e337c6b2430aba, 0xb602e99248c6c558, 0x387e976e8a0fddb2, 0x3a4114b75c3c39ae,
-        0x106ad9d92e140169, 0x9c0d5dedeac988b8, 0x061853075d7c4473, 0x09ca0498156c36d4,
-        0xc6179bbe1990d036, 0x791bb98c142d666f, 0x502a65886bed36ac, 0x643e155cbafc2347,
-        0x60df1cff4288a7e0, 0xf04983fdfadf2c59, 0x28e2bc18fe8197b4, 0xca01537539b44ce6,
-        0xca59cf8994fd9d64, 0xbf8a05a78906ad49, 0x343b74d7de643676, 0x72409c5144f2ca34,
-        0xa320aaa6eb96b49d, 0xa2211b09f8d262c6, 0x48084e79d25ae672, 0xfa7a4000e34d1444,
-        0xe6e0f3292b35e9da, 0xa7ca62a75c6d5e4d, 0xc451e73108ad5cd3, 0x7efd8873585429bb,
-        0x1902100d31e253a5, 0x97ea4c4382c93f08, 0x023a6e44f5599cb1, 0x5adf4b12626fc5b8,
-        0x8763074a48352d03, 0x9a1795d654d13102, 0xeb7a1cf22f172b46, 0xb80bfb068e5d32a2,
-        0xfa375c71e520cce2, 0xf4f1830dbd771d7f, 0x1e216516fd4d439e, 0xfacd349e335a85b9,
-        0x6bc6dcf94b8686f5, 0x6a4eac874fee2e46, 0x5cdec624c1f29acc, 0x70a262acda92c7d2,
-        0x4746ef56cd4cb427, 0x8f7f5f05d024d5dd, 0x992e51cd2d85150c, 0x2118169c3307b9d9,
-        0xe3e84ffba7103a93, 0x896333907747a295, 0x5f8f123fabf76336, 0x2b41bdfd1729a260,
-        0xefe3e5fe9adf8266, 0x0d9d17d211f81bda, 0x0b85c59b3ce3c07e, 0xac36fe0059100fe6,
-        0x23e6cc7759db4f73, 0xb471e3362976e43b, 0x1e9626c79627703f, 0x1ab2a2f7a3be7532,
-        0xfff287ee6d9dbbd7, 0xb6e16a2f9e11468c, 0x542e5a4ba99b9569, 0xe03d9d2a26df2e85,
-        0xe5e214808bf5c3dc, 0x0b8cef97e304322e, 0xd5589d554d1d584e, 0x51ddfbdb48d9728c,
-        0xfeb6ad0c34ff4585, 0x437a589dd8d05920, 0x5f4665f48a767be8, 0x18b2a73aa8bbb5ad,
-        0x7d42098e7fb34970, 0x9c41396c92e1e2ef, 0x903cd825b25684c9, 0x6a058657ec8c010c,
-        0x21b452cb4a56333e, 0xcd91a199df8d812f, 0x6db6815d70eb38d6, 0xfa2baa8ec9bc0213,
-        0x08bc1ed7ccc3ebd7, 0x12f122969b50e1d9, 0xb1a333ec64065f61, 0x86077c3eb930b474,
-        0x5c5dc5951e834b1d, 0x1d06ceaa91c14f62, 0xf22240c6015ed0c4, 0x9bc652ca43c7fa58,
-        0xb59e544368de0043, 0x8212241639032ec7, 0xff7478d8ca71947c, 0xe5b23653c5475991,
-        0x0aa459369e18c467, 0xc2de3b6f6aa9c5c4, 0x62c1d73f273f6e29, 0x2f466c09cd13f283,
-        0xcd8c9e896af2d80a, 0xabf4505461adb837, 0xa19c1c9db1a5cf2f, 0x0a53fc50027bbf92,
-        0x933a0f9aeb98b908, 0xc10fafa1cb7fe5fc, 0x82254d4dc71aeb5b, 0x7f740374be1b6770,
-        0xbc69adcfed13b3f5, 0xc231afcaea182186, 0xd6e5810e975fbb6a, 0x1945efb35060b1fb,
-        0x55e0b014438621de, 0x84bd6615fc0e08a4, 0x1deeab7ce346f4dc, 0x213094b8ce4d026b,
-        0x6052110edbfcde76, 0xb64e36b073d1fac3, 0xeae3673f2ea6e70d, 0xe416fddb6e5c1b08,
-        0xad59622f8c1700b5, 0x007f24939e393f33, 0xdd0adff079ad8e03, 0xb4f05ac8934b17e3,
-        0x6dba597b97bfaaf5, 0x8cc1ba11298d3ac0, 0x9d5e390890adfa5b, 0xf3f838b633011fe4,
-        0xda5d3b3fca9166bf, 0xd51b9168f55cba8f, 0x615dd529bfb0c930, 0x90dfcad6fccf8c4b,
-        0x90dd57f30bb029aa, 0x33e60a0b64f81737, 0x3f400df2e0c01fdc, 0xa00584553c682bd6,
-        0xa20f539a957ab509, 0x3453d4c2a913aa18, 0xd0309bdce067bbc2, 0x13d1bd1cd199f63e,
-        0x416a7deb794abdab, 0xd7bf1e8565f64470, 0xf8a50be54cb19334, 0x21383d290ee9a00c,
-        0xea435175a67d0e57, 0xcd2266f39705cbc6, 0xcdf7f124999fd82a, 0xac786fafe6d68af3,
-        0x9f0529b96564d5db, 0x3b38adc2af2785f6, 0xd27b215498a36a79, 0xdfffdef2b1152dfb,
-        0xcc8c07796bad71ff, 0x1ac80844af99caa8, 0x158ea0a3acf7ea22, 0x7f3c8e80de55c37c,
-        0x8ffc27ffa976b40a, 0xbfbb8748f57d2202, 0x4ea52eaa0421b095, 0x6a270f8a5e36ef0f,
-        0xe3c2d82a227cd317, 0xe6b2593ec708b8d0, 0x8d7c8b1e1d64517e, 0x1a7e396c0ac448f5,
-        0x1d27b944b898d189, 0xa292c145ddb60973, 0x6ef3cee7944f79f2, 0xecc668d9a1785bdf,
-        0xa8b953c5bb8b143a, 0x1c2e814d9fa4a192, 0x58ad811fa03aa167, 0xa6df2bfb7a56c832,
-        0x8236ca1fa9617b07, 0x42f19cfeea706f67, 0xf8a979404b95aaef, 0x3533a51c69249aa4,
-        0xf575d8d8cb114bbf, 0x345cc4f8b6bd892b, 0x6aed37c42e729905, 0x6b912c8d8acf0b00,
-        0xfc81f39eddff475a, 0xde36074c71f70ea1, 0x4ce0532cc79b574c, 0xfbd9d363cc11f850,
-        0xd970dffaaf62fec5, 0x5e0b3d74a8e551bd, 0x04fcf52334d46c32, 0x4ef26a7d2b3bd0ee,
-        0xd67ab30381fe8313, 0x8cbfb2d0d4be6caf, 0xb112953f4412ed84, 0x306663a927767ed9,
-        0xd4fea1e6aa3f36e1, 0xd3d734268bd7bab7, 0x49e1c0cc36a24ac0, 0xbb901481d8df04d3,
-        0xf69411df67150aab, 0x2e40f9e0f796b18d, 0x80779b9fb8a0a9b3, 0xc07aa1adc70b638f,
-        0xf00364575e1d9e5e, 0x8bf7a1c2293e0c25, 0x2d4fd620ca0eed61, 0x6a03b14b3caa76f3,
-        0xba1c6c5eb897ac78, 0xa2993ee96fd5fd07, 0xd494530ffd8f58a8, 0xce0165ffcb05a404,
-        0x7b7267786a475b01, 0xf896fef7fcad6b11, 0x348f6de621939068, 0x2f9eca88eb5f839f,
-        0xbfade35a8e1590a5, 0x3ab2192d3222e3e9, 0x5cd947a0b1c79c5f, 0x12fc6614f5370448,
-        0x2632b0109bfe2eaa, 0x50a1b4b3c9bb8dde, 0xb342f452a1fac4ce, 0x76e18dfb2e953390,
-        0x890eaba2000cc953, 0x784c3e978958545e, 0x6526c71667e62785, 0xb48b0d77b54717ac,
-        0x2f62778d46ad0630, 0x0f2d98553922ee4d, 0xc26c495f75f673b8, 0x9156f99429a6571d,
-        0x3d755c1321ac0f8c, 0x91489ebc7b11c30e, 0x88f438374c5a9abe, 0x66fcd978b4f99b35,
-        0x367a6b3c6fb856db, 0x75aacd3a906a1da6, 0xed37a7a2ffa18473, 0x0d21e8cf1feed9ff,
-        0x2b658b3dae6f6224, 0x2f078f22a8444481, 0xdc45a9909f677c56, 0xc393218e34ff02f8,
-        0x363cbc124c7a6577, 0x0058dae277a6a563, 0xeb34a604c189d78c, 0xcf993889458c3e12,
-        0x739ae0fb66968b49, 0xec2cdf81f390e8b1, 0x44730419646adbcb, 0x152ac5b3a52e5084,
-        0x0e1eee3e799aa292, 0x90b3cfd04d023d2c, 0x5531e87d2a1cc494, 0x333b3e538ff8b312,
-        0xec04aff0a21d2fd6, 0x8f1f2b3801ab32be, 0x8dc98b2c8758012d, 0x0355a97376840214,
-        0x5c7a16e93eda6a1e, 0x6d5eb59528333614, 0x028627c4ced1659a, 0x1bc3f0a0eeeab9a5,
-        0x76e8740e5de10031, 0x762039cd25e42da9, 0x383ace77245c8c05, 0xf86e86e1280fe373,
-        0x3c074153973fb5a3, 0x6b11020bcf3f6022, 0x482b3625f50d2221, 0xd5033b4ac06f1858,
-        0x310111c5f355c293, 0x2a5e6c2fe4dbfe51, 0x5736fa5c674af216, 0xfa3fa7c1bdc8e64e,
-        0x391dba39391b0665, 0x5d727e6070a3b596, 0x954bc0cfc5676fb0, 0xb6245026174b2753,
-        0x207545f6c7b16a5d, 0xc0b425ea0667ec5c, 0x8f6fc4aea68785d8, 0x15aceed4feb76065,
-        0x6024c42efc473b2b, 0x45320b132a64be0a, 0x99b5afcd6695ea33, 0xaedde9ec5f31149c,
-        0xe0a5d67e4b11cb4f, 0x6b716e0e10ffe267, 0x64c7cae32e6fe4de, 0xfb8baa9582eccc89,
-        0xb5248a8e9311429a, 0x7593805e286e7d41, 0xcf95d6147fcadf05, 0x38042829e35e0826,
-        0xd74f12888fd8b390, 0x8d0c169092de2d46, 0x92db5fce7c27c109, 0x70e7395062e8a495,
-        0xa2d78e2fc0923a5e, 0xc18f94a297714f4f, 0xd8fffe903e0f6aa7, 0xa0b4aad0fb2dc45a,
-        0x2156f9b7a1103f6b, 0x459e71fc2aa4a14f, 0x6602d55093b6ceb4, 0xa02f5a23035addad,
-        0x350d3263fcc7797f, 0x77a3c9d58c731c99, 0xabae197a20cb4c9f, 0xd1b89ded2b22e36b,
-        0xd204eb941326652c, 0x4c9cd3808a76bbb0, 0x48cc727d44875666, 0xfeb17dd7de1464ae,
-        0x260905d663ac75bd, 0xefb1dbf51b954d0b, 0x9c7d4eb732978103, 0x7fe2d77215d8f3ba,
-        0x791602f41a68e0aa, 0x1c720f18cf1dc8bb, 0x7170810a4c5318d6, 0x365e3e07443898e0,
-        0x279c6cdc02096fb9, 0xc9d5f8f6aa9140f8, 0x8d383a5171abdd1e, 0x8821afff42c2367d,
-        0xbb4a74794882c6e5, 0x913cd00400209e35, 0xd0be650bacd02c6b, 0x4fd6f41287ebd564,
-        0xbcdd19037a1818a6, 0x97cb05bc742a0037, 0x181b749d3840c89d, 0x883f523ea76c9690,
-        0x7fa22c67cc04e1d0, 0x608ce772bb42be00, 0xce1eb3c807cc2e8e, 0xf46bd989ffdc7393,
-        0x2349209c201e59a1, 0xdcc66d57946e9c31, 0xbd1c5b26804ab88e, 0xa9331c33a48d0542,
-        0xb15af038eb4cb86d, 0x66235aeff1813c08, 0x514fca0fe81dee8e, 0xd4b9b875d9006944,
-        0x2b4e8a887bb1ff0d, 0x60e10a5340b38b5e, 0x7035620c8782e907, 0xceab4ea517abf682,
-        0xd02a00cc377bbd3b, 0x44ea40fbff3d3354, 0xec5ecac361b3ad40, 0x25f754dca7fb34c1,
-        0xc6cb4fa2eda7b068, 0x1416615e28493b74, 0xd9685f4145982b4a, 0x7cfb686dbf9c4dc2,
-        0x953b2f3a7077bf94, 0xc96a52d8db33521e, 0xd4e37cf1b97744f2, 0x1382ad366a81d74d,
-        0xfa187fce564cfb92, 0x0995b7998ab6c155, 0x291d1b6c5ff6ebd8, 0xb1c45fe274d4d02a,
-        0xd20932da5d595613, 0xa89d98623fe9235d, 0xffb63150027fcbe3, 0x1dcf1e5a8cdcd789,
-        0x3cac004bd2828d70, 0x0d77a32fbb198c30, 0x15d092d124fdcca9, 0xa3b29c5417f4fefb,
-        0x2d61d89169cd95ee, 0x033736fc4c288911, 0xc9a0458ed42f5485, 0x677cbecd67af8bef,
-        0xcd243756e95bb142, 0xbff722b314e543fe, 0xbcb7fd564dcc5405, 0x5794e5ff478f781a,
-        0x35aa573c1453b939, 0x06ad3cdee2cab11d, 0x9520b3f0e9bd4754, 0x93e9daca0addd235,
-        0x573fb2bc5171e9f7, 0x22f59462629747ab, 0xf8c28c2c1dde912e, 0xd1241191b96656af,
-        0x6847ec27a569ce7e, 0x8634640a298418f1, 0xfad52f94a11b6f44, 0xd9738d8a18f69f85,
-        0x4161ff9fbe9cf910, 0xd6d0f947404580a5
+      // z_o_board: 512 zobrist keys
+      constexpr static u64 z_o_board[512] = {
+        0xd6d97b15865f929a, 0x6b6ed7d436f87ad5, 0x626469eef941fba5, 0xe552eb5ca313c808,
+        0x38bca604e149d8b6, 0x12b4212ee60cfac9, 0x21cbe0969c45357a, 0x8049bc3b53bd5a9b,
+        0x72a5dbcf908f91bf, 0xfda9ff3d2952e585, 0x46951933e288fb2e, 0x2047061145a37090,
+        0x4cb63b7c0a2a4423, 0xc6dfb294b8f14489, 0x91fb185d4c0b50a0, 0xf0a9e3c816561da5,
+        0xb73131dfe00a412d, 0x241500405da7e8c9, 0x1c5be34b6283cda6, 0xbce54e7c85bf0357,
+        0x651f0edcf2681fa1, 0x1035ed96b4c008c1, 0x4ce2950c52771668, 0x53f755f3668b5164,
+        0x095edca4c838f1be, 0xb604884880d4a315, 0x87f148e2bf44224d, 0x952ff155edd43be9,
+        0x848bb57c4dc3f5d9, 0xe8aac96ff74c859d, 0x2bf57d625df958bf, 0xdfd50a598d7ad665,
+        0xa326bb7ecbec1e03, 0x63647b1617a2eca6, 0x3a66b806ce727572, 0xe9a0019697f9bdf5,
+        0x8fe30ef6ef44bc7c, 0x327a0d450a4754f8, 0x7cd0d1bf09113c73, 0x07d25009495f6e07,
+        0x76ff8f5a27163351, 0x351e8a1cc752d456, 0x850c3fd3cf0c4a6f, 0x4553c4821ee958e9,
+        0x6f473785da261ca9, 0xfd252428cb0d60e6, 0xa7eea061c26a3739, 0xdf46f9d3964f6386,
+        0x983924585d630633, 0x6cbbcb537ab0d396, 0xedcd5677809755b0, 0xc935e2702ddd6126,
+        0xe729fcd1ba9b9fcb, 0xd004d37fa7c0c072, 0xe67a26023fe9e8c1, 0xc94bae350e868b89,
+        0x8a979c62a2aa0c48, 0xbcbf4e38d9e6caeb, 0x196a579cb6943c17, 0x87e1557ad275643a,
+        0x50cf07d5d994106b, 0x0004bd8e19635db4, 0xc0e9a20f1e48bc4b, 0xde773d235bc63ca4,
+        0x31c02f2ce03f42af, 0x37960a4d6ffc40dd, 0x602fa7d32d5b30ef, 0x94de3a7303fa99d4,
+        0xa3b7e1d29f6651f9, 0xb7c8151a9789e28c, 0xd876072039c6b3a1, 0x91f00451a23d8103,
+        0xbc473e45d0d90aaa, 0x1f628c96730c853f, 0x6f92dc654159eaab, 0x90d0af642f9d29f6,
+        0xd613aed28a6c1d2a, 0x1cb0015df659a40c, 0x143b6841b535967e, 0x01592bd35cc04695,
+        0x539dfe39ddcff1b4, 0xc1571111070c8419, 0x67aa0449a15c4987, 0x70c4d25ba9a19419,
+        0xe10f4fbff2778a61, 0xce88c7c994b0d89b, 0x2535c77c0af981bf, 0x065f0eaaedfb8fb8,
+        0x47f0ab4fde05d7f0, 0x0c822a5711ab7a95, 0x40a8e0b3282cd7fb, 0xf6ad2358892221a9,
+        0x25ae2f3e152019ef, 0xe27a78072b96ad46, 0x7932eef8dc7bc9aa, 0x6858d556aeda6bdf,
+        0x09af9d642cec5f5c, 0x347c3cf322bcc720, 0xb33e0b89ef1ed3f0, 0xa36b9e240c9bbb46,
+        0xe920d8b0f2580b64, 0xce9e8861e4b6c661, 0x9e449a817c4195df, 0x0e65d4faa9e4a10f,
+        0x218d161ab6700c06, 0x497ad65033c0e495, 0x171e47dfed37ae1e, 0xb3a6c732729f89b3,
+        0x01556d932397445f, 0xc1f7ad0126e68040, 0xd068271275494eb6, 0x29fa568d84bcad23,
+        0x154b887e4b696ed8, 0x0bb767a8c41d63c0, 0xc46e9c4d2ccc82ec, 0x7bfcda25788d016d,
+        0xa83e6c3b5392194e, 0x35a335ae3fd36398, 0xc47a5abd550a9d95, 0xdb87c304100791d0,
+        0x437534226c709189, 0xa898af6237ce32cd, 0xd183ceadfc66a739, 0x86191ef7a9ce0f75,
+        0xbbca6705550c1ba2, 0x99a395b02dbf4037, 0x61cb4335bf46efea, 0xaacf89531024d5a7,
+        0x7030ad0b6e137072, 0xcd298a8e04b49a18, 0x60ba548c80dd0ed9, 0x4bbd25a321bd7737,
+        0x7b8ae09671bb029e, 0x2e6823570a1ffc79, 0xa72efa6c298f7730, 0xd15bbb49cf3c861e,
+        0x2c0212989823aa19, 0x04ce8620c1251c8d, 0x687bc44605141042, 0x2cbb9f24a24303ab,
+        0x4db8c626f1d75630, 0x056bfaa5f329ff09, 0xec8597ae27dac453, 0x9a0201788b6b92f5,
+        0x081a01762426456e, 0xdf50b8c8a2332c9a, 0xaaacabd6598dfd4b, 0xb7ee154f21b1202d,
+        0xbb6529383455e546, 0x86e573f92565458d, 0x5a3cace5f8a53060, 0xbe98977f16453329,
+        0x6c9112db39f41a3f, 0x58f86bb9a5ac6d19, 0xf027555ec8f04482, 0x1a5f12b3520281ad,
+        0xf947bdb0acfb0860, 0x2df34cf08f63bbb4, 0x65ec4f2a7371b115, 0xa1458178eac04f00,
+        0xf2ba0c587f290148, 0x8c0fb04a2b8f8a9d, 0x627fbe9bf7fe11ad, 0x5d138afbc26bb1d5,
+        0xfd9b7ad2267e11ca, 0xe5369b296ae2d381, 0xf952cfa9807bf6bd, 0x3e1e7d155bdd9d71,
+        0xc487a0d5b0b072f6, 0xd6b7d9071fd41369, 0x3c9b518c67202d79, 0xbfb6598b647cd668,
+        0xe50d18c17adc821a, 0x40351695b6f47aa3, 0x83424a0049a68825, 0x2acead390f708e19,
+        0xcd824e5cf1fc126b, 0x4f8da3feae2d9080, 0x84ca7cb4d47ed58e, 0x80d7e9625cc2ed36,
+        0x202c91829c1bd641, 0x1ee02045c8e0e91c, 0x78d90c53999efe36, 0x4d5dab81344b0b65,
+        0x63a275e8fdc79304, 0xac896bd1fbda1604, 0x848e0de5a9a62b8d, 0xe05e0ef1192316db,
+        0x198394e293604b9d, 0x1ea11cdeca6c052b, 0x31233d9f0e90bfbf, 0x934dec59d586448d,
+        0xb15759a726b40314, 0x215ef15e5c6ca86f, 0xc37265da00e44a7b, 0xe2906647d4d5054e,
+        0x5b3bfce4bab82ff2, 0x575b607afb863778, 0xe8de759068681ac4, 0xd3a0a9390c25812d,
+        0x301504141c08cf64, 0xd2038afa9c924320, 0xdf779f3f52b49c93, 0xc2e1856dc06eba93,
+        0x4bfab8356b9fd0aa, 0x684502f32af09f89, 0x427069876f36113a, 0x527140fcb1d86d99,
+        0x882a0af4b073a757, 0x5d6d22254687b57c, 0xafb879ae6a379797, 0xdffc891d459b65f6,
+        0x2fcf27ed96776b26, 0x1f0c4dbc3fb91ae9, 0x5bfb370c1d970078, 0xcb2070a0d5d75032,
+        0xc037ebd57c3a7add, 0xd67a47e6bc64c5fc, 0x06e6c10ada81cbaf, 0x83479f8385819362,
+        0x909cfac8de5fa5e9, 0x3ead9928f9dbfcbd, 0x01c48577d82370ba, 0x59128af16c90a005,
+        0xc58f2637b4d8ec8b, 0x51b93a8178ca2ba8, 0x1351d976273fff8d, 0x7e06c4de756a6067,
+        0xc50bac51a4143e55, 0x264e05644c43b203, 0xff5afe318563aca7, 0xaafdb503547ca211,
+        0x8703242ff8bfe5c6, 0x193958cfa135c8de, 0x399fed3e9a21e114, 0x46708858a13bf266,
+        0x9b138a0e5314f02a, 0xfbfcd1a855dbe017, 0x34cf7c76b00150ee, 0x9e3655f27bf41843,
+        0x7cdd30d83ccfd23b, 0x7bf7a153833028b9, 0x4585aa7555b117a0, 0x6e2822c1a69a5c78,
+        0x9e53f5a4eb8ada25, 0xd02161b581e62c1e, 0x42d1dfaf52a58ded, 0x64d318b67a4ffaf1,
+        0x71608678af4ee881, 0xb023412d0dff0aa3, 0xc5b122885242c44e, 0xf6d1ff66089d4f97,
+        0x71cf1877095808d5, 0x7f5180fe7a9a5e18, 0x6542fbde3736d7e2, 0xdec69659bbe07b68,
+        0x30489d045cbe67c4, 0x32af06a1c7f1d1cc, 0x28dd382593d7367b, 0x4dd1093d80755c88,
+        0x7d9395bfa5206f21, 0xb4d0e806296ca129, 0x53f98695e7ab8287, 0xfe5f5da502486f7c,
+        0xaf3ce9e63315f1f3, 0xc79b18dd7262f224, 0x966b4df0cf596f72, 0x08fdd2607c48f815,
+        0x57af7d59c6c34b6f, 0xf4a5e226ef80168f, 0x41060108cd64da54, 0x3f54cb5e25fd1445,
+        0x97736195e6aa3f29, 0x50147024b7593504, 0x73b933d2068abf0f, 0x3c9818b4a8502b67,
+        0x8ff4d56d654717b6, 0x4ba2af01e1108792, 0x1fc8350eea2ffe90, 0x37453c0148782259,
+        0xe8cb4d6a043d5202, 0xed0aa72352148792, 0xec28b82a41feb049, 0xcc5b9dcc4cb25476,
+        0x9159ecc73856ad9b, 0x51a40e929ce51568, 0xeaaa8a5c127f7271, 0x35897c1f757e1d84,
+        0x582005f7d0d7facb, 0xa250af6aa9689117, 0x8bce7d5c9eb7e263, 0xdc6826f52d1c455d,
+        0x0918f0fe2b4fe571, 0x939d85ecb9bf146c, 0xb261c933a0fe1b54, 0xaf89d3caf40ef976,
+        0x186df5b2df868721, 0xa4e6be4e913db804, 0xdfa373fcbfe5f121, 0x13d9f68da27a5fc3,
+        0xd3bd8644ae14af78, 0x929e2aee27d039c8, 0x1417a6e852c1d9e0, 0x47bc56004f88424c,
+        0x08d56fb8b7a3160d, 0x79e87f487ee65bbb, 0x262684989cb6175c, 0x7e9ba1a037355920,
+        0xcac19b3582c2e8b2, 0xe327fc3242c19935, 0xc262cc169c65fe87, 0x4080c7e24720ecb5,
+        0x2a7372895420529c, 0x02be5cc7c8e2bfb6, 0x031d1e9c0bca71f4, 0x8c1e59f69117744b,
+        0x25e5a4ecbdd4155a, 0xd4b38051424100f3, 0xdaa9178d23f97171, 0x4f48775ce3fbabce,
+        0x09d6c26f404d834f, 0xfedced7b12c55ca5, 0x751f009ea1e2cc78, 0x76f33afbc359a209,
+        0xcdc41056ce1c49b5, 0xe1f4550b51d77231, 0xde70dc3fe6ad623f, 0x61c5f1d38aee1e4b,
+        0x16f40cf5f55087ce, 0x4184a3a22312e249, 0x52bf683a5d10a464, 0xff0f001d449dfa0e,
+        0xc93ef80b62f2accf, 0x67ea026a2e5bd05f, 0x2787a1a2b0759a7e, 0x91e25f3c357977a9,
+        0x846d57ffa4324593, 0xaa6deb99df54ad96, 0x6cc9978b8ced3f73, 0x39eef38e57bcffde,
+        0x6cac2d431bf6c065, 0xf6043b6ae2ea3cdb, 0x6b14c61b66631707, 0x288f4953f97ea6ea,
+        0x5f446a8f8952e324, 0x1e6e03eab2988767, 0xf5900ae2f41aada1, 0xd20112333bff5171,
+        0x61fda7447678c042, 0x4e92645fc9e1d0fb, 0x4787b26b5a5fc9d2, 0x49b974ef6a67deea,
+        0x25c86b5e7fe558c3, 0x5001e32e5139d112, 0x68e5bfde9a6e8ad7, 0x9cbea85780ee1e6c,
+        0x63999d99957c68c0, 0x553054974a91a34c, 0xfca842742d060c16, 0x392656990c78f9d7,
+        0x6bf1dc76acb04bae, 0x63640e6b8c816fdf, 0x7f2b3d27be7496d6, 0x329972c871da8db0,
+        0x0ee86305de65c60e, 0xd7dc7176667654d5, 0xbb60b1e9996eef29, 0x715e185a06d6ff59,
+        0xe36e3e754e5d703e, 0xa6708008709fc8c1, 0xad838e10e6cf36f4, 0x21c72530fcb4e899,
+        0xbf11bbc7fedf537f, 0x39135fc5a42f5031, 0x0858154c8c035ae8, 0x10b3f9b2dd6d5942,
+        0x043c85aa5ed2703f, 0x63d59a1c71c7e6a5, 0xcff831c2925456fb, 0x6338ba3d8490f900,
+        0x20595563d9351f0d, 0x2aa8681a3e4bda2e, 0xfe9dca36ce24fd5a, 0xb5447427836734c4,
+        0x0caa50cc122992d0, 0xb1adc725fdfd140b, 0xc442a837f0fd0998, 0xc01b21c09ed724d3,
+        0xb11fbd47c85d1d84, 0x839374d66d9f9cc2, 0xb4c903761c7c82a1, 0x22719eaae3d87383,
+        0xe143f8d3a152f0bf, 0xae03d6167810ee30, 0xc5b960a3b67f7efe, 0xd09d61f380dbcd6b,
+        0x9065a1cf243419cd, 0x922688e3ef307d13, 0x8be20a63255b0c73, 0x79f72924e925a325,
+        0x6054abdd65aedda4, 0x4378b2ddfe56f402, 0x00d517e60c17bc12, 0x00d85ab904c6b052,
+        0xa37225babdb0cad9, 0xdaf5a09717554fba, 0x0983ebafe6695fbe, 0xc554bf49297726f0,
+        0x20efd268e7da240e, 0x8ed529f82b873085, 0x2fb44e6eeb96b40a, 0x91cdcc78a5653c9f,
+        0x56593efc039eb833, 0x8e5bfc883edf6bf0, 0x2137517db6cc5f54, 0xefc93eaf805741f4,
+        0xbccf905719d42b8f, 0xbed57e5c1cf49bbe, 0xca2a2f0d68338459, 0xb47608e7c7200c51,
+        0xe02ebb6fc3535ac0, 0xbdadc863c74bde86, 0x5eb54892c5bca852, 0x63f068f0f685fb60,
+        0x01786856c37bc5a3, 0x0d81f1a5f5cd7441, 0xe8544f2dbb12a47c, 0x0453c6f62869a4d8,
+        0x7e34067eeec951d4, 0xeb039153e49e2d36, 0xffc6f8b842bd2407, 0x96467bee3cdfbc7a,
+        0x11e7a1c3af4e9159, 0x497b355ad08af0ce, 0xda6859ddbb4552e1, 0x58ea28368fdea56a,
+        0x93c5a1bf11fca287, 0xc9991645eaef42a8, 0xa62cd6651d01c010, 0x204621896e54e71c,
+        0x19401015d09b7e3c, 0x1632940cfdcc95a6, 0xab4d77bd0f4e8ab4, 0x14f411a6c04205eb,
+        0x931306a039c32fad, 0x22e29e58e8dfdc57, 0x38b25ce463a73461, 0xb6d78df748f4c077,
+        0xb489f03d3d479471, 0xe7fbaba7f46a5dbc, 0x19e7d23a93ea2fcf, 0xab252b3763e3c180,
+        0x82cc0721f1d3cd61, 0x59b69977ded3d535, 0x8e81be699be7df69, 0x51e273e76b4b8f19,
+        0xd2c00666a7da20a5, 0x3aa3f42b7b56a34c, 0x6413e9966d51c777, 0x4f25f1e8b7f9636e,
+        0x73ee27af5c78c0fe, 0x62d092b3d53a08e0, 0x59d78a83dca90d9f, 0x4dcfcc18b2d06641,
+        0x867532c37d9685df, 0x5bdb0cf2a545efc1, 0x6d2a6639298270f5, 0x4f21ff72dec17471,
+        0x46ed9a1efe1a447a, 0xbaaa584503a8f1f6, 0x36be935ef16d2c6a, 0xc642b169dbdc9789,
+        0xd965ab3732c64e1e, 0x22b6c76a8ef1ba98, 0x3381e2eccc7b2a5f, 0x9c90398fb4971c57,
+        0xcd48e624174adbcf, 0x64038e4de0094169, 0x7e76586f8316a2b0, 0xd14513dcd1f04a3f,
+        0x7ae94667fc22c1ec, 0x16a843b8ef94d8db, 0xcb30fc7dd4306c25, 0xee966119918cb833,
+        0x122ce1c6722c7f7f, 0x054a3db75f5aa0c0, 0x5798e13c42ded4ed, 0x89ae77ac9d44afa2,
+        0x90bf175c4dd8d6ac, 0xf3afcd52bd675a6a, 0xccf824490a079f7a, 0x2ca2b0764bdab32b,
+        0xf3e13333680e6fde, 0x4101314ca9332942, 0x9ece0a7eb9d3a198, 0x3613439f0ea15d16,
+        0x4624ac96c62c6bf2, 0x20103213aa6906de, 0x0663cbbb35a6e8a7, 0xb95240d3a0d00956,
+        0x7e147706b5aa422e, 0x33fd28fe593d0d90, 0x3fd2ab1c1fb4ea26, 0xc97f0cd370cd45ac,
+        0xe1a4948374bd4e60, 0x64c9f00eb17deb99, 0x487ae521aaf9bf8a, 0x3f63827777438b85,
+        0xf0fd3016f58874f3, 0xa0357974ad5821b4, 0x8ff7af948c59e5b3, 0x4ee214fa00011452
       };
-      constexpr static u64 z_next[9] = {
-        0x6ca4fb9924f5a045, 0xd176cc9ca768faa0, 0xb42084b6140f7f20, 0x957a2ea15485eaac,
-        0xd57ece5c12f3ae29, 0xac649769a3ec6e58, 0x3d7cf30f45f15b15, 0x338bdc2ab1bcea44
+      // z_next: 10 zobrist keys
+      constexpr static u64 z_next[10] = {
+        0x4369a186242069c1, 0x8dc53e566a28e1ef, 0xf08370d803f9bb02, 0x0533213f07eb61c4,
+        0x3a230f2554c9d2be, 0xdd9e9f9f8f1d1973, 0x999dd2d56602f1aa, 0xbdcb64bdbea5cc53,
+        0xdf7219c7b2404b60, 0x7e57eba1ff6588e4
       };
+      // z_turn: 2 zobrist keys
       constexpr static u64 z_turn[2] = {
-        0x44629b8ae60b7ee7, 0x8bf20f6937e6ccd1
+        0xce0b5b904295db70, 0xf36a6167a5a28dee
       };
 
+      // a short initializer list leaves zeros behind, which hash to nothing
+      static_assert(z_x_board[pow2(9) - 1] && z_o_board[pow2(9) - 1] && z_next[9] && z_turn[1],
+                    "a zobrist table is missing keys");
+
+      // Every local shares the two tables, so each one's keys are rotated
+      // by a different amount; otherwise swapping two locals' contents
+      // wouldn't change the hash. tools/zobrist-check.cpp checks all this.
       u64 result = 0;
-      for (const Board& it : board.locals) {
-        result ^= z_x_board[it.x_board];
-        result ^= z_o_board[it.o_board];
+      for (int idx = 0; idx < 9; ++idx) {
+        const u64 keys = z_x_board[board.locals[idx].x_board] ^ z_o_board[board.locals[idx].o_board];
+        result ^= (keys << (7 * idx)) | (keys >> ((64 - 7 * idx) & 63));
       }
-      result ^= z_next[board.next];
+      result ^= z_next[board.next + 1];   // next is -1 when any local can be played
       result ^= z_turn[board.x_turn];
       return result;
     }
@@ -602,28 +2014,106 @@ public:
 };
 
 
-class MonteCarlo {
+#if TELEMETRY
+ostream& telemetrySink() {
+  static ofstream file;
+  if (*TELEMETRY_FILE == '\0') return cerr;
+  if (!file.is_open()) file.open(TELEMETRY_FILE, ios::app);
+  return file;
+}
+
+// everything MonteCarlo measures during one call to runSearch
+struct SearchStats {
+  using ns = chrono::nanoseconds;
+
+  int turn = -1;
+  size_t iterations = 0, rollouts = 0, rollout_plies = 0;
+  size_t transpositions = 0;            // expansions that reached a node already in the table
+  array<size_t, 82> depths{};           // leaf depth per iteration
+  ns select_time{}, expand_time{}, rollout_time{}, backprop_time{};
+  double reuse = 0.0;                   // fraction of last search's tree that survived re-rooting
+  size_t last_tree_size = 0;
+  time_point start, end, lap;
+
+  void begin(size_t tree_size) {
+    size_t prev_tree_size = last_tree_size;
+    int prev_turn = turn;
+    *this = SearchStats();
+    turn = prev_turn + 1;
+    reuse = (prev_tree_size) ? tof(tree_size) / prev_tree_size : 0.0;
+    start = lap = steady_clock::now();
+  }
+  void tick(ns& phase) {
+    time_point now = steady_clock::now();
+    phase += now - lap;
+    lap = now;
+  }
+  static double ms(ns d) { return d.count() / 1e6; }
+
+  void print(ostream& os, size_t tree_size, double best_share) const {
+    double secs = ms(end - start) / 1e3;
+    size_t max_depth = 0;
+    for (size_t d = 0; d < depths.size(); ++d) if (depths[d]) max_depth = d;
+    os << "{\"turn\":" << turn
+      << ",\"iterations\":" << iterations
+      << ",\"rollouts\":" << rollouts
+      << ",\"rollouts_per_sec\":" << ((secs > 0.0) ? rollouts / secs : 0.0)
+      << ",\"avg_rollout_len\":" << ((rollouts) ? tof(rollout_plies) / rollouts : 0.f)
+      << ",\"depths\":[";
+    for (size_t d = 0; d <= max_depth; ++d) os << ((d) ? "," : "") << depths[d];
+    os << "],\"nodes\":" << tree_size
+      << ",\"transposition_hits\":" << transpositions
+      << ",\"reuse\":" << reuse
+      << ",\"ms\":{\"select\":" << ms(select_time)
+      << ",\"expand\":" << ms(expand_time)
+      << ",\"rollout\":" << ms(rollout_time)
+      << ",\"backprop\":" << ms(backprop_time)
+      << ",\"total\":" << ms(end - start)
+      << "},\"best_visit_share\":" << best_share << "}\n";
+  }
+};
+#endif
+
+enum RolloutPolicy {
+  random_playout, // uniformly random moves
+  heavy_playout,  // take game wins, then local wins, then block local wins
+};
+
+// The search graph is a DAG: position_table hands out one Node per position,
+// so transpositions share a Node between several parents.
+// Stats are kept at two levels so that sharing never skews selection:
+//  - Node::sims/wins count every rollout that passed through the position,
+//    whichever parent it came from. They give the move's value, so a
+//    transposed subtree contributes everything it already knows.
+//  - Child::visits counts only rollouts that went through that edge.
+//    It drives exploration, and a node's edge visits always sum to the
+//    number of times an iteration went on past it.
+template <template <class> class Allocator>
+class BasicMonteCarlo {
   struct Node {
     struct Child {
       Node* child;
-      Node* parent;
       int move;
       int visits;
-      Child(Node* child, Node* parent, int move) : child(child), parent(parent), move(move), visits(0) {}
-      float ucb1() const {
+      Child(Node* child, int move) : child(child), move(move), visits(0) {}
+      float ucb1(float log_parent_visits) const {
         constexpr static float bias = 1.41421356237f;//sqrt(2);
-        return (tof(child->wins) / child->sims) + bias * sqrt(tof(parent->sims) / visits);
+        return (tof(child->wins) / child->sims) + bias * sqrt(log_parent_visits / visits);
       }
     };
     UltimateBoard board;
-    int sims, wins;
-    vector<Child> children;
+    int sims, wins;                 // over every path into this position
+    vector<Child, Allocator<Child>> children;
 
     int parent_count;               // for maintenance of the transposition table
-    Node(const UltimateBoard& board) : board(board), children(), parent_count(1) {}
+    Node(const UltimateBoard& board) : board(board), sims(0), wins(0), children(), parent_count(1) {}
   };
+  using Child = typename Node::Child;
+  // a game is at most 81 moves, so no path from the root is longer
+  using VisitedStack = inline_stack<Child*, 81>;
 public:
-  MonteCarlo(const UltimateBoard& state) : position_table(103), root(&emplace(state)), rng() {
+  BasicMonteCarlo(const UltimateBoard& state, RolloutPolicy policy = heavy_playout)
+    : position_table(103), root(&emplace(state)), rng(), policy(policy) {
     rng.seed(chrono::high_resolution_clock::now().time_since_epoch().count());
   }
 
@@ -654,42 +2144,65 @@ public:
     }
   }
 
-  size_t runSearch(time_point timeout) {
+  // searches until `timeout`, or until max_iterations if that comes first
+  // (tools/gen-tables-uttt.cpp stops on a count, so its books don't depend
+  // on how fast the machine is)
+  size_t runSearch(time_point timeout, size_t max_iterations = SIZE_MAX) {
     size_t loop_count = 0;
-    MoveVector moves;       // this vector gets passed down the stack to avoid constructor/destructor thrashing
-    moves.reserve(81);
-    stack<Node*> visited;
-    while (steady_clock::now() < timeout) {
+    telemetry(stats.begin(position_table.size()));
+    MoveVector moves;
+    VisitedStack visited;   // edges taken from the root this iteration
+    while (loop_count < max_iterations && steady_clock::now() < timeout) {
       Node* node = root;
+      telemetry(stats.lap = steady_clock::now());
 
-      // selection phase
-      while (node->children.size() == node->board.getNumMoves() && node->children.size() != 0) {
-        visited.push(node);
-        node = selectNext(node);
-      }
+      while (true) {
+        // selection phase
+        while (node->children.size() == size_t(node->board.getNumMoves()) && node->children.size() != 0) {
+          visited.push(selectNext(node));
+          node = visited.top()->child;
+        }
+        telemetry(stats.tick(stats.select_time));
 
-      // expansion phase
-      Board b = node->board.getGlobal();
-      if (lookup2d(winState, b.x_board, b.o_board) == ongoing && node->board.getNumMoves() > 0) {
-        node = expand(node, visited, moves);
+        // expansion phase
+        Board b = node->board.getGlobal();
+        if (lookup2d(winState, b.x_board, b.o_board) != ongoing || node->board.getNumMoves() == 0) break;
+        visited.push(expand(node, moves));
+        node = visited.top()->child;
         moves.clear();
+        // a transposition into a position that already has rollouts behind it
+        // doesn't need another one yet; keep descending through its subtree
+        if (node->sims == 0) break;
+        telemetry(stats.tick(stats.expand_time));
       }
+      telemetry(++stats.depths[visited.size()]; stats.tick(stats.expand_time));
 
+      // rollout phase
+      int x_wins = 0, o_wins = 0;
       for (int i = 0; i < NUM_ROLLOUTS; i++) {
-        // rollout phase
-        WinState outcome = rollout(node, moves);
-
-        // backprop phase
-        backprop(node, outcome, visited);
+        switch (rollout(node)) {
+        case x_won: ++x_wins; break;
+        case o_won: ++o_wins; break;
+        default: break;
+        }
       }
+      telemetry(stats.tick(stats.rollout_time));
+
+      // backprop phase
+      backprop(root, x_wins, o_wins, visited);
+      telemetry(stats.tick(stats.backprop_time));
 
       ++loop_count;
     }
+    telemetry(stats.end = steady_clock::now();
+      stats.iterations = loop_count;
+      stats.rollouts = loop_count * NUM_ROLLOUTS;
+      stats.last_tree_size = position_table.size());
     return loop_count;
   }
 
   int getBest() {
-    Node::Child* best = nullptr;
+    Child* best = nullptr;
     int most_visits = -1;
     for (auto& child : root->children) {
       if (child.visits > most_visits) {
@@ -700,13 +2213,40 @@ public:
     return best->move;
   }
 
+  // For bench/uttt.cpp: a rollout from the root with nothing else of the
+  // search around it, and a seed so that it plays the same games every run.
+  void seed(u64 seed) { rng.seed(seed); }
+  WinState rolloutFromRoot() { return rollout(root); }
+
+#if TELEMETRY
+  // one JSON line describing the last search
+  void report(ostream& os) const {
+    int total_visits = 0, most_visits = 0;
+    for (auto& child : root->children) {
+      total_visits += child.visits;
+      most_visits = max(most_visits, child.visits);
+    }
+    stats.print(os, position_table.size(), (total_visits) ? tof(most_visits) / total_visits : 0.f);
+    os.flush();
+  }
+#endif
+
 private:
-  unordered_map<UltimateBoard, Node, UltimateBoard::hash> position_table;
+  unordered_map<UltimateBoard, Node, UltimateBoard::hash, equal_to<UltimateBoard>,
+                Allocator<pair<const UltimateBoard, Node>>> position_table;
   Node* root;
-  mt19937_64 rng;
+  Pcg32 rng;
+  RolloutPolicy policy;
+#if TELEMETRY
+  SearchStats stats;
+#endif
 
   inline Node& emplace(const UltimateBoard& state) {
     auto [it, worked] = position_table.emplace(state, Node(state));
+    if (!worked) {
+      ++it->second.parent_count;   // transposition: one more parent shares this node
+      telemetry(++stats.transpositions);
+    }
     return it->second;
   }
 
@@ -719,140 +2259,218 @@ private:
     position_table.erase(node->board);
   }
 
-  static Node* selectNext(Node* node) {
+  static Child* selectNext(Node* node) {
+    int parent_visits = 0;
+    for (const auto& child : node->children) parent_visits += child.visits;
+    float log_parent_visits = log(tof(parent_visits));
+
     auto it = node->children.begin();
     auto best = it;
-    float best_score = best->ucb1();
+    float best_score = best->ucb1(log_parent_visits);
     for (; it != node->children.end(); ++it) {
-      float score = it->ucb1();
+      float score = it->ucb1(log_parent_visits);
       if (score > best_score) {
         best = it;
         best_score = score;
       }
     }
-    best->visits += NUM_ROLLOUTS;
-    return best->child;
+    return &*best;
   }
 
-  Node* expand(Node* node, stack<Node*>& visited, MoveVector& moves) {
+  Child* expand(Node* node, MoveVector& moves) {
     node->board.getMoves(moves);
-    size_t move_idx = 1 + (rng() % (moves.size() - node->children.size()));
-    int next_move;
+    size_t move_idx = 1 + (bounded(rng, moves.size() - node->children.size()));
+    int next_move = moves[0];
     for (int& move : moves) {
       bool already_tried = false;
       for (auto& it : node->children) {
         if (it.move == move) already_tried = true;
       }
-      if (!already_tried) {
-        --move_idx;
-        if (move_idx == 0) next_move = move;
+      if (!already_tried && --move_idx == 0) {
+        next_move = move;
+        break;
       }
     }
     Node* next_node = &emplace(node->board.copy().mark(globalIdxToLocalIdx_idx(next_move)));
-    node->children.push_back({ next_node, node, next_move });
+    node->children.push_back({ next_node, next_move });
     moves.clear();
-    return next_node;
+    return &node->children.back();
   }
 
-  WinState rollout(const Node* node, MoveVector& moves) {
+  WinState rollout(const Node* node) {
     UltimateBoard board = node->board;
     Board glob = board.getGlobal();
-    while (!lookup2d(isTerminal, glob.x_board, glob.o_board) && board.getNumMoves() > 0) {
-      if (board.next != -1) {
-        EasyWin w = lookup2d(easyWin, board.locals[board.next].x_board, board.locals[board.next].o_board);
-        if (board.x_turn && w == easy_x) return x_won;
-        else if (!board.x_turn && w == easy_o) return o_won;
-      }
-      else {
-        for (int i = 0; i < 9; ++i) {
-          EasyWin w = lookup2d(easyWin, board.locals[i].x_board, board.locals[i].o_board);
-          if (board.x_turn && w == easy_x) return x_won;
-          else if (!board.x_turn && w == easy_o) return o_won;
-        }
-      }
-      board.getMoves(moves);
-      int next_move = moves[rng() % moves.size()];
+    while (!lookupBit2d(isTerminal, glob.x_board, glob.o_board) && board.getNumMoves() > 0) {
+      int next_move = (policy == heavy_playout)
+        ? heavyMove(board, glob)
+        : randomMove(board);
       board.mark(globalIdxToLocalIdx_idx(next_move));
       glob = board.getGlobal();
-      moves.clear();
+      telemetry(++stats.rollout_plies);
     }
     WinState out = lookup2d(winState, glob.x_board, glob.o_board);
     if (out == ongoing) return draw;  // the global may be ongoing but there still aren't any moves left
     else return out;
   }
 
-  static void backprop(Node* node, WinState outcome, stack<Node*>& visited) {
-    bool winner_node = false;
-    bool winning_outcome = outcome == x_won || outcome == o_won;
-    do {
-      ++node->sims;
-      if (winner_node && winning_outcome) ++node->wins;
-      winner_node = !winner_node;
-      if (visited.empty()) break;
-      node = visited.top();
+  int randomMove(const UltimateBoard& board) {
+    return board.getMove(bounded(rng, board.getNumMoves()));
+  }
+
+  // Takes a local win that also wins the game, then any local win, then
+  // blocks a local win for the opponent, otherwise plays randomly.
+  // The checks cost at most 2 winningSquares lookups per playable local,
+  // so a ply never does more than 18 of them on top of the random fallback.
+  int heavyMove(const UltimateBoard& board, const Board& glob) {
+    bb open_locals = ~(glob.x_board | glob.o_board) & ones(9);
+    bb playable = (board.next != -1
+      && !lookupBit2d(isTerminal, board.locals[board.next].x_board, board.locals[board.next].o_board))
+      ? localIdxToBB(board.next)
+      : open_locals;
+    bb game_winners = lookup(winningSquares, board.x_turn ? glob.x_board : glob.o_board) & open_locals;
+
+    int local_win = -1, block = -1;
+    for (int local_idx : setBits(playable)) {
+      const Board& local = board.locals[local_idx];
+      bb mine = board.x_turn ? local.x_board : local.o_board;
+      bb theirs = board.x_turn ? local.o_board : local.x_board;
+      bb empty = ~(mine | theirs) & ones(9);
+
+      bb wins = lookup(winningSquares, mine) & empty;
+      if (wins) {
+        int move = localIdxToGlobalIdx_idx(indexLS1B(wins), local_idx);
+        if (game_winners & localIdxToBB(local_idx)) return move;
+        if (local_win == -1) local_win = move;
+      }
+      else if (block == -1) {
+        bb blocks = lookup(winningSquares, theirs) & empty;
+        if (blocks) block = localIdxToGlobalIdx_idx(indexLS1B(blocks), local_idx);
+      }
+    }
+
+    if (local_win != -1) return local_win;
+    if (block != -1) return block;
+    return randomMove(board);
+  }
+
+  // Walks the edges taken this iteration, counting the visit on each edge and
+  // crediting the position it leads to with the rollouts won by the player
+  // who moved there.
+  static void backprop(Node* root, int x_wins, int o_wins, VisitedStack& visited) {
+    // x_turn means X moves next, so O made the move that led here
+    auto mover_wins = [=](const Node* node) { return (node->board.x_turn) ? o_wins : x_wins; };
+    root->sims += NUM_ROLLOUTS;
+    root->wins += mover_wins(root);
+    while (!visited.empty()) {
+      Child* edge = visited.top();
       visited.pop();
-    } while (true);
+      edge->visits += NUM_ROLLOUTS;
+      edge->child->sims += NUM_ROLLOUTS;
+      edge->child->wins += mover_wins(edge->child);
+    }
   }
 };
+using MonteCarlo = BasicMonteCarlo<NODE_ALLOCATOR>;
 
 void validateMovegen(UltimateBoard& board) {
   bool is_valid = true;
-  vector<int> generated_moves;
+  timeScope("validateMovegen");
+  MoveVector generated_moves;
   board.getMoves(generated_moves);
   int valid_action_count;
-  cin >> valid_action_count; cin.ignore();
-  if (valid_action_count != generated_moves.size()) {
-    cerr << "Incorrect number of moves!" << endl;
+  fast_in >> valid_action_count;
+  if (valid_action_count != int(generated_moves.size())) {
+    logError("Incorrect number of moves!");
     is_valid = false;
   }
-  vector<int> given_moves;
+  MoveVector given_moves;
   int row, col;
   for (int i = 0; i < valid_action_count; ++i) {
-    cin >> row >> col; cin.ignore();
+    fast_in >> row >> col;
     given_moves.push_back(globalXyToIdx(col, row));
     if (find(generated_moves.begin(), generated_moves.end(), globalXyToIdx(col, row)) == generated_moves.end()) {
-      cerr << "Failed to generate valid move: " << col << ' ' << row << endl;
+      logError("Failed to generate valid move: " << col << ' ' << row);
       is_valid = false;
     }
   }
   for (int& it : generated_moves) {
     if (find(given_moves.begin(), given_moves.end(), it) == given_moves.end()) {
-      cerr << "Generated invalid move: " << globalIdxToX(it) << ' ' << globalIdxToY(it) << endl;
+      logError("Generated invalid move: " << globalIdxToX(it) << ' ' << globalIdxToY(it));
       is_valid = false;
     }
   }
   if (!is_valid) {
-    cerr << "generated:\n";
-    for (auto& it : generated_moves) {
-      cerr << "  " << globalIdxToX(it) << ' ' << globalIdxToY(it) << '\n';
-    }
-    cerr << "valid:\n";
-    for (auto& it : given_moves) {
-      cerr << "  " << globalIdxToX(it) << ' ' << globalIdxToY(it) << '\n';
-    }
+    ostringstream moves;
+    moves << "generated:";
+    for (auto& it : generated_moves) moves << "  " << globalIdxToX(it) << ' ' << globalIdxToY(it);
+    moves << "\nvalid:    ";
+    for (auto& it : given_moves) moves << "  " << globalIdxToX(it) << ' ' << globalIdxToY(it);
+    logError(moves.str());
     throw std::runtime_error("Invalid move generation");
   }
 }
 
+#if ARENA
+
+// Self-play between the two rollout policies at equal time per move.
+// Reports the heavy policy's score and how many rollouts each side
+// manages per millisecond of CPU time.
+int main() {
+  int heavy_wins = 0, random_wins = 0, draws = 0;
+  double cpu_ms[2] = { 0.0, 0.0 };
+  size_t rollouts[2] = { 0, 0 };
+  for (int game = 0; game < ARENA_GAMES; ++game) {
+    UltimateBoard board;
+    MonteCarlo players[2] = { MonteCarlo(board, heavy_playout), MonteCarlo(board, random_playout) };
+    bool heavy_is_x = game % 2 == 0;
+    Board glob = board.getGlobal();
+    while (!lookupBit2d(isTerminal, glob.x_board, glob.o_board) && board.getNumMoves() > 0) {
+      int side = (board.x_turn == heavy_is_x) ? 0 : 1;
+      clock_t cpu_start = clock();
+      rollouts[side] += NUM_ROLLOUTS * players[side].runSearch(steady_clock::now() + milliseconds(ARENA_MOVE_MS));
+      cpu_ms[side] += 1000.0 * (clock() - cpu_start) / CLOCKS_PER_SEC;
+      int best = players[side].getBest();
+      board.mark(globalIdxToLocalIdx_idx(best));
+      players[0].updateState(board);
+      players[1].updateState(board);
+      glob = board.getGlobal();
+    }
+    WinState outcome = lookup2d(winState, glob.x_board, glob.o_board);
+    if (outcome == x_won) ++(heavy_is_x ? heavy_wins : random_wins);
+    else if (outcome == o_won) ++(heavy_is_x ? random_wins : heavy_wins);
+    else ++draws;
+  }
+  cout << "heavy vs random, " << ARENA_GAMES << " games at " << ARENA_MOVE_MS << "ms/move\n"
+    << "  heavy wins: " << heavy_wins << ", random wins: " << random_wins << ", draws: " << draws << '\n'
+    << "  heavy:  " << rollouts[0] << " rollouts, " << rollouts[0] / cpu_ms[0] << " rollouts/cpu-ms\n"
+    << "  random: " << rollouts[1] << " rollouts, " << rollouts[1] / cpu_ms[1] << " rollouts/cpu-ms" << endl;
+  return 0;
+}
+
+#else
+
 int main() {
   UltimateBoard board;
   int opponent_row = -1, opponent_col = -1;
-  cin >> opponent_row >> opponent_col; cin.ignore();
+  fast_in >> opponent_row >> opponent_col;
   if (opponent_row != -1 && opponent_col != -1) {
     board.mark(globalIdxToLocalIdx_idx(globalXyToIdx(opponent_col, opponent_row)));
   }
   validateMovegen(board);
   time_point start = steady_clock::now();
   MonteCarlo mcts(board);
-  auto nsims = mcts.runSearch(start + milliseconds(950));
+  [[maybe_unused]] auto nsims = mcts.runSearch(start + milliseconds(950));
   while (true) {
-    cerr << "Performed " << nsims << " expansions" << endl;
+    logInfo("Performed " << nsims << " expansions");
     int best = mcts.getBest();
-    cout << globalIdxToY(best) << ' ' << globalIdxToX(best) << endl;
+    telemetry(mcts.report(telemetrySink()));
+    fast_out << globalIdxToY(best) << ' ' << globalIdxToX(best) << '\n';
+    fast_out.flush();
+    instrTurnEnd();
     board.mark(globalIdxToLocalIdx_idx(best));
     mcts.updateState(board);
 
-    cin >> opponent_row >> opponent_col; cin.ignore();
+    fast_in >> opponent_row >> opponent_col;
     board.mark(globalIdxToLocalIdx_idx(globalXyToIdx(opponent_col, opponent_row)));
     validateMovegen(board);
     start = steady_clock::now();
@@ -861,3 +2479,5 @@ int main() {
   }
   return 0;
 }
+
+#endif
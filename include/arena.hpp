@@ -0,0 +1,286 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// arena.hpp
+namespace kel {
+  // Allocators for lots of small objects that are made and thrown away
+  // together (search trees, graphs, populations):
+  //   Arena          bump allocation out of big chunks, freed all at once
+  //   BlockPool      fixed-size blocks with a free list, carved from an Arena
+  //   ObjectPool<T>  a BlockPool that constructs and destroys Ts
+  //   PoolAllocator  an STL allocator over per-thread BlockPools, one per
+  //                  size class; pass it as a container's allocator (or as
+  //                  the `Allocator` template parameter of a bot's tree) to
+  //                  keep its nodes together and off malloc
+  //   ArenaResource  an Arena as a std::pmr::memory_resource
+
+  enum class PageBacking {
+    heap,         // plain malloc'd chunks
+    huge_pages,   // 2 MiB aligned chunks with transparent huge pages asked for (Linux); fewer TLB misses in big trees
+  };
+
+  constexpr size_t huge_page_bytes = size_t(2) << 20;
+
+  inline void* allocatePages(size_t bytes, PageBacking backing) {
+    if (backing == PageBacking::huge_pages) {
+      bytes = (bytes + huge_page_bytes - 1) & ~(huge_page_bytes - 1);
+      void* ptr = std::aligned_alloc(huge_page_bytes, bytes);
+      if (!ptr) throw std::bad_alloc();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+      madvise(ptr, bytes, MADV_HUGEPAGE);   // only a hint; without THP these are still normal pages
+#endif
+      return ptr;
+    }
+    void* ptr = std::malloc(bytes);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+  }
+
+  // Bump allocator: each allocation is a pointer increment into the current
+  // chunk, and nothing is freed until reset() or release().
+  class Arena {
+  public:
+    explicit Arena(size_t chunk_bytes = size_t(1) << 20, PageBacking backing = PageBacking::heap) noexcept
+      : chunk_bytes(chunk_bytes), backing(backing) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() { release(); }
+
+    // `align` has to be a power of 2
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+      size_t start = alignedOffset(align);
+      if (!head || start + bytes > head->size) {
+        grow(bytes + align);
+        start = alignedOffset(align);
+      }
+      used = start + bytes;
+      return reinterpret_cast<char*>(head) + start;
+    }
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+      return ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // forget everything allocated so far, but keep the first chunk to reuse
+    void reset() noexcept {
+      while (head && head->next) {
+        Chunk* next = head->next;
+        std::free(head);
+        head = next;
+      }
+      used = sizeof(Chunk);
+    }
+    // give every chunk back
+    void release() noexcept {
+      while (head) {
+        Chunk* next = head->next;
+        std::free(head);
+        head = next;
+      }
+      used = 0;
+    }
+    // for chunks allocated from now on
+    void setBacking(PageBacking new_backing) noexcept { backing = new_backing; }
+
+    size_t bytesReserved() const noexcept {
+      size_t total = 0;
+      for (Chunk* chunk = head; chunk; chunk = chunk->next) total += chunk->size;
+      return total;
+    }
+
+  private:
+    struct alignas(std::max_align_t) Chunk {
+      Chunk* next;
+      size_t size;
+    };
+    Chunk* head = nullptr;
+    size_t used = 0;          // bytes of head in use, its header included
+    size_t chunk_bytes;
+    PageBacking backing;
+
+    size_t alignedOffset(size_t align) const noexcept {
+      const size_t base = reinterpret_cast<size_t>(head);
+      return ((base + used + align - 1) & ~(align - 1)) - base;
+    }
+    void grow(size_t min_bytes) {
+      size_t size = sizeof(Chunk) + min_bytes;
+      if (size < chunk_bytes) size = chunk_bytes;
+      if (backing == PageBacking::huge_pages) size = (size + huge_page_bytes - 1) & ~(huge_page_bytes - 1);
+      Chunk* chunk = static_cast<Chunk*>(allocatePages(size, backing));
+      chunk->next = head;
+      chunk->size = size;
+      head = chunk;
+      used = sizeof(Chunk);
+    }
+  };
+
+  // Fixed-size blocks: freed ones go on an intrusive free list and come back
+  // out first, so a pool that's churning stays the size of its peak.
+  class BlockPool {
+  public:
+    explicit BlockPool(size_t block_bytes, size_t chunk_bytes = size_t(1) << 20, PageBacking backing = PageBacking::heap) noexcept
+      : arena(chunk_bytes, backing), block_bytes(block_bytes < sizeof(FreeBlock) ? sizeof(FreeBlock) : block_bytes) {}
+
+    void* allocate() {
+      if (free_list) {
+        FreeBlock* block = free_list;
+        free_list = block->next;
+        return block;
+      }
+      return arena.allocate(block_bytes, alignof(std::max_align_t));
+    }
+    void deallocate(void* ptr) noexcept {
+      FreeBlock* block = static_cast<FreeBlock*>(ptr);
+      block->next = free_list;
+      free_list = block;
+    }
+    // every block is free again; whatever was in them isn't destroyed
+    void reset() noexcept {
+      free_list = nullptr;
+      arena.reset();
+    }
+    size_t blockBytes() const noexcept { return block_bytes; }
+    Arena& backingArena() noexcept { return arena; }
+
+  private:
+    struct FreeBlock {
+      FreeBlock* next;
+    };
+    Arena arena;
+    FreeBlock* free_list = nullptr;
+    size_t block_bytes;
+  };
+
+  template <class T>
+  class ObjectPool {
+  public:
+    static_assert(alignof(T) <= alignof(std::max_align_t), "ObjectPool: over-aligned types aren't supported");
+
+    explicit ObjectPool(size_t chunk_bytes = size_t(1) << 20, PageBacking backing = PageBacking::heap) noexcept
+      : blocks(sizeof(T), chunk_bytes, backing) {}
+
+    template <class... Args>
+    T* create(Args&&... args) {
+      void* ptr = blocks.allocate();
+      ++live;
+      return ::new (ptr) T(std::forward<Args>(args)...);
+    }
+    void destroy(T* obj) noexcept {
+      obj->~T();
+      blocks.deallocate(obj);
+      --live;
+    }
+    // drop every object at once without running their destructors, so only
+    // for trivially destructible Ts or ones that own nothing else
+    void reset() noexcept {
+      blocks.reset();
+      live = 0;
+    }
+    size_t size() const noexcept { return live; }
+
+  private:
+    BlockPool blocks;
+    size_t live = 0;
+  };
+
+  // One BlockPool per 16-byte size class up to max_bytes; bigger requests go
+  // to operator new.
+  class SizeClassPools {
+  public:
+    static constexpr size_t granularity = 16, max_bytes = 1024;
+
+    SizeClassPools() : SizeClassPools(std::make_index_sequence<num_classes>()) {}
+
+    static constexpr bool pooled(size_t bytes) noexcept { return bytes <= max_bytes; }
+    void* allocate(size_t bytes) {
+      if (!pooled(bytes)) return ::operator new(bytes);
+      return pool(bytes).allocate();
+    }
+    void deallocate(void* ptr, size_t bytes) noexcept {
+      if (!pooled(bytes)) ::operator delete(ptr);
+      else pool(bytes).deallocate(ptr);
+    }
+    // for chunks allocated from now on, in every size class
+    void setBacking(PageBacking backing) noexcept {
+      for (BlockPool& p : pools) p.backingArena().setBacking(backing);
+    }
+
+  private:
+    static constexpr size_t num_classes = max_bytes / granularity;
+    BlockPool pools[num_classes];
+
+    // BlockPool has no default constructor, so each class gets its block size here
+    template <size_t... Idx>
+    explicit SizeClassPools(std::index_sequence<Idx...>) : pools{ BlockPool((Idx + 1) * granularity, size_t(64) << 10)... } {}
+    BlockPool& pool(size_t bytes) noexcept { return pools[(bytes ? bytes - 1 : 0) / granularity]; }
+  };
+
+  // This thread's pools. They're never destroyed, on purpose: a block can
+  // outlive its thread (freed by another one) or be freed by a static's
+  // destructor after this one would have run.
+  inline SizeClassPools& threadPools() {
+    thread_local SizeClassPools* pools = new SizeClassPools();
+    return *pools;
+  }
+
+  // Stateless, so every PoolAllocator compares equal and containers need no
+  // constructor arguments to use it. Blocks go back to whichever thread frees
+  // them.
+  template <class T>
+  struct PoolAllocator {
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <class U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+      if constexpr (alignof(T) > alignof(std::max_align_t)) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+      }
+      else return static_cast<T*>(threadPools().allocate(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) noexcept {
+      if constexpr (alignof(T) > alignof(std::max_align_t)) {
+        ::operator delete(ptr, std::align_val_t(alignof(T)));
+      }
+      else threadPools().deallocate(ptr, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template <class U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+  };
+
+  // An Arena behind std::pmr: deallocate is a no-op and release() frees
+  // everything, like std::pmr::monotonic_buffer_resource but with the
+  // Arena's chunk size and page backing.
+  class ArenaResource : public std::pmr::memory_resource {
+  public:
+    explicit ArenaResource(size_t chunk_bytes = size_t(1) << 20, PageBacking backing = PageBacking::heap) noexcept
+      : arena(chunk_bytes, backing) {}
+
+    void release() noexcept { arena.reset(); }
+    Arena& backingArena() noexcept { return arena; }
+
+  private:
+    Arena arena;
+
+    void* do_allocate(size_t bytes, size_t align) override { return arena.allocate(bytes, align); }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+  };
+}
+
+#endif
@@ -0,0 +1,266 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// bench.hpp
+namespace kel {
+  // Micro-benchmarks for the hot paths, so a change that slows one of them
+  // down shows up as a number instead of as a bot that got worse for no
+  // obvious reason.
+  //
+  //   int main(int argc, char** argv) {
+  //     BenchRunner bench("uttt", argc, argv);
+  //     bench.run("getMoves", [&] { board.getMoves(moves); doNotOptimize(moves); });
+  //     bench.run("simFrame", [&] { ...100 frames... }, 100);   // ops per call
+  //     return bench.finish();
+  //   }
+  //
+  // Each benchmark is warmed up, then called in batches long enough to time
+  // well (sample_us), and every batch gives one sample of nanoseconds per op.
+  // The samples are summarised as a line of the table; finish() writes them
+  // all out as JSON and compares the medians with an earlier run if it was
+  // asked to, and returns 1 if anything got slower by more than the noise.
+  //
+  //   --filter=TEXT     only the benchmarks with TEXT in their name
+  //   --samples=N       batches per benchmark (31)
+  //   --sample-us=N     how long a batch should take (2000)
+  //   --warmup-ms=N     how long to run each one before timing it (100)
+  //   --json=FILE       write every sample to FILE
+  //   --compare=FILE    compare with the --json of an earlier run
+  //   --threshold=PCT   how much slower counts as a regression (5)
+
+  // Makes the compiler treat `value` as read (and, for a non-const one,
+  // written) by something it can't see, so the work that produced it isn't
+  // thrown away or hoisted out of the timing loop.
+  template <class T>
+  inline void doNotOptimize(const T& value) noexcept {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+  template <class T>
+  inline void doNotOptimize(T& value) noexcept {
+    asm volatile("" : "+m,r"(value) : : "memory");
+  }
+  // makes every store so far happen before whatever comes next
+  inline void clobberMemory() noexcept { asm volatile("" : : : "memory"); }
+
+  struct BenchResult {
+    std::string name;
+    double ops_per_call;
+    size_t calls_per_sample;
+    std::vector<double> samples;   // ns per op, in the order they were taken
+    double min, median, mean, stddev;
+    double mad;                    // median absolute deviation from the median
+
+    void summarise() {
+      std::vector<double> sorted = samples;
+      std::sort(sorted.begin(), sorted.end());
+      min = sorted.front();
+      median = medianOf(sorted);
+      mean = 0;
+      for (double sample : sorted) mean += sample;
+      mean /= sorted.size();
+      stddev = 0;
+      for (double sample : sorted) stddev += (sample - mean) * (sample - mean);
+      stddev = (sorted.size() > 1) ? std::sqrt(stddev / (sorted.size() - 1)) : 0;
+      for (double& sample : sorted) sample = std::abs(sample - median);
+      std::sort(sorted.begin(), sorted.end());
+      mad = medianOf(sorted);
+    }
+
+  private:
+    static double medianOf(const std::vector<double>& sorted) {
+      size_t mid = sorted.size() / 2;
+      return (sorted.size() % 2) ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2;
+    }
+  };
+
+  class BenchRunner {
+  public:
+    BenchRunner(std::string suite, int argc, char** argv) : suite(std::move(suite)) {
+      for (int arg = 1; arg < argc; ++arg) {
+        std::string opt = argv[arg];
+        if (option(opt, "--filter=", filter)) continue;
+        if (option(opt, "--json=", json_file)) continue;
+        if (option(opt, "--compare=", compare_file)) continue;
+        std::string number;
+        if (option(opt, "--samples=", number)) num_samples = std::max(1, std::atoi(number.c_str()));
+        else if (option(opt, "--sample-us=", number)) sample_us = std::atof(number.c_str());
+        else if (option(opt, "--warmup-ms=", number)) warmup_ms = std::atof(number.c_str());
+        else if (option(opt, "--threshold=", number)) threshold_pct = std::atof(number.c_str());
+        else {
+          std::cerr << "unknown option " << opt << "; see bench.hpp for the list\n";
+          std::exit(2);
+        }
+      }
+#ifndef __OPTIMIZE__
+      std::cerr << "warning: " << this->suite << " was built without optimisation; its numbers don't mean much\n";
+#endif
+      std::cout << std::left << std::setw(name_width) << this->suite << std::right
+        << std::setw(12) << "median" << std::setw(10) << "+-mad" << std::setw(12) << "min"
+        << std::setw(12) << "mean" << std::setw(10) << "+-sd" << "   batch\n";
+    }
+
+    // Times fn(), which does `ops_per_call` of whatever's being measured.
+    // Anything it needs set up should be done before the call, and anything
+    // it has to reset between calls counts towards its time.
+    template <class Fn>
+    void run(const std::string& name, Fn&& fn, double ops_per_call = 1.0) {
+      using Clock = std::chrono::steady_clock;
+      if (!filter.empty() && name.find(filter) == std::string::npos) return;
+
+      // warm up the caches, the branch predictors and the clock speed, and
+      // find out roughly how long a call takes
+      size_t warmup_calls = 0;
+      Clock::time_point start = Clock::now();
+      std::chrono::duration<double, std::nano> elapsed;
+      do {
+        fn();
+        ++warmup_calls;
+        elapsed = Clock::now() - start;
+      } while (elapsed.count() < warmup_ms * 1e6);
+
+      BenchResult result;
+      result.name = name;
+      result.ops_per_call = ops_per_call;
+      result.calls_per_sample = std::max<size_t>(1, size_t(sample_us * 1e3 * warmup_calls / elapsed.count()));
+      for (int sample = 0; sample < num_samples; ++sample) {
+        start = Clock::now();
+        for (size_t call = 0; call < result.calls_per_sample; ++call) fn();
+        clobberMemory();
+        elapsed = Clock::now() - start;
+        result.samples.push_back(elapsed.count() / (result.calls_per_sample * ops_per_call));
+      }
+      result.summarise();
+
+      std::cout << std::left << std::setw(name_width) << name << std::right
+        << std::setw(12) << formatNs(result.median) << std::setw(10) << formatNs(result.mad)
+        << std::setw(12) << formatNs(result.min) << std::setw(12) << formatNs(result.mean)
+        << std::setw(10) << formatNs(result.stddev) << "   " << result.calls_per_sample << " x " << num_samples << '\n';
+      results.push_back(std::move(result));
+    }
+
+    const std::vector<BenchResult>& getResults() const { return results; }
+
+    // 1 if --compare found a regression, 0 otherwise
+    int finish() {
+      if (results.empty()) std::cout << "(nothing matched --filter=" << filter << ")\n";
+      if (!json_file.empty()) writeJson();
+      return compare_file.empty() ? 0 : compare();
+    }
+
+  private:
+    static constexpr int name_width = 28;
+
+    std::string suite, filter, json_file, compare_file;
+    int num_samples = 31;
+    double sample_us = 2000, warmup_ms = 100, threshold_pct = 5;
+    std::vector<BenchResult> results;
+
+    static bool option(const std::string& arg, const char* prefix, std::string& value) {
+      size_t len = std::strlen(prefix);
+      if (arg.compare(0, len, prefix) != 0) return false;
+      value = arg.substr(len);
+      return true;
+    }
+    static std::string formatNs(double ns) {
+      const char* unit = " ns";
+      if (ns >= 1e6) ns /= 1e6, unit = " ms";
+      else if (ns >= 1e3) ns /= 1e3, unit = " us";
+      std::ostringstream out;
+      out << std::fixed << std::setprecision((ns < 10) ? 2 : (ns < 100) ? 1 : 0) << ns << unit;
+      return out.str();
+    }
+    static std::string quoted(const std::string& str) {
+      std::string out = "\"";
+      for (char c : str) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+      }
+      return out + '"';
+    }
+
+    // One benchmark to a line, so compare() doesn't need a real JSON parser.
+    void writeJson() const {
+      std::ofstream out(json_file);
+      if (!out) {
+        std::cerr << "can't write " << json_file << '\n';
+        return;
+      }
+      out << std::setprecision(6);
+      out << "{\n  \"suite\": " << quoted(suite) << ",\n  \"compiler\": " << quoted(__VERSION__)
+#ifdef __OPTIMIZE__
+        << ",\n  \"optimized\": true"
+#else
+        << ",\n  \"optimized\": false"
+#endif
+        << ",\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n";
+      for (size_t idx = 0; idx < results.size(); ++idx) {
+        const BenchResult& result = results[idx];
+        out << "    {\"name\": " << quoted(result.name) << ", \"ops_per_call\": " << result.ops_per_call
+          << ", \"calls_per_sample\": " << result.calls_per_sample << ", \"min\": " << result.min
+          << ", \"median\": " << result.median << ", \"mean\": " << result.mean
+          << ", \"stddev\": " << result.stddev << ", \"mad\": " << result.mad << ", \"samples\": [";
+        for (size_t sample = 0; sample < result.samples.size(); ++sample) {
+          out << (sample ? ", " : "") << result.samples[sample];
+        }
+        out << "]}" << ((idx + 1 < results.size()) ? "," : "") << '\n';
+      }
+      out << "  ]\n}\n";
+    }
+
+    static double field(const std::string& line, const char* key) {
+      size_t at = line.find(std::string("\"") + key + "\": ");
+      return (at == std::string::npos) ? NAN : std::atof(line.c_str() + at + std::strlen(key) + 4);
+    }
+
+    // A benchmark has regressed when its median is more than threshold_pct
+    // slower and the gap is also wider than twice both runs' spread put
+    // together, so a noisy benchmark needs a bigger change to count.
+    int compare() const {
+      std::ifstream in(compare_file);
+      if (!in) {
+        std::cerr << "can't read " << compare_file << '\n';
+        return 1;
+      }
+      int regressions = 0;
+      std::cout << "\ncompared with " << compare_file << ":\n";
+      std::string line;
+      while (std::getline(in, line)) {
+        size_t at = line.find("{\"name\": ");
+        if (at == std::string::npos) continue;
+        for (const BenchResult& result : results) {
+          if (line.compare(at + 9, quoted(result.name).size() + 1, quoted(result.name) + ",") != 0) continue;
+          double old_median = field(line, "median"), old_mad = field(line, "mad");
+          double change_pct = 100 * (result.median - old_median) / old_median;
+          bool beyond_noise = std::abs(result.median - old_median) > 2 * (result.mad + old_mad);
+          const char* verdict = "same";
+          if (beyond_noise && change_pct > threshold_pct) {
+            verdict = "SLOWER";
+            ++regressions;
+          }
+          else if (beyond_noise && change_pct < -threshold_pct) verdict = "faster";
+          std::cout << "  " << std::left << std::setw(name_width) << result.name << std::right
+            << std::setw(12) << formatNs(old_median) << " -> " << std::setw(12) << formatNs(result.median)
+            << std::showpos << std::fixed << std::setprecision(1) << std::setw(9) << change_pct << "%"
+            << std::noshowpos << "   " << verdict << '\n';
+        }
+      }
+      if (regressions) std::cout << regressions << " regression" << ((regressions > 1) ? "s" : "") << '\n';
+      return regressions ? 1 : 0;
+    }
+  };
+}
+
+#endif
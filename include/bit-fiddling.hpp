@@ -1,11 +1,207 @@
+#ifndef BIT_FIDDLING_HPP
+#define BIT_FIDDLING_HPP
+
+#include <climits>
+#include <type_traits>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 #include <typedefs.hpp>
 
 // bit-fiddling.hpp
 namespace kel {
-#define pow2(power) (1ull << (power))
-#define ones(num) (pow2(num) - 1ull)
-#define bitRange(nbits, start, stop) (ones(nbits, stop) & (~ones(nbits, start)))
+  // Typed constexpr bit tricks for any unsigned type up to unsigned __int128.
+  // Each one compiles to a single instruction when the target has it:
+  // popcount wants -mpopcnt and pdep/pext/selectBit want -mbmi2 (or a
+  // `#pragma GCC target`). Without those flags, and always at compile time,
+  // portable versions are used instead. Note that pdep/pext are microcoded,
+  // and slow, on AMD before Zen 3.
+  using u128 = unsigned __int128;
+
+  template <class T>
+  constexpr bool is_mask_v = std::is_same<T, u128>::value
+    || (std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value);
+  template <class T>
+  constexpr int mask_bits = int(sizeof(T) * CHAR_BIT);
+
+  // smallest unsigned type with at least `Bits` bits
+  template <int Bits>
+  using mask_t = std::conditional_t<(Bits <= 8), u8,
+    std::conditional_t<(Bits <= 16), u16,
+    std::conditional_t<(Bits <= 32), u32,
+    std::conditional_t<(Bits <= 64), u64, u128>>>>;
+
+  template <class T = ull>
+  constexpr T pow2(int power) noexcept {
+    return static_cast<T>(T(1) << power);
+  }
+  // the lowest `num` bits; ones<u64>(64) is all of them
+  template <class T = ull>
+  constexpr T ones(int num) noexcept {
+    return (num >= mask_bits<T>) ? static_cast<T>(~T(0)) : static_cast<T>(pow2<T>(num) - 1);
+  }
+  // bits start, start + 1, ..., stop - 1
+  template <class T = ull>
+  constexpr T bitRange(int start, int stop) noexcept {
+    return static_cast<T>(ones<T>(stop) & ~ones<T>(start));
+  }
+
+  template <class T>
+  constexpr T getLS1B(T mask) noexcept {
+    return static_cast<T>(mask & (~mask + 1));
+  }
+  // clears the lowest set bit of `mask` and returns what's left,
+  // so `do { ... } while (clearLS1B(mask));` visits every set bit
+  template <class T>
+  constexpr T clearLS1B(T& mask) noexcept {
+    return mask = static_cast<T>(mask & (mask - 1));
+  }
 
-#define getLS1B(mask) ((mask) & -(mask))
-#define clearLS1B(mask) (mask &= (mask - static_cast<decltype(mask)>(1)))
+  template <class T>
+  constexpr int popcount(T mask) noexcept {
+    static_assert(is_mask_v<T>, "popcount: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      return popcount(u64(mask)) + popcount(u64(mask >> 64));
+    }
+    else {
+#if defined(__POPCNT__)
+      return __builtin_popcountll(mask);
+#else
+      // without popcnt the builtin is a call into libgcc; this is about as fast inline
+      u64 x = mask;
+      x = x - ((x >> 1) & 0x5555555555555555);
+      x = (x & 0x3333333333333333) + ((x >> 2) & 0x3333333333333333);
+      x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0f;
+      if constexpr (mask_bits<T> <= 8) return int(x);
+      else return int((x * 0x0101010101010101) >> 56);
+#endif
+    }
+  }
+
+  // index of the lowest/highest set bit; `mask` can't be 0
+  template <class T>
+  constexpr int indexLS1B(T mask) noexcept {
+    static_assert(is_mask_v<T>, "indexLS1B: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      return u64(mask) ? __builtin_ctzll(u64(mask)) : 64 + __builtin_ctzll(u64(mask >> 64));
+    }
+    else return __builtin_ctzll(mask);
+  }
+  template <class T>
+  constexpr int indexMS1B(T mask) noexcept {
+    static_assert(is_mask_v<T>, "indexMS1B: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      return u64(mask >> 64) ? 127 - __builtin_clzll(u64(mask >> 64)) : 63 - __builtin_clzll(u64(mask));
+    }
+    else return 63 - __builtin_clzll(mask);
+  }
+  // trailing/leading zeros, all of them for 0 (like C++20's countr_zero/countl_zero)
+  template <class T>
+  constexpr int ctz(T mask) noexcept {
+    return mask ? indexLS1B(mask) : mask_bits<T>;
+  }
+  template <class T>
+  constexpr int clz(T mask) noexcept {
+    return mask ? mask_bits<T> - 1 - indexMS1B(mask) : mask_bits<T>;
+  }
+
+  // deposit the low bits of `src` into the set bits of `mask`, in order
+  template <class T>
+  constexpr T pdep(T src, T mask) noexcept {
+    static_assert(is_mask_v<T>, "pdep: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      u64 lo = u64(mask), hi = u64(mask >> 64);
+      return T(pdep(u64(src), lo)) | T(pdep(u64(src >> popcount(lo)), hi)) << 64;
+    }
+    else {
+#if defined(__BMI2__)
+      if (!__builtin_is_constant_evaluated()) return static_cast<T>(_pdep_u64(src, mask));
+#endif
+      T out = 0;
+      for (; mask; src >>= 1) {
+        out |= static_cast<T>(getLS1B(mask) & (T(0) - (src & 1)));
+        clearLS1B(mask);
+      }
+      return out;
+    }
+  }
+  // gather the bits of `src` under the set bits of `mask` into the low bits
+  template <class T>
+  constexpr T pext(T src, T mask) noexcept {
+    static_assert(is_mask_v<T>, "pext: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      u64 lo = u64(mask), hi = u64(mask >> 64);
+      return T(pext(u64(src), lo)) | T(pext(u64(src >> 64), hi)) << popcount(lo);
+    }
+    else {
+#if defined(__BMI2__)
+      if (!__builtin_is_constant_evaluated()) return static_cast<T>(_pext_u64(src, mask));
+#endif
+      T out = 0;
+      for (int count = 0; mask; ++count) {
+        out |= static_cast<T>(T((src >> indexLS1B(mask)) & 1) << count);
+        clearLS1B(mask);
+      }
+      return out;
+    }
+  }
+
+  // index of set bit number `n` (0 is the lowest); `mask` needs more than n set bits
+  template <class T>
+  constexpr int selectBit(T mask, int n) noexcept {
+    static_assert(is_mask_v<T>, "selectBit: not an unsigned type");
+    if constexpr (mask_bits<T> > 64) {
+      int lo = popcount(u64(mask));
+      return (n < lo) ? selectBit(u64(mask), n) : 64 + selectBit(u64(mask >> 64), n - lo);
+    }
+    else {
+#if defined(__BMI2__)
+      if (!__builtin_is_constant_evaluated()) return indexLS1B(_pdep_u64(u64(1) << n, mask));
+#endif
+      u64 x = mask;
+      int base = 0;
+      if constexpr (mask_bits<T> > 16) {
+        // Running popcount up to every byte, then skip the bytes whose count is
+        // still <= n: (n | 0x80) - count keeps its top bit exactly for those.
+        constexpr u64 lsbs = 0x0101010101010101, msbs = 0x8080808080808080;
+        u64 bytes = x - ((x >> 1) & 0x5555555555555555);
+        bytes = (bytes & 0x3333333333333333) + ((bytes >> 2) & 0x3333333333333333);
+        bytes = ((bytes + (bytes >> 4)) & 0x0f0f0f0f0f0f0f0f) * lsbs;
+        base = int((((((u64(n) * lsbs) | msbs) - bytes) & msbs) >> 7) * lsbs >> 56) * 8;
+        n -= int((bytes << 8 >> base) & 0xff);
+        x >>= base;
+      }
+      for (; n > 0; --n) clearLS1B(x);
+      return base + indexLS1B(x);
+    }
+  }
+
+  // `for (int idx : setBits(mask))` visits the index of every set bit, lowest first
+  template <class T>
+  struct SetBits {
+    T mask;
+
+    struct iterator {
+      T mask;
+      constexpr int operator*() const noexcept { return indexLS1B(mask); }
+      constexpr iterator& operator++() noexcept {
+        clearLS1B(mask);
+        return *this;
+      }
+      constexpr bool operator==(const iterator& other) const noexcept { return mask == other.mask; }
+      constexpr bool operator!=(const iterator& other) const noexcept { return mask != other.mask; }
+    };
+    constexpr iterator begin() const noexcept { return { mask }; }
+    constexpr iterator end() const noexcept { return { 0 }; }
+    constexpr int size() const noexcept { return popcount(mask); }
+    constexpr bool empty() const noexcept { return !mask; }
+  };
+  template <class T>
+  constexpr SetBits<T> setBits(T mask) noexcept {
+    static_assert(is_mask_v<T>, "setBits: not an unsigned type");
+    return { mask };
+  }
 }
+
+#endif
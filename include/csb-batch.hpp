@@ -0,0 +1,314 @@
+#ifndef CSB_BATCH_HPP
+#define CSB_BATCH_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <csb-physics-sse.hpp>
+
+// csb-batch.hpp
+namespace kel {
+  // Thousands of independent races in float, for a trainer that wants a
+  // whole population's games played in one call instead of one at a time.
+  //
+  //   RaceBatch batch;
+  //   for (...) batch.add(field, start);          // game ids count up from 0
+  //   batch.run([&](size_t game, const BasicRace<float>& race, BasicMove<float>* moves) {
+  //     ...moves[0] to moves[3], one for each pod...
+  //   });
+  //   batch.outcome(game), batch.completion(game), batch.race(game)
+  //
+  // Games are kept four to a block, a field to an array with one game per
+  // SSE lane, and the block's simFrame is csb-physics-sse.hpp's kernel turned
+  // sideways: the same pair and checkpoint times for four games at once,
+  // with the games that have run out of events (or finished) masked off
+  // until the others catch up. Every game comes out the same to the bit as
+  // BasicRace<float> would make it. run() hands whole blocks to threads, so
+  // a block is only ever touched by one of them, and a game that's finished
+  // stops being stepped and stops calling the policy.
+  //
+  // The policy is called from all the threads at once, for different games;
+  // anything it writes to has to be per game (or per thread).
+  class RaceBatch {
+  public:
+    static constexpr int lanes = 4;
+
+    size_t add(const BasicField<float>& field, const BasicRace<float>& start) {
+      if (num_games % lanes == 0) blocks.emplace_back();
+      Block& block = blocks.back();
+      int lane = int(num_games % lanes);
+      block.fields[lane] = field;
+      block.setRace(lane, start);
+      block.outcomes[lane] = start.outcome(field);
+      block.frames[lane] = 0;
+      return num_games++;
+    }
+    void clear() {
+      blocks.clear();
+      num_games = 0;
+    }
+    size_t size() const { return num_games; }
+
+    // Plays every game that's still going until it finishes or has had
+    // max_frames more; 0 threads means one per core.
+    template <class Policy>
+    void run(Policy&& policy, int max_frames = INT_MAX, unsigned num_threads = 0) {
+      if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+      std::atomic<size_t> next{ 0 };
+      auto work = [&] {
+        for (size_t idx; (idx = next++) < blocks.size();) {
+          Block& block = blocks[idx];
+          for (int frame = 0; frame < max_frames && block.running(); ++frame) stepBlock(block, idx * lanes, policy);
+        }
+      };
+      std::vector<std::thread> pool;
+      for (unsigned thread = 1; thread < num_threads && thread < blocks.size(); ++thread) pool.emplace_back(work);
+      work();
+      for (std::thread& thread : pool) thread.join();
+    }
+    // one frame of every game that's still going
+    template <class Policy>
+    void step(Policy&& policy, unsigned num_threads = 1) { run(policy, 1, num_threads); }
+
+    // BasicRace::outcome: 0 while it's going, 1 or 2 for the team that won
+    int outcome(size_t game) const { return block(game).outcomes[game % lanes]; }
+    bool finished(size_t game) const { return outcome(game) != 0; }
+    size_t numRunning() const {
+      size_t count = 0;
+      for (size_t game = 0; game < num_games; ++game) count += !finished(game);
+      return count;
+    }
+    int frames(size_t game) const { return block(game).frames[game % lanes]; }
+    // How far ahead team 0 is, as a fraction of the race: the checkpoints its
+    // pods have passed (laps count as all of them) minus team 1's, over the
+    // race's. 0 for an even race, 2 when one team's pods have both finished
+    // and the other's never left the start.
+    float completion(size_t game) const {
+      const Block& b = block(game);
+      int lane = int(game % lanes);
+      const BasicField<float>& f = b.fields[lane];
+      int passed = 0;
+      for (int pod = 0; pod < 4; ++pod) {
+        int pod_passed = b.laps[pod][lane] * f.num_checkpoints + b.next_cps[pod][lane];
+        passed += (pod < 2) ? pod_passed : -pod_passed;
+      }
+      return float(passed) / float(f.num_checkpoints * f.num_laps);
+    }
+    BasicRace<float> race(size_t game) const { return block(game).race(int(game % lanes)); }
+    const BasicField<float>& field(size_t game) const { return block(game).fields[game % lanes]; }
+
+  private:
+    // four games, one to a lane; arrays are [pod][lane]
+    struct alignas(16) Block {
+      float xs[4][lanes], ys[4][lanes], vxs[4][lanes], vys[4][lanes], angles[4][lanes];
+      int next_cps[4][lanes], laps[4][lanes], shield_frames[4][lanes];
+      int timeouts[2][lanes];
+      int outcomes[lanes];  // -1 for a lane no game was added to
+      int frames[lanes];
+      bool can_boost[4][lanes];
+      BasicField<float> fields[lanes];
+
+      Block() {
+        for (int lane = 0; lane < lanes; ++lane) {
+          setRace(lane, BasicRace<float>());
+          outcomes[lane] = -1;
+          frames[lane] = 0;
+        }
+      }
+
+      bool running() const {
+        for (int outcome : outcomes) {
+          if (outcome == 0) return true;
+        }
+        return false;
+      }
+
+      BasicPod<float> pod(int idx, int lane) const {
+        BasicPod<float> ret;
+        ret.pos = { xs[idx][lane], ys[idx][lane] };
+        ret.vel = { vxs[idx][lane], vys[idx][lane] };
+        ret.angle = angles[idx][lane];
+        ret.next_cp = next_cps[idx][lane];
+        ret.laps = laps[idx][lane];
+        ret.can_boost = can_boost[idx][lane];
+        ret.shield_frames = shield_frames[idx][lane];
+        return ret;
+      }
+      void setPod(int idx, int lane, const BasicPod<float>& pod) {
+        xs[idx][lane] = pod.pos.x;
+        ys[idx][lane] = pod.pos.y;
+        vxs[idx][lane] = pod.vel.x;
+        vys[idx][lane] = pod.vel.y;
+        angles[idx][lane] = pod.angle;
+        next_cps[idx][lane] = pod.next_cp;
+        laps[idx][lane] = pod.laps;
+        can_boost[idx][lane] = pod.can_boost;
+        shield_frames[idx][lane] = pod.shield_frames;
+      }
+      BasicRace<float> race(int lane) const {
+        BasicRace<float> ret;
+        for (int idx = 0; idx < 4; ++idx) ret.pods[idx] = pod(idx, lane);
+        ret.timeouts = { timeouts[0][lane], timeouts[1][lane] };
+        return ret;
+      }
+      void setRace(int lane, const BasicRace<float>& race) {
+        for (int idx = 0; idx < 4; ++idx) setPod(idx, lane, race.pods[idx]);
+        timeouts[0][lane] = race.timeouts[0];
+        timeouts[1][lane] = race.timeouts[1];
+      }
+
+#ifdef __SSE2__
+      // SoaRace::simFrame with the lanes as games instead of pods
+      void simFrame() {
+        constexpr int pair_lhs[6] = { 0, 0, 0, 1, 1, 2 }, pair_rhs[6] = { 1, 2, 3, 2, 3, 3 };
+        const __m128 pod_reach2 = _mm_set1_ps(float(2 * BasicPod<float>::radius) * float(2 * BasicPod<float>::radius));
+        const float cp_radius = float(BasicField<float>::checkpoint_radius);
+        const __m128 cp_reach2 = _mm_set1_ps(cp_radius * cp_radius);
+
+        // lanes that aren't playing start the frame already at its end
+        alignas(16) float t[lanes];
+        for (int lane = 0; lane < lanes; ++lane) {
+          t[lane] = (outcomes[lane] == 0) ? 0.f : 1.f;
+          if (outcomes[lane] != 0) continue;
+          --timeouts[0][lane];
+          --timeouts[1][lane];
+        }
+        const __m128 playing = _mm_cmplt_ps(_mm_load_ps(t), _mm_set1_ps(1.f));
+
+        while (true) {
+          __m128 moving = _mm_cmplt_ps(_mm_load_ps(t), _mm_set1_ps(1.f));
+          if (_mm_movemask_ps(moving) == 0) break;
+
+          __m128 x[4], y[4], vx[4], vy[4];
+          for (int idx = 0; idx < 4; ++idx) {
+            x[idx] = _mm_load_ps(xs[idx]);
+            y[idx] = _mm_load_ps(ys[idx]);
+            vx[idx] = _mm_load_ps(vxs[idx]);
+            vy[idx] = _mm_load_ps(vys[idx]);
+          }
+          alignas(16) float times[10][lanes];
+          for (int pair_idx = 0; pair_idx < 6; ++pair_idx) {
+            int lhs = pair_lhs[pair_idx], rhs = pair_rhs[pair_idx];
+            _mm_store_ps(times[pair_idx], sseContactTimes(_mm_sub_ps(x[lhs], x[rhs]), _mm_sub_ps(y[lhs], y[rhs]),
+              _mm_sub_ps(vx[lhs], vx[rhs]), _mm_sub_ps(vy[lhs], vy[rhs]), pod_reach2, false));
+          }
+          for (int idx = 0; idx < 4; ++idx) {
+            const int* cp = next_cps[idx];
+            __m128 cp_x = _mm_setr_ps(fields[0].checkpoints[cp[0]].x, fields[1].checkpoints[cp[1]].x,
+                                      fields[2].checkpoints[cp[2]].x, fields[3].checkpoints[cp[3]].x);
+            __m128 cp_y = _mm_setr_ps(fields[0].checkpoints[cp[0]].y, fields[1].checkpoints[cp[1]].y,
+                                      fields[2].checkpoints[cp[2]].y, fields[3].checkpoints[cp[3]].y);
+            _mm_store_ps(times[6 + idx], sseContactTimes(_mm_sub_ps(x[idx], cp_x), _mm_sub_ps(y[idx], cp_y),
+              vx[idx], vy[idx], cp_reach2, true));
+          }
+
+          // each game's first event, picked the way BasicRace::simFrame does
+          alignas(16) float first[lanes];
+          int hit[lanes], hit_with[lanes];
+          for (int lane = 0; lane < lanes; ++lane) {
+            first[lane] = 1.f - t[lane];
+            hit[lane] = hit_with[lane] = -1;
+            if (t[lane] >= 1.f) continue;
+            for (int pair_idx = 0; pair_idx < 6; ++pair_idx) {
+              if (times[pair_idx][lane] < first[lane]) {
+                first[lane] = times[pair_idx][lane];
+                hit[lane] = pair_lhs[pair_idx];
+                hit_with[lane] = pair_rhs[pair_idx];
+              }
+            }
+            for (int idx = 0; idx < 4; ++idx) {
+              if (times[6 + idx][lane] < first[lane]) {
+                first[lane] = times[6 + idx][lane];
+                hit[lane] = idx;
+                hit_with[lane] = -1;
+              }
+            }
+          }
+
+          __m128 dt = _mm_load_ps(first);
+          for (int idx = 0; idx < 4; ++idx) {
+            _mm_store_ps(xs[idx], blend(moving, _mm_add_ps(x[idx], _mm_mul_ps(vx[idx], dt)), x[idx]));
+            _mm_store_ps(ys[idx], blend(moving, _mm_add_ps(y[idx], _mm_mul_ps(vy[idx], dt)), y[idx]));
+          }
+          for (int lane = 0; lane < lanes; ++lane) {
+            if (t[lane] >= 1.f) continue;
+            t[lane] += first[lane];
+            if (hit[lane] < 0) t[lane] = 1.f;
+            else if (hit_with[lane] >= 0) {
+              BasicPod<float> lhs = pod(hit[lane], lane), rhs = pod(hit_with[lane], lane);
+              lhs.bounce(rhs);
+              setPod(hit[lane], lane, lhs);
+              setPod(hit_with[lane], lane, rhs);
+            }
+            else {
+              int& next_cp = next_cps[hit[lane]][lane];
+              if (next_cp == 0) ++laps[hit[lane]][lane];
+              next_cp = (next_cp + 1) % fields[lane].num_checkpoints;
+              timeouts[hit[lane] / 2][lane] = BasicRace<float>::timeout_turns;
+            }
+          }
+        }
+
+        // BasicPod::endFrame, for the lanes that played
+        const __m128 friction = _mm_set1_ps(0.85f), full_turn = _mm_set1_ps(360.f);
+        for (int idx = 0; idx < 4; ++idx) {
+          __m128 x = _mm_load_ps(xs[idx]), y = _mm_load_ps(ys[idx]);
+          __m128 vx = _mm_load_ps(vxs[idx]), vy = _mm_load_ps(vys[idx]), angle = _mm_load_ps(angles[idx]);
+          _mm_store_ps(xs[idx], blend(playing, sseRoundHalfUp(x), x));
+          _mm_store_ps(ys[idx], blend(playing, sseRoundHalfUp(y), y));
+          _mm_store_ps(vxs[idx], blend(playing, sseTruncate(_mm_mul_ps(vx, friction)), vx));
+          _mm_store_ps(vys[idx], blend(playing, sseTruncate(_mm_mul_ps(vy, friction)), vy));
+          __m128 rounded = sseRoundHalfUp(angle);
+          rounded = _mm_sub_ps(rounded, _mm_and_ps(_mm_cmpge_ps(rounded, full_turn), full_turn));
+          _mm_store_ps(angles[idx], blend(playing, rounded, angle));
+          for (int lane = 0; lane < lanes; ++lane) {
+            if (outcomes[lane] == 0 && shield_frames[idx][lane] > 0) --shield_frames[idx][lane];
+          }
+        }
+      }
+
+      static __m128 blend(__m128 mask, __m128 yes, __m128 no) {
+        return _mm_or_ps(_mm_and_ps(mask, yes), _mm_andnot_ps(mask, no));
+      }
+#else
+      void simFrame() {
+        for (int lane = 0; lane < lanes; ++lane) {
+          if (outcomes[lane] != 0) continue;
+          BasicRace<float> next = race(lane);
+          next.simFrame(fields[lane]);
+          setRace(lane, next);
+        }
+      }
+#endif
+    };
+
+    std::vector<Block> blocks;
+    size_t num_games = 0;
+
+    const Block& block(size_t game) const { return blocks[game / lanes]; }
+
+    template <class Policy>
+    static void stepBlock(Block& block, size_t first_game, Policy& policy) {
+      BasicMove<float> moves[4];
+      for (int lane = 0; lane < lanes; ++lane) {
+        if (block.outcomes[lane] != 0) continue;
+        BasicRace<float> race = block.race(lane);
+        policy(first_game + lane, static_cast<const BasicRace<float>&>(race), moves);
+        for (int idx = 0; idx < 4; ++idx) race.pods[idx].apply(moves[idx]);
+        block.setRace(lane, race);
+      }
+      block.simFrame();
+      for (int lane = 0; lane < lanes; ++lane) {
+        if (block.outcomes[lane] != 0) continue;
+        ++block.frames[lane];
+        block.outcomes[lane] = block.race(lane).outcome(block.fields[lane]);
+      }
+    }
+  };
+}
+
+#endif
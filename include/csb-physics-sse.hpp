@@ -0,0 +1,215 @@
+#ifndef CSB_PHYSICS_SSE_HPP
+#define CSB_PHYSICS_SSE_HPP
+
+#include <array>
+
+#include <csb-physics.hpp>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+// csb-physics-sse.hpp
+namespace kel {
+  // BasicRace<float>::simFrame with the pods stored a field to an array
+  // (xs[4], ys[4], ...), so each field of all four pods is one SSE register.
+  // The six pair collision times and the four checkpoint times come out of
+  // one pass over three registers, and moving and ending the frame are a
+  // handful of instructions for all four; only picking the earliest event,
+  // bouncing and passing a checkpoint stay scalar.
+  //
+  // Every float operation is the one BasicPod's scalar code does, in the
+  // same order, and the rounding is done exactly as roundHalfUp/truncf do, so
+  // the result is the same to the bit (bench-csb checks it on every frame it
+  // times). That holds as long as neither path gets its multiplies and adds
+  // fused into FMAs, which the default x86-64 target never does.
+  //
+  // Only SSE2, which every x86-64 has: four pods fill a 128-bit register
+  // exactly, so AVX would only add empty lanes. Without SSE2 simFrame goes
+  // through BasicRace<float>.
+
+#ifdef __SSE2__
+  // BasicPod::contactTime (and checkpointTime, if cp) for four lanes: the
+  // time where there's a contact, +inf where there isn't
+  inline __m128 sseContactTimes(__m128 dx, __m128 dy, __m128 dvx, __m128 dvy, __m128 reach2, bool cp) {
+    const __m128 zero = _mm_setzero_ps(), sign = _mm_set1_ps(-0.f);
+    __m128 closing = _mm_add_ps(_mm_mul_ps(dx, dvx), _mm_mul_ps(dy, dvy));
+    __m128 gap = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), reach2);
+    __m128 touching = _mm_cmple_ps(gap, zero);
+    __m128 speed2 = _mm_add_ps(_mm_mul_ps(dvx, dvx), _mm_mul_ps(dvy, dvy));
+    __m128 neg_closing = _mm_xor_ps(closing, sign);
+    __m128 closest_at = _mm_div_ps(neg_closing, speed2);
+    __m128 half_chord2 = _mm_sub_ps(_mm_mul_ps(neg_closing, closest_at), gap);
+    __m128 time = _mm_max_ps(_mm_sub_ps(closest_at, _mm_sqrt_ps(_mm_div_ps(half_chord2, speed2))), zero);
+
+    __m128 reaches = _mm_andnot_ps(_mm_cmpgt_ps(gap, _mm_mul_ps(_mm_set1_ps(-2.f), closing)),
+                                   _mm_cmpnlt_ps(half_chord2, zero));
+    __m128 valid = _mm_and_ps(_mm_cmplt_ps(closing, zero), _mm_or_ps(touching, reaches));
+    // a pod already inside its checkpoint passes it whichever way it's going
+    if (cp) valid = _mm_or_ps(valid, touching);
+    time = _mm_andnot_ps(touching, time);
+    return _mm_or_ps(_mm_and_ps(valid, time), _mm_andnot_ps(valid, _mm_set1_ps(INFINITY)));
+  }
+
+  // truncf, minus-zero included, for |x| < 2^31
+  inline __m128 sseTruncate(__m128 x) {
+    const __m128 sign = _mm_set1_ps(-0.f);
+    return _mm_or_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(x)), _mm_and_ps(x, sign));
+  }
+  // floorf, minus-zero included, for |x| < 2^31
+  inline __m128 sseFloor(__m128 x) {
+    __m128 whole = sseTruncate(x);
+    return _mm_sub_ps(whole, _mm_and_ps(_mm_cmpgt_ps(whole, x), _mm_set1_ps(1.f)));
+  }
+  // roundHalfUp, for |x| < 2^31. It picks between whole and whole + 1
+  // rather than adding 0 or 1, so a -0 out of floor stays -0 as it does in
+  // the scalar code.
+  inline __m128 sseRoundHalfUp(__m128 x) {
+    __m128 whole = sseFloor(x);
+    __m128 up = _mm_cmpge_ps(_mm_sub_ps(x, whole), _mm_set1_ps(0.5f));
+    return _mm_or_ps(_mm_and_ps(up, _mm_add_ps(whole, _mm_set1_ps(1.f))), _mm_andnot_ps(up, whole));
+  }
+#endif
+
+  struct alignas(16) SoaRace {
+    float xs[4], ys[4], vxs[4], vys[4], angles[4];
+    int next_cps[4], laps[4], shield_frames[4];
+    bool can_boost[4];
+    std::array<int, 2> timeouts;
+
+    SoaRace() : SoaRace(BasicRace<float>()) {}
+    explicit SoaRace(const BasicRace<float>& race) : timeouts(race.timeouts) {
+      for (int idx = 0; idx < 4; ++idx) setPod(idx, race.pods[idx]);
+    }
+    BasicRace<float> unpack() const {
+      BasicRace<float> race;
+      for (int idx = 0; idx < 4; ++idx) race.pods[idx] = pod(idx);
+      race.timeouts = timeouts;
+      return race;
+    }
+
+    BasicPod<float> pod(int idx) const {
+      BasicPod<float> ret;
+      ret.pos = { xs[idx], ys[idx] };
+      ret.vel = { vxs[idx], vys[idx] };
+      ret.angle = angles[idx];
+      ret.next_cp = next_cps[idx];
+      ret.laps = laps[idx];
+      ret.can_boost = can_boost[idx];
+      ret.shield_frames = shield_frames[idx];
+      return ret;
+    }
+    void setPod(int idx, const BasicPod<float>& pod) {
+      xs[idx] = pod.pos.x;
+      ys[idx] = pod.pos.y;
+      vxs[idx] = pod.vel.x;
+      vys[idx] = pod.vel.y;
+      angles[idx] = pod.angle;
+      next_cps[idx] = pod.next_cp;
+      laps[idx] = pod.laps;
+      can_boost[idx] = pod.can_boost;
+      shield_frames[idx] = pod.shield_frames;
+    }
+
+    // same as BasicRace::outcome
+    int outcome(const BasicField<float>& field) const {
+      for (int team = 0; team < 2; ++team) {
+        if (laps[2 * team] >= field.num_laps || laps[2 * team + 1] >= field.num_laps) return 1 + team;
+      }
+      for (int team = 0; team < 2; ++team) {
+        if (timeouts[team] <= 0) return 2 - team;
+      }
+      return 0;
+    }
+
+#ifdef __SSE2__
+    void simFrame(const BasicField<float>& field) {
+      // the pairs in the order BasicRace::simFrame tries them; the last two
+      // lanes of the second register pair pod 3 with itself, which never closes
+      constexpr int pair_lhs[6] = { 0, 0, 0, 1, 1, 2 }, pair_rhs[6] = { 1, 2, 3, 2, 3, 3 };
+      const __m128 pod_reach2 = _mm_set1_ps(float(2 * BasicPod<float>::radius) * float(2 * BasicPod<float>::radius));
+      const __m128 cp_reach2 = _mm_set1_ps(float(field.checkpoint_radius) * float(field.checkpoint_radius));
+
+      --timeouts[0];
+      --timeouts[1];
+      float t = 0.f;
+      while (t < 1.f) {
+        __m128 x = _mm_load_ps(xs), y = _mm_load_ps(ys), vx = _mm_load_ps(vxs), vy = _mm_load_ps(vys);
+        alignas(16) float times[12];
+        _mm_store_ps(times, sseContactTimes(
+          _mm_sub_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 0, 0, 0)), _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 2, 1))),
+          _mm_sub_ps(_mm_shuffle_ps(y, y, _MM_SHUFFLE(1, 0, 0, 0)), _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 3, 2, 1))),
+          _mm_sub_ps(_mm_shuffle_ps(vx, vx, _MM_SHUFFLE(1, 0, 0, 0)), _mm_shuffle_ps(vx, vx, _MM_SHUFFLE(2, 3, 2, 1))),
+          _mm_sub_ps(_mm_shuffle_ps(vy, vy, _MM_SHUFFLE(1, 0, 0, 0)), _mm_shuffle_ps(vy, vy, _MM_SHUFFLE(2, 3, 2, 1))),
+          pod_reach2, false));
+        _mm_store_ps(times + 4, sseContactTimes(
+          _mm_sub_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 2, 1)), _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3))),
+          _mm_sub_ps(_mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 2, 1)), _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 3, 3))),
+          _mm_sub_ps(_mm_shuffle_ps(vx, vx, _MM_SHUFFLE(3, 3, 2, 1)), _mm_shuffle_ps(vx, vx, _MM_SHUFFLE(3, 3, 3, 3))),
+          _mm_sub_ps(_mm_shuffle_ps(vy, vy, _MM_SHUFFLE(3, 3, 2, 1)), _mm_shuffle_ps(vy, vy, _MM_SHUFFLE(3, 3, 3, 3))),
+          pod_reach2, false));
+        const BasicVec2<float>* cps = field.checkpoints.data();
+        __m128 cp_x = _mm_setr_ps(cps[next_cps[0]].x, cps[next_cps[1]].x, cps[next_cps[2]].x, cps[next_cps[3]].x);
+        __m128 cp_y = _mm_setr_ps(cps[next_cps[0]].y, cps[next_cps[1]].y, cps[next_cps[2]].y, cps[next_cps[3]].y);
+        _mm_store_ps(times + 8, sseContactTimes(_mm_sub_ps(x, cp_x), _mm_sub_ps(y, cp_y), vx, vy, cp_reach2, true));
+
+        // the first event, ties going to whichever the scalar loop tries first
+        float first = 1.f - t;
+        int hit = -1, hit_with = -1;
+        for (int pair_idx = 0; pair_idx < 6; ++pair_idx) {
+          if (times[pair_idx] < first) {
+            first = times[pair_idx];
+            hit = pair_lhs[pair_idx];
+            hit_with = pair_rhs[pair_idx];
+          }
+        }
+        for (int idx = 0; idx < 4; ++idx) {
+          if (times[8 + idx] < first) {
+            first = times[8 + idx];
+            hit = idx;
+            hit_with = -1;
+          }
+        }
+
+        __m128 dt = _mm_set1_ps(first);
+        _mm_store_ps(xs, _mm_add_ps(x, _mm_mul_ps(vx, dt)));
+        _mm_store_ps(ys, _mm_add_ps(y, _mm_mul_ps(vy, dt)));
+        t += first;
+        if (hit < 0) break;
+        if (hit_with >= 0) {
+          BasicPod<float> lhs = pod(hit), rhs = pod(hit_with);
+          lhs.bounce(rhs);
+          setPod(hit, lhs);
+          setPod(hit_with, rhs);
+        }
+        else {
+          if (next_cps[hit] == 0) ++laps[hit];
+          next_cps[hit] = (next_cps[hit] + 1) % field.num_checkpoints;
+          timeouts[hit / 2] = BasicRace<float>::timeout_turns;
+        }
+      }
+
+      // BasicPod::endFrame
+      _mm_store_ps(xs, sseRoundHalfUp(_mm_load_ps(xs)));
+      _mm_store_ps(ys, sseRoundHalfUp(_mm_load_ps(ys)));
+      const __m128 friction = _mm_set1_ps(0.85f);
+      _mm_store_ps(vxs, sseTruncate(_mm_mul_ps(_mm_load_ps(vxs), friction)));
+      _mm_store_ps(vys, sseTruncate(_mm_mul_ps(_mm_load_ps(vys), friction)));
+      const __m128 full_turn = _mm_set1_ps(360.f);
+      __m128 angle = sseRoundHalfUp(_mm_load_ps(angles));
+      _mm_store_ps(angles, _mm_sub_ps(angle, _mm_and_ps(_mm_cmpge_ps(angle, full_turn), full_turn)));
+      for (int& frames : shield_frames) {
+        if (frames > 0) --frames;
+      }
+    }
+#else
+    void simFrame(const BasicField<float>& field) {
+      BasicRace<float> race = unpack();
+      race.simFrame(field);
+      *this = SoaRace(race);
+    }
+#endif
+  };
+}
+
+#endif
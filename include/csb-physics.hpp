@@ -0,0 +1,426 @@
+#ifndef CSB_PHYSICS_HPP
+#define CSB_PHYSICS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <istream>
+
+// csb-physics.hpp
+namespace kel {
+  // Coders Strike Back's physics the way the referee runs them, templated on
+  // the scalar they're done in: the bot searches in double, the nn trainer
+  // plays its races in float, and a Fixed<> gives the same answer whatever
+  // the compiler does with floating point. Everything that does maths on a T
+  // calls it unqualified (sqrt(x), not std::sqrt(x)), so a scalar type can
+  // bring its own through ADL.
+  //
+  // A turn is apply() (or applyTarget()) for each pod, then simFrame(), which
+  // moves all four, bounces pods off each other and passes checkpoints in the
+  // order they happen, and ends with the referee's friction and rounding.
+  //
+  // Angles are in degrees, like the game's input: 0 is east, 90 is south,
+  // and a pod's facing is kept in [0, 360) once it has one.
+
+  template <class T>
+  struct BasicVec2 {
+    T x, y;
+    constexpr BasicVec2() : x(), y() {}
+    constexpr BasicVec2(T x, T y) : x(x), y(y) {}
+    template <class U>
+    explicit constexpr BasicVec2(const BasicVec2<U>& other) : x(T(other.x)), y(T(other.y)) {}
+
+    constexpr T r2() const { return x * x + y * y; }
+    T r() const {
+      using std::sqrt;
+      return sqrt(r2());
+    }
+
+    constexpr bool operator==(const BasicVec2& other) const { return x == other.x && y == other.y; }
+    constexpr bool operator!=(const BasicVec2& other) const { return !(*this == other); }
+
+    constexpr BasicVec2 operator+(const BasicVec2& other) const { return { x + other.x, y + other.y }; }
+    constexpr BasicVec2 operator-(const BasicVec2& other) const { return { x - other.x, y - other.y }; }
+    constexpr BasicVec2 operator*(T d) const { return { x * d, y * d }; }
+    constexpr BasicVec2 operator/(T d) const { return { x / d, y / d }; }
+    constexpr BasicVec2 operator-() const { return { -x, -y }; }
+    constexpr BasicVec2& operator+=(const BasicVec2& other) { x += other.x; y += other.y; return *this; }
+    constexpr BasicVec2& operator-=(const BasicVec2& other) { x -= other.x; y -= other.y; return *this; }
+    constexpr BasicVec2& operator*=(T d) { x *= d; y *= d; return *this; }
+  };
+  template <class T>
+  constexpr T dot(const BasicVec2<T>& lhs, const BasicVec2<T>& rhs) { return lhs.x * rhs.x + lhs.y * rhs.y; }
+
+  // The referee's Math.round: to the nearest whole number, halves toward
+  // +inf. std::round takes halves away from zero instead, which sends
+  // -2.5 to -3 where the referee has -2. x - floor(x) is exact, so unlike
+  // floor(x + 0.5) this never rounds up something just under a half.
+  template <class T>
+  T roundHalfUp(T x) {
+    using std::floor;
+    T whole = floor(x);
+    return (x - whole >= T(0.5)) ? whole + T(1) : whole;
+  }
+
+  // Trig without libm. A facing is a whole number of degrees at the start
+  // of every turn and moves by at most 18 in it, so a pod's heading is the
+  // table entry for the whole degree, rotated by the fraction through the
+  // angle-sum formulas with short series (exact at whole degrees, where the
+  // fraction is 0). atan2 is a table of atan(k / 64) and the series for
+  // what's left, which is under 1/128. Both are as close as libm's in float
+  // and double (tools-csb-parity measures it), with no call that can't be
+  // inlined, and they come out the same in a Fixed<> on any machine.
+  namespace trig {
+    // at compile time, so only ever for the tables
+    constexpr long double pi = 3.141592653589793238462643383279502884L;
+    constexpr long double sinSeries(long double x) {
+      long double sum = 0, term = x;
+      for (int n = 1; n < 30; n += 2) {
+        sum += term;
+        term *= -x * x / ((n + 1) * (n + 2));
+      }
+      return sum;
+    }
+    constexpr long double sinDegree(int deg) {
+      deg %= 360;
+      if (deg >= 180) return -sinDegree(deg - 180);
+      if (deg > 90) deg = 180 - deg;
+      return sinSeries(deg * pi / 180);
+    }
+    // Euler's series, which converges for any x
+    constexpr long double atanSeries(long double x) {
+      long double ratio = x * x / (1 + x * x), sum = 0, term = x / (1 + x * x);
+      for (int n = 1; n < 120; ++n) {
+        sum += term;
+        term *= ratio * (2 * n) / (2 * n + 1);
+      }
+      return sum;
+    }
+
+    constexpr int atan_steps = 64;
+    template <class T>
+    struct Tables {
+      // sin of every whole degree up to 450, so cos(deg) is sines[deg + 90]
+      static constexpr std::array<T, 451> sines = [] {
+        std::array<T, 451> ret{};
+        for (int deg = 0; deg <= 450; ++deg) ret[deg] = T(double(sinDegree(deg)));
+        return ret;
+      }();
+      static constexpr std::array<T, atan_steps + 1> atans = [] {
+        std::array<T, atan_steps + 1> ret{};
+        for (int k = 0; k <= atan_steps; ++k) ret[k] = T(double(atanSeries((long double)k / atan_steps)));
+        return ret;
+      }();
+    };
+  }
+
+  // (cos, sin) of an angle in [0, 360) degrees
+  template <class T>
+  BasicVec2<T> unitVector(T degrees) {
+    using Tables = trig::Tables<T>;
+    int whole = int(degrees);
+    T frac = (degrees - T(whole)) * T(M_PI) / T(180);
+    T frac2 = frac * frac;
+    T sin_frac = frac * (T(1) - frac2 * (T(1.0 / 6) - frac2 * T(1.0 / 120)));
+    T cos_frac = T(1) - frac2 * (T(0.5) - frac2 * (T(1.0 / 24) - frac2 * T(1.0 / 720)));
+    T sin_whole = Tables::sines[whole], cos_whole = Tables::sines[whole + 90];
+    return { cos_whole * cos_frac - sin_whole * sin_frac, sin_whole * cos_frac + cos_whole * sin_frac };
+  }
+  // std::atan2, in radians in [-pi, pi]
+  template <class T>
+  T fastAtan2(T y, T x) {
+    using std::abs;
+    using Tables = trig::Tables<T>;
+    T abs_x = abs(x), abs_y = abs(y);
+    if (abs_x == T(0) && abs_y == T(0)) return T(0);
+    bool steep = abs_y > abs_x;
+    T ratio = steep ? abs_x / abs_y : abs_y / abs_x;
+    int step = int(ratio * T(trig::atan_steps) + T(0.5));
+    T at_step = T(step) / T(trig::atan_steps);
+    // atan(ratio) - atan(at_step)
+    T rest = (ratio - at_step) / (T(1) + ratio * at_step);
+    T rest2 = rest * rest;
+    T ret = Tables::atans[step] + rest * (T(1) - rest2 * (T(1.0 / 3) - rest2 * T(0.2)));
+    if (steep) ret = T(M_PI / 2) - ret;
+    if (x < T(0)) ret = T(M_PI) - ret;
+    return (y < T(0)) ? -ret : ret;
+  }
+
+  enum SpecialThrust : int { SHIELD = -1, BOOST = 650 };
+
+  // one pod's command for a turn: thrust is 0 to 100, SHIELD or BOOST, and
+  // turn is how far to rotate first, in degrees (clamped to max_turn)
+  template <class T>
+  struct BasicMove {
+    int thrust;
+    T turn;
+  };
+
+  template <class T>
+  struct BasicPod {
+    static constexpr int radius = 400;
+    static constexpr int max_turn = 18;
+    // the turn a shield goes up counts, then 3 more without thrust
+    static constexpr int shield_turns = 4;
+
+    BasicVec2<T> pos, vel;
+    T angle;            // facing; negative until the first turn sets it
+    int next_cp;        // index of the checkpoint it's heading for
+    int laps;           // times it has passed checkpoint 0
+    bool can_boost;
+    int shield_frames;  // turns left before it can thrust again
+
+    BasicPod() : pos(), vel(), angle(-1), next_cp(1), laps(0), can_boost(true), shield_frames(0) {}
+    template <class U>
+    explicit BasicPod(const BasicPod<U>& other)
+      : pos(other.pos), vel(other.vel), angle(T(other.angle)), next_cp(other.next_cp),
+        laps(other.laps), can_boost(other.can_boost), shield_frames(other.shield_frames) {}
+
+    T mass() const { return T((shield_frames == shield_turns) ? 10 : 1); }
+
+    BasicVec2<T> heading() const { return unitVector(angle); }
+    // the absolute angle from here to target
+    T angleTo(const BasicVec2<T>& target) const {
+      BasicVec2<T> d = target - pos;
+      T deg = fastAtan2(d.y, d.x) * T(180) / T(M_PI);
+      return (deg < T(0)) ? deg + T(360) : deg;
+    }
+    // how far to turn from `from` to face `to`, in (-180, 180]
+    static T turnBetween(T from, T to) {
+      T turn = to - from;
+      if (turn > T(180)) turn -= T(360);
+      else if (turn <= T(-180)) turn += T(360);
+      return turn;
+    }
+
+    void apply(int thrust, T turn) {
+      angle += std::clamp(turn, T(-max_turn), T(max_turn));
+      if (angle >= T(360)) angle -= T(360);
+      else if (angle < T(0)) angle += T(360);
+
+      if (thrust == SHIELD) {
+        shield_frames = shield_turns;
+        return;
+      }
+      if (shield_frames > 0) return;
+      if (thrust == BOOST) {
+        // a second boost is just full thrust
+        if (can_boost) can_boost = false;
+        else thrust = 100;
+      }
+      vel += heading() * T(thrust);
+    }
+    void apply(const BasicMove<T>& move) { apply(move.thrust, move.turn); }
+    // what the game's "x y thrust" does: turn toward target, all the way on
+    // the first turn, then thrust
+    void applyTarget(const BasicVec2<T>& target, int thrust) {
+      T want = angleTo(target);
+      if (angle < T(0)) angle = want;
+      apply(thrust, turnBetween(angle, want));
+    }
+
+    void move(T t) { pos += vel * t; }
+
+    // friction, then the rounding the referee sends back as integers: a
+    // Math.round of the position and facing, and a cast to int (toward
+    // zero) of the velocity
+    void endFrame() {
+      using std::trunc;
+      pos = { roundHalfUp(pos.x), roundHalfUp(pos.y) };
+      vel = { trunc(vel.x * T(0.85)), trunc(vel.y * T(0.85)) };
+      angle = roundHalfUp(angle);
+      if (angle >= T(360)) angle -= T(360);
+      if (shield_frames > 0) --shield_frames;
+    }
+
+    // When, within a frame of now, this pod first touches `other`. Pods that
+    // already overlap only count while they're still closing on each other,
+    // which keeps a bounce from being found again at the same instant.
+    bool collisionTime(const BasicPod& other, T& time) const {
+      return contactTime(pos - other.pos, vel - other.vel, T(2 * radius), time);
+    }
+    // When, within a frame, this pod's centre enters the checkpoint at cp.
+    bool checkpointTime(const BasicVec2<T>& cp, int cp_radius, T& time) const {
+      if ((pos - cp).r2() <= T(cp_radius) * T(cp_radius)) {
+        time = T(0);
+        return true;
+      }
+      return contactTime(pos - cp, vel, T(cp_radius), time);
+    }
+
+    // The referee's elastic collision: the impulse that swaps the pods'
+    // velocities along the line between them (weighted by mass), applied
+    // once, then again scaled up to at least 120.
+    void bounce(BasicPod& other) {
+      T m1 = mass(), m2 = other.mass();
+      BasicVec2<T> normal = pos - other.pos;
+      T dist2 = normal.r2();
+      if (dist2 == T(0)) return;
+      BasicVec2<T> force = normal * (dot(normal, vel - other.vel) * m1 * m2 / ((m1 + m2) * dist2));
+      vel -= force / m1;
+      other.vel += force / m2;
+
+      T impulse = force.r();
+      if (impulse > T(0) && impulse < T(120)) force *= T(120) / impulse;
+      vel -= force / m1;
+      other.vel += force / m2;
+    }
+
+  private:
+    // Earliest time in [0, 1] that |d + dv t| comes down to `reach`, for a d
+    // that's closing (d.dv < 0). Written in terms of the closest approach
+    // rather than the raw quadratic so no intermediate gets much bigger than
+    // a squared distance, which a Fixed<> has room for. None of it depends
+    // on how much of the frame is left, so every pair can be worked out at
+    // once (csb-physics-sse.hpp does) and the earliest picked after.
+    static bool contactTime(const BasicVec2<T>& d, const BasicVec2<T>& dv, T reach, T& time) {
+      using std::sqrt;
+      T closing = dot(d, dv);
+      if (!(closing < T(0))) return false;
+      T gap = d.r2() - reach * reach;
+      if (gap <= T(0)) {
+        time = T(0);
+        return true;
+      }
+      // gap = -2 closing t - |dv|^2 t^2 at contact, so it can't come before
+      // gap / (-2 closing), and that has to be inside the frame
+      if (gap > T(-2) * closing) return false;
+      T speed2 = dv.r2();
+      T closest_at = -closing / speed2;
+      T half_chord2 = -closing * closest_at - gap;  // reach^2 - (closest distance)^2
+      if (half_chord2 < T(0)) return false;
+      time = std::max(T(0), closest_at - sqrt(half_chord2 / speed2));
+      return true;
+    }
+  };
+
+  template <class T>
+  struct BasicField {
+    static constexpr int checkpoint_radius = 600;
+    static constexpr int max_checkpoints = 8;
+
+    int num_laps, num_checkpoints;
+    std::array<BasicVec2<T>, max_checkpoints> checkpoints;
+
+    BasicField() : num_laps(), num_checkpoints(), checkpoints() {}
+    template <class U>
+    explicit BasicField(const BasicField<U>& other) : num_laps(other.num_laps), num_checkpoints(other.num_checkpoints) {
+      for (int idx = 0; idx < max_checkpoints; ++idx) checkpoints[idx] = BasicVec2<T>(other.checkpoints[idx]);
+    }
+
+    // the game's initialisation input
+    friend std::istream& operator>>(std::istream& is, BasicField& field) {
+      is >> field.num_laps >> field.num_checkpoints;
+      field.num_checkpoints = std::clamp(field.num_checkpoints, 0, max_checkpoints);
+      for (int idx = 0; idx < field.num_checkpoints; ++idx) {
+        int x, y;
+        is >> x >> y;
+        field.checkpoints[idx] = { T(x), T(y) };
+      }
+      return is;
+    }
+  };
+
+  template <class T>
+  struct BasicRace {
+    static constexpr int timeout_turns = 100;
+
+    std::array<BasicPod<T>, 4> pods;  // team 0's two, then team 1's
+    std::array<int, 2> timeouts;      // turns each team has left to reach a checkpoint
+
+    BasicRace() : pods(), timeouts{ timeout_turns, timeout_turns } {}
+    template <class U>
+    explicit BasicRace(const BasicRace<U>& other) : timeouts(other.timeouts) {
+      for (int idx = 0; idx < 4; ++idx) pods[idx] = BasicPod<T>(other.pods[idx]);
+    }
+
+    BasicPod<T>& pod(int team, int idx) { return pods[2 * team + idx]; }
+    const BasicPod<T>& pod(int team, int idx) const { return pods[2 * team + idx]; }
+
+    // Points every pod without a facing at its next checkpoint, which is
+    // what its first turn does anyway for a bot that aims at it. Only needed
+    // before steering with relative turns.
+    void faceCheckpoints(const BasicField<T>& field) {
+      for (BasicPod<T>& p : pods) {
+        if (p.angle < T(0)) p.angle = p.angleTo(field.checkpoints[p.next_cp]);
+      }
+    }
+
+    // 0 if ongoing
+    // 1 if team 0 has won, 2 if team 1 has won
+    int outcome(const BasicField<T>& field) const {
+      for (int team = 0; team < 2; ++team) {
+        if (pod(team, 0).laps >= field.num_laps || pod(team, 1).laps >= field.num_laps) return 1 + team;
+      }
+      for (int team = 0; team < 2; ++team) {
+        if (timeouts[team] <= 0) return 2 - team;
+      }
+      return 0;
+    }
+
+    void simFrame(const BasicField<T>& field) {
+      --timeouts[0];
+      --timeouts[1];
+      T t = T(0);
+      while (t < T(1)) {
+        // the first thing to happen in what's left of the frame: a pair of
+        // pods touching, or a pod (hit_with == -1) reaching its checkpoint
+        T first = T(1) - t, time;
+        int hit = -1, hit_with = -1;
+        for (int idx = 0; idx < 4; ++idx) {
+          for (int other = idx + 1; other < 4; ++other) {
+            if (pods[idx].collisionTime(pods[other], time) && time < first) {
+              first = time;
+              hit = idx;
+              hit_with = other;
+            }
+          }
+        }
+        for (int idx = 0; idx < 4; ++idx) {
+          const BasicVec2<T>& cp = field.checkpoints[pods[idx].next_cp];
+          if (pods[idx].checkpointTime(cp, field.checkpoint_radius, time) && time < first) {
+            first = time;
+            hit = idx;
+            hit_with = -1;
+          }
+        }
+
+        for (BasicPod<T>& p : pods) p.move(first);
+        t += first;
+        if (hit < 0) break;
+        if (hit_with >= 0) pods[hit].bounce(pods[hit_with]);
+        else passCheckpoint(field, hit);
+      }
+      for (BasicPod<T>& p : pods) p.endFrame();
+    }
+
+    BasicRace next(const BasicField<T>& field) const {
+      BasicRace ret = *this;
+      ret.simFrame(field);
+      return ret;
+    }
+
+    // a turn's input: four lines of "x y vx vy angle next_cp", the reader's
+    // two pods first
+    friend std::istream& operator>>(std::istream& is, BasicRace& race) {
+      for (BasicPod<T>& p : race.pods) {
+        int x, y, vx, vy, angle;
+        is >> x >> y >> vx >> vy >> angle >> p.next_cp;
+        p.pos = { T(x), T(y) };
+        p.vel = { T(vx), T(vy) };
+        p.angle = T(angle);
+      }
+      return is;
+    }
+
+  private:
+    void passCheckpoint(const BasicField<T>& field, int idx) {
+      BasicPod<T>& p = pods[idx];
+      if (p.next_cp == 0) ++p.laps;
+      p.next_cp = (p.next_cp + 1) % field.num_checkpoints;
+      timeouts[idx / 2] = timeout_turns;
+    }
+  };
+}
+
+#endif
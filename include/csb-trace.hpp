@@ -0,0 +1,209 @@
+#ifndef CSB_TRACE_HPP
+#define CSB_TRACE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include <csb-physics.hpp>
+
+// csb-trace.hpp
+namespace kel {
+  // Recorded Coders Strike Back races, frame by frame: what each pod was
+  // told to do and what the referee sent back after it, as ground truth for
+  // the engine in csb-physics.hpp (tools-csb-trace writes and replays them).
+  //
+  // A file is "CSBT" and the version, then races back to back, every number
+  // a little-endian int32:
+  //
+  //   race:    num_laps, num_checkpoints, max_checkpoints (x, y) pairs (the
+  //            unused ones 0), the 4 pods at the start, num_frames, frames
+  //   frame:   the 4 pods' commands, then the 4 pods after the frame
+  //   command: x, y, thrust, the game's output for a pod: thrust is 0 to
+  //            100, SHIELD or BOOST as csb-physics.hpp numbers them
+  //   pod:     x, y, vx, vy, angle, next_cp, the game's input for a pod
+  //
+  // with pods in BasicRace's order, team 0's two and then team 1's. Only
+  // what the game shows is recorded: laps, boosts, shields and timeouts
+  // follow from the commands and the checkpoints passed.
+
+  struct TracePod {
+    int32_t x, y, vx, vy, angle, next_cp;
+
+    TracePod() : x(), y(), vx(), vy(), angle(), next_cp() {}
+    template <class T>
+    explicit TracePod(const BasicPod<T>& pod)
+      : x(int32_t(double(pod.pos.x))), y(int32_t(double(pod.pos.y))),
+        vx(int32_t(double(pod.vel.x))), vy(int32_t(double(pod.vel.y))),
+        angle(int32_t(double(pod.angle))), next_cp(pod.next_cp) {}
+
+    // sets what the game shows of `pod`, leaving the rest
+    template <class T>
+    void setVisible(BasicPod<T>& pod) const {
+      pod.pos = { T(x), T(y) };
+      pod.vel = { T(vx), T(vy) };
+      pod.angle = T(angle);
+      pod.next_cp = next_cp;
+    }
+  };
+
+  struct TraceCommand {
+    int32_t x, y, thrust;
+
+    template <class T>
+    void apply(BasicPod<T>& pod) const { pod.applyTarget({ T(x), T(y) }, thrust); }
+  };
+
+  struct TraceFrame {
+    std::array<TraceCommand, 4> commands;
+    std::array<TracePod, 4> pods;
+  };
+
+  struct TraceRace {
+    int32_t num_laps = 0, num_checkpoints = 0;
+    std::array<std::array<int32_t, 2>, BasicField<double>::max_checkpoints> checkpoints = {};
+    std::array<TracePod, 4> start;
+    std::vector<TraceFrame> frames;
+
+    TraceRace() = default;
+    template <class T>
+    TraceRace(const BasicField<T>& field, const BasicRace<T>& race)
+      : num_laps(field.num_laps), num_checkpoints(field.num_checkpoints) {
+      for (int idx = 0; idx < field.num_checkpoints; ++idx) {
+        checkpoints[idx] = { int32_t(double(field.checkpoints[idx].x)), int32_t(double(field.checkpoints[idx].y)) };
+      }
+      for (int idx = 0; idx < 4; ++idx) start[idx] = TracePod(race.pods[idx]);
+    }
+
+    template <class T>
+    BasicField<T> field() const {
+      BasicField<T> ret;
+      ret.num_laps = num_laps;
+      ret.num_checkpoints = num_checkpoints;
+      for (int idx = 0; idx < num_checkpoints; ++idx) ret.checkpoints[idx] = { T(checkpoints[idx][0]), T(checkpoints[idx][1]) };
+      return ret;
+    }
+    template <class T>
+    BasicRace<T> startRace() const {
+      BasicRace<T> ret;
+      for (int idx = 0; idx < 4; ++idx) start[idx].setVisible(ret.pods[idx]);
+      return ret;
+    }
+
+    // The race after `frame`, given the race before it and `sim`, that frame
+    // simulated from `before`. What the game shows comes from the recording,
+    // laps and timeouts from the checkpoints it shows being passed, and
+    // boosts and shields from `sim`, since only the commands decide those.
+    template <class T>
+    BasicRace<T> after(int frame, const BasicRace<T>& before, const BasicRace<T>& sim) const {
+      BasicRace<T> ret = sim;
+      ret.timeouts = { before.timeouts[0] - 1, before.timeouts[1] - 1 };
+      for (int idx = 0; idx < 4; ++idx) {
+        BasicPod<T>& pod = ret.pods[idx];
+        frames[frame].pods[idx].setVisible(pod);
+        pod.laps = before.pods[idx].laps;
+        if (pod.next_cp != before.pods[idx].next_cp) {
+          if (before.pods[idx].next_cp == 0) ++pod.laps;
+          ret.timeouts[idx / 2] = BasicRace<T>::timeout_turns;
+        }
+      }
+      return ret;
+    }
+  };
+
+  namespace trace_io {
+    constexpr char magic[4] = { 'C', 'S', 'B', 'T' };
+    constexpr int32_t version = 1;
+
+    inline void put(std::ostream& os, int32_t value) {
+      uint32_t bits = uint32_t(value);
+      char bytes[4] = { char(bits), char(bits >> 8), char(bits >> 16), char(bits >> 24) };
+      os.write(bytes, 4);
+    }
+    inline bool get(std::istream& is, int32_t& value) {
+      unsigned char bytes[4];
+      if (!is.read(reinterpret_cast<char*>(bytes), 4)) return false;
+      value = int32_t(uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24);
+      return true;
+    }
+
+    inline void put(std::ostream& os, const TracePod& pod) {
+      for (int32_t value : { pod.x, pod.y, pod.vx, pod.vy, pod.angle, pod.next_cp }) put(os, value);
+    }
+    inline bool get(std::istream& is, TracePod& pod) {
+      return get(is, pod.x) && get(is, pod.y) && get(is, pod.vx) && get(is, pod.vy)
+        && get(is, pod.angle) && get(is, pod.next_cp);
+    }
+  }
+
+  inline void writeTrace(std::ostream& os, const std::vector<TraceRace>& races) {
+    using namespace trace_io;
+    os.write(magic, 4);
+    put(os, version);
+    for (const TraceRace& race : races) {
+      put(os, race.num_laps);
+      put(os, race.num_checkpoints);
+      for (const std::array<int32_t, 2>& cp : race.checkpoints) {
+        put(os, cp[0]);
+        put(os, cp[1]);
+      }
+      for (const TracePod& pod : race.start) put(os, pod);
+      put(os, int32_t(race.frames.size()));
+      for (const TraceFrame& frame : race.frames) {
+        for (const TraceCommand& cmd : frame.commands) {
+          put(os, cmd.x);
+          put(os, cmd.y);
+          put(os, cmd.thrust);
+        }
+        for (const TracePod& pod : frame.pods) put(os, pod);
+      }
+    }
+  }
+
+  // false if it isn't a trace this version reads, or a race is cut short
+  // or can't be played (a checkpoint out of range)
+  inline bool readTrace(std::istream& is, std::vector<TraceRace>& races) {
+    using namespace trace_io;
+    char file_magic[4];
+    int32_t file_version;
+    if (!is.read(file_magic, 4) || !std::equal(file_magic, file_magic + 4, magic)) return false;
+    if (!get(is, file_version) || file_version != version) return false;
+
+    races.clear();
+    TraceRace race;
+    while (get(is, race.num_laps)) {
+      if (!get(is, race.num_checkpoints)) return false;
+      if (race.num_checkpoints < 1 || race.num_checkpoints > int32_t(race.checkpoints.size())) return false;
+      for (std::array<int32_t, 2>& cp : race.checkpoints) {
+        if (!get(is, cp[0]) || !get(is, cp[1])) return false;
+      }
+      for (TracePod& pod : race.start) {
+        if (!get(is, pod)) return false;
+      }
+      int32_t num_frames;
+      if (!get(is, num_frames) || num_frames < 0) return false;
+      race.frames.resize(num_frames);
+      for (TraceFrame& frame : race.frames) {
+        for (TraceCommand& cmd : frame.commands) {
+          if (!get(is, cmd.x) || !get(is, cmd.y) || !get(is, cmd.thrust)) return false;
+        }
+        for (TracePod& pod : frame.pods) {
+          if (!get(is, pod)) return false;
+        }
+      }
+      auto bad_cp = [&](const TracePod& pod) { return pod.next_cp < 0 || pod.next_cp >= race.num_checkpoints; };
+      if (std::any_of(race.start.begin(), race.start.end(), bad_cp)) return false;
+      for (const TraceFrame& frame : race.frames) {
+        if (std::any_of(frame.pods.begin(), frame.pods.end(), bad_cp)) return false;
+      }
+      races.push_back(race);
+    }
+    // a clean end is one between races
+    return is.eof() && is.gcount() == 0;
+  }
+}
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef FIXED_CONTAINERS_HPP
+#define FIXED_CONTAINERS_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+
+// 1 to check every index, push and pop against the size/capacity (and abort
+// with a message when one's out of range); off by default under NDEBUG
+#ifndef CONTAINER_CHECKS
+#  ifdef NDEBUG
+#    define CONTAINER_CHECKS 0
+#  else
+#    define CONTAINER_CHECKS 1
+#  endif
+#endif
+
+// fixed-containers.hpp
+namespace kel {
+  // Containers with their capacity fixed at compile time and their elements
+  // stored inline, so they never allocate. The storage is a plain T[N]: T has
+  // to be default constructible, all N are constructed up front, and popped
+  // slots keep their old value until they're reused. In return a container
+  // of a trivially copyable T is itself trivially copyable.
+#if CONTAINER_CHECKS
+#define _containerCheck(cond, what)                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::fputs(what "\n", stderr);                                           \
+      std::abort();                                                            \
+    }                                                                          \
+  } while (0)
+#else
+#define _containerCheck(cond, what) ((void)0)
+#endif
+
+  template <class T, size_t N>
+  class static_vector {
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t capacity() noexcept { return N; }
+    constexpr size_t size() const noexcept { return count; }
+    constexpr bool empty() const noexcept { return count == 0; }
+    constexpr bool full() const noexcept { return count == N; }
+
+    constexpr T& operator[](size_t idx) noexcept {
+      _containerCheck(idx < count, "static_vector: index out of range");
+      return items[idx];
+    }
+    constexpr const T& operator[](size_t idx) const noexcept {
+      _containerCheck(idx < count, "static_vector: index out of range");
+      return items[idx];
+    }
+    constexpr T& front() noexcept { return (*this)[0]; }
+    constexpr const T& front() const noexcept { return (*this)[0]; }
+    constexpr T& back() noexcept { return (*this)[count - 1]; }
+    constexpr const T& back() const noexcept { return (*this)[count - 1]; }
+
+    constexpr T* data() noexcept { return items; }
+    constexpr const T* data() const noexcept { return items; }
+    constexpr T* begin() noexcept { return items; }
+    constexpr const T* begin() const noexcept { return items; }
+    constexpr T* end() noexcept { return items + count; }
+    constexpr const T* end() const noexcept { return items + count; }
+
+    constexpr void push_back(const T& value) noexcept(std::is_nothrow_copy_assignable<T>::value) {
+      _containerCheck(count < N, "static_vector: push_back past capacity");
+      items[count++] = value;
+    }
+    constexpr void push_back(T&& value) noexcept(std::is_nothrow_move_assignable<T>::value) {
+      _containerCheck(count < N, "static_vector: push_back past capacity");
+      items[count++] = std::move(value);
+    }
+    template <class... Args>
+    constexpr T& emplace_back(Args&&... args) {
+      _containerCheck(count < N, "static_vector: emplace_back past capacity");
+      return items[count++] = T(std::forward<Args>(args)...);
+    }
+    constexpr void pop_back() noexcept {
+      _containerCheck(count > 0, "static_vector: pop_back on empty");
+      --count;
+    }
+    constexpr void resize(size_t new_size) noexcept {
+      _containerCheck(new_size <= N, "static_vector: resize past capacity");
+      count = new_size;
+    }
+    constexpr void clear() noexcept { count = 0; }
+    // O(1): the last element takes its place, so the order isn't kept
+    constexpr void swapRemove(size_t idx) noexcept {
+      _containerCheck(idx < count, "static_vector: index out of range");
+      items[idx] = std::move(items[--count]);
+    }
+
+  private:
+    T items[N] = {};
+    size_t count = 0;
+  };
+
+  // FIFO over a circular buffer: push at the back, pop from the front
+  template <class T, size_t N>
+  class ring_queue {
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+
+    static constexpr size_t capacity() noexcept { return N; }
+    constexpr size_t size() const noexcept { return count; }
+    constexpr bool empty() const noexcept { return count == 0; }
+    constexpr bool full() const noexcept { return count == N; }
+
+    constexpr T& front() noexcept {
+      _containerCheck(count > 0, "ring_queue: front on empty");
+      return items[head];
+    }
+    constexpr const T& front() const noexcept {
+      _containerCheck(count > 0, "ring_queue: front on empty");
+      return items[head];
+    }
+    constexpr T& back() noexcept {
+      _containerCheck(count > 0, "ring_queue: back on empty");
+      return items[wrap(head + count - 1)];
+    }
+    constexpr const T& back() const noexcept {
+      _containerCheck(count > 0, "ring_queue: back on empty");
+      return items[wrap(head + count - 1)];
+    }
+    // 0 is the front
+    constexpr T& operator[](size_t idx) noexcept {
+      _containerCheck(idx < count, "ring_queue: index out of range");
+      return items[wrap(head + idx)];
+    }
+    constexpr const T& operator[](size_t idx) const noexcept {
+      _containerCheck(idx < count, "ring_queue: index out of range");
+      return items[wrap(head + idx)];
+    }
+
+    constexpr void push(const T& value) noexcept(std::is_nothrow_copy_assignable<T>::value) {
+      _containerCheck(count < N, "ring_queue: push past capacity");
+      items[wrap(head + count++)] = value;
+    }
+    constexpr void push(T&& value) noexcept(std::is_nothrow_move_assignable<T>::value) {
+      _containerCheck(count < N, "ring_queue: push past capacity");
+      items[wrap(head + count++)] = std::move(value);
+    }
+    constexpr void pop() noexcept {
+      _containerCheck(count > 0, "ring_queue: pop on empty");
+      head = wrap(head + 1);
+      --count;
+    }
+    constexpr void clear() noexcept { head = count = 0; }
+
+  private:
+    T items[N] = {};
+    size_t head = 0, count = 0;
+
+    // indices never get past 2N - 2, so one compare is enough
+    static constexpr size_t wrap(size_t idx) noexcept { return (idx >= N) ? idx - N : idx; }
+  };
+
+  // LIFO, with std::stack's interface
+  template <class T, size_t N>
+  class inline_stack {
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using container_type = static_vector<T, N>;
+
+    static constexpr size_t capacity() noexcept { return N; }
+    constexpr size_t size() const noexcept { return items.size(); }
+    constexpr bool empty() const noexcept { return items.empty(); }
+    constexpr bool full() const noexcept { return items.full(); }
+
+    constexpr T& top() noexcept { return items.back(); }
+    constexpr const T& top() const noexcept { return items.back(); }
+    constexpr void push(const T& value) { items.push_back(value); }
+    constexpr void push(T&& value) { items.push_back(std::move(value)); }
+    template <class... Args>
+    constexpr T& emplace(Args&&... args) { return items.emplace_back(std::forward<Args>(args)...); }
+    constexpr void pop() noexcept { items.pop_back(); }
+    constexpr void clear() noexcept { items.clear(); }
+
+    // bottom to top
+    constexpr const T* begin() const noexcept { return items.begin(); }
+    constexpr const T* end() const noexcept { return items.end(); }
+
+  private:
+    container_type items;
+  };
+
+  static_assert(std::is_trivially_copyable<static_vector<int, 4>>::value
+    && std::is_trivially_copyable<ring_queue<int, 4>>::value
+    && std::is_trivially_copyable<inline_stack<int, 4>>::value,
+    "fixed containers of a trivially copyable type should be too");
+}
+
+#endif
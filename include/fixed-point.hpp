@@ -0,0 +1,96 @@
+#ifndef FIXED_POINT_HPP
+#define FIXED_POINT_HPP
+
+#include <cmath>
+#include <cstdint>
+
+// fixed-point.hpp
+namespace kel {
+  // A signed number with FracBits of its 64 bits after the point, for maths
+  // that has to come out the same whatever the compiler does with floating
+  // point. Adding, subtracting and comparing are plain integer ops;
+  // multiplying and dividing go through 128 bits, so only the result has to
+  // fit, and drop the bits they can't keep (rounding toward -inf).
+  //
+  // It converts implicitly from int and double so generic code can write
+  // T(0.85) or x * 2, and explicitly back. sqrt, round, floor and trunc are exact;
+  // cos, sin and atan2 go through double, which makes them only as portable
+  // as the libm underneath. All of them are found by ADL, so templates that
+  // call them unqualified work on a Fixed the same as on a float.
+  template <int FracBits>
+  class Fixed {
+    static_assert(FracBits > 0 && FracBits < 62, "Fixed needs some bits on both sides of the point");
+
+  public:
+    static constexpr int frac_bits = FracBits;
+    static constexpr int64_t one = int64_t(1) << FracBits;
+
+    constexpr Fixed() : raw() {}
+    constexpr Fixed(int value) : raw(int64_t(value) * one) {}
+    constexpr Fixed(double value) : raw(int64_t(value * one + ((value < 0) ? -0.5 : 0.5))) {}
+
+    static constexpr Fixed fromRaw(int64_t raw) {
+      Fixed ret;
+      ret.raw = raw;
+      return ret;
+    }
+    constexpr int64_t getRaw() const { return raw; }
+
+    explicit constexpr operator double() const { return double(raw) / one; }
+    explicit constexpr operator float() const { return float(double(*this)); }
+    // toward zero, like converting a double
+    explicit constexpr operator int() const { return int(raw / one); }
+
+    constexpr Fixed operator-() const { return fromRaw(-raw); }
+    friend constexpr Fixed operator+(Fixed lhs, Fixed rhs) { return fromRaw(lhs.raw + rhs.raw); }
+    friend constexpr Fixed operator-(Fixed lhs, Fixed rhs) { return fromRaw(lhs.raw - rhs.raw); }
+    friend constexpr Fixed operator*(Fixed lhs, Fixed rhs) {
+      return fromRaw(int64_t((__int128(lhs.raw) * rhs.raw) >> FracBits));
+    }
+    friend constexpr Fixed operator/(Fixed lhs, Fixed rhs) {
+      __int128 num = __int128(lhs.raw) * one;
+      __int128 quot = num / rhs.raw;
+      // floor rather than toward zero, to match the shift in operator*
+      if ((num % rhs.raw != 0) && ((num < 0) != (rhs.raw < 0))) --quot;
+      return fromRaw(int64_t(quot));
+    }
+    constexpr Fixed& operator+=(Fixed rhs) { return *this = *this + rhs; }
+    constexpr Fixed& operator-=(Fixed rhs) { return *this = *this - rhs; }
+    constexpr Fixed& operator*=(Fixed rhs) { return *this = *this * rhs; }
+    constexpr Fixed& operator/=(Fixed rhs) { return *this = *this / rhs; }
+
+    friend constexpr bool operator==(Fixed lhs, Fixed rhs) { return lhs.raw == rhs.raw; }
+    friend constexpr bool operator!=(Fixed lhs, Fixed rhs) { return lhs.raw != rhs.raw; }
+    friend constexpr bool operator<(Fixed lhs, Fixed rhs) { return lhs.raw < rhs.raw; }
+    friend constexpr bool operator>(Fixed lhs, Fixed rhs) { return lhs.raw > rhs.raw; }
+    friend constexpr bool operator<=(Fixed lhs, Fixed rhs) { return lhs.raw <= rhs.raw; }
+    friend constexpr bool operator>=(Fixed lhs, Fixed rhs) { return lhs.raw >= rhs.raw; }
+
+    friend constexpr Fixed abs(Fixed x) { return (x.raw < 0) ? -x : x; }
+    // halves away from zero, like std::round
+    friend constexpr Fixed round(Fixed x) {
+      int64_t mag = ((x.raw < 0) ? -x.raw : x.raw) + one / 2;
+      mag -= mag % one;
+      return fromRaw((x.raw < 0) ? -mag : mag);
+    }
+    friend constexpr Fixed trunc(Fixed x) { return fromRaw(x.raw - x.raw % one); }
+    friend constexpr Fixed floor(Fixed x) { return fromRaw(x.raw & ~(one - 1)); }
+    // the largest result whose square doesn't pass x; 0 for x <= 0
+    friend Fixed sqrt(Fixed x) {
+      if (x.raw <= 0) return Fixed();
+      unsigned __int128 target = (unsigned __int128)x.raw << FracBits;
+      uint64_t root = uint64_t(std::sqrt(double(target)));
+      while ((unsigned __int128)root * root > target) --root;
+      while ((unsigned __int128)(root + 1) * (root + 1) <= target) ++root;
+      return fromRaw(int64_t(root));
+    }
+    friend Fixed cos(Fixed x) { return Fixed(std::cos(double(x))); }
+    friend Fixed sin(Fixed x) { return Fixed(std::sin(double(x))); }
+    friend Fixed atan2(Fixed y, Fixed x) { return Fixed(std::atan2(double(y), double(x))); }
+
+  private:
+    int64_t raw;
+  };
+}
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef INSTRUMENT_HPP
+#define INSTRUMENT_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 1 for the timers, counters and histograms below; 0 compiles them out
+#ifndef INSTRUMENT
+#define INSTRUMENT 0
+#endif
+// which log lines are kept: 0 none, 1 errors, 2 and info (a few lines a
+// turn), 3 and debug (anything inside hot loops)
+#ifndef LOG_LEVEL
+#define LOG_LEVEL 1
+#endif
+
+// instrument.hpp
+namespace kel {
+  // Diagnostics that cost nothing unless they're switched on:
+  //   timeScope("expand");            time from here to the end of the scope (rdtsc)
+  //   countEvent("nodes popped");     add 1 to a named counter
+  //   countAdd("plies", n);           add n
+  //   histogramAdd("depth", depth);   record a value; shown in power-of-2 buckets
+  //   logInfo("best " << move);       a line of log, anything cerr can print
+  //   logDebug(...) / logError(...)   the same at the other levels
+  //   instrTurnEnd();                 once a turn, after the answer's flushed
+  // Everything is collected over the turn and written to stderr in one go by
+  // instrTurnEnd(), then reset; what's left at exit is written then. Errors
+  // are the exception: they go out straight away, in case the bot's about to
+  // die. With INSTRUMENT 0 and LOG_LEVEL 0 every macro is ((void)0), and
+  // the arguments aren't evaluated at all.
+#if INSTRUMENT || LOG_LEVEL > 0
+  namespace instr {
+    // the cycle counter where there is one, steady_clock nanoseconds otherwise
+    inline uint64_t ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    struct TimerStat {
+      const char* name;
+      uint64_t calls, ticks;
+    };
+    struct CounterStat {
+      const char* name;
+      int64_t value;
+    };
+    struct HistogramStat {
+      const char* name;
+      uint64_t samples;
+      int64_t min, max, sum;
+      uint64_t buckets[65];   // 0 for values <= 0, then n for [2^(n-1), 2^n)
+    };
+
+    class Registry {
+    public:
+      static constexpr size_t max_stats = 64;   // of each kind; more than that are dropped
+
+      Registry() : start_ticks(ticks()), start_time(std::chrono::steady_clock::now()) {}
+      ~Registry() { if (pending || hasStats()) endTurn(); }
+
+      // Looked up by name once per call site (see the macros), so several
+      // sites with the same name add up.
+      TimerStat& timer(const char* name) noexcept { return find(timers, num_timers, name); }
+      CounterStat& counter(const char* name) noexcept { return find(counters, num_counters, name); }
+      HistogramStat& histogram(const char* name) noexcept {
+        HistogramStat& stat = find(histograms, num_histograms, name);
+        if (stat.samples == 0) resetHistogram(stat);
+        return stat;
+      }
+      void add(HistogramStat& stat, int64_t value) noexcept {
+        if (value < stat.min) stat.min = value;
+        if (value > stat.max) stat.max = value;
+        stat.sum += value;
+        ++stat.samples;
+        ++stat.buckets[(value <= 0) ? 0 : 64 - __builtin_clzll(uint64_t(value))];
+      }
+
+      std::ostream& log() noexcept {
+        pending = true;
+        return log_lines;
+      }
+      void logNow(const std::string& line) noexcept { writeAll(line.data(), line.size()); }
+
+      void endTurn() {
+        if (!pending && !hasStats()) {
+          ++turn;
+          return;
+        }
+        std::ostringstream out;
+        out << "-- turn " << turn++ << " --\n" << log_lines.str();
+        const double ticks_per_us = ticksPerMicro();
+        out << std::fixed << std::setprecision(2);
+        for (size_t idx = 0; idx < num_timers; ++idx) {
+          TimerStat& stat = timers[idx];
+          if (stat.calls == 0) continue;
+          const double total_us = stat.ticks / ticks_per_us;
+          out << "time  " << std::left << std::setw(24) << stat.name << std::right
+              << std::setw(10) << stat.calls << " calls " << std::setw(12) << total_us << " us "
+              << std::setw(10) << total_us / stat.calls << " us/call\n";
+          stat.calls = stat.ticks = 0;
+        }
+        for (size_t idx = 0; idx < num_counters; ++idx) {
+          CounterStat& stat = counters[idx];
+          if (stat.value == 0) continue;
+          out << "count " << std::left << std::setw(24) << stat.name << std::right << std::setw(10) << stat.value << '\n';
+          stat.value = 0;
+        }
+        for (size_t idx = 0; idx < num_histograms; ++idx) {
+          HistogramStat& stat = histograms[idx];
+          if (stat.samples == 0) continue;
+          out << "hist  " << std::left << std::setw(24) << stat.name << std::right
+              << " n " << stat.samples << ", min " << stat.min << ", mean " << double(stat.sum) / stat.samples
+              << ", max " << stat.max << "\n     ";
+          for (int bucket = 0; bucket < 65; ++bucket) {
+            if (stat.buckets[bucket] == 0) continue;
+            if (bucket == 0) out << " <=0:";
+            else if (bucket == 1) out << " 1:";
+            else out << ' ' << (uint64_t(1) << (bucket - 1)) << '-' << (uint64_t(1) << bucket) - 1 << ':';
+            out << stat.buckets[bucket];
+          }
+          out << '\n';
+          resetHistogram(stat);
+        }
+        const std::string text = out.str();
+        writeAll(text.data(), text.size());
+        log_lines.str(std::string());
+        pending = false;
+      }
+
+    private:
+      TimerStat timers[max_stats] = {};
+      CounterStat counters[max_stats] = {};
+      HistogramStat histograms[max_stats] = {};
+      size_t num_timers = 0, num_counters = 0, num_histograms = 0;
+      std::ostringstream log_lines;
+      int turn = 0;
+      bool pending = false;
+      uint64_t start_ticks;
+      std::chrono::steady_clock::time_point start_time;
+
+      bool hasStats() const noexcept {
+        for (size_t idx = 0; idx < num_timers; ++idx) if (timers[idx].calls) return true;
+        for (size_t idx = 0; idx < num_counters; ++idx) if (counters[idx].value) return true;
+        for (size_t idx = 0; idx < num_histograms; ++idx) if (histograms[idx].samples) return true;
+        return false;
+      }
+      template <class Stat>
+      Stat& find(Stat (&stats)[max_stats], size_t& count, const char* name) noexcept {
+        for (size_t idx = 0; idx < count; ++idx) {
+          if (std::strcmp(stats[idx].name, name) == 0) return stats[idx];
+        }
+        if (count == max_stats) {
+          static Stat overflow;   // counted, but never shown
+          return overflow;
+        }
+        stats[count].name = name;
+        return stats[count++];
+      }
+      static void resetHistogram(HistogramStat& stat) noexcept {
+        const char* name = stat.name;
+        stat = HistogramStat();
+        stat.name = name;
+        stat.min = INT64_MAX;
+        stat.max = INT64_MIN;
+      }
+      // calibrated against steady_clock over everything since startup
+      double ticksPerMicro() const noexcept {
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+        return (us > 0) ? (ticks() - start_ticks) / us : 1.0;
+      }
+      static void writeAll(const char* data, size_t len) noexcept {
+        while (len > 0) {
+          ssize_t put = ::write(STDERR_FILENO, data, len);
+          if (put <= 0) return;
+          data += put;
+          len -= size_t(put);
+        }
+      }
+    };
+
+    inline Registry& registry() {
+      static Registry reg;
+      return reg;
+    }
+
+    class ScopedTimer {
+    public:
+      explicit ScopedTimer(TimerStat& stat) noexcept : stat(stat), start(ticks()) {}
+      ~ScopedTimer() {
+        stat.ticks += ticks() - start;
+        ++stat.calls;
+      }
+    private:
+      TimerStat& stat;
+      uint64_t start;
+    };
+  }
+#endif
+
+#define _instrCat2(a, b) a##b
+#define _instrCat(a, b) _instrCat2(a, b)
+#define _instrSite(kind, name)                                                 \
+  static auto& _instrCat(_instr_stat_, __LINE__) = ::kel::instr::registry().kind(name)
+
+#if INSTRUMENT
+#define timeScope(name)                                                        \
+  _instrSite(timer, name);                                                     \
+  ::kel::instr::ScopedTimer _instrCat(_instr_timer_, __LINE__)(_instrCat(_instr_stat_, __LINE__))
+#define countAdd(name, n)                                                      \
+  do {                                                                         \
+    _instrSite(counter, name);                                                 \
+    _instrCat(_instr_stat_, __LINE__).value += (n);                            \
+  } while (0)
+#define countEvent(name) countAdd(name, 1)
+#define histogramAdd(name, value)                                              \
+  do {                                                                         \
+    _instrSite(histogram, name);                                               \
+    ::kel::instr::registry().add(_instrCat(_instr_stat_, __LINE__), (value));  \
+  } while (0)
+#else
+#define timeScope(name) ((void)0)
+#define countAdd(name, n) ((void)0)
+#define countEvent(name) ((void)0)
+#define histogramAdd(name, value) ((void)0)
+#endif
+
+#if LOG_LEVEL >= 1
+#define logError(...)                                                          \
+  do {                                                                         \
+    std::ostringstream _instr_line;                                            \
+    _instr_line << "error: " << __VA_ARGS__ << '\n';                           \
+    ::kel::instr::registry().logNow(_instr_line.str());                        \
+  } while (0)
+#else
+#define logError(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 2
+#define logInfo(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logInfo(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 3
+#define logDebug(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logDebug(...) ((void)0)
+#endif
+
+#if INSTRUMENT || LOG_LEVEL >= 2
+#define instrTurnEnd() ::kel::instr::registry().endTurn()
+#else
+#define instrTurnEnd() ((void)0)
+#endif
+}
+
+#endif
@@ -1,6 +1,8 @@
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <functional>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -8,20 +10,231 @@
 // lookup-tables.hpp
 namespace kel {
 #define rtype(fn) decltype(fn::eval(std::declval<size_t>()))
-#define rtype2d(fn) decltype(fn::eval(std::declval<size_t>(), std::declval<size_t>()))
 
-  template <class GenFn, size_t N, size_t... Indexes>
-  static constexpr std::array<rtype(GenFn), N> 
-    _makeLookupTable(std::index_sequence<Indexes...>) noexcept {
-    constexpr std::array<rtype(GenFn), N> table{{GenFn::eval(Indexes)...}};
+  // Tables are filled by plain constexpr loops instead of expanding an
+  // index_sequence into one initializer with an element per entry. GCC gives
+  // every constant expression a budget (-fconstexpr-loop-limit,
+  // -fconstexpr-ops-limit), so tables up to lut_flat_max entries are filled in
+  // one go into a flat std::array, and bigger ones are split into chunks of
+  // lut_chunk entries that each get their own budget.
+  constexpr size_t lut_chunk = 1 << 12;
+  constexpr size_t lut_flat_max = 1 << 16;
+
+  // not constexpr on purpose: reaching it while filling a table is a compile error
+  inline void lookupValueDoesntFitElementType() noexcept {}
+
+  // A plain array with just enough of std::array's interface. Indexing is a
+  // builtin subscript rather than a call to std::array::operator[], which
+  // matters when tables are built out of other tables at compile time.
+  template <class T, size_t N>
+  struct LookupTable {
+    T values[N];
+
+    constexpr const T& operator[](size_t idx) const noexcept { return values[idx]; }
+    static constexpr size_t size() noexcept { return N; }
+    constexpr const T* begin() const noexcept { return values; }
+    constexpr const T* end() const noexcept { return values + N; }
+  };
+
+  // entries [Begin, min(Begin + Len, N)) of the table, as T
+  template <class T, class GenFn, size_t N, size_t Begin, size_t Len>
+  static constexpr LookupTable<T, Len> fillLutChunk() noexcept {
+    constexpr size_t end = std::min(Len, N - Begin);
+    LookupTable<T, Len> chunk{};
+    for (size_t start = 0; start < end; start += lut_chunk) {
+      const size_t stop = std::min(end, start + lut_chunk);
+      for (size_t idx = start; idx < stop; ++idx) {
+        const auto value = GenFn::eval(Begin + idx);
+        chunk.values[idx] = static_cast<T>(value);
+        if constexpr (!std::is_same_v<T, std::remove_const_t<decltype(value)>>) {
+          if (static_cast<decltype(value)>(chunk.values[idx]) != value) lookupValueDoesntFitElementType();
+        }
+      }
+    }
+    return chunk;
+  }
+
+  // a table too big to fill flat; indexing costs a shift and a mask more
+  template <class T, size_t N>
+  struct ChunkedLookupTable {
+    static constexpr size_t num_chunks = (N + lut_chunk - 1) / lut_chunk;
+    LookupTable<T, lut_chunk> chunks[num_chunks];
+
+    constexpr const T& operator[](size_t idx) const noexcept {
+      return chunks[idx / lut_chunk].values[idx % lut_chunk];
+    }
+    static constexpr size_t size() noexcept { return N; }
+  };
+  template <class T, class GenFn, size_t N, size_t... Chunks>
+  static constexpr ChunkedLookupTable<T, N> fillChunkedLookupTable(std::index_sequence<Chunks...>) noexcept {
+    return {{ fillLutChunk<T, GenFn, N, Chunks * lut_chunk, lut_chunk>()... }};
+  }
+
+  template <class T, class GenFn, size_t N>
+  static constexpr auto fillLookupTable() noexcept {
+    if constexpr (N <= lut_flat_max) return fillLutChunk<T, GenFn, N, 0, N>();
+    else return fillChunkedLookupTable<T, GenFn, N>(
+      std::make_index_sequence<ChunkedLookupTable<T, N>::num_chunks>{});
+  }
+  template <class GenFn, size_t N>
+  static constexpr auto makeLookupTable() noexcept {
+    return fillLookupTable<rtype(GenFn), GenFn, N>();
+  }
+  // same, but stores every entry as a T (e.g. u8 instead of int); values that
+  // don't survive the round trip fail to compile
+  template <class T, class GenFn, size_t N>
+  static constexpr auto makePackedLookupTable() noexcept {
+    return fillLookupTable<T, GenFn, N>();
+  }
+
+  // Booleans (or small enums) packed Bits to an entry into u64 words, so a
+  // table of 2^18 flags is 32 KB instead of 256 KB. Bits has to divide 64, and
+  // every value has to survive being cut down to Bits bits.
+  template <class T, size_t Bits, size_t N>
+  struct BitLookupTable {
+    static_assert(Bits > 0 && 64 % Bits == 0, "BitLookupTable: Bits has to divide 64");
+    static constexpr size_t per_word = 64 / Bits;
+    static constexpr size_t num_words = (N + per_word - 1) / per_word;
+    static constexpr uint64_t mask = (Bits == 64) ? ~uint64_t(0) : (uint64_t(1) << (Bits % 64)) - 1;
+    LookupTable<uint64_t, num_words> words;
+
+    constexpr T operator[](size_t idx) const noexcept {
+      return static_cast<T>((words.values[idx / per_word] >> (idx % per_word * Bits)) & mask);
+    }
+    static constexpr size_t size() noexcept { return N; }
+  };
+
+  // words [Begin, Begin + Len) of a BitLookupTable
+  template <class Table, class GenFn, size_t Begin, size_t Len>
+  static constexpr LookupTable<uint64_t, Len> fillLutWords() noexcept {
+    constexpr size_t bits = 64 / Table::per_word;
+    LookupTable<uint64_t, Len> words{};
+    for (size_t word = 0; word < Len; ++word) {
+      for (size_t slot = 0; slot < Table::per_word; ++slot) {
+        const size_t idx = (Begin + word) * Table::per_word + slot;
+        if (idx >= Table::size()) break;
+        const auto value = GenFn::eval(idx);
+        const uint64_t packed = static_cast<uint64_t>(value) & Table::mask;
+        if (static_cast<decltype(value)>(packed) != value) lookupValueDoesntFitElementType();
+        words.values[word] |= packed << (slot * bits);
+      }
+    }
+    return words;
+  }
+  // Big tables are filled lut_chunk entries per constant expression like
+  // above, but the words are small enough to copy into one flat array after.
+  template <class Table, class GenFn, size_t... Chunks>
+  static constexpr Table fillBitLookupTable(std::index_sequence<Chunks...>) noexcept {
+    constexpr size_t chunk_words = lut_chunk / Table::per_word;
+    const LookupTable<uint64_t, chunk_words> chunks[] = {
+      fillLutWords<Table, GenFn, Chunks * chunk_words, chunk_words>()... };
+    Table table{};
+    for (size_t word = 0; word < Table::num_words; ++word) {
+      table.words.values[word] = chunks[word / chunk_words].values[word % chunk_words];
+    }
     return table;
   }
-  template <class GenFn, size_t N, size_t... Indexes>
-  static constexpr std::array<rtype(GenFn), N> makeLookupTable() noexcept {
-    return _makeLookupTable<GenFn, N>(std::make_index_sequence<N>{});
+  template <size_t Bits, class GenFn, size_t N>
+  static constexpr auto makeBitLookupTable() noexcept {
+    using Table = BitLookupTable<rtype(GenFn), Bits, N>;
+    if constexpr (N <= lut_flat_max) return Table{ fillLutWords<Table, GenFn, 0, Table::num_words>() };
+    else return fillBitLookupTable<Table, GenFn>(
+      std::make_index_sequence<(N + lut_chunk - 1) / lut_chunk>{});
+  }
+
+  // Where a table lives. A 512-entry table sits in L1 and beats computing
+  // anything, while a 256 KB one can lose to a few ALU ops once a search tree
+  // is fighting it for cache, so this is picked per table (see
+  // tools/lut-policy-bench.cpp):
+  //   compile_time  constexpr table baked into the binary
+  //   startup       the same table, filled by a plain loop during static
+  //                 initialization; costs startup time instead of compile time
+  //                 and binary size. Tables are filled in declaration order, so
+  //                 a startup table may use the tables declared above it, but
+  //                 a compile_time table can't use a startup one.
+  //   compute       no table, every lookup calls the generator
+  enum class LutPolicy { compile_time, startup, compute };
+
+  template <class GenFn, size_t N>
+  struct ComputedLookupTable {
+    constexpr auto operator[](size_t idx) const noexcept { return GenFn::eval(idx); }
+    static constexpr size_t size() noexcept { return N; }
+  };
+
+  // not constexpr, so that a startup table really is filled at runtime
+  template <size_t Bits, class GenFn, size_t N>
+  static auto buildLookupTable() noexcept {
+    if constexpr (Bits == 0) {
+      LookupTable<rtype(GenFn), N> table{};
+      for (size_t idx = 0; idx < N; ++idx) table.values[idx] = GenFn::eval(idx);
+      return table;
+    } else {
+      using Table = BitLookupTable<rtype(GenFn), Bits, N>;
+      Table table{};
+      for (size_t idx = 0; idx < N; ++idx) {
+        const uint64_t packed = static_cast<uint64_t>(GenFn::eval(idx)) & Table::mask;
+        table.words.values[idx / Table::per_word] |= packed << (idx % Table::per_word * Bits);
+      }
+      return table;
+    }
+  }
+
+  // Bits == 0 stores whole values, anything else packs them like BitLookupTable
+  template <LutPolicy Policy, size_t Bits, class GenFn, size_t N>
+  static constexpr auto makeLookupTableWith() noexcept {
+    if constexpr (Policy == LutPolicy::compute) return ComputedLookupTable<GenFn, N>{};
+    else if constexpr (Policy == LutPolicy::startup) return buildLookupTable<Bits, GenFn, N>();
+    else if constexpr (Bits == 0) return makeLookupTable<GenFn, N>();
+    else return makeBitLookupTable<Bits, GenFn, N>();
   }
 
-#define genLookupTable(gen_fn, size)                                           \
+  // Row-major shape of a multi-dimensional table, first index fastest
+  // (so LutShape<w, h> matches the x + w * y layout of the 2d tables).
+  template <size_t... Dims>
+  struct LutShape {
+    static constexpr size_t rank = sizeof...(Dims);
+    static constexpr size_t size = (Dims * ... * size_t(1));
+    static constexpr std::array<size_t, rank> dims{{ Dims... }};
+
+    template <class... Idx>
+    static constexpr size_t flatten(Idx... idx) noexcept {
+      static_assert(sizeof...(Idx) == rank, "LutShape: wrong number of indices");
+      const size_t indices[] = { static_cast<size_t>(idx)... };
+      size_t flat = 0;
+      for (size_t d = rank; d-- > 0;) flat = flat * dims[d] + indices[d];
+      return flat;
+    }
+    static constexpr std::array<size_t, rank> unflatten(size_t flat) noexcept {
+      std::array<size_t, rank> indices{};
+      for (size_t d = 0; d < rank; ++d) {
+        indices[d] = flat % dims[d];
+        flat /= dims[d];
+      }
+      return indices;
+    }
+  };
+
+  // genLookupTableWith(policy, ...) and friends take one of the LutPolicy
+  // names as their first argument (a macro that expands to one works too);
+  // the versions without "With" are compile_time.
+#define lut_compile_time constexpr
+#define lut_startup const
+#define lut_compute constexpr
+#define _lutDeclare(policy, gen_fn, bits, size)                                \
+  lut_##policy auto lut_##gen_fn =                                             \
+    kel::makeLookupTableWith<kel::LutPolicy::policy, bits, gen_##gen_fn, size>()
+
+#define genLookupTableWith(policy, gen_fn, size)                               \
+  struct gen_##gen_fn                                                          \
+  {                                                                            \
+    static constexpr auto eval(size_t input) noexcept                          \
+    {                                                                          \
+      return gen_fn(input);                                                    \
+    }                                                                          \
+  };                                                                           \
+  _lutDeclare(policy, gen_fn, 0, size)
+#define genLookupTable(gen_fn, size) genLookupTableWith(compile_time, gen_fn, size)
+#define genLookupTableAs(gen_fn, type, size)                                   \
   struct gen_##gen_fn                                                          \
   {                                                                            \
     static constexpr auto eval(size_t input) noexcept                          \
@@ -29,10 +242,11 @@ namespace kel {
       return gen_fn(input);                                                    \
     }                                                                          \
   };                                                                           \
-  constexpr auto lut_##gen_fn = kel::makeLookupTable<gen_##gen_fn, size>()
+  constexpr auto lut_##gen_fn =                                                \
+    kel::makePackedLookupTable<type, gen_##gen_fn, size>()
 #define lookup(gen_fn, index) (lut_##gen_fn[index])
 
-#define genLookupTable2d(gen_fn, width, height)                                \
+#define genLookupTable2dWith(policy, gen_fn, width, height)                    \
   struct gen_##gen_fn                                                          \
   {                                                                            \
     static constexpr size_t w = width;                                         \
@@ -41,12 +255,56 @@ namespace kel {
       return gen_fn(input % w, input / w);                                     \
     }                                                                          \
   };                                                                           \
-  constexpr auto lut_##gen_fn =                                                \
-    kel::makeLookupTable<gen_##gen_fn, width * height>()
+  _lutDeclare(policy, gen_fn, 0, width * height)
+#define genLookupTable2d(gen_fn, width, height)                                \
+  genLookupTable2dWith(compile_time, gen_fn, width, height)
 #define lookup2d(gen_fn, x, y) (lut_##gen_fn[x + gen_##gen_fn::w * y])
 
+  // packed tables: genLookupTableBits(fn, 1, size) for a bool per bit
+#define genLookupTableBitsWith(policy, gen_fn, bits, size)                     \
+  struct gen_##gen_fn                                                          \
+  {                                                                            \
+    static constexpr auto eval(size_t input) noexcept                          \
+    {                                                                          \
+      return gen_fn(input);                                                    \
+    }                                                                          \
+  };                                                                           \
+  _lutDeclare(policy, gen_fn, bits, size)
+#define genLookupTableBits(gen_fn, bits, size)                                 \
+  genLookupTableBitsWith(compile_time, gen_fn, bits, size)
+#define lookupBit(gen_fn, index) (lut_##gen_fn[index])
+
+#define genLookupTableBits2dWith(policy, gen_fn, bits, width, height)          \
+  struct gen_##gen_fn                                                          \
+  {                                                                            \
+    static constexpr size_t w = width;                                         \
+    static constexpr auto eval(size_t input) noexcept                          \
+    {                                                                          \
+      return gen_fn(input % w, input / w);                                     \
+    }                                                                          \
+  };                                                                           \
+  _lutDeclare(policy, gen_fn, bits, width * height)
+#define genLookupTableBits2d(gen_fn, bits, width, height)                      \
+  genLookupTableBits2dWith(compile_time, gen_fn, bits, width, height)
+#define lookupBit2d(gen_fn, x, y) (lut_##gen_fn[x + gen_##gen_fn::w * y])
+
+  // any number of dimensions: genLookupTableNd(fn, type, d0, d1, d2, ...)
+  // calls fn(i0, i1, i2, ...) for every index and stores the result as `type`
+#define genLookupTableNd(gen_fn, type, ...)                                    \
+  struct gen_##gen_fn                                                          \
+  {                                                                            \
+    using shape = kel::LutShape<__VA_ARGS__>;                                  \
+    static constexpr auto eval(size_t input) noexcept                          \
+    {                                                                          \
+      return std::apply([](auto... idx) { return gen_fn(idx...); },            \
+                        shape::unflatten(input));                              \
+    }                                                                          \
+  };                                                                           \
+  constexpr auto lut_##gen_fn = kel::makePackedLookupTable<type, gen_##gen_fn, \
+    gen_##gen_fn::shape::size>()
+#define lookupNd(gen_fn, ...) (lut_##gen_fn[gen_##gen_fn::shape::flatten(__VA_ARGS__)])
+
 #undef rtype
-#undef rtype2d
 }
 
 
@@ -70,3 +328,33 @@ static constexpr int popcnt_of_2(size_t a, size_t b) noexcept {
 
 genLookupTable2d(popcnt_of_2, 10, 10);
 constexpr int b = lookup2d(popcnt_of_2, 7, 4);
+
+// Example 3: 3 dimensions, stored a byte per entry
+static constexpr int popcnt_of_3(size_t a, size_t b, size_t c) noexcept {
+  return lookup(popcnt, a) + lookup(popcnt, b) + lookup(popcnt, c);
+}
+
+genLookupTableNd(popcnt_of_3, uint8_t, 10, 10, 10);
+constexpr int c = lookupNd(popcnt_of_3, 7, 4, 9);
+
+// Example 4: one bit per entry
+static constexpr bool isOdd(size_t a) noexcept {
+  return lookup(popcnt, a) % 2;
+}
+
+genLookupTableBits(isOdd, 1, 10);
+constexpr bool d = lookupBit(isOdd, 7);
+
+// Example 5: computed on every lookup, or filled in at startup
+static constexpr int lowestBit(size_t mask) noexcept {
+  return mask ? __builtin_ctzll(mask) : -1;
+}
+
+genLookupTableWith(compute, lowestBit, 10);
+constexpr int e = lookup(lowestBit, 8);
+
+static constexpr int highestBit(size_t mask) noexcept {
+  return mask ? 63 - __builtin_clzll(mask) : -1;
+}
+
+genLookupTableWith(startup, highestBit, 10);   // lookup(highestBit, 8) is 3, but only at runtime
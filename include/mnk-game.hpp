@@ -0,0 +1,211 @@
+#ifndef MNK_GAME_HPP
+#define MNK_GAME_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <typedefs.hpp>
+
+// mnk-game.hpp
+namespace kel {
+  // Bitboard for an m,n,k-game: a W x H board where the first player to get
+  // K stones in a row (in any direction) wins. Tic-tac-toe is MnkBoard<3, 3, 3>.
+  //
+  // Cells are stored row by row with one always-empty padding bit after every
+  // row, so shifting by 1, W, W + 1 or W + 2 moves every stone one step along
+  // a line without wrapping onto the next row. Boards up to 64 bits use a u64,
+  // bigger ones (up to 128 bits) an unsigned __int128.
+  template <int W, int H, int K>
+  class MnkBoard {
+  public:
+    static constexpr int width = W, height = H, k = K;
+    static constexpr int stride = W + 1;
+    static constexpr int num_cells = W * H;
+    static constexpr int num_bits = stride * H;
+    static_assert(num_bits <= 128, "MnkBoard: board doesn't fit in 128 bits");
+    static_assert(K >= 2 && (K <= W || K <= H), "MnkBoard: nobody can ever get K in a row");
+
+    using Bits = std::conditional_t<(num_bits <= 64), u64, unsigned __int128>;
+
+    static constexpr int cell(int x, int y) { return x + stride * y; }
+    static constexpr Bits bit(int cell) { return static_cast<Bits>(1) << cell; }
+
+    static constexpr Bits all_cells = [] {
+      Bits mask = 0;
+      for (int y = 0; y < H; ++y) for (int x = 0; x < W; ++x) mask |= bit(cell(x, y));
+      return mask;
+    }();
+
+    // every cell, most central first (good enough move ordering for a solver)
+    static constexpr std::array<i8, num_cells> center_out = [] {
+      std::array<i8, num_cells> order{};
+      std::array<int, num_cells> dist{};
+      for (int y = 0, i = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x, ++i) {
+          order[i] = static_cast<i8>(cell(x, y));
+          int dx = 2 * x - (W - 1), dy = 2 * y - (H - 1);
+          dist[i] = dx * dx + dy * dy;
+        }
+      }
+      for (int i = 1; i < num_cells; ++i) {         // insertion sort, it's constexpr
+        for (int j = i; j > 0 && dist[j - 1] > dist[j]; --j) {
+          int d = dist[j - 1]; dist[j - 1] = dist[j]; dist[j] = d;     // std::swap isn't constexpr until C++20
+          i8 o = order[j - 1]; order[j - 1] = order[j]; order[j] = o;
+        }
+      }
+      return order;
+    }();
+
+    // one key per (player, bit); splitmix64 so they're fixed at compile time
+    static constexpr std::array<u64, 2 * num_bits> zobrist = [] {
+      std::array<u64, 2 * num_bits> keys{};
+      u64 state = 0x6d6e6b2d67616d65;  // "mnk-game"
+      for (u64& key : keys) {
+        u64 z = (state += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        key = z ^ (z >> 31);
+      }
+      return keys;
+    }();
+
+    // whether `stones` has K in a row anywhere on the board
+    static constexpr bool hasLine(Bits stones) noexcept {
+      constexpr int dirs[4] = { 1, stride, stride + 1, stride - 1 };
+      for (int dir : dirs) {
+        Bits run = stones;
+        // after i steps, a bit survives where i + 1 stones line up in this direction
+        for (int i = 1; i < K && run; ++i) run &= run >> dir;
+        if (run) return true;
+      }
+      return false;
+    }
+
+    Bits stones[2] = { 0, 0 };  // [0] moved first
+    int to_move = 0;
+    int num_moves = 0;
+    u64 key = 0;
+
+    Bits empty() const noexcept { return all_cells & ~(stones[0] | stones[1]); }
+    bool isEmpty(int cell) const noexcept { return !((stones[0] | stones[1]) & bit(cell)); }
+    bool full() const noexcept { return num_moves == num_cells; }
+    int emptyCount() const noexcept { return num_cells - num_moves; }
+    // whether the player who just moved has won
+    bool lastMoveWon() const noexcept { return hasLine(stones[to_move ^ 1]); }
+
+    void play(int cell) noexcept {
+      stones[to_move] |= bit(cell);
+      key ^= zobrist[to_move * num_bits + cell];
+      to_move ^= 1;
+      ++num_moves;
+    }
+    void undo(int cell) noexcept {
+      --num_moves;
+      to_move ^= 1;
+      key ^= zobrist[to_move * num_bits + cell];
+      stones[to_move] &= ~bit(cell);
+    }
+  };
+
+
+  // Negamax with alpha-beta and a Zobrist-keyed transposition table.
+  // Scores are from the side to move: 0 is a draw (or unknown past the depth
+  // limit), otherwise +/-(1 + empty cells left when the game ended), so faster
+  // wins and slower losses score higher.
+  template <class Board>
+  class MnkSolver {
+  public:
+    explicit MnkSolver(int table_bits = 20)
+      : table(size_t(1) << table_bits), table_mask((size_t(1) << table_bits) - 1) {}
+
+    u64 nodes = 0;
+    u64 node_limit = ~u64(0);   // give up once `nodes` passes this; the result is then meaningless
+    bool hit_horizon = false;   // some line was cut off by the depth limit, so a 0 may not be a draw
+    bool aborted = false;       // the last search ran into node_limit
+
+    void clear() { std::fill(table.begin(), table.end(), Entry()); }
+
+    // best score for the side to move looking at most `depth` plies ahead
+    int search(Board& board, int depth, int* best_move = nullptr) {
+      hit_horizon = aborted = false;
+      int score = negamax(board, depth, -max_score, max_score);
+      if (best_move) *best_move = table[board.key & table_mask].move;
+      return score;
+    }
+    int solve(Board& board, int* best_move = nullptr) {
+      return search(board, board.emptyCount(), best_move);
+    }
+
+  private:
+    static constexpr int max_score = Board::num_cells + 1;
+    enum Bound : u8 { none, exact, lower, upper };
+    struct Entry {
+      u64 key = 0;
+      i16 score = 0;
+      i8 move = -1;
+      u8 depth = 0;
+      Bound bound = none;
+    };
+    std::vector<Entry> table;
+    size_t table_mask;
+
+    int negamax(Board& board, int depth, int alpha, int beta) {
+      if (++nodes > node_limit) aborted = true;
+      if (aborted) return 0;
+      if (board.lastMoveWon()) return -(1 + board.emptyCount());
+      if (board.full()) return 0;
+      if (depth == 0) {
+        hit_horizon = true;
+        return 0;
+      }
+      // nobody can do better than winning with the very next move
+      beta = std::min(beta, board.emptyCount());
+      if (alpha >= beta) return beta;
+
+      const int alpha_in = alpha;
+      Entry& entry = table[board.key & table_mask];
+      int tt_move = -1;
+      if (entry.bound != none && entry.key == board.key) {
+        tt_move = entry.move;
+        if (entry.depth >= depth) {
+          if (entry.bound == exact) return entry.score;
+          if (entry.bound == lower) alpha = std::max(alpha, int(entry.score));
+          else beta = std::min(beta, int(entry.score));
+          if (alpha >= beta) return entry.score;
+        }
+      }
+
+      int best = -max_score - 1, best_move = -1;
+      auto tryMove = [&](int cell) {
+        board.play(cell);
+        int score = -negamax(board, depth - 1, -beta, -alpha);
+        board.undo(cell);
+        if (score > best) {
+          best = score;
+          best_move = cell;
+        }
+        alpha = std::max(alpha, score);
+        return alpha >= beta;
+      };
+      bool cutoff = tt_move != -1 && board.isEmpty(tt_move) && tryMove(tt_move);
+      for (int i = 0; !cutoff && i < Board::num_cells; ++i) {
+        int cell = Board::center_out[i];
+        if (cell == tt_move || !board.isEmpty(cell)) continue;
+        cutoff = tryMove(cell);
+      }
+      if (aborted) return 0;     // don't poison the table with half-searched scores
+
+      entry.key = board.key;
+      entry.score = static_cast<i16>(best);
+      entry.move = static_cast<i8>(best_move);
+      entry.depth = static_cast<u8>(depth);
+      entry.bound = (best <= alpha_in) ? upper : (best >= beta) ? lower : exact;
+      return best;
+    }
+  };
+}
+
+#endif
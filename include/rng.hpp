@@ -0,0 +1,265 @@
+#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include <typedefs.hpp>
+
+// rng.hpp
+namespace kel {
+  // Small, fast, deterministic generators. They're all standard
+  // UniformRandomBitGenerators (so std::shuffle and <random>'s distributions
+  // take them), but the helpers below are a lot cheaper than the
+  // distributions: bounded() is Lemire's nearly-divisionless method, one
+  // multiply and almost never a division, instead of rng() % n.
+  //
+  // Every generator is constexpr, seeds from a single u64, and has a way to
+  // hand out independent streams (one per thread, per game, ...):
+  //   Xoshiro256ss: jump() skips 2^128 outputs, longJump() 2^192
+  //   Pcg32:        a stream number picks one of 2^63 sequences, advance(n) skips n
+  //   WyRand:       split() seeds a new generator from this one's output
+
+  // Only used to expand one u64 seed into a bigger state: consecutive seeds
+  // give unrelated states.
+  struct SplitMix64 {
+    using result_type = u64;
+    u64 state;
+
+    constexpr explicit SplitMix64(u64 seed = 0) noexcept : state(seed) {}
+    constexpr u64 operator()() noexcept {
+      u64 z = (state += 0x9e3779b97f4a7c15);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      return z ^ (z >> 31);
+    }
+    static constexpr u64 min() noexcept { return 0; }
+    static constexpr u64 max() noexcept { return ~u64(0); }
+  };
+
+  // xoshiro256** (Blackman & Vigna): 256 bits of state, period 2^256 - 1,
+  // good in every bit of the output
+  class Xoshiro256ss {
+  public:
+    using result_type = u64;
+
+    constexpr explicit Xoshiro256ss(u64 seed = 0x5eed5eed5eed5eed) noexcept : s() { this->seed(seed); }
+    constexpr void seed(u64 seed) noexcept {
+      SplitMix64 expand(seed);
+      for (u64& word : s) word = expand();
+    }
+
+    constexpr u64 operator()() noexcept {
+      const u64 out = rotl(s[1] * 5, 7) * 9;
+      const u64 t = s[1] << 17;
+      s[2] ^= s[0];
+      s[3] ^= s[1];
+      s[1] ^= s[2];
+      s[0] ^= s[3];
+      s[2] ^= t;
+      s[3] = rotl(s[3], 45);
+      return out;
+    }
+    static constexpr u64 min() noexcept { return 0; }
+    static constexpr u64 max() noexcept { return ~u64(0); }
+
+    // the same as 2^128 calls; gives 2^128 non-overlapping streams of 2^128
+    constexpr void jump() noexcept {
+      constexpr u64 poly[4] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+      jumpBy(poly);
+    }
+    // the same as 2^192 calls
+    constexpr void longJump() noexcept {
+      constexpr u64 poly[4] = { 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 };
+      jumpBy(poly);
+    }
+    // a copy of this generator, which then jumps ahead past everything the copy will use
+    constexpr Xoshiro256ss split() noexcept {
+      Xoshiro256ss child = *this;
+      jump();
+      return child;
+    }
+
+  private:
+    u64 s[4];
+
+    static constexpr u64 rotl(u64 x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+    constexpr void jumpBy(const u64 (&poly)[4]) noexcept {
+      u64 t[4] = { 0, 0, 0, 0 };
+      for (u64 word : poly) {
+        for (int b = 0; b < 64; ++b) {
+          if (word & (u64(1) << b)) for (int i = 0; i < 4; ++i) t[i] ^= s[i];
+          (*this)();
+        }
+      }
+      for (int i = 0; i < 4; ++i) s[i] = t[i];
+    }
+  };
+
+  // wyrand (Wang Yi): one add and one 64x64->128 multiply per output, 64 bits
+  // of state, period 2^64
+  class WyRand {
+  public:
+    using result_type = u64;
+
+    constexpr explicit WyRand(u64 seed = 0x5eed5eed5eed5eed) noexcept : state(seed) {}
+    constexpr void seed(u64 seed) noexcept { state = seed; }
+
+    constexpr u64 operator()() noexcept {
+      state += 0xa0761d6478bd642f;
+      unsigned __int128 t = static_cast<unsigned __int128>(state) * (state ^ 0xe7037ed1a0b428db);
+      return static_cast<u64>(t >> 64) ^ static_cast<u64>(t);
+    }
+    static constexpr u64 min() noexcept { return 0; }
+    static constexpr u64 max() noexcept { return ~u64(0); }
+
+    // a new generator seeded from this one; no guarantee the streams never
+    // overlap, but with a 2^64 period they're vanishingly unlikely to
+    constexpr WyRand split() noexcept { return WyRand(SplitMix64((*this)())()); }
+
+  private:
+    u64 state;
+  };
+
+  // PCG32 (O'Neill), XSH-RR: 64-bit LCG state, 32-bit output, period 2^64.
+  // Each `stream` is a different sequence.
+  class Pcg32 {
+  public:
+    using result_type = u32;
+
+    constexpr explicit Pcg32(u64 seed = 0x5eed5eed5eed5eed, u64 stream = 0xda3e39cb94b95bdb) noexcept
+      : state(0), inc((stream << 1) | 1) {
+      (*this)();
+      state += seed;
+      (*this)();
+    }
+    // restart at `seed`, staying on the same stream
+    constexpr void seed(u64 seed) noexcept { *this = Pcg32(seed, inc >> 1); }
+
+    constexpr u32 operator()() noexcept {
+      const u64 old = state;
+      state = old * mult + inc;
+      const u32 xorshifted = static_cast<u32>(((old >> 18) ^ old) >> 27);
+      const int rot = static_cast<int>(old >> 59);
+      return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+    static constexpr u32 min() noexcept { return 0; }
+    static constexpr u32 max() noexcept { return ~u32(0); }
+
+    // the same as `delta` calls, in O(log delta)
+    constexpr void advance(u64 delta) noexcept {
+      u64 acc_mult = 1, acc_plus = 0, cur_mult = mult, cur_plus = inc;
+      for (; delta; delta >>= 1) {
+        if (delta & 1) {
+          acc_mult *= cur_mult;
+          acc_plus = acc_plus * cur_mult + cur_plus;
+        }
+        cur_plus *= cur_mult + 1;
+        cur_mult *= cur_mult;
+      }
+      state = acc_mult * state + acc_plus;
+    }
+    // a generator on another stream, seeded from this one
+    constexpr Pcg32 split() noexcept {
+      u64 seed = (u64((*this)()) << 32) | (*this)();
+      u64 stream = (u64((*this)()) << 32) | (*this)();
+      return Pcg32(seed, stream);
+    }
+
+  private:
+    static constexpr u64 mult = 6364136223846793005;
+    u64 state, inc;
+  };
+
+
+  // [0, range), without the bias or the division of rng() % range
+  template <class Rng>
+  constexpr u32 bounded(Rng& rng, u32 range) noexcept {
+    if constexpr (sizeof(typename Rng::result_type) >= 8) {
+      unsigned __int128 m = static_cast<unsigned __int128>(static_cast<u64>(rng())) * range;
+      u64 low = static_cast<u64>(m);
+      if (low < range) {
+        const u64 threshold = (0 - u64(range)) % range;
+        while (low < threshold) {
+          m = static_cast<unsigned __int128>(static_cast<u64>(rng())) * range;
+          low = static_cast<u64>(m);
+        }
+      }
+      return static_cast<u32>(m >> 64);
+    }
+    else {
+      u64 m = u64(static_cast<u32>(rng())) * range;
+      u32 low = static_cast<u32>(m);
+      if (low < range) {
+        const u32 threshold = (0 - range) % range;
+        while (low < threshold) {
+          m = u64(static_cast<u32>(rng())) * range;
+          low = static_cast<u32>(m);
+        }
+      }
+      return static_cast<u32>(m >> 32);
+    }
+  }
+  // 64 random bits, from two calls if the generator only gives 32
+  template <class Rng>
+  constexpr u64 bits64(Rng& rng) noexcept {
+    if constexpr (sizeof(typename Rng::result_type) >= 8) return static_cast<u64>(rng());
+    else {
+      u64 high = static_cast<u32>(rng());
+      return (high << 32) | static_cast<u32>(rng());
+    }
+  }
+  // [0, range) for ranges that don't fit in 32 bits
+  template <class Rng>
+  constexpr u64 bounded64(Rng& rng, u64 range) noexcept {
+    unsigned __int128 m = static_cast<unsigned __int128>(bits64(rng)) * range;
+    u64 low = static_cast<u64>(m);
+    if (low < range) {
+      const u64 threshold = (0 - range) % range;
+      while (low < threshold) {
+        m = static_cast<unsigned __int128>(bits64(rng)) * range;
+        low = static_cast<u64>(m);
+      }
+    }
+    return static_cast<u64>(m >> 64);
+  }
+  // [lo, hi], both ends included
+  template <class Rng>
+  constexpr int uniformInt(Rng& rng, int lo, int hi) noexcept {
+    const u64 range = u64(i64(hi) - lo) + 1;
+    return static_cast<int>(lo + i64((range <= 0xffffffff) ? bounded(rng, u32(range)) : bounded64(rng, range)));
+  }
+
+  // [0, 1) in steps of 2^-24 (float) or 2^-53 (double), so every step is equally likely
+  template <class Rng>
+  constexpr float uniformFloat(Rng& rng) noexcept {
+    if constexpr (sizeof(typename Rng::result_type) >= 8) return float(static_cast<u64>(rng()) >> 40) * 0x1.0p-24f;
+    else return float(static_cast<u32>(rng()) >> 8) * 0x1.0p-24f;
+  }
+  template <class Rng>
+  constexpr double uniformDouble(Rng& rng) noexcept {
+    return double(bits64(rng) >> 11) * 0x1.0p-53;
+  }
+  // [lo, hi)
+  template <class Rng>
+  constexpr float uniformFloat(Rng& rng, float lo, float hi) noexcept {
+    return lo + uniformFloat(rng) * (hi - lo);
+  }
+  template <class Rng>
+  constexpr double uniformDouble(Rng& rng, double lo, double hi) noexcept {
+    return lo + uniformDouble(rng) * (hi - lo);
+  }
+
+  // true with probability `p`
+  template <class Rng>
+  constexpr bool chance(Rng& rng, float p) noexcept {
+    return uniformFloat(rng) < p;
+  }
+  template <class Rng>
+  constexpr bool coinFlip(Rng& rng) noexcept {
+    return static_cast<typename Rng::result_type>(rng()) >> (std::numeric_limits<typename Rng::result_type>::digits - 1);
+  }
+}
+
+#endif
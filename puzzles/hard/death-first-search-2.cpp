@@ -1,23 +1,503 @@
+#include <cerrno>
+#include <charconv>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <new>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define INSTRUMENT 0        // per-turn timers, counters and histograms on stderr (instrument.hpp)
+#define LOG_LEVEL 1         // 0 silent, 1 errors, 2 and a few lines a turn, 3 and hot-loop debug
+
+// fast-io.hpp
+namespace kel {
+    // Referee I/O without iostreams. FdReader pulls whatever's available from
+    // a file descriptor with read(2) into its buffer and parses straight out of
+    // it; FdWriter collects a turn's output and hands it to write(2) in one go
+    // when flush() is called (and once more at exit, for whatever's left).
+    // Neither allocates unless you read a std::string.
+    //
+    //   fast_in >> x >> y;                  // whitespace and newlines are skipped, no ignore() needed
+    //   std::string_view row = fast_in.readToken();
+    //   fast_out << x << ' ' << y << '\n';
+    //   fast_out.flush();                   // once per turn, instead of endl per line
+    //
+    // Don't mix these with cin/cout on the same descriptor: each side buffers
+    // what the other can't see.
+
+    class FdReader {
+    public:
+        static constexpr size_t capacity = size_t(1) << 16;
+
+        explicit FdReader(int fd = STDIN_FILENO) noexcept : fd(fd) { buf[0] = '\0'; }
+        FdReader(const FdReader&) = delete;
+        FdReader& operator=(const FdReader&) = delete;
+
+        // true once there's nothing left but whitespace; waits for more input to
+        // find out, so it's for reading files, not for asking between turns
+        bool eof() {
+            skipSpace();
+            return pos == end;
+        }
+
+        template <class Int>
+        Int readInt() {
+            static_assert(std::is_integral<Int>::value, "readInt: not an integer type");
+            skipSpace();
+            bool negative = false;
+            if constexpr (std::is_signed<Int>::value) {
+                negative = (buf[pos] == '-');
+                pos += negative;
+            }
+            // make unsigned so overflow past the end of the number wraps harmlessly
+            using U = std::make_unsigned_t<Int>;
+            U value = 0;
+            while (true) {
+                // the '\0' sentinel at buf[end] stops the loop without a bounds check
+                unsigned digit;
+                while ((digit = unsigned(buf[pos]) - '0') < 10) {
+                    value = U(value * 10 + digit);
+                    ++pos;
+                }
+                if (pos < end || !refill()) break;   // a number split across two reads carries on
+            }
+            return negative ? Int(U(0) - value) : Int(value);
+        }
+        double readDouble() {
+            std::string_view token = readToken();
+            double value = 0;
+            std::from_chars(token.data(), token.data() + token.size(), value);
+            return value;
+        }
+        // the next character that isn't whitespace ('\0' at the end of input)
+        char readChar() {
+            skipSpace();
+            return (pos < end) ? buf[pos++] : '\0';
+        }
+        // The next whitespace-separated word. It points into the buffer, so it's
+        // only good until the next read.
+        std::string_view readToken() {
+            skipSpace();
+            size_t start = pos;
+            while (true) {
+                while (buf[pos] > ' ') ++pos;
+                if (pos < end) break;
+                size_t len = pos - start;
+                compact(start);
+                start = 0;
+                pos = len;
+                if (!fill()) break;
+            }
+            return std::string_view(buf + start, pos - start);
+        }
+        // The rest of the current line, without the newline (or a '\r' before
+        // it). Also only good until the next read.
+        std::string_view readLine() {
+            size_t start = pos;
+            while (true) {
+                const void* newline = std::memchr(buf + pos, '\n', end - pos);
+                if (newline) {
+                    pos = static_cast<const char*>(newline) - buf;
+                    break;
+                }
+                size_t len = end - start;
+                compact(start);
+                start = 0;
+                pos = len;
+                if (!fill()) break;
+            }
+            size_t stop = pos;
+            if (pos < end) ++pos;
+            if (stop > start && buf[stop - 1] == '\r') --stop;
+            return std::string_view(buf + start, stop - start);
+        }
+        void skipLine() { readLine(); }
+
+        template <class T>
+        FdReader& operator>>(T& value) {
+            if constexpr (std::is_same<T, bool>::value) value = readInt<int>() != 0;
+            else if constexpr (std::is_same<T, char>::value) value = readChar();
+            else if constexpr (std::is_integral<T>::value) value = readInt<T>();
+            else if constexpr (std::is_floating_point<T>::value) value = static_cast<T>(readDouble());
+            else if constexpr (std::is_same<T, std::string_view>::value) value = readToken();
+            else if constexpr (std::is_same<T, std::string>::value) value.assign(readToken());
+            else static_assert(!sizeof(T*), "FdReader: can't read this type");
+            return *this;
+        }
+
+    private:
+        char buf[capacity + 1];   // one more for the '\0' after the last byte read
+        size_t pos = 0, end = 0;
+        int fd;
+
+        void skipSpace() {
+            while (true) {
+                while (pos < end && buf[pos] <= ' ') ++pos;
+                if (pos < end || !refill()) return;
+            }
+        }
+        // move [from, end) to the front of the buffer
+        void compact(size_t from) noexcept {
+            std::memmove(buf, buf + from, end - from);
+            end -= from;
+            pos -= from;
+            buf[end] = '\0';
+        }
+        // everything's been used: start over at the front
+        bool refill() {
+            pos = end = 0;
+            return fill();
+        }
+        // read more after `end`; blocks until something's there, false at the end of input
+        bool fill() {
+            if (end == capacity) return false;    // a single token bigger than the buffer
+            ssize_t got;
+            do got = ::read(fd, buf + end, capacity - end);
+            while (got < 0 && errno == EINTR);
+            if (got <= 0) {
+                buf[end] = '\0';
+                return false;
+            }
+            end += size_t(got);
+            buf[end] = '\0';
+            return true;
+        }
+    };
+
+    class FdWriter {
+    public:
+        static constexpr size_t capacity = size_t(1) << 16;
+
+        explicit FdWriter(int fd = STDOUT_FILENO) noexcept : fd(fd) {}
+        FdWriter(const FdWriter&) = delete;
+        FdWriter& operator=(const FdWriter&) = delete;
+        ~FdWriter() { flush(); }
+
+        void write(char c) {
+            if (used == capacity) flush();
+            buf[used++] = c;
+        }
+        void write(std::string_view str) {
+            if (str.size() > capacity - used) {
+                flush();
+                if (str.size() > capacity) return writeAll(str.data(), str.size());
+            }
+            std::memcpy(buf + used, str.data(), str.size());
+            used += str.size();
+        }
+        template <class T>
+        void writeNumber(T value) {
+            // 24 is enough for any integer, and for the shortest round-trip form of a double
+            if (capacity - used < 24) flush();
+            used = std::to_chars(buf + used, buf + capacity, value).ptr - buf;
+        }
+        // hand everything written so far to the descriptor
+        void flush() {
+            writeAll(buf, used);
+            used = 0;
+        }
+
+        template <class T>
+        FdWriter& operator<<(const T& value) {
+            if constexpr (std::is_same<T, char>::value) write(value);
+            else if constexpr (std::is_same<T, bool>::value) write(value ? '1' : '0');
+            else if constexpr (std::is_arithmetic<T>::value) writeNumber(value);
+            else write(std::string_view(value));
+            return *this;
+        }
+
+    private:
+        char buf[capacity];
+        size_t used = 0;
+        int fd;
+
+        void writeAll(const char* data, size_t len) {
+            while (len > 0) {
+                ssize_t put = ::write(fd, data, len);
+                if (put <= 0) return;     // nowhere to send it: the referee's gone
+                data += put;
+                len -= size_t(put);
+            }
+        }
+    };
+
+    inline FdReader fast_in(STDIN_FILENO);
+    inline FdWriter fast_out(STDOUT_FILENO);
+}
+
+// instrument.hpp
+namespace kel {
+    // Diagnostics that cost nothing unless they're switched on:
+    //   timeScope("expand");            time from here to the end of the scope (rdtsc)
+    //   countEvent("nodes popped");     add 1 to a named counter
+    //   countAdd("plies", n);           add n
+    //   histogramAdd("depth", depth);   record a value; shown in power-of-2 buckets
+    //   logInfo("best " << move);       a line of log, anything cerr can print
+    //   logDebug(...) / logError(...)   the same at the other levels
+    //   instrTurnEnd();                 once a turn, after the answer's flushed
+    // Everything is collected over the turn and written to stderr in one go by
+    // instrTurnEnd(), then reset; what's left at exit is written then. Errors
+    // are the exception: they go out straight away, in case the bot's about to
+    // die. With INSTRUMENT 0 and LOG_LEVEL 0 every macro is ((void)0), and
+    // the arguments aren't evaluated at all.
+#if INSTRUMENT || LOG_LEVEL > 0
+    namespace instr {
+        // the cycle counter where there is one, steady_clock nanoseconds otherwise
+        inline uint64_t ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        struct TimerStat {
+            const char* name;
+            uint64_t calls, ticks;
+        };
+        struct CounterStat {
+            const char* name;
+            int64_t value;
+        };
+        struct HistogramStat {
+            const char* name;
+            uint64_t samples;
+            int64_t min, max, sum;
+            uint64_t buckets[65];   // 0 for values <= 0, then n for [2^(n-1), 2^n)
+        };
+
+        class Registry {
+        public:
+            static constexpr size_t max_stats = 64;   // of each kind; more than that are dropped
+
+            Registry() : start_ticks(ticks()), start_time(std::chrono::steady_clock::now()) {}
+            ~Registry() { if (pending || hasStats()) endTurn(); }
+
+            // Looked up by name once per call site (see the macros), so several
+            // sites with the same name add up.
+            TimerStat& timer(const char* name) noexcept { return find(timers, num_timers, name); }
+            CounterStat& counter(const char* name) noexcept { return find(counters, num_counters, name); }
+            HistogramStat& histogram(const char* name) noexcept {
+                HistogramStat& stat = find(histograms, num_histograms, name);
+                if (stat.samples == 0) resetHistogram(stat);
+                return stat;
+            }
+            void add(HistogramStat& stat, int64_t value) noexcept {
+                if (value < stat.min) stat.min = value;
+                if (value > stat.max) stat.max = value;
+                stat.sum += value;
+                ++stat.samples;
+                ++stat.buckets[(value <= 0) ? 0 : 64 - __builtin_clzll(uint64_t(value))];
+            }
+
+            std::ostream& log() noexcept {
+                pending = true;
+                return log_lines;
+            }
+            void logNow(const std::string& line) noexcept { writeAll(line.data(), line.size()); }
+
+            void endTurn() {
+                if (!pending && !hasStats()) {
+                    ++turn;
+                    return;
+                }
+                std::ostringstream out;
+                out << "-- turn " << turn++ << " --\n" << log_lines.str();
+                const double ticks_per_us = ticksPerMicro();
+                out << std::fixed << std::setprecision(2);
+                for (size_t idx = 0; idx < num_timers; ++idx) {
+                    TimerStat& stat = timers[idx];
+                    if (stat.calls == 0) continue;
+                    const double total_us = stat.ticks / ticks_per_us;
+                    out << "time  " << std::left << std::setw(24) << stat.name << std::right
+                            << std::setw(10) << stat.calls << " calls " << std::setw(12) << total_us << " us "
+                            << std::setw(10) << total_us / stat.calls << " us/call\n";
+                    stat.calls = stat.ticks = 0;
+                }
+                for (size_t idx = 0; idx < num_counters; ++idx) {
+                    CounterStat& stat = counters[idx];
+                    if (stat.value == 0) continue;
+                    out << "count " << std::left << std::setw(24) << stat.name << std::right << std::setw(10) << stat.value << '\n';
+                    stat.value = 0;
+                }
+                for (size_t idx = 0; idx < num_histograms; ++idx) {
+                    HistogramStat& stat = histograms[idx];
+                    if (stat.samples == 0) continue;
+                    out << "hist  " << std::left << std::setw(24) << stat.name << std::right
+                            << " n " << stat.samples << ", min " << stat.min << ", mean " << double(stat.sum) / stat.samples
+                            << ", max " << stat.max << "\n     ";
+                    for (int bucket = 0; bucket < 65; ++bucket) {
+                        if (stat.buckets[bucket] == 0) continue;
+                        if (bucket == 0) out << " <=0:";
+                        else if (bucket == 1) out << " 1:";
+                        else out << ' ' << (uint64_t(1) << (bucket - 1)) << '-' << (uint64_t(1) << bucket) - 1 << ':';
+                        out << stat.buckets[bucket];
+                    }
+                    out << '\n';
+                    resetHistogram(stat);
+                }
+                const std::string text = out.str();
+                writeAll(text.data(), text.size());
+                log_lines.str(std::string());
+                pending = false;
+            }
+
+        private:
+            TimerStat timers[max_stats] = {};
+            CounterStat counters[max_stats] = {};
+            HistogramStat histograms[max_stats] = {};
+            size_t num_timers = 0, num_counters = 0, num_histograms = 0;
+            std::ostringstream log_lines;
+            int turn = 0;
+            bool pending = false;
+            uint64_t start_ticks;
+            std::chrono::steady_clock::time_point start_time;
+
+            bool hasStats() const noexcept {
+                for (size_t idx = 0; idx < num_timers; ++idx) if (timers[idx].calls) return true;
+                for (size_t idx = 0; idx < num_counters; ++idx) if (counters[idx].value) return true;
+                for (size_t idx = 0; idx < num_histograms; ++idx) if (histograms[idx].samples) return true;
+                return false;
+            }
+            template <class Stat>
+            Stat& find(Stat (&stats)[max_stats], size_t& count, const char* name) noexcept {
+                for (size_t idx = 0; idx < count; ++idx) {
+                    if (std::strcmp(stats[idx].name, name) == 0) return stats[idx];
+                }
+                if (count == max_stats) {
+                    static Stat overflow;   // counted, but never shown
+                    return overflow;
+                }
+                stats[count].name = name;
+                return stats[count++];
+            }
+            static void resetHistogram(HistogramStat& stat) noexcept {
+                const char* name = stat.name;
+                stat = HistogramStat();
+                stat.name = name;
+                stat.min = INT64_MAX;
+                stat.max = INT64_MIN;
+            }
+            // calibrated against steady_clock over everything since startup
+            double ticksPerMicro() const noexcept {
+                const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+                return (us > 0) ? (ticks() - start_ticks) / us : 1.0;
+            }
+            static void writeAll(const char* data, size_t len) noexcept {
+                while (len > 0) {
+                    ssize_t put = ::write(STDERR_FILENO, data, len);
+                    if (put <= 0) return;
+                    data += put;
+                    len -= size_t(put);
+                }
+            }
+        };
+
+        inline Registry& registry() {
+            static Registry reg;
+            return reg;
+        }
+
+        class ScopedTimer {
+        public:
+            explicit ScopedTimer(TimerStat& stat) noexcept : stat(stat), start(ticks()) {}
+            ~ScopedTimer() {
+                stat.ticks += ticks() - start;
+                ++stat.calls;
+            }
+        private:
+            TimerStat& stat;
+            uint64_t start;
+        };
+    }
+#endif
+
+#define _instrCat2(a, b) a##b
+#define _instrCat(a, b) _instrCat2(a, b)
+#define _instrSite(kind, name)                                                 \
+    static auto& _instrCat(_instr_stat_, __LINE__) = ::kel::instr::registry().kind(name)
+
+#if INSTRUMENT
+#define timeScope(name)                                                        \
+    _instrSite(timer, name);                                                     \
+    ::kel::instr::ScopedTimer _instrCat(_instr_timer_, __LINE__)(_instrCat(_instr_stat_, __LINE__))
+#define countAdd(name, n)                                                      \
+    do {                                                                         \
+        _instrSite(counter, name);                                                 \
+        _instrCat(_instr_stat_, __LINE__).value += (n);                            \
+    } while (0)
+#define countEvent(name) countAdd(name, 1)
+#define histogramAdd(name, value)                                              \
+    do {                                                                         \
+        _instrSite(histogram, name);                                               \
+        ::kel::instr::registry().add(_instrCat(_instr_stat_, __LINE__), (value));  \
+    } while (0)
+#else
+#define timeScope(name) ((void)0)
+#define countAdd(name, n) ((void)0)
+#define countEvent(name) ((void)0)
+#define histogramAdd(name, value) ((void)0)
+#endif
+
+#if LOG_LEVEL >= 1
+#define logError(...)                                                          \
+    do {                                                                         \
+        std::ostringstream _instr_line;                                            \
+        _instr_line << "error: " << __VA_ARGS__ << '\n';                           \
+        ::kel::instr::registry().logNow(_instr_line.str());                        \
+    } while (0)
+#else
+#define logError(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 2
+#define logInfo(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logInfo(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 3
+#define logDebug(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logDebug(...) ((void)0)
+#endif
+
+#if INSTRUMENT || LOG_LEVEL >= 2
+#define instrTurnEnd() ::kel::instr::registry().endTurn()
+#else
+#define instrTurnEnd() ((void)0)
+#endif
+}
 
 using namespace std;
+using namespace kel;
 
-struct Node {
+template <template <class> class Allocator>
+struct BasicNode {
     int idx;
     bool is_exit;
-    vector<Node*> connections;
-    Node* explored_from;
+    vector<BasicNode*, Allocator<BasicNode*>> connections;
+    BasicNode* explored_from;
     float distance;
-    Node(size_t idx, bool is_gateway = false) : idx(idx), is_exit(is_gateway), connections(), explored_from(nullptr), distance(0.f) {}
+    BasicNode(size_t idx, bool is_gateway = false) : idx(idx), is_exit(is_gateway), connections(), explored_from(nullptr), distance(0.f) {}
     int numExits() const {
         if (is_exit) return 0;
         int num_exits = 0;
-        for (const Node* node : connections) { if (node->is_exit) ++num_exits; }
+        for (const BasicNode* node : connections) { if (node->is_exit) ++num_exits; }
         return num_exits;
     }
     int numChances() const {
@@ -26,6 +506,8 @@ struct Node {
         else return 1 + explored_from->numChances() - numExits();
     }
 };
+using Node = BasicNode<std::allocator>;
+
 class MoreChances {
 public:
     bool operator()(Node* lhs, Node* rhs) { return lhs->numChances() > rhs->numChances(); }
@@ -34,8 +516,8 @@ struct Connection {
     Node& node1;
     Node& node2;
     Connection(Node& node1, Node& node2) : node1(node1), node2(node2) {}
-    friend ostream& operator<<(ostream& os, const Connection& c) {
-        return os << c.node1.idx << ' ' << c.node2.idx;
+    friend FdWriter& operator<<(FdWriter& out, const Connection& c) {
+        return out << c.node1.idx << ' ' << c.node2.idx;
     }
 };
 
@@ -43,26 +525,26 @@ class Graph {
 public:
     Graph() : nodes() {}
 
-    friend istream& operator>>(istream& is, Graph& graph) {
+    friend FdReader& operator>>(FdReader& in, Graph& graph) {
         int num_nodes, num_links, num_exits;
-        is >> num_nodes >> num_links >> num_exits; is.ignore();
+        in >> num_nodes >> num_links >> num_exits;
         graph.nodes.reserve(num_nodes);
         for (int idx = 0; idx < num_nodes; ++idx) {
             graph.nodes.push_back(Node(idx));
         }
         for (int i = 0; i < num_links; ++i) {
             int node1, node2;
-            is >> node1 >> node2; is.ignore();
+            in >> node1 >> node2;
             graph.nodes[node1].connections.push_back(&graph.nodes[node2]);
             graph.nodes[node2].connections.push_back(&graph.nodes[node1]);
             //graph.connections.push_back({graph.nodes[node1], graph.nodes[node2]});
         }
         for (int i = 0; i < num_exits; ++i) {
             int exit_idx;
-            is >> exit_idx; is.ignore();
+            in >> exit_idx;
             graph.nodes[exit_idx].is_exit = true;
         }
-        return is;
+        return in;
     }
 
     void reset() {
@@ -73,6 +555,7 @@ public:
     }
 
     Connection getNextSever(int bob_idx) {
+        timeScope("getNextSever");
         reset();
         Node* home = &nodes[bob_idx];
         home->distance = 0;
@@ -82,11 +565,12 @@ public:
         Node* to_cut = nullptr;
         do {
             node = to_explore.top();
-            cerr << "exploring " << hex << node << ", " << dec << node->is_exit << endl;
+            logDebug("exploring " << node << ", " << node->is_exit);
+            countEvent("nodes popped");
             to_explore.pop();
             if (node->is_exit) {
-                cerr << "it's an exit! " << node->explored_from->numExits() << " exist and ";
-                cerr << node->numChances() << " chances to cut" << endl;
+                logDebug("it's an exit! " << node->explored_from->numExits() << " exist and "
+                    << node->numChances() << " chances to cut");
                 if (to_cut == nullptr) to_cut = node;
                 else if (node->explored_from == home) {
                     to_cut = node;
@@ -95,29 +579,26 @@ public:
                 else if (node->numChances() < to_cut->numChances()) to_cut = node;
             }
             else {
-                cerr << "Finding more nodes to explore ";
                 for (Node* next : node->connections) {
-                    cerr << '.';
                     if (next->explored_from == nullptr && next != home) {
                         next->explored_from = node;
                         next->distance = node->distance + 1.f;
                         to_explore.push(next);
-                        cerr << 'o';
+                        countEvent("nodes pushed");
                     }
                 }
-                cerr << endl;
             }
-            cerr << to_explore.size() << " nodes left to explore" << endl;
+            logDebug(to_explore.size() << " nodes left to explore");
         } while (!to_explore.empty());
-        cerr << "cutting " << hex << to_cut << endl;
+        logInfo("cutting " << to_cut);
         return Connection(*to_cut, *(to_cut->explored_from));
     }
 
     void cut(const Connection& to_sever) {
         Node& node1 = to_sever.node1;
-        vector<Node*>& conns1 = node1.connections;
+        auto& conns1 = node1.connections;
         Node& node2 = to_sever.node2;
-        vector<Node*>& conns2 = node2.connections;
+        auto& conns2 = node2.connections;
         conns1.erase(find(conns1.begin(), conns1.end(), &node2));
         conns2.erase(find(conns2.begin(), conns2.end(), &node1));
     }
@@ -130,13 +611,15 @@ private:
 int main()
 {
     Graph graph;
-    cin >> graph;
+    fast_in >> graph;
 
     while (true) {
         int bob_idx;
-        cin >> bob_idx; cin.ignore();
+        fast_in >> bob_idx;
         Connection to_sever = graph.getNextSever(bob_idx);
         graph.cut(to_sever);
-        cout << to_sever << endl;
+        fast_out << to_sever << '\n';
+        fast_out.flush();
+        instrTurnEnd();
     }
 }
@@ -1,9 +1,233 @@
 #include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
+#include <unistd.h>
+
+// fast-io.hpp
+namespace kel {
+  // Referee I/O without iostreams. FdReader pulls whatever's available from
+  // a file descriptor with read(2) into its buffer and parses straight out of
+  // it; FdWriter collects a turn's output and hands it to write(2) in one go
+  // when flush() is called (and once more at exit, for whatever's left).
+  // Neither allocates unless you read a std::string.
+  //
+  //   fast_in >> x >> y;                  // whitespace and newlines are skipped, no ignore() needed
+  //   std::string_view row = fast_in.readToken();
+  //   fast_out << x << ' ' << y << '\n';
+  //   fast_out.flush();                   // once per turn, instead of endl per line
+  //
+  // Don't mix these with cin/cout on the same descriptor: each side buffers
+  // what the other can't see.
+
+  class FdReader {
+  public:
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    explicit FdReader(int fd = STDIN_FILENO) noexcept : fd(fd) { buf[0] = '\0'; }
+    FdReader(const FdReader&) = delete;
+    FdReader& operator=(const FdReader&) = delete;
+
+    // true once there's nothing left but whitespace; waits for more input to
+    // find out, so it's for reading files, not for asking between turns
+    bool eof() {
+      skipSpace();
+      return pos == end;
+    }
+
+    template <class Int>
+    Int readInt() {
+      static_assert(std::is_integral<Int>::value, "readInt: not an integer type");
+      skipSpace();
+      bool negative = false;
+      if constexpr (std::is_signed<Int>::value) {
+        negative = (buf[pos] == '-');
+        pos += negative;
+      }
+      // make unsigned so overflow past the end of the number wraps harmlessly
+      using U = std::make_unsigned_t<Int>;
+      U value = 0;
+      while (true) {
+        // the '\0' sentinel at buf[end] stops the loop without a bounds check
+        unsigned digit;
+        while ((digit = unsigned(buf[pos]) - '0') < 10) {
+          value = U(value * 10 + digit);
+          ++pos;
+        }
+        if (pos < end || !refill()) break;   // a number split across two reads carries on
+      }
+      return negative ? Int(U(0) - value) : Int(value);
+    }
+    double readDouble() {
+      std::string_view token = readToken();
+      double value = 0;
+      std::from_chars(token.data(), token.data() + token.size(), value);
+      return value;
+    }
+    // the next character that isn't whitespace ('\0' at the end of input)
+    char readChar() {
+      skipSpace();
+      return (pos < end) ? buf[pos++] : '\0';
+    }
+    // The next whitespace-separated word. It points into the buffer, so it's
+    // only good until the next read.
+    std::string_view readToken() {
+      skipSpace();
+      size_t start = pos;
+      while (true) {
+        while (buf[pos] > ' ') ++pos;
+        if (pos < end) break;
+        size_t len = pos - start;
+        compact(start);
+        start = 0;
+        pos = len;
+        if (!fill()) break;
+      }
+      return std::string_view(buf + start, pos - start);
+    }
+    // The rest of the current line, without the newline (or a '\r' before
+    // it). Also only good until the next read.
+    std::string_view readLine() {
+      size_t start = pos;
+      while (true) {
+        const void* newline = std::memchr(buf + pos, '\n', end - pos);
+        if (newline) {
+          pos = static_cast<const char*>(newline) - buf;
+          break;
+        }
+        size_t len = end - start;
+        compact(start);
+        start = 0;
+        pos = len;
+        if (!fill()) break;
+      }
+      size_t stop = pos;
+      if (pos < end) ++pos;
+      if (stop > start && buf[stop - 1] == '\r') --stop;
+      return std::string_view(buf + start, stop - start);
+    }
+    void skipLine() { readLine(); }
+
+    template <class T>
+    FdReader& operator>>(T& value) {
+      if constexpr (std::is_same<T, bool>::value) value = readInt<int>() != 0;
+      else if constexpr (std::is_same<T, char>::value) value = readChar();
+      else if constexpr (std::is_integral<T>::value) value = readInt<T>();
+      else if constexpr (std::is_floating_point<T>::value) value = static_cast<T>(readDouble());
+      else if constexpr (std::is_same<T, std::string_view>::value) value = readToken();
+      else if constexpr (std::is_same<T, std::string>::value) value.assign(readToken());
+      else static_assert(!sizeof(T*), "FdReader: can't read this type");
+      return *this;
+    }
+
+  private:
+    char buf[capacity + 1];   // one more for the '\0' after the last byte read
+    size_t pos = 0, end = 0;
+    int fd;
+
+    void skipSpace() {
+      while (true) {
+        while (pos < end && buf[pos] <= ' ') ++pos;
+        if (pos < end || !refill()) return;
+      }
+    }
+    // move [from, end) to the front of the buffer
+    void compact(size_t from) noexcept {
+      std::memmove(buf, buf + from, end - from);
+      end -= from;
+      pos -= from;
+      buf[end] = '\0';
+    }
+    // everything's been used: start over at the front
+    bool refill() {
+      pos = end = 0;
+      return fill();
+    }
+    // read more after `end`; blocks until something's there, false at the end of input
+    bool fill() {
+      if (end == capacity) return false;    // a single token bigger than the buffer
+      ssize_t got;
+      do got = ::read(fd, buf + end, capacity - end);
+      while (got < 0 && errno == EINTR);
+      if (got <= 0) {
+        buf[end] = '\0';
+        return false;
+      }
+      end += size_t(got);
+      buf[end] = '\0';
+      return true;
+    }
+  };
+
+  class FdWriter {
+  public:
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    explicit FdWriter(int fd = STDOUT_FILENO) noexcept : fd(fd) {}
+    FdWriter(const FdWriter&) = delete;
+    FdWriter& operator=(const FdWriter&) = delete;
+    ~FdWriter() { flush(); }
+
+    void write(char c) {
+      if (used == capacity) flush();
+      buf[used++] = c;
+    }
+    void write(std::string_view str) {
+      if (str.size() > capacity - used) {
+        flush();
+        if (str.size() > capacity) return writeAll(str.data(), str.size());
+      }
+      std::memcpy(buf + used, str.data(), str.size());
+      used += str.size();
+    }
+    template <class T>
+    void writeNumber(T value) {
+      // 24 is enough for any integer, and for the shortest round-trip form of a double
+      if (capacity - used < 24) flush();
+      used = std::to_chars(buf + used, buf + capacity, value).ptr - buf;
+    }
+    // hand everything written so far to the descriptor
+    void flush() {
+      writeAll(buf, used);
+      used = 0;
+    }
+
+    template <class T>
+    FdWriter& operator<<(const T& value) {
+      if constexpr (std::is_same<T, char>::value) write(value);
+      else if constexpr (std::is_same<T, bool>::value) write(value ? '1' : '0');
+      else if constexpr (std::is_arithmetic<T>::value) writeNumber(value);
+      else write(std::string_view(value));
+      return *this;
+    }
+
+  private:
+    char buf[capacity];
+    size_t used = 0;
+    int fd;
+
+    void writeAll(const char* data, size_t len) {
+      while (len > 0) {
+        ssize_t put = ::write(fd, data, len);
+        if (put <= 0) return;     // nowhere to send it: the referee's gone
+        data += put;
+        len -= size_t(put);
+      }
+    }
+  };
+
+  inline FdReader fast_in(STDIN_FILENO);
+  inline FdWriter fast_out(STDOUT_FILENO);
+}
 
 using namespace std;
+using namespace kel;
 
 enum Action {
   SPEED = 0, SLOW = 1, JUMP = 2, WAIT = 3, UP = 4, DOWN = 5, action_count = 6
@@ -25,13 +249,11 @@ array<vector<bool>, 4> safe;
 State global_state;
 
 void intakeGame() {
-  cin >> num_bikes;
+  fast_in >> num_bikes;
   global_state.bikes.reserve(num_bikes);
-  cin >> min_survival;
+  fast_in >> min_survival;
   for (int i = 0; i < 4; ++i) {
-    char c;
-    cin >> c;
-    while (c != '\n') {
+    for (char c : fast_in.readToken()) {
       safe[i].push_back(c == '.');
     }
     for (int j = 0; j < 10; ++j) {
@@ -43,11 +265,11 @@ void intakeGame() {
 void intakeState() {
   global_state.bikes.clear();
   //global_state.bikes.reserve(num_bikes);
-  cin >> global_state.speed;
+  fast_in >> global_state.speed;
   for (int i = 0; i < num_bikes; ++i) {
     int x, y;
     bool active;
-    cin >> x >> y >> active;
+    fast_in >> x >> y >> active;
     if (active) global_state.bikes.push_back({ x, y });
   }
 }
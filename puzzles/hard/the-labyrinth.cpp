@@ -1,14 +1,494 @@
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
 #include <cmath>
-#include <stack>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <queue>
 #include <algorithm>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define INSTRUMENT 0        // per-turn timers, counters and histograms on stderr (instrument.hpp)
+#define LOG_LEVEL 1         // 0 silent, 1 errors, 2 and a few lines a turn, 3 and hot-loop debug
+
+// fast-io.hpp
+namespace kel {
+  // Referee I/O without iostreams. FdReader pulls whatever's available from
+  // a file descriptor with read(2) into its buffer and parses straight out of
+  // it; FdWriter collects a turn's output and hands it to write(2) in one go
+  // when flush() is called (and once more at exit, for whatever's left).
+  // Neither allocates unless you read a std::string.
+  //
+  //   fast_in >> x >> y;                  // whitespace and newlines are skipped, no ignore() needed
+  //   std::string_view row = fast_in.readToken();
+  //   fast_out << x << ' ' << y << '\n';
+  //   fast_out.flush();                   // once per turn, instead of endl per line
+  //
+  // Don't mix these with cin/cout on the same descriptor: each side buffers
+  // what the other can't see.
+
+  class FdReader {
+  public:
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    explicit FdReader(int fd = STDIN_FILENO) noexcept : fd(fd) { buf[0] = '\0'; }
+    FdReader(const FdReader&) = delete;
+    FdReader& operator=(const FdReader&) = delete;
+
+    // true once there's nothing left but whitespace; waits for more input to
+    // find out, so it's for reading files, not for asking between turns
+    bool eof() {
+      skipSpace();
+      return pos == end;
+    }
+
+    template <class Int>
+    Int readInt() {
+      static_assert(std::is_integral<Int>::value, "readInt: not an integer type");
+      skipSpace();
+      bool negative = false;
+      if constexpr (std::is_signed<Int>::value) {
+        negative = (buf[pos] == '-');
+        pos += negative;
+      }
+      // make unsigned so overflow past the end of the number wraps harmlessly
+      using U = std::make_unsigned_t<Int>;
+      U value = 0;
+      while (true) {
+        // the '\0' sentinel at buf[end] stops the loop without a bounds check
+        unsigned digit;
+        while ((digit = unsigned(buf[pos]) - '0') < 10) {
+          value = U(value * 10 + digit);
+          ++pos;
+        }
+        if (pos < end || !refill()) break;   // a number split across two reads carries on
+      }
+      return negative ? Int(U(0) - value) : Int(value);
+    }
+    double readDouble() {
+      std::string_view token = readToken();
+      double value = 0;
+      std::from_chars(token.data(), token.data() + token.size(), value);
+      return value;
+    }
+    // the next character that isn't whitespace ('\0' at the end of input)
+    char readChar() {
+      skipSpace();
+      return (pos < end) ? buf[pos++] : '\0';
+    }
+    // The next whitespace-separated word. It points into the buffer, so it's
+    // only good until the next read.
+    std::string_view readToken() {
+      skipSpace();
+      size_t start = pos;
+      while (true) {
+        while (buf[pos] > ' ') ++pos;
+        if (pos < end) break;
+        size_t len = pos - start;
+        compact(start);
+        start = 0;
+        pos = len;
+        if (!fill()) break;
+      }
+      return std::string_view(buf + start, pos - start);
+    }
+    // The rest of the current line, without the newline (or a '\r' before
+    // it). Also only good until the next read.
+    std::string_view readLine() {
+      size_t start = pos;
+      while (true) {
+        const void* newline = std::memchr(buf + pos, '\n', end - pos);
+        if (newline) {
+          pos = static_cast<const char*>(newline) - buf;
+          break;
+        }
+        size_t len = end - start;
+        compact(start);
+        start = 0;
+        pos = len;
+        if (!fill()) break;
+      }
+      size_t stop = pos;
+      if (pos < end) ++pos;
+      if (stop > start && buf[stop - 1] == '\r') --stop;
+      return std::string_view(buf + start, stop - start);
+    }
+    void skipLine() { readLine(); }
+
+    template <class T>
+    FdReader& operator>>(T& value) {
+      if constexpr (std::is_same<T, bool>::value) value = readInt<int>() != 0;
+      else if constexpr (std::is_same<T, char>::value) value = readChar();
+      else if constexpr (std::is_integral<T>::value) value = readInt<T>();
+      else if constexpr (std::is_floating_point<T>::value) value = static_cast<T>(readDouble());
+      else if constexpr (std::is_same<T, std::string_view>::value) value = readToken();
+      else if constexpr (std::is_same<T, std::string>::value) value.assign(readToken());
+      else static_assert(!sizeof(T*), "FdReader: can't read this type");
+      return *this;
+    }
+
+  private:
+    char buf[capacity + 1];   // one more for the '\0' after the last byte read
+    size_t pos = 0, end = 0;
+    int fd;
+
+    void skipSpace() {
+      while (true) {
+        while (pos < end && buf[pos] <= ' ') ++pos;
+        if (pos < end || !refill()) return;
+      }
+    }
+    // move [from, end) to the front of the buffer
+    void compact(size_t from) noexcept {
+      std::memmove(buf, buf + from, end - from);
+      end -= from;
+      pos -= from;
+      buf[end] = '\0';
+    }
+    // everything's been used: start over at the front
+    bool refill() {
+      pos = end = 0;
+      return fill();
+    }
+    // read more after `end`; blocks until something's there, false at the end of input
+    bool fill() {
+      if (end == capacity) return false;    // a single token bigger than the buffer
+      ssize_t got;
+      do got = ::read(fd, buf + end, capacity - end);
+      while (got < 0 && errno == EINTR);
+      if (got <= 0) {
+        buf[end] = '\0';
+        return false;
+      }
+      end += size_t(got);
+      buf[end] = '\0';
+      return true;
+    }
+  };
+
+  class FdWriter {
+  public:
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    explicit FdWriter(int fd = STDOUT_FILENO) noexcept : fd(fd) {}
+    FdWriter(const FdWriter&) = delete;
+    FdWriter& operator=(const FdWriter&) = delete;
+    ~FdWriter() { flush(); }
+
+    void write(char c) {
+      if (used == capacity) flush();
+      buf[used++] = c;
+    }
+    void write(std::string_view str) {
+      if (str.size() > capacity - used) {
+        flush();
+        if (str.size() > capacity) return writeAll(str.data(), str.size());
+      }
+      std::memcpy(buf + used, str.data(), str.size());
+      used += str.size();
+    }
+    template <class T>
+    void writeNumber(T value) {
+      // 24 is enough for any integer, and for the shortest round-trip form of a double
+      if (capacity - used < 24) flush();
+      used = std::to_chars(buf + used, buf + capacity, value).ptr - buf;
+    }
+    // hand everything written so far to the descriptor
+    void flush() {
+      writeAll(buf, used);
+      used = 0;
+    }
+
+    template <class T>
+    FdWriter& operator<<(const T& value) {
+      if constexpr (std::is_same<T, char>::value) write(value);
+      else if constexpr (std::is_same<T, bool>::value) write(value ? '1' : '0');
+      else if constexpr (std::is_arithmetic<T>::value) writeNumber(value);
+      else write(std::string_view(value));
+      return *this;
+    }
+
+  private:
+    char buf[capacity];
+    size_t used = 0;
+    int fd;
+
+    void writeAll(const char* data, size_t len) {
+      while (len > 0) {
+        ssize_t put = ::write(fd, data, len);
+        if (put <= 0) return;     // nowhere to send it: the referee's gone
+        data += put;
+        len -= size_t(put);
+      }
+    }
+  };
+
+  inline FdReader fast_in(STDIN_FILENO);
+  inline FdWriter fast_out(STDOUT_FILENO);
+}
+
+// instrument.hpp
+namespace kel {
+  // Diagnostics that cost nothing unless they're switched on:
+  //   timeScope("expand");            time from here to the end of the scope (rdtsc)
+  //   countEvent("nodes popped");     add 1 to a named counter
+  //   countAdd("plies", n);           add n
+  //   histogramAdd("depth", depth);   record a value; shown in power-of-2 buckets
+  //   logInfo("best " << move);       a line of log, anything cerr can print
+  //   logDebug(...) / logError(...)   the same at the other levels
+  //   instrTurnEnd();                 once a turn, after the answer's flushed
+  // Everything is collected over the turn and written to stderr in one go by
+  // instrTurnEnd(), then reset; what's left at exit is written then. Errors
+  // are the exception: they go out straight away, in case the bot's about to
+  // die. With INSTRUMENT 0 and LOG_LEVEL 0 every macro is ((void)0), and
+  // the arguments aren't evaluated at all.
+#if INSTRUMENT || LOG_LEVEL > 0
+  namespace instr {
+    // the cycle counter where there is one, steady_clock nanoseconds otherwise
+    inline uint64_t ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    struct TimerStat {
+      const char* name;
+      uint64_t calls, ticks;
+    };
+    struct CounterStat {
+      const char* name;
+      int64_t value;
+    };
+    struct HistogramStat {
+      const char* name;
+      uint64_t samples;
+      int64_t min, max, sum;
+      uint64_t buckets[65];   // 0 for values <= 0, then n for [2^(n-1), 2^n)
+    };
+
+    class Registry {
+    public:
+      static constexpr size_t max_stats = 64;   // of each kind; more than that are dropped
+
+      Registry() : start_ticks(ticks()), start_time(std::chrono::steady_clock::now()) {}
+      ~Registry() { if (pending || hasStats()) endTurn(); }
+
+      // Looked up by name once per call site (see the macros), so several
+      // sites with the same name add up.
+      TimerStat& timer(const char* name) noexcept { return find(timers, num_timers, name); }
+      CounterStat& counter(const char* name) noexcept { return find(counters, num_counters, name); }
+      HistogramStat& histogram(const char* name) noexcept {
+        HistogramStat& stat = find(histograms, num_histograms, name);
+        if (stat.samples == 0) resetHistogram(stat);
+        return stat;
+      }
+      void add(HistogramStat& stat, int64_t value) noexcept {
+        if (value < stat.min) stat.min = value;
+        if (value > stat.max) stat.max = value;
+        stat.sum += value;
+        ++stat.samples;
+        ++stat.buckets[(value <= 0) ? 0 : 64 - __builtin_clzll(uint64_t(value))];
+      }
+
+      std::ostream& log() noexcept {
+        pending = true;
+        return log_lines;
+      }
+      void logNow(const std::string& line) noexcept { writeAll(line.data(), line.size()); }
+
+      void endTurn() {
+        if (!pending && !hasStats()) {
+          ++turn;
+          return;
+        }
+        std::ostringstream out;
+        out << "-- turn " << turn++ << " --\n" << log_lines.str();
+        const double ticks_per_us = ticksPerMicro();
+        out << std::fixed << std::setprecision(2);
+        for (size_t idx = 0; idx < num_timers; ++idx) {
+          TimerStat& stat = timers[idx];
+          if (stat.calls == 0) continue;
+          const double total_us = stat.ticks / ticks_per_us;
+          out << "time  " << std::left << std::setw(24) << stat.name << std::right
+              << std::setw(10) << stat.calls << " calls " << std::setw(12) << total_us << " us "
+              << std::setw(10) << total_us / stat.calls << " us/call\n";
+          stat.calls = stat.ticks = 0;
+        }
+        for (size_t idx = 0; idx < num_counters; ++idx) {
+          CounterStat& stat = counters[idx];
+          if (stat.value == 0) continue;
+          out << "count " << std::left << std::setw(24) << stat.name << std::right << std::setw(10) << stat.value << '\n';
+          stat.value = 0;
+        }
+        for (size_t idx = 0; idx < num_histograms; ++idx) {
+          HistogramStat& stat = histograms[idx];
+          if (stat.samples == 0) continue;
+          out << "hist  " << std::left << std::setw(24) << stat.name << std::right
+              << " n " << stat.samples << ", min " << stat.min << ", mean " << double(stat.sum) / stat.samples
+              << ", max " << stat.max << "\n     ";
+          for (int bucket = 0; bucket < 65; ++bucket) {
+            if (stat.buckets[bucket] == 0) continue;
+            if (bucket == 0) out << " <=0:";
+            else if (bucket == 1) out << " 1:";
+            else out << ' ' << (uint64_t(1) << (bucket - 1)) << '-' << (uint64_t(1) << bucket) - 1 << ':';
+            out << stat.buckets[bucket];
+          }
+          out << '\n';
+          resetHistogram(stat);
+        }
+        const std::string text = out.str();
+        writeAll(text.data(), text.size());
+        log_lines.str(std::string());
+        pending = false;
+      }
+
+    private:
+      TimerStat timers[max_stats] = {};
+      CounterStat counters[max_stats] = {};
+      HistogramStat histograms[max_stats] = {};
+      size_t num_timers = 0, num_counters = 0, num_histograms = 0;
+      std::ostringstream log_lines;
+      int turn = 0;
+      bool pending = false;
+      uint64_t start_ticks;
+      std::chrono::steady_clock::time_point start_time;
+
+      bool hasStats() const noexcept {
+        for (size_t idx = 0; idx < num_timers; ++idx) if (timers[idx].calls) return true;
+        for (size_t idx = 0; idx < num_counters; ++idx) if (counters[idx].value) return true;
+        for (size_t idx = 0; idx < num_histograms; ++idx) if (histograms[idx].samples) return true;
+        return false;
+      }
+      template <class Stat>
+      Stat& find(Stat (&stats)[max_stats], size_t& count, const char* name) noexcept {
+        for (size_t idx = 0; idx < count; ++idx) {
+          if (std::strcmp(stats[idx].name, name) == 0) return stats[idx];
+        }
+        if (count == max_stats) {
+          static Stat overflow;   // counted, but never shown
+          return overflow;
+        }
+        stats[count].name = name;
+        return stats[count++];
+      }
+      static void resetHistogram(HistogramStat& stat) noexcept {
+        const char* name = stat.name;
+        stat = HistogramStat();
+        stat.name = name;
+        stat.min = INT64_MAX;
+        stat.max = INT64_MIN;
+      }
+      // calibrated against steady_clock over everything since startup
+      double ticksPerMicro() const noexcept {
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+        return (us > 0) ? (ticks() - start_ticks) / us : 1.0;
+      }
+      static void writeAll(const char* data, size_t len) noexcept {
+        while (len > 0) {
+          ssize_t put = ::write(STDERR_FILENO, data, len);
+          if (put <= 0) return;
+          data += put;
+          len -= size_t(put);
+        }
+      }
+    };
+
+    inline Registry& registry() {
+      static Registry reg;
+      return reg;
+    }
+
+    class ScopedTimer {
+    public:
+      explicit ScopedTimer(TimerStat& stat) noexcept : stat(stat), start(ticks()) {}
+      ~ScopedTimer() {
+        stat.ticks += ticks() - start;
+        ++stat.calls;
+      }
+    private:
+      TimerStat& stat;
+      uint64_t start;
+    };
+  }
+#endif
+
+#define _instrCat2(a, b) a##b
+#define _instrCat(a, b) _instrCat2(a, b)
+#define _instrSite(kind, name)                                                 \
+  static auto& _instrCat(_instr_stat_, __LINE__) = ::kel::instr::registry().kind(name)
+
+#if INSTRUMENT
+#define timeScope(name)                                                        \
+  _instrSite(timer, name);                                                     \
+  ::kel::instr::ScopedTimer _instrCat(_instr_timer_, __LINE__)(_instrCat(_instr_stat_, __LINE__))
+#define countAdd(name, n)                                                      \
+  do {                                                                         \
+    _instrSite(counter, name);                                                 \
+    _instrCat(_instr_stat_, __LINE__).value += (n);                            \
+  } while (0)
+#define countEvent(name) countAdd(name, 1)
+#define histogramAdd(name, value)                                              \
+  do {                                                                         \
+    _instrSite(histogram, name);                                               \
+    ::kel::instr::registry().add(_instrCat(_instr_stat_, __LINE__), (value));  \
+  } while (0)
+#else
+#define timeScope(name) ((void)0)
+#define countAdd(name, n) ((void)0)
+#define countEvent(name) ((void)0)
+#define histogramAdd(name, value) ((void)0)
+#endif
+
+#if LOG_LEVEL >= 1
+#define logError(...)                                                          \
+  do {                                                                         \
+    std::ostringstream _instr_line;                                            \
+    _instr_line << "error: " << __VA_ARGS__ << '\n';                           \
+    ::kel::instr::registry().logNow(_instr_line.str());                        \
+  } while (0)
+#else
+#define logError(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 2
+#define logInfo(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logInfo(...) ((void)0)
+#endif
+#if LOG_LEVEL >= 3
+#define logDebug(...) do { ::kel::instr::registry().log() << __VA_ARGS__ << '\n'; } while (0)
+#else
+#define logDebug(...) ((void)0)
+#endif
+
+#if INSTRUMENT || LOG_LEVEL >= 2
+#define instrTurnEnd() ::kel::instr::registry().endTurn()
+#else
+#define instrTurnEnd() ((void)0)
+#endif
+}
 
 using namespace std;
+using namespace kel;
 
-class Map {
+template <template <class> class Allocator>
+class BasicMap {
 public:
   enum Direction : int {
     up = 0, left = 1, down = 2, right = 3, ndirs = 4
@@ -45,14 +525,19 @@ public:
   };
   using Row = vector<Node*>;
   using Grid = vector<Row>;
+  using Path = vector<Direction>;  // the next move at the back
 
-  Map(size_t rows, size_t cols)
+  BasicMap(size_t rows, size_t cols)
     : grid(rows, Row(cols, nullptr)), width(cols)
     , height(rows), spawn_point(), control_room() {
+    // the searches' working space, sized once for this map so no turn allocates
+    frontier.reserve(rows * cols);
+    open_heap.reserve(4 * rows * cols + 1);
     for (size_t row_idx = 0; row_idx < rows; ++row_idx) {
       Row& row = grid[row_idx];
       for (size_t col_idx = 0; col_idx < cols; ++col_idx) {
-        row[col_idx] = new Node(row_idx, col_idx);
+        row[col_idx] = NodeTraits::allocate(node_alloc, 1);
+        NodeTraits::construct(node_alloc, row[col_idx], row_idx, col_idx);
       }
     }
     for (size_t row_idx = 0; row_idx < rows; ++row_idx) {
@@ -67,35 +552,38 @@ public:
     }
   }
 
-  ~Map() {
+  ~BasicMap() {
     for (Row& row : grid) {
       for (Node*& node : row) {
-        delete node;
+        NodeTraits::destroy(node_alloc, node);
+        NodeTraits::deallocate(node_alloc, node, 1);
       }
     }
   }
 
-  friend istream& operator>>(istream& is, Map& map) {
-    for (int row_idx = 0; row_idx < map.height; ++row_idx) {
+  // each row comes as one word, a character per square
+  friend FdReader& operator>>(FdReader& in, BasicMap& map) {
+    for (size_t row_idx = 0; row_idx < map.height; ++row_idx) {
       Row& row = map.grid[row_idx];
-      for (int col_idx = 0; col_idx < map.width; ++col_idx) {
+      string_view line = in.readToken();
+      for (size_t col_idx = 0; col_idx < map.width; ++col_idx) {
         Node* node = row[col_idx];
-        is >> node->type;
+        node->type = line[col_idx];
         switch (node->type) {
         case 'T':
-          map.spawn_point = { row_idx, col_idx };
+          map.spawn_point = { int(row_idx), int(col_idx) };
           break;
         case 'C':
-          map.control_room = { row_idx, col_idx };
+          map.control_room = { int(row_idx), int(col_idx) };
           break;
         default:
           break;
         }
       }
     }
-    return is;
+    return in;
   }
-  friend ostream& operator<<(ostream& os, const Map& map) {
+  friend ostream& operator<<(ostream& os, const BasicMap& map) {
     for (const Row& row : map.grid) {
       for (const Node* node : row) {
         os << node->type;
@@ -115,35 +603,42 @@ public:
     }
   }
 
-  void print(Node* looking_at = nullptr, Node* target_square = nullptr) const {
+  // the map with the search drawn on it, for logging
+  string picture(Node* looking_at = nullptr, Node* target_square = nullptr) const {
+    string pic;
     for (const Row& row : grid) {
       for (const Node* node : row) {
-        if (node == looking_at) cerr << '@';
-        else if (node == target_square) cerr << 'X';
-        else if (node->explored_from != nullptr && node->type == '.') cerr << 'o';
-        else cerr << node->type;
+        if (node == looking_at) pic += '@';
+        else if (node == target_square) pic += 'X';
+        else if (node->explored_from != nullptr && node->type == '.') pic += 'o';
+        else pic += node->type;
       }
-      cerr << '\n';
+      pic += '\n';
     }
+    return pic;
   }
 
+  // a path's worth of moves, for a Path that's going to be reused all game
+  size_t maxPathLength() const { return width * height; }
+
   Direction explore(GridSquare from) {
+    timeScope("explore");
     setUpGraph();
-    queue<Node*> to_explore;
+    frontier.clear();
     Node* home = grid.at(from.row).at(from.col);
     home->explored_from = home;
-    to_explore.push(home);
-    Node* node;
-    while (!to_explore.empty()) {
-      node = to_explore.front();
-      to_explore.pop();
+    frontier.push_back(home);
+    Node* node = home;
+    for (size_t next = 0; next < frontier.size(); ++next) {
+      node = frontier[next];
+      countEvent("explore pops");
       if (node->type == '?') break;
       else if (node->type != '#' && node->type != 'C') {
         for (int d = 0; d < ndirs; ++d) {
           if (node->connections[d]->type == '#') continue;
           if (node->connections[d]->explored_from == nullptr) {
             node->connections[d]->explored_from = node;
-            to_explore.push(node->connections[d]);
+            frontier.push_back(node->connections[d]);
           }
         }
       }
@@ -160,20 +655,24 @@ public:
     return abs(from.col - to.col) + abs(from.row - to.row);
   }
 
-  stack<Direction> a_star(GridSquare from, GridSquare target) {
+  // the shortest path from `from` to `target`, into `movements`
+  void a_star(GridSquare from, GridSquare target, Path& movements) {
+    timeScope("a_star");
     setUpGraph(target);
-    priority_queue<Node*, vector<Node*>, NodeCompare> to_explore;
-    stack<Direction> movements;
+    open_heap.clear();
+    movements.clear();
 
     Node* start_square = grid.at(from.row).at(from.col);
     Node* target_square = grid.at(target.row).at(target.col);
     start_square->path_cost = 0.f;
-    to_explore.push(start_square);
-    Node* node;
-    while (!to_explore.empty()) {
-      node = to_explore.top();
-      to_explore.pop();
-      if (node == target_square) print(node, target_square);
+    open_heap.push_back(start_square);
+    Node* node = start_square;
+    while (!open_heap.empty()) {
+      pop_heap(open_heap.begin(), open_heap.end(), NodeCompare());
+      node = open_heap.back();
+      open_heap.pop_back();
+      countEvent("a_star pops");
+      if (node == target_square) logDebug(picture(node, target_square));
       if (node == target_square) break;
       else if (node->type != '#' && node->type != '?') {
         for (size_t d = 0; d < ndirs; ++d) {
@@ -181,85 +680,96 @@ public:
           if (node->path_cost + 1.f < next->path_cost) {
             next->path_cost = node->path_cost + 1.f;
             next->explored_from = node;
-            to_explore.push(next);
+            open_heap.push_back(next);
+            push_heap(open_heap.begin(), open_heap.end(), NodeCompare());
           }
         }
       }
     }
     while (node->explored_from != nullptr) {
       Direction d = node->explored_from->getDir(node);
-      movements.push(d);
+      movements.push_back(d);
       node = node->explored_from;
     }
-    cerr << endl;
-    return movements;
+    histogramAdd("path length", movements.size());
   }
 
 private:
+  using NodeTraits = allocator_traits<Allocator<Node>>;
+  Allocator<Node> node_alloc;
   Grid grid;
   size_t width, height;
+  // the searches' working space, kept here so no turn allocates
+  vector<Node*> frontier;     // breadth-first, read from the front; every node goes in at most once
+  // a node goes in once per neighbour that improves its path, so at most 4 times
+  vector<Node*> open_heap;
 public:
   GridSquare spawn_point;
   GridSquare control_room;
 };
 
+using Map = BasicMap<std::allocator>;
+
 int main()
 {
   int nrows; // number of rows.
   int ncols; // number of columns.
   int alarm; // number of rounds between the time the alarm countdown is activated and the time the alarm goes off.
-  cin >> nrows >> ncols >> alarm; cin.ignore();
+  fast_in >> nrows >> ncols >> alarm;
 
   Map map(nrows, ncols);
 
-  stack<Map::Direction> movements;
+  Map::Path movements;
+  movements.reserve(map.maxPathLength());
   Map::Direction explore_dir = Map::up;
 
   // game loop
   while (true) {
     int rick_row; // row where Rick is located.
     int rick_col; // column where Rick is located.
-    cin >> rick_row >> rick_col; cin.ignore();
-    cin >> map;
-    cerr << map;
+    fast_in >> rick_row >> rick_col;
+    fast_in >> map;
+    logDebug(map);
 
     if (explore_dir != Map::ndirs) explore_dir = map.explore({ rick_row, rick_col });
 
     if (explore_dir != Map::ndirs) {
-      movements.push(explore_dir);
+      movements.push_back(explore_dir);
     }
     else {
-      cerr << "Done exploring" << endl;
+      logInfo("Done exploring");
       if (movements.empty()) {
         if (rick_row == map.control_room.row && rick_col == map.control_room.col) {
           // we've just gotten to the control room
           // time to SCRAM!
-          movements = move(map.a_star({ rick_row, rick_col }, map.spawn_point));
+          map.a_star({ rick_row, rick_col }, map.spawn_point, movements);
         }
         else {
           // navigate to the control room
-          movements = map.a_star({ rick_row, rick_col }, map.control_room);
+          map.a_star({ rick_row, rick_col }, map.control_room, movements);
         }
       }
     }
     if (!movements.empty()) {
-      switch (movements.top()) {
+      switch (movements.back()) {
       case Map::up:
-        cout << "UP" << endl;
+        fast_out << "UP\n";
         break;
       case Map::left:
-        cout << "LEFT" << endl;
+        fast_out << "LEFT\n";
         break;
       case Map::down:
-        cout << "DOWN" << endl;
+        fast_out << "DOWN\n";
         break;
       case Map::right:
-        cout << "RIGHT" << endl;
+        fast_out << "RIGHT\n";
         break;
       default:
         break;
       }
-      movements.pop();
+      movements.pop_back();
+      fast_out.flush();
+      instrTurnEnd();
     }
     else break;
   }
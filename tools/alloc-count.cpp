@@ -0,0 +1,102 @@
+// Counts a bot's heap allocations turn by turn. Build it as a shared library
+// (the tools-alloc-count target) and preload it into the bot:
+//   LD_PRELOAD=./libtools-alloc-count.so ./bot < input.txt
+// Every operator new is counted, and a turn ends whenever the bot flushes an
+// answer to stdout (fflush(stdout) with something to flush, which is what endl
+// does on cout, or a write(2) to fd 1). Reading cin flushes cout too, but with
+// nothing in it, so that doesn't count. At exit it prints a summary to
+// stderr; the first turn includes all of the setup, so it's reported on its
+// own. ALLOC_COUNT_TURNS=1 in the environment prints a line for every turn as
+// well (a bot that gets killed never reaches the summary).
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <dlfcn.h>
+#include <stdio_ext.h>
+#include <unistd.h>
+
+namespace {
+  struct Counts {
+    size_t allocs = 0, bytes = 0;
+  };
+
+  Counts total, turn, first_turn, later_turns, worst_turn;
+  size_t num_turns = 0;
+  bool per_turn = false;
+  bool in_hook = false;   // don't count (or report) anything the reporting itself does
+
+  void* countedAlloc(size_t size) {
+    if (!in_hook) {
+      ++turn.allocs;
+      turn.bytes += size;
+    }
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+  }
+
+  void endTurn() {
+    if (in_hook) return;
+    in_hook = true;
+    ++num_turns;
+    total.allocs += turn.allocs;
+    total.bytes += turn.bytes;
+    if (num_turns == 1) first_turn = turn;
+    else {
+      later_turns.allocs += turn.allocs;
+      later_turns.bytes += turn.bytes;
+      if (turn.allocs > worst_turn.allocs) worst_turn = turn;
+    }
+    if (per_turn) std::fprintf(stderr, "alloc-count: turn %zu: %zu allocations, %zu bytes\n", num_turns, turn.allocs, turn.bytes);
+    turn = Counts();
+    in_hook = false;
+  }
+
+  struct Report {
+    Report() { per_turn = std::getenv("ALLOC_COUNT_TURNS") != nullptr; }
+    ~Report() {
+      in_hook = true;
+      std::fprintf(stderr,
+                   "alloc-count: %zu turns\n"
+                   "  first turn (with setup): %zu allocations, %zu bytes\n"
+                   "  later turns:             %zu allocations, %zu bytes (%.2f per turn, at most %zu in one)\n"
+                   "  after the last turn:     %zu allocations, %zu bytes\n",
+                   num_turns, first_turn.allocs, first_turn.bytes,
+                   later_turns.allocs, later_turns.bytes,
+                   (num_turns > 1) ? double(later_turns.allocs) / double(num_turns - 1) : 0.0, worst_turn.allocs,
+                   turn.allocs, turn.bytes);
+    }
+  } report;
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  try { return countedAlloc(size); }
+  catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  try { return countedAlloc(size); }
+  catch (...) { return nullptr; }
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+extern "C" {
+  int fflush(FILE* stream) {
+    static auto real_fflush = reinterpret_cast<int (*)(FILE*)>(dlsym(RTLD_NEXT, "fflush"));
+    bool answered = stream == stdout && __fpending(stdout) > 0;
+    int ret = real_fflush(stream);
+    if (answered) endTurn();
+    return ret;
+  }
+  ssize_t write(int fd, const void* buf, size_t count) {
+    static auto real_write = reinterpret_cast<ssize_t (*)(int, const void*, size_t)>(dlsym(RTLD_NEXT, "write"));
+    ssize_t ret = real_write(fd, buf, count);
+    if (fd == STDOUT_FILENO) endTurn();
+    return ret;
+  }
+}
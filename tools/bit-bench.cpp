@@ -0,0 +1,200 @@
+// Times bit-fiddling.hpp against what ultimate-tic-tac-toe.cpp used before it:
+// 512-entry popcnt/bsf lookup tables, walking set bits with bsf + clearLS1B,
+// and picking the nth move out of a list. The 9-bit inputs are local boards.
+// The 64-bit part times select/pdep/pext against plain loops.
+//
+// Which code popcount/pdep/selectBit compile to depends on the target flags,
+// so build it both ways to see each side of the dispatch:
+//   g++ -std=c++17 -O2 -Iinclude tools/bit-bench.cpp
+//   g++ -std=c++17 -O2 -Iinclude -mpopcnt -mbmi2 tools/bit-bench.cpp
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../include/typedefs.hpp"
+#include "../include/bit-fiddling.hpp"
+#include "../include/lookup-tables.hpp"
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+constexpr size_t num_inputs = 1 << 20;          // operations per pass
+constexpr int num_passes = 4;
+constexpr int num_runs = 5;                     // keep the best of this many timings
+
+/*****************************************************************************/
+
+// the tables the bot had, filled the way it filled them (startup)
+struct gen_tablePopcnt {
+  static constexpr int eval(size_t mask) noexcept { return __builtin_popcountll(mask); }
+};
+struct gen_tableBsf {
+  static constexpr int eval(size_t mask) noexcept { return mask ? __builtin_ctzll(mask) : -1; }
+};
+const auto table_popcnt = makeLookupTableWith<LutPolicy::startup, 0, gen_tablePopcnt, pow2(9)>();
+const auto table_bsf = makeLookupTableWith<LutPolicy::startup, 0, gen_tableBsf, pow2(9)>();
+
+using Clock = chrono::steady_clock;
+
+u64 sink = 0;
+volatile u64 opaque_zero = 0;
+
+// Latency, not throughput: each input is xor'ed with (a zero derived from) the
+// last result, so operations can't overlap, the same as in a rollout.
+template <class Op>
+double timeOps(const vector<u64>& inputs, Op op) {
+  const u64 zero = opaque_zero;
+  u64 sum = 0, dep = 0;
+  Clock::time_point start = Clock::now();
+  for (int pass = 0; pass < num_passes; ++pass) {
+    for (u64 input : inputs) {
+      dep = op(input ^ (dep & zero));
+      sum += dep;
+    }
+  }
+  double secs = chrono::duration<double>(Clock::now() - start).count();
+  sink ^= sum;
+  return secs * 1e9 / (double(num_passes) * inputs.size());
+}
+template <class Op>
+double nsPerOp(const vector<u64>& inputs, Op op) {
+  double best = timeOps(inputs, op);
+  for (int run = 1; run < num_runs; ++run) best = min(best, timeOps(inputs, op));
+  return best;
+}
+
+double baseline = 0;
+
+template <class OldOp, class NewOp>
+void bench(const char* name, const vector<u64>& inputs, OldOp old_op, NewOp new_op) {
+  double old_ns = nsPerOp(inputs, old_op) - baseline, new_ns = nsPerOp(inputs, new_op) - baseline;
+  cout << left << setw(22) << name << right << fixed << setprecision(2)
+    << setw(10) << old_ns << setw(10) << new_ns << setw(9) << old_ns / new_ns << "x" << endl;
+}
+
+// the library against the obvious loop, everywhere it's cheap to check
+template <class T>
+bool selfCheck(mt19937_64& rng, size_t n) {
+  for (size_t it = 0; it < n; ++it) {
+    T mask = static_cast<T>(rng() & rng()), src = static_cast<T>(rng());
+    if constexpr (mask_bits<T> > 64) mask |= static_cast<T>(rng() & rng()) << 64;
+    T dep = 0, ext = 0;
+    int count = 0, lowest = -1, highest = -1;
+    for (int idx = 0; idx < mask_bits<T>; ++idx) {
+      if (!((mask >> idx) & 1)) continue;
+      if (selectBit(mask, count) != idx) return false;
+      if ((src >> count) & 1) dep |= static_cast<T>(T(1) << idx);
+      if ((src >> idx) & 1) ext |= static_cast<T>(T(1) << count);
+      if (lowest == -1) lowest = idx;
+      highest = idx;
+      ++count;
+    }
+    int walked = 0;
+    for (int idx : setBits(mask)) walked += (idx == selectBit(mask, walked));
+    if (popcount(mask) != count || walked != count || pdep(src, mask) != dep || pext(src, mask) != ext) return false;
+    if (mask && (indexLS1B(mask) != lowest || indexMS1B(mask) != highest)) return false;
+  }
+  return true;
+}
+
+int main() {
+  mt19937_64 rng(2024);
+  for (u64 mask = 0; mask < pow2(9); ++mask) {
+    if (popcount(u16(mask)) != table_popcnt[mask] || (mask && indexLS1B(u16(mask)) != table_bsf[mask])) {
+      cout << "disagrees with the tables at " << mask << endl;
+      return 1;
+    }
+  }
+  if (!selfCheck<u8>(rng, 1 << 16) || !selfCheck<u16>(rng, 1 << 16) || !selfCheck<u32>(rng, 1 << 16)
+    || !selfCheck<u64>(rng, 1 << 16) || !selfCheck<u128>(rng, 1 << 16)) {
+    cout << "disagrees with the naive loops" << endl;
+    return 1;
+  }
+
+  // local boards with at least one empty square, and which of them to pick
+  vector<u64> boards(num_inputs), wide(num_inputs);
+  for (u64& input : boards) {
+    u64 mask = rng() % (pow2(9) - 1) + 1;
+    input = mask | (rng() % popcount(mask)) << 16;
+  }
+  for (u64& input : wide) {
+    u64 mask = (rng() & ones(58)) | 1;
+    input = mask | (rng() % popcount(mask)) << 58;    // which bit to pick rides in the top 6 bits
+  }
+
+  baseline = nsPerOp(boards, [](u64 x) { return x; });
+  cout << "popcnt: "
+#if defined(__POPCNT__)
+    << "yes"
+#else
+    << "no"
+#endif
+    << ", bmi2: "
+#if defined(__BMI2__)
+    << "yes"
+#else
+    << "no"
+#endif
+    << "; ns per operation over the cost of the loop (" << baseline << ")\n"
+    << left << setw(22) << "9-bit local boards" << right
+    << setw(10) << "before" << setw(10) << "library" << setw(10) << "speedup" << endl;
+
+  bench("popcount", boards,
+        [](u64 x) -> u64 { return table_popcnt[x & 511]; },
+        [](u64 x) -> u64 { return popcount(u16(x & 511)); });
+  bench("lowest bit", boards,
+        [](u64 x) -> u64 { return table_bsf[x & 511]; },
+        [](u64 x) -> u64 { return indexLS1B(u16(x & 511)); });
+  bench("walk set bits", boards,
+        [](u64 x) -> u64 {
+          u16 mask = x & 511;
+          u64 sum = 0;
+          do sum += table_bsf[mask]; while (clearLS1B(mask));
+          return sum;
+        },
+        [](u64 x) -> u64 {
+          u64 sum = 0;
+          for (int idx : setBits(u16(x & 511))) sum += idx;
+          return sum;
+        });
+  bench("nth set bit", boards,
+        [](u64 x) -> u64 {
+          u16 mask = x & 511;
+          int list[9], size = 0;
+          do list[size++] = table_bsf[mask]; while (clearLS1B(mask));
+          return list[(x >> 16) % size];
+        },
+        [](u64 x) -> u64 { return selectBit(u16(x & 511), int(x >> 16)); });
+
+  cout << left << setw(22) << "random 64-bit masks" << endl;
+  bench("popcount", wide,
+        [](u64 x) -> u64 { return __builtin_popcountll(x); },
+        [](u64 x) -> u64 { return popcount(x); });
+  bench("nth set bit", wide,
+        [](u64 x) -> u64 {
+          u64 mask = x & ones(58);
+          for (int n = int(x >> 58); n > 0; --n) clearLS1B(mask);
+          return __builtin_ctzll(mask);
+        },
+        [](u64 x) -> u64 { return selectBit(x & ones<u64>(58), int(x >> 58)); });
+  bench("pdep", wide,
+        [](u64 x) -> u64 {
+          u64 mask = x * 0x9e3779b97f4a7c15, out = 0;
+          for (u64 bit = 1; mask; bit <<= 1, clearLS1B(mask)) if (x & bit) out |= getLS1B(mask);
+          return out;
+        },
+        [](u64 x) -> u64 { return pdep(x, x * 0x9e3779b97f4a7c15); });
+  bench("pext", wide,
+        [](u64 x) -> u64 {
+          u64 mask = x * 0x9e3779b97f4a7c15, out = 0;
+          for (u64 bit = 1; mask; bit <<= 1, clearLS1B(mask)) if (x & getLS1B(mask)) out |= bit;
+          return out;
+        },
+        [](u64 x) -> u64 { return pext(x, x * 0x9e3779b97f4a7c15); });
+  return sink == 42;
+}
@@ -0,0 +1,248 @@
+// Checks that csb-physics.hpp gives the same races in float and Fixed<20>
+// as it does in double. Every field in nn/fields is raced with the same
+// stream of random commands (a target near the next checkpoint, a thrust,
+// now and then a shield or a boost) in each precision, two ways:
+//
+//   step:    from every state of the double race, one frame in T; the
+//            integers the referee would send back should match exactly, and
+//            a mismatch is a value that fell on the other side of a rounding
+//   rollout: the whole race in T on its own, to see how long it stays with
+//            double before those mismatches pile up into a different race
+//
+// Before that, the engine's table trig (unitVector and fastAtan2) is held
+// up against libm in long double, to show it's no worse than libm's own
+// float and double, and roundHalfUp in each precision against the Java
+// Math.round the referee ends every frame with.
+//
+// Fixed<20> rather than <16>: with 16 bits, pi / 180 alone is off by enough
+// to turn 2% of the steps to the other side of a rounding.
+//
+// Exits 1 if any rounding differs from Math.round, if more than
+// max_mismatch_pct of the steps disagree, or if any of them is off by more
+// than max_step_diff.
+//
+//   tools-csb-parity [num_races]   (races per field, default 20)
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/typedefs.hpp"
+#include "../include/rng.hpp"
+#include "../include/fixed-point.hpp"
+#include "../include/csb-physics.hpp"
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+constexpr int num_fields = 15;          // nn/fields/1.txt to 15.txt
+constexpr int max_frames = 400;         // a race that hasn't finished by then is cut off
+constexpr u64 seed = 43;
+constexpr double max_mismatch_pct = 1.0;
+constexpr double max_step_diff = 1.0;   // one unit either way of a rounding
+constexpr int trig_samples = 1000000;
+
+/*****************************************************************************/
+
+using Fixed20 = Fixed<20>;
+
+struct Command {
+  int dx, dy;   // aim this far off the next checkpoint
+  int thrust;
+};
+using Turn = array<Command, 4>;
+
+Turn randomTurn(Pcg32& rng) {
+  Turn turn;
+  for (Command& cmd : turn) {
+    cmd.dx = uniformInt(rng, -1500, 1500);
+    cmd.dy = uniformInt(rng, -1500, 1500);
+    float roll = uniformFloat(rng);
+    cmd.thrust = (roll < 0.02f) ? SHIELD : (roll < 0.03f) ? BOOST : uniformInt(rng, 0, 100);
+  }
+  return turn;
+}
+
+template <class T>
+void play(const Turn& turn, const BasicField<T>& field, BasicRace<T>& race) {
+  for (int idx = 0; idx < 4; ++idx) {
+    BasicPod<T>& pod = race.pods[idx];
+    BasicVec2<T> target = field.checkpoints[pod.next_cp] + BasicVec2<T>(T(turn[idx].dx), T(turn[idx].dy));
+    pod.applyTarget(target, turn[idx].thrust);
+  }
+  race.simFrame(field);
+}
+
+// the largest difference between what the referee would send back for each
+// race; checkpoint and lap differences count as infinitely large
+template <class T>
+double difference(const BasicRace<T>& race, const BasicRace<double>& ref) {
+  double diff = 0;
+  for (int idx = 0; idx < 4; ++idx) {
+    const BasicPod<T>& pod = race.pods[idx];
+    const BasicPod<double>& ref_pod = ref.pods[idx];
+    if (pod.next_cp != ref_pod.next_cp || pod.laps != ref_pod.laps) return INFINITY;
+    diff = max({ diff, abs(double(pod.pos.x) - ref_pod.pos.x), abs(double(pod.pos.y) - ref_pod.pos.y),
+      abs(double(pod.vel.x) - ref_pod.vel.x), abs(double(pod.vel.y) - ref_pod.vel.y) });
+    double angle_diff = abs(double(pod.angle) - ref_pod.angle);
+    diff = max(diff, min(angle_diff, 360 - angle_diff));
+  }
+  return diff;
+}
+
+// the largest error of a (cos, sin) over angles in [0, 360), and of an
+// atan2 over vectors the size of the ones on a map
+template <class T, class Unit, class Atan2>
+void reportTrig(const char* name, Unit unit_vector, Atan2 atan2_of) {
+  const long double pi = 3.141592653589793238462643383279502884L;
+  Pcg32 rng(seed);
+  double unit_error = 0, atan_error = 0;
+  for (int sample = 0; sample < trig_samples; ++sample) {
+    double degrees = 360.0 * sample / trig_samples;
+    BasicVec2<T> unit = unit_vector(T(degrees));
+    long double rad = degrees * pi / 180;
+    unit_error = max({ unit_error, double(fabsl(double(unit.x) - cosl(rad))), double(fabsl(double(unit.y) - sinl(rad))) });
+    int x = uniformInt(rng, -16000, 16000), y = uniformInt(rng, -9000, 9000);
+    atan_error = max(atan_error, double(fabsl(double(atan2_of(T(y), T(x))) - atan2l(y, x))));
+  }
+  cout << left << setw(12) << name << right << scientific << setprecision(2)
+    << setw(14) << unit_error << setw(14) << atan_error << defaultfloat << '\n';
+}
+template <class T>
+void reportTrig(const char* name) {
+  reportTrig<T>(name, [](T degrees) { return unitVector(degrees); }, [](T y, T x) { return fastAtan2(y, x); });
+}
+// what heading() and angleTo() used to do
+template <class T>
+void reportLibmTrig(const char* name) {
+  reportTrig<T>(name, [](T degrees) {
+    T rad = degrees * T(M_PI) / T(180);
+    return BasicVec2<T>(cos(rad), sin(rad));
+  }, [](T y, T x) { return atan2(y, x); });
+}
+
+// Math.round, for values a long double holds with room for the + 0.5
+long double javaRound(long double x) { return floorl(x + 0.5L); }
+
+// Halves, and the values 1/1024 either side of them, all over (and a way
+// off) the map: the ones where roundHalfUp could differ from Math.round.
+// Far enough out a float can't hold the ones either side, so each is
+// checked as the value T actually holds. Returns how many came out
+// different.
+template <class T>
+int reportRounding(const char* name) {
+  int checked = 0, wrong = 0;
+  for (int whole = -20000; whole <= 20000; ++whole) {
+    for (double offset : { 0.5 - 1.0 / 1024, 0.5, 0.5 + 1.0 / 1024 }) {
+      T x = T(whole + offset);
+      ++checked;
+      if (double(roundHalfUp(x)) != javaRound(double(x))) ++wrong;
+    }
+  }
+  cout << left << setw(12) << name << right << setw(8) << wrong << " of " << checked << '\n';
+  return wrong;
+}
+
+struct Parity {
+  size_t steps = 0, mismatched = 0;
+  double worst_step = 0;
+  size_t rollouts = 0, stayed = 0;    // rollouts that never left double's race
+  double frames_together = 0;         // summed over the rollouts that did
+  size_t same_winner = 0;
+};
+
+template <class T>
+void check(const BasicField<double>& field, const BasicRace<double>& start, const vector<Turn>& turns,
+           const vector<BasicRace<double>>& ref, Parity& parity) {
+  BasicField<T> t_field(field);
+  for (size_t frame = 0; frame < turns.size(); ++frame) {
+    BasicRace<T> race(frame ? ref[frame - 1] : start);
+    play(turns[frame], t_field, race);
+    double diff = difference(race, ref[frame]);
+    ++parity.steps;
+    if (diff > 0) ++parity.mismatched;
+    parity.worst_step = max(parity.worst_step, diff);
+  }
+
+  BasicRace<T> race(start);
+  size_t frame = 0;
+  for (; frame < turns.size(); ++frame) {
+    play(turns[frame], t_field, race);
+    if (difference(race, ref[frame]) > 0) break;
+  }
+  ++parity.rollouts;
+  if (frame == turns.size()) ++parity.stayed;
+  else parity.frames_together += frame;
+  for (; frame < turns.size() && race.outcome(t_field) == 0; ++frame) play(turns[frame], t_field, race);
+  if (race.outcome(t_field) == ref.back().outcome(field)) ++parity.same_winner;
+}
+
+void report(const char* name, const Parity& parity) {
+  double mismatch_pct = 100.0 * parity.mismatched / parity.steps;
+  cout << left << setw(12) << name << right << fixed << setprecision(3) << setw(9) << mismatch_pct << "%"
+    << setprecision(1) << setw(12) << parity.worst_step << setw(10) << parity.stayed << "/" << parity.rollouts
+    << setw(14) << ((parity.rollouts > parity.stayed) ? parity.frames_together / (parity.rollouts - parity.stayed) : NAN)
+    << setw(10) << parity.same_winner << "/" << parity.rollouts << '\n';
+}
+
+int main(int argc, char** argv) {
+  int races_per_field = (argc > 1) ? max(1, atoi(argv[1])) : 20;
+  cout << "trig, worst error against long double:\n"
+    << left << setw(12) << "" << right << setw(14) << "unitVector" << setw(14) << "fastAtan2" << '\n';
+  reportTrig<float>("float");
+  reportTrig<double>("double");
+  reportTrig<Fixed20>("Fixed<20>");
+  reportLibmTrig<float>("libm float");
+  reportLibmTrig<double>("libm double");
+  cout << "\nroundHalfUp, differences from Math.round:\n";
+  int rounding_wrong = reportRounding<float>("float") + reportRounding<double>("double")
+    + reportRounding<Fixed20>("Fixed<20>");
+  cout << '\n';
+
+  Pcg32 rng(seed);
+  Parity float_parity, fixed_parity;
+
+  for (int field_id = 1; field_id <= num_fields; ++field_id) {
+    string path = string(CSB_FIELDS_DIR "/") + to_string(field_id) + ".txt";
+    ifstream in(path);
+    BasicField<double> field;
+    BasicRace<double> start;
+    if (!(in >> field >> start)) {
+      cerr << "can't read " << path << '\n';
+      return 2;
+    }
+    for (int race_idx = 0; race_idx < races_per_field; ++race_idx) {
+      vector<Turn> turns;
+      vector<BasicRace<double>> ref;
+      BasicRace<double> race = start;
+      while (turns.size() < max_frames && race.outcome(field) == 0) {
+        turns.push_back(randomTurn(rng));
+        play(turns.back(), field, race);
+        ref.push_back(race);
+      }
+      check<float>(field, start, turns, ref, float_parity);
+      check<Fixed20>(field, start, turns, ref, fixed_parity);
+    }
+  }
+
+  cout << "against double, over " << float_parity.steps << " frames:\n"
+    << left << setw(12) << "" << right << setw(10) << "steps off" << setw(12) << "worst" << setw(16) << "rollouts same"
+    << setw(14) << "frames same" << setw(16) << "same winner\n";
+  report("float", float_parity);
+  report("Fixed<20>", fixed_parity);
+
+  bool ok = (rounding_wrong == 0);
+  if (!ok) cout << "FAILED: roundHalfUp differs from Math.round\n";
+  for (const Parity* parity : { &float_parity, &fixed_parity }) {
+    ok &= 100.0 * parity->mismatched / parity->steps <= max_mismatch_pct && parity->worst_step <= max_step_diff;
+  }
+  if (!ok && rounding_wrong == 0) cout << "FAILED: more than " << max_mismatch_pct << "% of steps, or a step by more than "
+    << max_step_diff << ", differ from double\n";
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+// Holds csb-physics.hpp up against recorded races (csb-trace.hpp), so a
+// change to the engine has to show it still gets the referee's answers, and
+// how fast it gets them.
+//
+//   tools-csb-trace replay FILE...
+//
+// plays every frame of every race from the recorded state before it, in
+// float, double, Fixed<20> and the SSE float SoaRace. For each field it
+// reports how far the pods' positions and velocities came out from the
+// recording (worst and mean, in map units), the worst facing (degrees),
+// and how many frames had a pod heading for a different checkpoint; for
+// each precision, how many simFrames a second it does over the whole
+// trace. Exits 1 if any frame is off by more than max_error, or more than
+// max_cp_off_pct of them have a different checkpoint.
+//
+//   tools-csb-trace import FILE < TEXT
+//
+// writes the races in TEXT out as a trace, for races recorded elsewhere
+// (the Java referee run locally, or a replay copied out of the IDE). Each
+// race is the game's initialisation input, the 4 pods' first input lines,
+// then for each frame the 4 commands ("x y thrust", thrust a number,
+// SHIELD or BOOST) and the 4 pod lines after it, and END.
+//
+//   tools-csb-trace record FILE [races_per_field]
+//
+// writes races over nn/fields with random commands (as tools-csb-parity
+// makes them), played by BasicRace<double> standing in for the referee. A
+// replay of those only measures agreement with the double engine, but it
+// gives the format and the frames/sec something to run on without a
+// referee.
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../include/typedefs.hpp"
+#include "../include/bench.hpp"
+#include "../include/rng.hpp"
+#include "../include/fixed-point.hpp"
+#include "../include/csb-physics.hpp"
+#include "../include/csb-physics-sse.hpp"
+#include "../include/csb-trace.hpp"
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+constexpr int num_fields = 15;          // nn/fields/1.txt to 15.txt
+constexpr int max_frames = 400;         // a recorded race that hasn't finished by then is cut off
+constexpr u64 seed = 44;
+constexpr double max_error = 2.0;       // the diagonal of one unit off in x and y, and then some
+constexpr double max_cp_off_pct = 0.1;
+constexpr double min_timing_s = 0.2;    // how long to spend timing each precision
+
+/*****************************************************************************/
+
+int usage() {
+  cerr << "usage: tools-csb-trace replay FILE...\n"
+          "       tools-csb-trace import FILE < TEXT\n"
+          "       tools-csb-trace record FILE [races_per_field]\n";
+  return 2;
+}
+
+bool writeFile(const string& path, const vector<TraceRace>& races) {
+  ofstream out(path, ios::binary);
+  writeTrace(out, races);
+  if (!out) {
+    cerr << "can't write " << path << '\n';
+    return false;
+  }
+  size_t frames = 0;
+  for (const TraceRace& race : races) frames += race.frames.size();
+  cout << "wrote " << races.size() << " races, " << frames << " frames, to " << path << '\n';
+  return true;
+}
+
+/********************************** record ***********************************/
+
+TraceCommand randomCommand(Pcg32& rng, const BasicField<double>& field, const BasicPod<double>& pod) {
+  TraceCommand cmd;
+  cmd.x = int32_t(field.checkpoints[pod.next_cp].x) + uniformInt(rng, -1500, 1500);
+  cmd.y = int32_t(field.checkpoints[pod.next_cp].y) + uniformInt(rng, -1500, 1500);
+  float roll = uniformFloat(rng);
+  cmd.thrust = (roll < 0.02f) ? SHIELD : (roll < 0.03f) ? BOOST : uniformInt(rng, 0, 100);
+  return cmd;
+}
+
+int record(const string& path, int races_per_field) {
+  Pcg32 rng(seed);
+  vector<TraceRace> races;
+  for (int field_id = 1; field_id <= num_fields; ++field_id) {
+    string field_path = string(CSB_FIELDS_DIR "/") + to_string(field_id) + ".txt";
+    ifstream in(field_path);
+    BasicField<double> field;
+    BasicRace<double> start;
+    if (!(in >> field >> start)) {
+      cerr << "can't read " << field_path << '\n';
+      return 2;
+    }
+    for (int race_idx = 0; race_idx < races_per_field; ++race_idx) {
+      TraceRace trace(field, start);
+      BasicRace<double> race = start;
+      while (trace.frames.size() < max_frames && race.outcome(field) == 0) {
+        TraceFrame frame;
+        for (int idx = 0; idx < 4; ++idx) {
+          frame.commands[idx] = randomCommand(rng, field, race.pods[idx]);
+          frame.commands[idx].apply(race.pods[idx]);
+        }
+        race.simFrame(field);
+        for (int idx = 0; idx < 4; ++idx) frame.pods[idx] = TracePod(race.pods[idx]);
+        trace.frames.push_back(frame);
+      }
+      races.push_back(trace);
+    }
+  }
+  return writeFile(path, races) ? 0 : 2;
+}
+
+/********************************** import ***********************************/
+
+bool readPod(istream& is, TracePod& pod) {
+  return bool(is >> pod.x >> pod.y >> pod.vx >> pod.vy >> pod.angle >> pod.next_cp);
+}
+
+int import(const string& path) {
+  vector<TraceRace> races;
+  BasicField<double> field;
+  while (cin >> field) {
+    TraceRace race(field, BasicRace<double>());
+    for (TracePod& pod : race.start) {
+      if (!readPod(cin, pod)) break;
+    }
+    string token;
+    while (cin >> token && token != "END") {
+      TraceFrame frame;
+      bool ok = true;
+      for (int idx = 0; idx < 4 && ok; ++idx) {
+        TraceCommand& cmd = frame.commands[idx];
+        string thrust;
+        if (idx == 0) cmd.x = atoi(token.c_str());
+        else ok = bool(cin >> cmd.x);
+        ok = ok && (cin >> cmd.y >> thrust);
+        cmd.thrust = (thrust == "SHIELD") ? SHIELD : (thrust == "BOOST") ? BOOST : atoi(thrust.c_str());
+      }
+      for (TracePod& pod : frame.pods) ok = ok && readPod(cin, pod);
+      if (!ok) break;
+      race.frames.push_back(frame);
+    }
+    if (token != "END") {
+      cerr << "race " << races.size() + 1 << " doesn't end in END after a whole frame\n";
+      return 2;
+    }
+    races.push_back(race);
+  }
+  if (!cin.eof()) {
+    cerr << "can't read the field of race " << races.size() + 1 << '\n';
+    return 2;
+  }
+  return writeFile(path, races) ? 0 : 2;
+}
+
+/********************************** replay ***********************************/
+
+struct Errors {
+  size_t frames = 0, cp_off = 0, pods = 0;
+  double pos_worst = 0, pos_sum = 0, vel_worst = 0, vel_sum = 0, angle_worst = 0;
+
+  void add(const BasicPod<double>& pod, const TracePod& rec) {
+    ++pods;
+    double pos = hypot(pod.pos.x - rec.x, pod.pos.y - rec.y);
+    double vel = hypot(pod.vel.x - rec.vx, pod.vel.y - rec.vy);
+    double angle = abs(pod.angle - rec.angle);
+    pos_worst = max(pos_worst, pos);
+    vel_worst = max(vel_worst, vel);
+    angle_worst = max(angle_worst, min(angle, 360 - angle));
+    pos_sum += pos;
+    vel_sum += vel;
+  }
+  void add(const Errors& other) {
+    frames += other.frames;
+    cp_off += other.cp_off;
+    pods += other.pods;
+    pos_worst = max(pos_worst, other.pos_worst);
+    vel_worst = max(vel_worst, other.vel_worst);
+    angle_worst = max(angle_worst, other.angle_worst);
+    pos_sum += other.pos_sum;
+    vel_sum += other.vel_sum;
+  }
+  bool ok() const { return pos_worst <= max_error && vel_worst <= max_error && 100.0 * cp_off <= max_cp_off_pct * frames; }
+};
+
+// what a SoaRace simulates is a BasicRace<float> underneath
+template <class T>
+const BasicRace<T>& unpacked(const BasicRace<T>& race) { return race; }
+BasicRace<float> unpacked(const SoaRace& race) { return race.unpack(); }
+
+// Replays every frame in T, simulated as a Sim (BasicRace<T>, or something
+// built from one that can simFrame and unpack). Returns the errors of each
+// field, in the order the fields first turn up, and the frames/sec.
+template <class T, class Sim = BasicRace<T>>
+double replay(const vector<TraceRace>& races, vector<Errors>& by_field) {
+  map<vector<int32_t>, size_t> field_ids;
+  struct Frame {
+    size_t field;   // into fields, which has one per race
+    Sim applied;    // the recorded state before the frame, with its commands applied
+  };
+  vector<BasicField<T>> fields;
+  vector<Frame> frames;
+
+  for (const TraceRace& trace : races) {
+    vector<int32_t> key = { trace.num_laps };
+    for (const array<int32_t, 2>& cp : trace.checkpoints) key.insert(key.end(), cp.begin(), cp.end());
+    size_t field_id = field_ids.emplace(key, field_ids.size()).first->second;
+    if (by_field.size() <= field_id) by_field.resize(field_id + 1);
+    Errors& errors = by_field[field_id];
+
+    fields.push_back(trace.field<T>());
+    const BasicField<T>& field = fields.back();
+    BasicRace<T> before = trace.startRace<T>();
+    for (size_t frame = 0; frame < trace.frames.size(); ++frame) {
+      BasicRace<T> applied = before;
+      for (int idx = 0; idx < 4; ++idx) trace.frames[frame].commands[idx].apply(applied.pods[idx]);
+      frames.push_back({ fields.size() - 1, Sim(applied) });
+      Sim sim = frames.back().applied;
+      sim.simFrame(field);
+      BasicRace<T> result = unpacked(sim);
+
+      ++errors.frames;
+      bool cp_off = false;
+      for (int idx = 0; idx < 4; ++idx) {
+        const TracePod& rec = trace.frames[frame].pods[idx];
+        errors.add(BasicPod<double>(result.pods[idx]), rec);
+        cp_off |= (result.pods[idx].next_cp != rec.next_cp);
+      }
+      errors.cp_off += cp_off;
+      before = trace.after(int(frame), before, result);
+    }
+  }
+
+  using Clock = chrono::steady_clock;
+  size_t simulated = 0;
+  Clock::time_point start = Clock::now();
+  double elapsed = 0;
+  while (elapsed < min_timing_s && !frames.empty()) {
+    for (const Frame& frame : frames) {
+      Sim sim = frame.applied;
+      sim.simFrame(fields[frame.field]);
+      doNotOptimize(sim);
+    }
+    simulated += frames.size();
+    elapsed = chrono::duration<double>(Clock::now() - start).count();
+  }
+  return simulated ? simulated / elapsed : 0;
+}
+
+void printErrors(const string& name, const Errors& errors) {
+  cout << left << setw(10) << name << right << setw(8) << errors.frames << fixed << setprecision(3)
+    << setw(10) << errors.pos_worst << setw(10) << (errors.pods ? errors.pos_sum / errors.pods : 0)
+    << setw(10) << errors.vel_worst << setw(10) << (errors.pods ? errors.vel_sum / errors.pods : 0)
+    << setw(10) << errors.angle_worst << setw(8) << errors.cp_off << defaultfloat << '\n';
+}
+
+template <class T, class Sim = BasicRace<T>>
+bool report(const char* name, const vector<TraceRace>& races) {
+  vector<Errors> by_field;
+  double frames_per_sec = replay<T, Sim>(races, by_field);
+  cout << name << ":\n" << left << setw(10) << "field" << right << setw(8) << "frames"
+    << setw(10) << "pos max" << setw(10) << "mean" << setw(10) << "vel max" << setw(10) << "mean"
+    << setw(10) << "angle" << setw(8) << "cp off" << '\n';
+  Errors total;
+  for (size_t field_id = 0; field_id < by_field.size(); ++field_id) {
+    printErrors(to_string(field_id + 1), by_field[field_id]);
+    total.add(by_field[field_id]);
+  }
+  printErrors("all", total);
+  cout << "  " << unsigned(frames_per_sec) << " simFrames/sec\n\n";
+  return total.ok();
+}
+
+int replayFiles(int num_files, char** paths) {
+  vector<TraceRace> races;
+  for (int idx = 0; idx < num_files; ++idx) {
+    ifstream in(paths[idx], ios::binary);
+    vector<TraceRace> file_races;
+    if (!readTrace(in, file_races)) {
+      cerr << "can't read " << paths[idx] << " as a version " << trace_io::version << " trace\n";
+      return 2;
+    }
+    races.insert(races.end(), file_races.begin(), file_races.end());
+  }
+
+  bool ok = report<float>("float", races);
+  ok &= report<double>("double", races);
+  ok &= report<Fixed<20>>("Fixed<20>", races);
+  ok &= report<float, SoaRace>("float SoA", races);
+  if (!ok) cout << "FAILED: a frame is off by more than " << max_error << ", or more than " << max_cp_off_pct
+    << "% of them have the wrong checkpoint\n";
+  return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) return usage();
+  string command = argv[1];
+  if (command == "replay") return replayFiles(argc - 2, argv + 2);
+  if (command == "import" && argc == 3) return import(argv[2]);
+  if (command == "record" && argc <= 4) return record(argv[2], (argc > 3) ? max(1, atoi(argv[3])) : 1);
+  return usage();
+}
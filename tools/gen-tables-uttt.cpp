@@ -0,0 +1,14 @@
+// The opening book for gen-tables.cpp, on its own because it brings the
+// whole bot with it (and the bot's own copies of the include/ headers).
+#define main uttt_main
+#include "../bot-programming/ultimate-tic-tac-toe/ultimate-tic-tac-toe.cpp"
+#undef main
+
+int utttBookMove(int first_move, u64 seed, size_t iterations) {
+  UltimateBoard board;
+  if (first_move >= 0) board.mark(globalIdxToLocalIdx_idx(first_move));
+  MonteCarlo mcts(board);
+  mcts.seed(seed);
+  mcts.runSearch(time_point::max(), iterations);
+  return mcts.getBest();
+}
@@ -0,0 +1,415 @@
+// Writes precomputed tables as C++ source, ready to paste into a submission.
+//
+//   tools-gen-tables [options] TABLE...
+//
+// Every TABLE is kind:name[:key=value...], and a run can write as many as it
+// likes:
+//   zobrist:NAME:count=N[:bits=32]    N random keys (u64, or u32 with bits=32)
+//   trig:NAME:steps=N[:scale=S]       NAME_cos[N] and NAME_sin[N] at k * 360 / N
+//                                     degrees; floats, or ints rounded from S * cos
+//                                     if there's a scale
+//   ternary:NAME                      NAME[512]: a 9-bit board's squares as powers
+//                                     of 3, so NAME[x] + 2 * NAME[o] is a local
+//                                     board's index into a 3^9 table
+//   uttt-local:NAME                   NAME[3^9]: X's expected result from every local
+//                                     board if both sides play randomly from there,
+//                                     -100 (O always wins) to 100 (X always wins)
+//   uttt-book:NAME[:iterations=N]     NAME[82]: the bot's search's move on the empty
+//                                     board, then its reply to each of X's 81 first
+//                                     moves (N iterations each, default 20000)
+// Any of them also takes encoding=hex, a list of literals (the default), or
+// encoding=string: base-64 digits in a string literal, with a function to
+// unpack them (unpackTable, guarded by #ifndef UNPACK_TABLE so two runs' output
+// can share a file). That's 40% fewer characters for 64-bit keys, and more
+// than half for tables of small numbers.
+// CodinGame caps a submission at 100k characters, so the big ones want that.
+//
+// Options:
+//   --seed=N        every table's rng starts from this and the table's name (default 1)
+//   --threads=N     for the tables that take a while (default: every core)
+//   --out=FILE      write there instead of to stdout
+//   --indent=N      spaces in front of every line (default 0)
+//   --width=N       wrap lines at N characters (default 100)
+//   --storage=TEXT  what goes in front of every declaration (default "constexpr static")
+//
+// The same command always writes the same tables, whatever --threads is: the
+// expensive tables seed every entry on its own. The command is written into
+// the output, so whoever finds a table can make it again.
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/typedefs.hpp"
+#include "../include/rng.hpp"
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+constexpr u64 default_seed = 1;
+constexpr size_t default_book_iterations = 20000;
+constexpr int default_width = 100;
+const char* default_storage = "constexpr static";
+
+/*****************************************************************************/
+
+// in gen-tables-uttt.cpp: the search's move on the empty board (first_move
+// -1) or as O after X's first_move, from `iterations` iterations
+int utttBookMove(int first_move, u64 seed, size_t iterations);
+
+struct Table {
+  string name, type;
+  string about;                 // a line of comment on what's in it
+  bool is_real = false, is_signed = false;
+  vector<u64> ints;             // two's complement when is_signed
+  vector<double> reals;
+  bool packed = false;          // encoding=string
+
+  size_t size() const { return is_real ? reals.size() : ints.size(); }
+};
+
+struct Options {
+  u64 seed = default_seed;
+  int threads = max(1u, thread::hardware_concurrency());
+  int indent = 0, width = default_width;
+  string storage = default_storage, command;
+};
+
+[[noreturn]] void fail(const string& why) {
+  cerr << "gen-tables: " << why << '\n';
+  exit(2);
+}
+
+u64 number(const string& text, const string& what) {
+  char* end;
+  u64 value = strtoull(text.c_str(), &end, 0);
+  if (text.empty() || *end != '\0') fail(what + " isn't a number: " + text);
+  return value;
+}
+
+// independent of every other table's, and of the order they're asked for in
+u64 tableSeed(u64 seed, const string& name) {
+  u64 hash = 0xcbf29ce484222325;   // FNV-1a
+  for (char c : name) hash = (hash ^ u8(c)) * 0x100000001b3;
+  return SplitMix64(seed ^ hash)();
+}
+u64 entrySeed(u64 table_seed, size_t idx) { return SplitMix64(table_seed + idx)(); }
+
+// fn(idx) for every idx in [0, count), spread over `threads` threads
+template <class Fn>
+void parallelFor(size_t count, int threads, Fn fn) {
+  atomic<size_t> next{ 0 };
+  auto work = [&] {
+    for (size_t idx; (idx = next++) < count;) fn(idx);
+  };
+  vector<thread> pool;
+  for (int t = 1; t < threads && size_t(t) < count; ++t) pool.emplace_back(work);
+  work();
+  for (thread& t : pool) t.join();
+}
+
+/********************************* The tables ********************************/
+
+Table zobrist(const string& name, map<string, string>& args, const Options& opt) {
+  Table table;
+  table.name = name;
+  if (!args.count("count")) fail(name + ": zobrist needs count=");
+  size_t count = number(args["count"], "count");
+  int bits = args.count("bits") ? int(number(args["bits"], "bits")) : 64;
+  if (bits != 64 && bits != 32) fail(name + ": bits is 64 or 32");
+  table.type = (bits == 64) ? "u64" : "u32";
+  table.about = to_string(count) + " zobrist keys";
+  Xoshiro256ss rng(tableSeed(opt.seed, name));
+  for (size_t idx = 0; idx < count; ++idx) {
+    u64 key = rng();
+    table.ints.push_back((bits == 64) ? key : key >> 32);
+  }
+  return table;
+}
+
+vector<Table> trig(const string& name, map<string, string>& args, const Options&) {
+  if (!args.count("steps")) fail(name + ": trig needs steps=");
+  size_t steps = number(args["steps"], "steps");
+  bool scaled = args.count("scale");
+  double scale = scaled ? double(number(args["scale"], "scale")) : 1.0;
+  vector<Table> tables(2);
+  for (int fn = 0; fn < 2; ++fn) {
+    Table& table = tables[fn];
+    table.name = name + ((fn == 0) ? "_cos" : "_sin");
+    table.type = scaled ? "int" : "float";
+    table.is_real = !scaled;
+    table.is_signed = scaled;
+    table.about = string((fn == 0) ? "cos" : "sin") + " of k * 360 / " + to_string(steps) + " degrees"
+      + (scaled ? ", times " + args["scale"] : "");
+    for (size_t step = 0; step < steps; ++step) {
+      double angle = 2 * M_PI * double(step) / double(steps);
+      double value = (fn == 0) ? cos(angle) : sin(angle);
+      if (scaled) table.ints.push_back(u64(i64(llround(value * scale))));
+      else table.reals.push_back(value);
+    }
+  }
+  return tables;
+}
+
+Table ternary(const string& name, map<string, string>&, const Options&) {
+  Table table;
+  table.name = name;
+  table.type = "u16";
+  table.about = "each set bit i of a 9-bit board as 3^i";
+  for (u64 board = 0; board < 512; ++board) {
+    u64 value = 0;
+    for (int bit = 8; bit >= 0; --bit) value = value * 3 + ((board >> bit) & 1);
+    table.ints.push_back(value);
+  }
+  return table;
+}
+
+// Exact, not sampled: every board's value is the average over the moves
+// from it, which is cheap with the 3^9 * 2 positions memoised.
+Table utttLocal(const string& name, map<string, string>&, const Options&) {
+  constexpr int num_boards = 19683;   // 3^9
+  constexpr int lines[8] = { 0007, 0070, 0700, 0111, 0222, 0444, 0421, 0124 };
+  auto won = [&](int bits) {
+    for (int line : lines) if ((bits & line) == line) return true;
+    return false;
+  };
+  int pow3[9];
+  for (int sq = 0, p = 1; sq < 9; ++sq, p *= 3) pow3[sq] = p;
+  vector<double> memo(2 * num_boards, NAN);
+  // from X's point of view, with `x_to_move` to play next
+  auto value = [&](auto& self, int x, int o, bool x_to_move) -> double {
+    if (won(x)) return 1;
+    if (won(o)) return -1;
+    if ((x | o) == 0777) return 0;
+    int idx = 0;
+    for (int sq = 0; sq < 9; ++sq) idx += pow3[sq] * (((x >> sq) & 1) + 2 * ((o >> sq) & 1));
+    double& known = memo[2 * idx + x_to_move];
+    if (!isnan(known)) return known;
+    double sum = 0;
+    int moves = 0;
+    for (int sq = 0; sq < 9; ++sq) {
+      if ((x | o) & (1 << sq)) continue;
+      sum += x_to_move ? self(self, x | (1 << sq), o, false) : self(self, x, o | (1 << sq), true);
+      ++moves;
+    }
+    return known = sum / moves;
+  };
+
+  Table table;
+  table.name = name;
+  table.type = "i8";
+  table.is_signed = true;
+  table.about = "X's expected result under random play, by ternary index (100 is a certain win)";
+  table.ints.resize(num_boards);
+  for (int idx = 0; idx < num_boards; ++idx) {
+    int x = 0, o = 0;
+    for (int sq = 0, rest = idx; sq < 9; ++sq, rest /= 3) {
+      if (rest % 3 == 1) x |= 1 << sq;
+      if (rest % 3 == 2) o |= 1 << sq;
+    }
+    // nobody knows whose turn it is in a local board, so it's both
+    double mean = (value(value, x, o, true) + value(value, x, o, false)) / 2;
+    table.ints[idx] = u64(i64(llround(100 * mean)));
+  }
+  return table;
+}
+
+Table utttBook(const string& name, map<string, string>& args, const Options& opt) {
+  size_t iterations = args.count("iterations") ? number(args["iterations"], "iterations") : default_book_iterations;
+  Table table;
+  table.name = name;
+  table.type = "i8";
+  table.about = "[0]: the first move, [1 + m]: the reply to m; global square indices, "
+    + to_string(iterations) + " iterations each";
+  table.ints.resize(82);
+  const u64 seed = tableSeed(opt.seed, name);
+  cerr << name << ": 82 searches of " << iterations << " iterations on " << opt.threads << " thread(s)\n";
+  parallelFor(82, opt.threads, [&](size_t idx) {
+    table.ints[idx] = u64(utttBookMove(int(idx) - 1, entrySeed(seed, idx), iterations));
+  });
+  return table;
+}
+
+/********************************* Writing **********************************/
+
+class Writer {
+public:
+  Writer(ostream& out, const Options& opt) : out(out), opt(opt), pad(opt.indent, ' ') {}
+
+  void header() {
+    out << pad << "// generated by: tools-gen-tables" << opt.command << '\n';
+  }
+
+  void write(const Table& table) {
+    if (table.packed) writePacked(table);
+    else writeList(table);
+  }
+
+private:
+  ostream& out;
+  const Options& opt;
+  string pad;
+  bool unpack_written = false;
+
+  string literal(const Table& table, size_t idx) const {
+    ostringstream lit;
+    if (table.is_real) {
+      lit << setprecision(9) << table.reals[idx];
+      if (lit.str().find_first_of(".e") == string::npos) lit << ".0";   // 1f isn't a float literal, 1.0f is
+      if (table.type == "float") lit << 'f';
+    }
+    else if (table.is_signed) lit << i64(table.ints[idx]);
+    else if (table.type == "u64") lit << "0x" << hex << setfill('0') << setw(16) << table.ints[idx];
+    else if (table.type == "u32") lit << "0x" << hex << setfill('0') << setw(8) << table.ints[idx];
+    else lit << table.ints[idx];
+    return lit.str();
+  }
+
+  // like the hand-written tables: as many to a line as fit, all the same width
+  void writeList(const Table& table) {
+    size_t item_len = 1;
+    for (size_t idx = 0; idx < table.size(); ++idx) item_len = max(item_len, literal(table, idx).size());
+    const int usable = opt.width - opt.indent - 2;
+    const size_t per_line = max<size_t>(1, usable / (item_len + 2));
+    out << pad << "// " << table.name << ": " << table.about << '\n';
+    out << pad << opt.storage << ' ' << table.type << ' ' << table.name << '[' << table.size() << "] = {\n";
+    for (size_t idx = 0; idx < table.size();) {
+      out << pad << "  ";
+      for (size_t end = min(idx + per_line, table.size()); idx < end; ++idx) {
+        string lit = literal(table, idx);
+        if (!table.is_real) lit = string(item_len - lit.size(), ' ') + lit;
+        out << lit << ((idx + 1 < table.size()) ? "," : "");
+        if (idx + 1 < end) out << ' ';
+      }
+      out << '\n';
+    }
+    out << pad << "};\n";
+  }
+
+  // Base-64 digits, most significant first and `digits` to an entry, from
+  // '#' up, stepping over the backslash so nothing needs escaping. Signed
+  // tables are stored less their smallest value.
+  void writePacked(const Table& table) {
+    if (table.is_real) fail(table.name + ": floats can't be encoding=string; give trig a scale=");
+    i64 offset = 0;
+    u64 span = 0;
+    if (table.is_signed) {
+      offset = i64(table.ints[0]);
+      for (u64 value : table.ints) offset = min(offset, i64(value));
+    }
+    for (u64 value : table.ints) span = max(span, value - u64(offset));
+    int digits = 1;
+    while (digits < 11 && (span >> (6 * digits)) != 0) ++digits;
+
+    if (!unpack_written) {
+      out << pad << "// the tables written as encoding=string: entry `idx`, `digits` base-64 digits long\n"
+          << "#ifndef UNPACK_TABLE\n#define UNPACK_TABLE\n"
+          << pad << opt.storage << " u64 unpackTable(const char* packed, size_t idx, int digits) noexcept {\n"
+          << pad << "  u64 value = 0;\n"
+          << pad << "  for (const char* c = packed + idx * digits; c != packed + (idx + 1) * digits; ++c) {\n"
+          << pad << "    value = (value << 6) | u64(*c - '#' - (*c > '\\\\'));\n"
+          << pad << "  }\n"
+          << pad << "  return value;\n"
+          << pad << "}\n"
+          << "#endif\n";
+      unpack_written = true;
+    }
+    string chars;
+    for (u64 value : table.ints) {
+      u64 stored = value - u64(offset);
+      for (int digit = digits - 1; digit >= 0; --digit) {
+        char c = char('#' + ((stored >> (6 * digit)) & 63));
+        chars += (c >= '\\') ? char(c + 1) : c;
+      }
+    }
+    const size_t per_line = max<size_t>(digits, (opt.width - opt.indent - 4) / digits * digits);
+    out << pad << "// " << table.name << ": " << table.about << '\n';
+    out << pad << opt.storage << " const char " << table.name << "_packed[] =\n";
+    for (size_t at = 0; at < chars.size(); at += per_line) {
+      out << pad << "  \"" << chars.substr(at, per_line) << '"' << ((at + per_line >= chars.size()) ? ";" : "") << '\n';
+    }
+    out << pad << opt.storage << ' ' << table.type << ' ' << table.name << "(size_t idx) noexcept {\n"
+        << pad << "  return " << table.type << "(";
+    if (offset) {
+      out << "i64(unpackTable(" << table.name << "_packed, idx, " << digits << ")) "
+          << ((offset < 0) ? "- " : "+ ") << ((offset < 0) ? u64(0) - u64(offset) : u64(offset));
+    }
+    else out << "unpackTable(" << table.name << "_packed, idx, " << digits << ')';
+    out << ");\n" << pad << "}\n";
+  }
+};
+
+int main(int argc, char** argv) {
+  Options opt;
+  vector<string> specs;
+  string out_file;
+  for (int arg = 1; arg < argc; ++arg) {
+    string text = argv[arg];
+    opt.command += ' ' + text;
+    auto value = [&](const char* prefix) { return text.substr(strlen(prefix)); };
+    if (text.rfind("--seed=", 0) == 0) opt.seed = number(value("--seed="), "--seed");
+    else if (text.rfind("--threads=", 0) == 0) opt.threads = max(1, int(number(value("--threads="), "--threads")));
+    else if (text.rfind("--out=", 0) == 0) out_file = value("--out=");
+    else if (text.rfind("--indent=", 0) == 0) opt.indent = int(number(value("--indent="), "--indent"));
+    else if (text.rfind("--width=", 0) == 0) opt.width = int(number(value("--width="), "--width"));
+    else if (text.rfind("--storage=", 0) == 0) opt.storage = value("--storage=");
+    else if (text.rfind("--", 0) == 0) fail("unknown option " + text + "; see the top of gen-tables.cpp");
+    else specs.push_back(text);
+  }
+  if (specs.empty()) fail("no tables asked for; see the top of gen-tables.cpp");
+
+  vector<Table> tables;
+  for (const string& spec : specs) {
+    vector<string> parts;
+    for (size_t start = 0, colon; start <= spec.size(); start = colon + 1) {
+      colon = spec.find(':', start);
+      if (colon == string::npos) colon = spec.size();
+      parts.push_back(spec.substr(start, colon - start));
+    }
+    if (parts.size() < 2 || parts[1].empty()) fail("tables are kind:name[:key=value...], not " + spec);
+    const string& kind = parts[0], name = parts[1];
+    map<string, string> args;
+    for (size_t idx = 2; idx < parts.size(); ++idx) {
+      size_t eq = parts[idx].find('=');
+      if (eq == string::npos) fail(name + ": expected key=value, not " + parts[idx]);
+      args[parts[idx].substr(0, eq)] = parts[idx].substr(eq + 1);
+    }
+    string encoding = args.count("encoding") ? args["encoding"] : "hex";
+    if (encoding != "hex" && encoding != "string") fail(name + ": encoding is hex or string");
+    args.erase("encoding");
+
+    vector<Table> made;
+    if (kind == "zobrist") made.push_back(zobrist(name, args, opt));
+    else if (kind == "trig") made = trig(name, args, opt);
+    else if (kind == "ternary") made.push_back(ternary(name, args, opt));
+    else if (kind == "uttt-local") made.push_back(utttLocal(name, args, opt));
+    else if (kind == "uttt-book") made.push_back(utttBook(name, args, opt));
+    else fail("no kind of table called " + kind);
+    for (Table& table : made) {
+      table.packed = (encoding == "string");
+      tables.push_back(move(table));
+    }
+  }
+
+  ofstream file;
+  if (!out_file.empty()) {
+    file.open(out_file);
+    if (!file) fail("can't write " + out_file);
+  }
+  Writer writer(out_file.empty() ? cout : file, opt);
+  writer.header();
+  for (const Table& table : tables) writer.write(table);
+  return 0;
+}
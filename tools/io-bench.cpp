@@ -0,0 +1,301 @@
+// Times a turn of referee I/O the way the bots used to do it (cin/cout, with
+// cin.ignore() after every line and endl after every answer) against
+// fast-io.hpp (fast_in/fast_out, one flush() per turn).
+//
+// Each game's input is recorded up front: a fixed-seed stream of turns shaped
+// like its referee's (ultimate tic-tac-toe's move list, the largest labyrinth
+// map, coders strike back's pods). A child process plays the bot: it parses
+// every turn into plain variables and writes an answer, over pipes, like it
+// would under the referee. The parent sends a turn, waits for the answer, and
+// times the round trip, so each number is one turn's worth of read, parse,
+// format and write, plus the pipe wake-ups both sides pay the same for.
+//
+//   tools-io-bench                  every game
+//   tools-io-bench labyrinth        just the one
+//   tools-io-bench labyrinth dump   print that recorded stream instead
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/fast-io.hpp"
+#include "../include/rng.hpp"
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+constexpr int num_turns = 2000;                 // recorded turns per game
+constexpr int warmup_turns = 50;                // left out of the timings
+constexpr int lab_rows = 100, lab_cols = 200;   // the biggest map the puzzle allows
+constexpr u64 seed = 38;
+
+/*****************************************************************************/
+
+using Clock = chrono::steady_clock;
+
+enum Game { uttt, labyrinth, csb, num_games };
+const char* const game_names[num_games] = { "uttt", "labyrinth", "csb" };
+
+enum Mode { cin_synced, cin_unsynced, fast, num_modes };
+const char* const mode_names[num_modes] = { "cin/cout", "cin/cout, unsynced", "fast-io" };
+
+// what the referee sends before the first turn, and then every turn's input
+struct Recording {
+  string setup;
+  vector<string> turns;
+  int answer_lines;
+};
+
+Recording record(Game game) {
+  WyRand rng(seed + game);
+  Recording rec;
+  for (int turn = 0; turn < num_turns; ++turn) {
+    string in;
+    switch (game) {
+    case uttt: {
+      rec.answer_lines = 1;
+      in += to_string(int(bounded(rng, 9))) + ' ' + to_string(int(bounded(rng, 9))) + '\n';
+      int num_moves = 1 + bounded(rng, 81);
+      in += to_string(num_moves) + '\n';
+      for (int move = 0; move < num_moves; ++move) {
+        in += to_string(int(bounded(rng, 9))) + ' ' + to_string(int(bounded(rng, 9))) + '\n';
+      }
+      break;
+    }
+    case labyrinth: {
+      rec.answer_lines = 1;
+      if (turn == 0) rec.setup = to_string(lab_rows) + ' ' + to_string(lab_cols) + " 100\n";
+      in += to_string(int(bounded(rng, lab_rows))) + ' ' + to_string(int(bounded(rng, lab_cols))) + '\n';
+      for (int row = 0; row < lab_rows; ++row) {
+        for (int col = 0; col < lab_cols; ++col) in += "#.?"[bounded(rng, 3)];
+        in += '\n';
+      }
+      break;
+    }
+    case csb: {
+      rec.answer_lines = 2;
+      if (turn == 0) {
+        rec.setup = "3\n4\n";
+        for (int cp = 0; cp < 4; ++cp) {
+          rec.setup += to_string(int(bounded(rng, 16000))) + ' ' + to_string(int(bounded(rng, 9000))) + '\n';
+        }
+      }
+      for (int pod = 0; pod < 4; ++pod) {
+        in += to_string(int(bounded(rng, 16000))) + ' ' + to_string(int(bounded(rng, 9000))) + ' '
+          + to_string(int(bounded(rng, 1200)) - 600) + ' ' + to_string(int(bounded(rng, 1200)) - 600) + ' '
+          + to_string(int(bounded(rng, 360))) + ' ' + to_string(int(bounded(rng, 4))) + '\n';
+      }
+      break;
+    }
+    default:
+      break;
+    }
+    rec.turns.push_back(move(in));
+  }
+  return rec;
+}
+
+// The bot's side, parsing like the bots did before fast-io.hpp. Returns
+// false once the referee hangs up.
+bool cinTurn(Game game, bool first_turn, char (&grid)[lab_rows][lab_cols]) {
+  switch (game) {
+  case uttt: {
+    int row, col, num_moves;
+    cin >> row >> col; cin.ignore();
+    cin >> num_moves; cin.ignore();
+    int first_row = row, first_col = col;
+    for (int move = 0; move < num_moves; ++move) {
+      cin >> row >> col; cin.ignore();
+      if (move == 0) first_row = row, first_col = col;
+    }
+    if (!cin) return false;
+    cout << first_row << ' ' << first_col << endl;
+    return true;
+  }
+  case labyrinth: {
+    int rows, cols, alarm, kirk_row, kirk_col;
+    if (first_turn) { cin >> rows >> cols >> alarm; cin.ignore(); }
+    cin >> kirk_row >> kirk_col; cin.ignore();
+    for (int row = 0; row < lab_rows; ++row) {
+      for (int col = 0; col < lab_cols; ++col) cin >> grid[row][col];
+    }
+    if (!cin) return false;
+    cout << ((grid[kirk_row][kirk_col] == '#') ? "UP" : "DOWN") << endl;
+    return true;
+  }
+  case csb: {
+    int num_laps, num_checkpoints, x, y, vx, vy, angle, next_cp;
+    if (first_turn) {
+      cin >> num_laps; cin.ignore();
+      cin >> num_checkpoints; cin.ignore();
+      for (int cp = 0; cp < num_checkpoints; ++cp) { cin >> x >> y; cin.ignore(); }
+    }
+    int sum = 0;
+    for (int pod = 0; pod < 4; ++pod) {
+      cin >> x >> y >> vx >> vy >> angle >> next_cp; cin.ignore();
+      sum += x + y + vx + vy + angle + next_cp;
+    }
+    if (!cin) return false;
+    cout << "8000 4500 " << (sum & 63) << endl;
+    cout << "8000 4500 100" << endl;
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+// the same with fast-io.hpp
+bool fastTurn(Game game, bool first_turn, char (&grid)[lab_rows][lab_cols]) {
+  if (fast_in.eof()) return false;
+  switch (game) {
+  case uttt: {
+    int row, col, num_moves;
+    fast_in >> row >> col >> num_moves;
+    int first_row = row, first_col = col;
+    for (int move = 0; move < num_moves; ++move) {
+      fast_in >> row >> col;
+      if (move == 0) first_row = row, first_col = col;
+    }
+    fast_out << first_row << ' ' << first_col << '\n';
+    break;
+  }
+  case labyrinth: {
+    int rows, cols, alarm, kirk_row, kirk_col;
+    if (first_turn) fast_in >> rows >> cols >> alarm;
+    fast_in >> kirk_row >> kirk_col;
+    for (int row = 0; row < lab_rows; ++row) {
+      string_view line = fast_in.readToken();
+      memcpy(grid[row], line.data(), min<size_t>(line.size(), lab_cols));
+    }
+    fast_out << ((grid[kirk_row][kirk_col] == '#') ? "UP\n" : "DOWN\n");
+    break;
+  }
+  case csb: {
+    int num_laps, num_checkpoints, x, y, vx, vy, angle, next_cp;
+    if (first_turn) {
+      fast_in >> num_laps >> num_checkpoints;
+      for (int cp = 0; cp < num_checkpoints; ++cp) fast_in >> x >> y;
+    }
+    int sum = 0;
+    for (int pod = 0; pod < 4; ++pod) {
+      fast_in >> x >> y >> vx >> vy >> angle >> next_cp;
+      sum += x + y + vx + vy + angle + next_cp;
+    }
+    fast_out << "8000 4500 " << (sum & 63) << '\n';
+    fast_out << "8000 4500 100\n";
+    break;
+  }
+  default:
+    return false;
+  }
+  fast_out.flush();
+  return true;
+}
+
+[[noreturn]] void playBot(Game game, Mode mode) {
+  static char grid[lab_rows][lab_cols];
+  if (mode == cin_unsynced) ios::sync_with_stdio(false);
+  bool first_turn = true;
+  if (mode == fast) {
+    while (fastTurn(game, first_turn, grid)) first_turn = false;
+  }
+  else {
+    while (cinTurn(game, first_turn, grid)) first_turn = false;
+  }
+  _exit(0);
+}
+
+void writeAll(int fd, const string& str) {
+  size_t done = 0;
+  while (done < str.size()) {
+    ssize_t put = write(fd, str.data() + done, str.size() - done);
+    if (put <= 0) { perror("write"); exit(1); }
+    done += size_t(put);
+  }
+}
+
+// round trip of every turn, in microseconds
+vector<double> referee(const Recording& rec, Game game, Mode mode) {
+  int to_bot[2], from_bot[2];
+  if (pipe(to_bot) || pipe(from_bot)) { perror("pipe"); exit(1); }
+  cout.flush();   // or the child's first endl sends our report along with its answer
+  pid_t pid = fork();
+  if (pid == 0) {
+    dup2(to_bot[0], STDIN_FILENO);
+    dup2(from_bot[1], STDOUT_FILENO);
+    close(to_bot[0]); close(to_bot[1]); close(from_bot[0]); close(from_bot[1]);
+    playBot(game, mode);
+  }
+  close(to_bot[0]);
+  close(from_bot[1]);
+
+  vector<double> micros;
+  char answer[256];
+  writeAll(to_bot[1], rec.setup);
+  for (const string& turn : rec.turns) {
+    Clock::time_point start = Clock::now();
+    writeAll(to_bot[1], turn);
+    for (int lines = 0; lines < rec.answer_lines;) {
+      ssize_t got = read(from_bot[0], answer, sizeof(answer));
+      if (got <= 0) { cerr << game_names[game] << ": the bot hung up\n"; exit(1); }
+      lines += int(count(answer, answer + got, '\n'));
+    }
+    micros.push_back(chrono::duration<double, micro>(Clock::now() - start).count());
+  }
+  close(to_bot[1]);
+  close(from_bot[0]);
+  waitpid(pid, nullptr, 0);
+  micros.erase(micros.begin(), micros.begin() + warmup_turns);
+  return micros;
+}
+
+int main(int argc, char** argv) {
+  vector<Game> games;
+  for (int game = 0; game < num_games; ++game) {
+    if (argc < 2 || strcmp(argv[1], game_names[game]) == 0) games.push_back(Game(game));
+  }
+  if (games.empty()) {
+    cerr << "usage: " << argv[0] << " [uttt|labyrinth|csb [dump]]\n";
+    return 1;
+  }
+  if (argc > 2 && strcmp(argv[2], "dump") == 0) {
+    Recording rec = record(games[0]);
+    cout << rec.setup;
+    for (const string& turn : rec.turns) cout << turn;
+    return 0;
+  }
+
+  cout << fixed << setprecision(1);
+  for (Game game : games) {
+    Recording rec = record(game);
+    size_t bytes = 0;
+    for (const string& turn : rec.turns) bytes += turn.size();
+    cout << game_names[game] << ": " << rec.turns.size() << " turns, " << bytes / rec.turns.size() << " bytes each\n";
+    double base_median = 0;
+    for (int mode = 0; mode < num_modes; ++mode) {
+      vector<double> micros = referee(rec, game, Mode(mode));
+      sort(micros.begin(), micros.end());
+      double mean = 0;
+      for (double us : micros) mean += us;
+      mean /= micros.size();
+      double median = micros[micros.size() / 2], p99 = micros[micros.size() * 99 / 100];
+      if (mode == cin_synced) base_median = median;
+      cout << "  " << left << setw(20) << mode_names[mode] << right
+        << "median " << setw(7) << median << " us   mean " << setw(7) << mean << " us   p99 " << setw(7) << p99 << " us";
+      if (mode != cin_synced) cout << "   saves " << setw(6) << base_median - median << " us/turn";
+      cout << '\n';
+    }
+  }
+  return 0;
+}
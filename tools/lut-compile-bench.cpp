@@ -0,0 +1,67 @@
+// Compile-time benchmark for lookup-tables.hpp: builds one table of LUT_SIZE
+// entries either with the constexpr-loop generator (LUT_LOOP 1) or with the old
+// index_sequence expansion (LUT_LOOP 0). The interesting numbers are how long
+// this file takes to compile and how big the binary is; lut-compile-bench.sh
+// sweeps both over a range of sizes.
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+#include "../include/typedefs.hpp"
+#include "../include/lookup-tables.hpp"
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+#ifndef LUT_LOOP
+#define LUT_LOOP 1              // 1: constexpr loop, 0: index_sequence expansion
+#endif
+#ifndef LUT_SIZE
+#define LUT_SIZE (1 << 18)      // number of entries (512 x 512, like the UTTT 2d tables)
+#endif
+#ifndef LUT_PACKED
+#define LUT_PACKED 0            // store entries as u8 instead of int (loop generator only)
+#endif
+
+/*****************************************************************************/
+
+// the old generator, kept here for comparison
+template <class GenFn, size_t N, size_t... Indexes>
+static constexpr std::array<decltype(GenFn::eval(0)), N>
+  _makeLookupTableUnrolled(std::index_sequence<Indexes...>) noexcept {
+  constexpr std::array<decltype(GenFn::eval(0)), N> table{{GenFn::eval(Indexes)...}};
+  return table;
+}
+template <class GenFn, size_t N>
+static constexpr std::array<decltype(GenFn::eval(0)), N> makeLookupTableUnrolled() noexcept {
+  return _makeLookupTableUnrolled<GenFn, N>(std::make_index_sequence<N>{});
+}
+
+// about as much work per entry as winState: a few popcounts on two 9-bit boards
+static constexpr int benchFn(size_t input) noexcept {
+  size_t x_b = input & 511, o_b = (input >> 9) & 511;
+  return popcnt(x_b) * 10 + popcnt(o_b) + popcnt(x_b & o_b) + int(input >> 18) % 7;
+}
+
+struct gen_benchFn {
+  static constexpr auto eval(size_t input) noexcept { return benchFn(input); }
+};
+
+#if !LUT_LOOP
+constexpr auto lut_benchFn = makeLookupTableUnrolled<gen_benchFn, LUT_SIZE>();
+#elif LUT_PACKED
+constexpr auto lut_benchFn = makePackedLookupTable<u8, gen_benchFn, LUT_SIZE>();
+#else
+constexpr auto lut_benchFn = makeLookupTable<gen_benchFn, LUT_SIZE>();
+#endif
+
+int main(int argc, char**) {
+  // touch the table at a runtime index so it has to be emitted
+  size_t idx = size_t(argc) * 2654435761u % LUT_SIZE;
+  cout << "entries " << lut_benchFn.size() << " bytes " << sizeof(lut_benchFn)
+    << " lut[" << idx << "] = " << int(lut_benchFn[idx]) << endl;
+  return 0;
+}
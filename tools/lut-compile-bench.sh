@@ -0,0 +1,32 @@
+#!/bin/sh
+# Compile lut-compile-bench.cpp for a range of table sizes with each
+# generator and report compile time and text+data size of the result.
+#
+#   tools/lut-compile-bench.sh [compiler] [extra flags...]
+#
+# A generator that fails to compile a size (compiler limit, out of memory)
+# is reported as FAILED; the log is left in $TMPDIR/lut-bench-*.log.
+
+CXX=${1:-${CXX:-g++}}
+[ $# -gt 0 ] && shift
+FLAGS="-std=c++17 -O2 $*"
+DIR=$(dirname "$0")
+TMP=${TMPDIR:-/tmp}
+
+printf '%-10s %-14s %10s %12s\n' entries generator seconds bytes
+for size in 512 4096 32768 262144 1048576 4194304; do
+  for variant in "unrolled:-DLUT_LOOP=0" "loop:-DLUT_LOOP=1" "loop-u8:-DLUT_LOOP=1 -DLUT_PACKED=1"; do
+    name=${variant%%:*}
+    defs=${variant#*:}
+    out="$TMP/lut-bench-$name-$size"
+    start=$(date +%s.%N)
+    if $CXX $FLAGS $defs -DLUT_SIZE=$size -o "$out" "$DIR/lut-compile-bench.cpp" > "$out.log" 2>&1; then
+      end=$(date +%s.%N)
+      bytes=$(size "$out" | awk 'NR == 2 { print $1 + $2 }')
+      printf '%-10s %-14s %10.2f %12s\n' $size $name "$(echo "$end $start" | awk '{ print $1 - $2 }')" $bytes
+      rm -f "$out" "$out.log"
+    else
+      printf '%-10s %-14s %10s %12s\n' $size $name FAILED -
+    fi
+  done
+done
@@ -0,0 +1,204 @@
+// Times every lookup table in ultimate-tic-tac-toe.cpp under each LutPolicy
+// (compile_time, startup, compute) and prints the fastest one for each, ready
+// to paste over the *_LUT defines at the top of the bot.
+//
+// Each table is timed twice: hot, with nothing else touching memory, and
+// under pressure, where every lookup comes with a couple of reads from a
+// buffer bigger than L2, standing in for the search tree evicting the tables. The
+// recommendation goes by the pressured numbers, since that's what the bot sees.
+// compile_time is only offered where the bot could build it with its other
+// *_LUT defines as they are, so after pasting in a change, run it again.
+// The generators are the bot's own, included below, so the tables can't drift
+// from it, and its BIT_INSTRUCTIONS pragma applies here too. popcnt and bsf
+// used to be tables as well; they're bit-fiddling.hpp calls now, see
+// tools/bit-bench.
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#define main uttt_main
+#include "../bot-programming/ultimate-tic-tac-toe/ultimate-tic-tac-toe.cpp"
+#undef main
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+constexpr size_t num_indices = 1 << 20;         // lookups per pass
+constexpr int num_passes = 4;
+constexpr int num_runs = 5;                     // keep the best of this many timings
+constexpr size_t pressure_bytes = 4 << 20;      // bigger than L2, smaller than L3
+constexpr int pressure_reads = 1;               // reads from it after every lookup
+
+/*****************************************************************************/
+
+// The bot's own generators (gen_isWon and so on, from genLookupTable*With)
+// with the same storage: Bits 0 is a whole value per entry
+template <LutPolicy P>
+struct Tables {
+  static inline const auto isWon = makeLookupTableWith<P, 1, gen_isWon, pow2(9)>();
+  static inline const auto winningSquares = makeLookupTableWith<P, 0, gen_winningSquares, pow2(9)>();
+  static inline const auto winState = makeLookupTableWith<P, 0, gen_winState, pow2(18)>();
+  static inline const auto isOngoing = makeLookupTableWith<P, 1, gen_isOngoing, pow2(18)>();
+  static inline const auto isTerminal = makeLookupTableWith<P, 1, gen_isTerminal, pow2(18)>();
+};
+
+// Whether the compiler can build GenFn's table, which it can't when the
+// generator reads a table the bot builds at startup (WIN_STATE_LUT startup
+// rules out compile_time for isOngoing and isTerminal). Goes by the bot's
+// *_LUT defines as they are now.
+template <class GenFn, class = void>
+struct CompileTimeOk : false_type {};
+template <class GenFn>
+struct CompileTimeOk<GenFn, enable_if_t<(static_cast<void>(GenFn::eval(0)), true)>> : true_type {};
+
+// stands in for a lookup that costs nothing, to take the loop overhead out
+struct Identity {
+  constexpr size_t operator[](size_t idx) const noexcept { return idx; }
+};
+
+using Clock = chrono::steady_clock;
+
+vector<u64> pressure(pressure_bytes / sizeof(u64), 1);
+u64 sink = 0;
+
+volatile size_t opaque_zero = 0;
+
+// Latency, not throughput: every index depends on the previous lookup (through
+// a zero the compiler can't see), the way a rollout's next lookup depends on
+// the last one.
+template <class Table>
+double timeLookups(const Table& table, const vector<u32>& indices, bool pressured) {
+  const size_t mask = pressure.size() - 1, zero = opaque_zero;
+  u64 sum = 0, dep = 0, state = 0x9e3779b97f4a7c15;
+  Clock::time_point start = Clock::now();
+  for (int pass = 0; pass < num_passes; ++pass) {
+    for (u32 idx : indices) {
+      dep = static_cast<u64>(table[idx ^ (dep & zero)]);
+      sum += dep;
+      if (pressured) {
+        for (int read = 0; read < pressure_reads; ++read) {
+          state = state * 6364136223846793005ull + 1442695040888963407ull;
+          dep += pressure[((state >> 20) ^ (dep & zero)) & mask];
+        }
+      }
+    }
+  }
+  double secs = chrono::duration<double>(Clock::now() - start).count();
+  sink ^= sum;
+  return secs * 1e9 / (double(num_passes) * indices.size());
+}
+template <class Table>
+double nsPerLookup(const Table& table, const vector<u32>& indices, bool pressured) {
+  double best = timeLookups(table, indices, pressured);
+  for (int run = 1; run < num_runs; ++run) best = min(best, timeLookups(table, indices, pressured));
+  return best;
+}
+
+// local boards as they come up in play: a random number of alternating moves
+vector<u32> boardPairs(mt19937& rng) {
+  vector<u32> indices(num_indices);
+  for (u32& idx : indices) {
+    int squares[9] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+    shuffle(squares, squares + 9, rng);
+    int moves = rng() % 10;
+    u32 boards[2] = { 0, 0 };
+    for (int move = 0; move < moves; ++move) boards[move % 2] |= 1 << squares[move];
+    idx = boards[0] + (boards[1] << 9);
+  }
+  return indices;
+}
+vector<u32> masks(mt19937& rng) {
+  vector<u32> indices(num_indices);
+  for (u32& idx : indices) idx = rng() % pow2(9);
+  return indices;
+}
+
+template <class Get>
+void bench(const char* name, const char* define, bool compile_time_ok, const vector<u32>& indices, double baseline[2], Get get) {
+  const char* policies[3] = { "compile_time", "startup", "compute" };
+  double ns[3][2];
+  if (compile_time_ok) {
+    get(Tables<LutPolicy::compile_time>(), [&](const auto& table) {
+      ns[0][0] = nsPerLookup(table, indices, false) - baseline[0];
+      ns[0][1] = nsPerLookup(table, indices, true) - baseline[1];
+    });
+  }
+  get(Tables<LutPolicy::startup>(), [&](const auto& table) {
+    ns[1][0] = nsPerLookup(table, indices, false) - baseline[0];
+    ns[1][1] = nsPerLookup(table, indices, true) - baseline[1];
+  });
+  get(Tables<LutPolicy::compute>(), [&](const auto& table) {
+    ns[2][0] = nsPerLookup(table, indices, false) - baseline[0];
+    ns[2][1] = nsPerLookup(table, indices, true) - baseline[1];
+  });
+  // Anything within 5% is a tie. compile_time and startup tables are the same
+  // array, so they always tie, and then startup wins: filling even the 2^18
+  // entry tables takes well under a millisecond, while baking them in costs
+  // seconds of compile time and hundreds of KB of binary.
+  const int preference[3] = { 1, 0, 2 };
+  int best = preference[0];
+  for (int policy : preference) {
+    if (policy == 0 && !compile_time_ok) continue;
+    if (ns[policy][1] + baseline[1] < 0.95 * (ns[best][1] + baseline[1])) best = policy;
+  }
+  cout << left << setw(16) << name << right << fixed << setprecision(2);
+  for (int policy = 0; policy < 3; ++policy) {
+    if (policy == 0 && !compile_time_ok) cout << setw(8) << '-' << setw(8) << '-';
+    else cout << setw(8) << ns[policy][0] << setw(8) << ns[policy][1];
+  }
+  cout << "   #define " << define << ' ' << policies[best] << endl;
+}
+
+// every policy has to agree with the generator everywhere
+template <class A, class B, class C, class GenFn>
+bool agree(const A& a, const B& b, const C& c, GenFn, size_t n) {
+  for (size_t idx = 0; idx < n; ++idx) {
+    auto expected = GenFn::eval(idx);
+    if (a[idx] != expected || b[idx] != expected || c[idx] != expected) {
+      cout << "policies disagree at " << idx << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  using CT = Tables<LutPolicy::compile_time>;
+  using ST = Tables<LutPolicy::startup>;
+  using CP = Tables<LutPolicy::compute>;
+  if (!agree(CT::isWon, ST::isWon, CP::isWon, gen_isWon(), pow2(9))
+    || !agree(CT::winningSquares, ST::winningSquares, CP::winningSquares, gen_winningSquares(), pow2(9))
+    || !agree(CT::winState, ST::winState, CP::winState, gen_winState(), pow2(18))
+    || !agree(CT::isOngoing, ST::isOngoing, CP::isOngoing, gen_isOngoing(), pow2(18))
+    || !agree(CT::isTerminal, ST::isTerminal, CP::isTerminal, gen_isTerminal(), pow2(18))) return 1;
+
+  mt19937 rng(2024);
+  vector<u32> mask_indices = masks(rng), board_indices = boardPairs(rng);
+  double baseline[2] = {
+    nsPerLookup(Identity(), mask_indices, false),
+    nsPerLookup(Identity(), mask_indices, true),
+  };
+
+  cout << "ns per lookup, over the cost of the loop (" << baseline[0] << " hot, "
+    << baseline[1] << " pressured)\n"
+    << left << setw(16) << "table" << right
+    << setw(16) << "compile_time" << setw(16) << "startup" << setw(16) << "compute" << '\n'
+    << setw(16) << "" << "     hot  press.     hot  press.     hot  press." << endl;
+  // a - is a compile_time table that wouldn't build with the bot's other *_LUT defines
+#define BENCH(fn, define, indices)                                             \
+  bench(#fn, define, CompileTimeOk<gen_##fn>::value, indices, baseline,      \
+        [](auto tables, auto run) { run(decltype(tables)::fn); })
+  BENCH(isWon, "IS_WON_LUT", mask_indices);
+  BENCH(winningSquares, "WINNING_SQUARES_LUT", mask_indices);
+  BENCH(winState, "WIN_STATE_LUT", board_indices);
+  BENCH(isOngoing, "IS_ONGOING_LUT", board_indices);
+  BENCH(isTerminal, "IS_TERMINAL_LUT", board_indices);
+#undef BENCH
+  return sink == 42;
+}
@@ -0,0 +1,69 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "../include/typedefs.hpp"
+#include "../include/mnk-game.hpp"
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+constexpr int max_seconds = 10;     // stop deepening a variant after this long (override with argv[1])
+constexpr int table_bits = 22;      // transposition table size, log2 entries
+
+/*****************************************************************************/
+
+using Clock = chrono::steady_clock;
+
+// Iteratively deepens on the empty board until the game is solved or the time
+// runs out, then reports the outcome and how fast the solver went.
+template <int W, int H, int K>
+void bench(const char* name, double seconds) {
+  using Board = MnkBoard<W, H, K>;
+  Board board;
+  MnkSolver<Board> solver(table_bits);
+
+  Clock::time_point start = Clock::now();
+  double elapsed = 0.0;
+  int depth = 0, score = 0, best_move = -1;
+  bool solved = false;
+  while (!solved && depth < Board::num_cells && elapsed < seconds) {
+    // cap the next iteration at whatever the time left is worth at the speed so far
+    if (solver.nodes > 0) solver.node_limit = solver.nodes + u64(solver.nodes / elapsed * (seconds - elapsed));
+    int move;
+    int s = solver.search(board, depth + 1, &move);
+    elapsed = chrono::duration<double>(Clock::now() - start).count();
+    if (solver.aborted) break;
+    ++depth;
+    score = s;
+    best_move = move;
+    solved = !solver.hit_horizon || score != 0;
+  }
+
+  const char* outcome = (!solved) ? "unknown" : (score > 0) ? "first player wins"
+    : (score < 0) ? "second player wins" : "draw";
+  cout << left << setw(14) << name
+    << " depth " << setw(3) << depth
+    << setw(19) << outcome
+    << " first move " << setw(3) << ((best_move >= 0) ? to_string(best_move % Board::stride) + ","
+                                                       + to_string(best_move / Board::stride) : "-")
+    << " nodes " << setw(12) << solver.nodes
+    << fixed << setprecision(2) << " secs " << setw(7) << elapsed
+    << setprecision(0) << " nodes/sec " << solver.nodes / max(elapsed, 1e-9) << endl;
+}
+
+int main(int argc, char** argv) {
+  double seconds = (argc > 1) ? atof(argv[1]) : max_seconds;
+  bench<3, 3, 3>("3x3 k=3", seconds);
+  bench<4, 4, 3>("4x4 k=3", seconds);
+  bench<4, 4, 4>("4x4 k=4", seconds);
+  bench<5, 5, 4>("5x5 k=4", seconds);
+  bench<6, 6, 4>("6x6 k=4", seconds);
+  bench<7, 7, 5>("7x7 k=5", seconds);     // gomoku-lite
+  bench<9, 9, 5>("9x9 k=5", seconds);     // gomoku-lite, 128-bit board
+  return 0;
+}
@@ -0,0 +1,96 @@
+// Times the generators in rng.hpp against what the search code used before
+// them: mt19937_64 with `rng() % n` in ultimate-tic-tac-toe.cpp, and mt19937
+// with a <random> distribution built for every call in genetic.cpp.
+//
+// "move" is one pick out of 1 to 81 moves, which is what a rollout ply costs
+// in random numbers. "gene" is one gene of genetic.cpp's makeBaby: a coin flip
+// for the parent and a 1/2048 chance of a mutation drawn from [-0.1, 0.1).
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../include/rng.hpp"
+
+using namespace std;
+using namespace kel;
+
+/***************************** User  Variables *******************************/
+
+constexpr size_t num_calls = 1 << 22;           // calls per timing
+constexpr int num_runs = 5;                     // keep the best of this many timings
+constexpr float p_mutate = 1.f / 2048.f;        // same as genetic.h
+
+/*****************************************************************************/
+
+using Clock = chrono::steady_clock;
+
+u64 sink = 0;
+vector<u32> ranges;
+
+template <class Fn>
+double nsPerCall(Fn fn) {
+  double best = 1e9;
+  for (int run = 0; run < num_runs; ++run) {
+    u64 sum = 0;
+    Clock::time_point start = Clock::now();
+    for (size_t call = 0; call < num_calls; ++call) sum += fn(call);
+    double secs = chrono::duration<double>(Clock::now() - start).count();
+    sink ^= sum;
+    best = min(best, secs * 1e9 / num_calls);
+  }
+  return best;
+}
+
+void row(const char* name, double raw, double move, double flt, double gene) {
+  cout << left << setw(34) << name << right << fixed << setprecision(2)
+    << setw(8) << raw << setw(8) << move << setw(8) << flt << setw(8) << gene << endl;
+}
+
+// what the bot and genetic.cpp did before
+template <class Std>
+void benchStd(const char* name) {
+  Std gen(12345);
+  row(name,
+      nsPerCall([&](size_t) { return u64(gen()); }),
+      nsPerCall([&](size_t call) { return u64(gen() % ranges[call & 1023]); }),
+      nsPerCall([&](size_t) { return u64(1e6f * uniform_real_distribution<float>(-1.f, 1.f)(gen)); }),
+      nsPerCall([&](size_t) {
+        u64 parent = uniform_int_distribution(0, 1)(gen);
+        if ((static_cast<float>(gen()) / UINT32_MAX) < p_mutate) {
+          parent += u64(1e6f * uniform_real_distribution<float>(-0.1f, 0.1f)(gen));
+        }
+        return parent;
+      }));
+}
+
+template <class Rng>
+void bench(const char* name) {
+  Rng rng(12345);
+  row(name,
+      nsPerCall([&](size_t) { return u64(rng()); }),
+      nsPerCall([&](size_t call) { return u64(bounded(rng, ranges[call & 1023])); }),
+      nsPerCall([&](size_t) { return u64(1e6f * uniformFloat(rng, -1.f, 1.f)); }),
+      nsPerCall([&](size_t) {
+        u64 parent = coinFlip(rng);
+        if (chance(rng, p_mutate)) parent += u64(1e6f * uniformFloat(rng, -0.1f, 0.1f));
+        return parent;
+      }));
+}
+
+int main() {
+  mt19937 seeder(2024);
+  for (int call = 0; call < 1024; ++call) ranges.push_back(seeder() % 81 + 1);
+
+  cout << "ns per call" << '\n' << left << setw(34) << "generator" << right
+    << setw(8) << "raw" << setw(8) << "move" << setw(8) << "float" << setw(8) << "gene" << endl;
+  benchStd<mt19937>("mt19937 + % / distributions");
+  benchStd<mt19937_64>("mt19937_64 + % / distributions");
+  bench<Xoshiro256ss>("Xoshiro256ss");
+  bench<WyRand>("WyRand");
+  bench<Pcg32>("Pcg32");
+  return sink == 42;
+}
@@ -0,0 +1,330 @@
+// Checks the zobrist tables UltimateBoard::hash is built from, the way
+// they're written in a source file, and then how the hash does on real
+// positions. Exits with 1 if anything fails, so a table that got pasted short
+// or twice gets noticed before it quietly costs the transposition table.
+//
+//   tools-zobrist-check [--positions=N] [--seed=N] [FILE]
+//
+// FILE (the ultimate tic-tac-toe bot by default) is searched for arrays whose
+// names start with z_, written like gen-tables writes them:
+//   NAME[size] = { literal, literal, ... };
+//
+// On the tables as written:
+//   - every declared size has that many initializers (the rest would be 0)
+//   - no key is 0, and no key turns up twice, in one table or across them
+//   - each table has what the hash indexes: z_x_board and z_o_board 512,
+//     z_next 10 (next runs from -1 to 8), z_turn 2
+//   - every bit is set in about half the keys of each table
+//   - the keys are as linearly independent as 64 bits allow: full GF(2)
+//     rank, and no 2, 3 or 4 of them XOR to 0 (for the keys the hash
+//     actually uses, with each local's rotation, 2 and 3)
+// On N distinct positions from random self-play, hashed with those tables:
+//   - full 64-bit collisions between different positions (there should be none)
+//   - collisions in the low 32 bits, against what random keys would give
+//   - how evenly an unordered_set with the bot's hash spreads them over its
+//     buckets (a chi-squared test)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#define main uttt_main
+#include "../bot-programming/ultimate-tic-tac-toe/ultimate-tic-tac-toe.cpp"
+#undef main
+
+/***************************** User  Variables *******************************/
+
+constexpr size_t default_positions = 2000000;
+constexpr u64 default_seed = 42;
+constexpr double max_bit_sigmas = 4.0;        // a bit this far from half its keys is biased
+constexpr double max_low_collision_ratio = 1.5;
+constexpr double max_bucket_z = 5.0;          // chi-squared, as standard deviations above expected
+
+/*****************************************************************************/
+
+struct KeyTable {
+  string name;
+  long declared;          // -1 if the size isn't a number or pow2(n)
+  vector<u64> keys;
+};
+
+int failures = 0;
+void fail(const string& what) {
+  cout << "  FAIL  " << what << '\n';
+  ++failures;
+}
+void pass(const string& what) { cout << "  ok    " << what << '\n'; }
+
+long sizeOf(string expr) {
+  expr.erase(remove(expr.begin(), expr.end(), ' '), expr.end());
+  smatch match;
+  if (regex_match(expr, match, regex("pow2\\((\\d+)\\)"))) return 1L << stol(match[1]);
+  if (regex_match(expr, match, regex("\\d+"))) return stol(expr);
+  return -1;
+}
+
+map<string, KeyTable> loadTables(const string& path) {
+  ifstream in(path);
+  if (!in) {
+    cerr << "can't read " << path << '\n';
+    exit(2);
+  }
+  stringstream text;
+  text << in.rdbuf();
+  const string source = text.str();
+  map<string, KeyTable> tables;
+  regex array("\\b(z_\\w+)\\s*\\[([^\\]]*)\\]\\s*=\\s*\\{([^}]*)\\}");
+  for (sregex_iterator it(source.begin(), source.end(), array), end; it != end; ++it) {
+    KeyTable table{ (*it)[1], sizeOf((*it)[2]), {} };
+    string body = (*it)[3];
+    regex literal("0[xX][0-9a-fA-F]+|\\d+");
+    for (sregex_iterator lit(body.begin(), body.end(), literal); lit != sregex_iterator(); ++lit) {
+      table.keys.push_back(strtoull(lit->str().c_str(), nullptr, 0));
+    }
+    tables[table.name] = table;
+  }
+  return tables;
+}
+
+// the same as UltimateBoard::hash, but with whatever tables were loaded
+struct TableHash {
+  const vector<u64> *x_board, *o_board, *next, *turn;
+
+  static u64 rotl(u64 key, int by) { return (key << by) | (key >> ((64 - by) & 63)); }
+  size_t operator()(const UltimateBoard& board) const noexcept {
+    u64 result = 0;
+    for (int idx = 0; idx < 9; ++idx) {
+      result ^= rotl((*x_board)[board.locals[idx].x_board] ^ (*o_board)[board.locals[idx].o_board], 7 * idx);
+    }
+    return result ^ (*next)[board.next + 1] ^ (*turn)[board.x_turn];
+  }
+};
+
+int gf2Rank(vector<u64> rows) {
+  int rank = 0;
+  for (int bit = 63; bit >= 0 && rank < int(rows.size()); --bit) {
+    auto pivot = find_if(rows.begin() + rank, rows.end(), [&](u64 row) { return (row >> bit) & 1; });
+    if (pivot == rows.end()) continue;
+    swap(rows[rank], *pivot);
+    for (size_t idx = 0; idx < rows.size(); ++idx) {
+      if (idx != size_t(rank) && ((rows[idx] >> bit) & 1)) rows[idx] ^= rows[rank];
+    }
+    ++rank;
+  }
+  return rank;
+}
+
+// how many pairs of keys XOR to another key (3 keys summing to 0)
+size_t tripleDependencies(const vector<u64>& keys) {
+  unordered_set<u64> set(keys.begin(), keys.end());
+  size_t found = 0;
+  for (size_t a = 0; a < keys.size(); ++a) {
+    for (size_t b = a + 1; b < keys.size(); ++b) found += set.count(keys[a] ^ keys[b]);
+  }
+  return found / 3;   // each triple is found from all three of its pairs
+}
+
+// how many pairs of disjoint pairs XOR to the same thing (4 keys summing to 0)
+size_t quadDependencies(const vector<u64>& keys) {
+  struct Pair { u64 xored; u32 a, b; };
+  vector<Pair> pairs;
+  pairs.reserve(keys.size() * (keys.size() - 1) / 2);
+  for (u32 a = 0; a < keys.size(); ++a) {
+    for (u32 b = a + 1; b < keys.size(); ++b) pairs.push_back({ keys[a] ^ keys[b], a, b });
+  }
+  sort(pairs.begin(), pairs.end(), [](const Pair& l, const Pair& r) { return l.xored < r.xored; });
+  size_t found = 0;
+  for (size_t idx = 0; idx + 1 < pairs.size(); ++idx) {
+    for (size_t other = idx + 1; other < pairs.size() && pairs[other].xored == pairs[idx].xored; ++other) {
+      const Pair &p = pairs[idx], &q = pairs[other];
+      if (p.a != q.a && p.a != q.b && p.b != q.a && p.b != q.b) ++found;
+    }
+  }
+  return found / 3;   // each 4 keys split into two pairs three ways
+}
+
+bool checkTables(const map<string, KeyTable>& tables) {
+  cout << "tables:\n";
+  vector<u64> all;
+  map<u64, string> seen;
+  for (const auto& [name, table] : tables) {
+    cout << "  " << name << ": " << table.keys.size() << " keys";
+    if (table.declared >= 0) cout << ", declared " << table.declared;
+    cout << '\n';
+    if (table.declared >= 0 && size_t(table.declared) != table.keys.size()) {
+      fail(name + " is declared with " + to_string(table.declared) + " entries but has "
+        + to_string(table.keys.size()) + " initializers; the rest are 0");
+    }
+    for (size_t idx = 0; idx < table.keys.size(); ++idx) {
+      u64 key = table.keys[idx];
+      string where = name + '[' + to_string(idx) + ']';
+      if (key == 0) fail(where + " is 0");
+      else if (seen.count(key)) fail(where + " is the same key as " + seen[key]);
+      else seen[key] = where;
+      all.push_back(key);
+    }
+    // bit balance, for tables big enough to say anything
+    const size_t n = table.keys.size();
+    if (n >= 64) {
+      int biased = 0;
+      double worst = 0;
+      for (int bit = 0; bit < 64; ++bit) {
+        size_t ones = count_if(table.keys.begin(), table.keys.end(), [&](u64 key) { return (key >> bit) & 1; });
+        double sigmas = abs(double(ones) - n / 2.0) / (sqrt(double(n)) / 2);
+        worst = max(worst, sigmas);
+        biased += (sigmas > max_bit_sigmas);
+      }
+      ostringstream line;
+      line << name << ": bit balance, worst bit " << fixed << setprecision(1) << worst << " sigma from half";
+      if (biased) fail(line.str() + ", " + to_string(biased) + " bits past " + to_string(int(max_bit_sigmas)));
+      else pass(line.str());
+    }
+    int rank = gf2Rank(table.keys);
+    if (rank < int(min<size_t>(n, 64))) fail(name + ": GF(2) rank " + to_string(rank) + " of a possible " + to_string(min<size_t>(n, 64)));
+  }
+
+  const pair<const char*, size_t> needed[] = { { "z_x_board", 512 }, { "z_o_board", 512 }, { "z_next", 10 }, { "z_turn", 2 } };
+  bool usable = true;
+  for (auto [name, size] : needed) {
+    auto it = tables.find(name);
+    if (it == tables.end()) {
+      fail(string("no ") + name + " table");
+      usable = false;
+    }
+    else if (it->second.keys.size() < size) {
+      fail(string(name) + " has " + to_string(it->second.keys.size()) + " keys; the hash indexes " + to_string(size)
+        + (string(name) == "z_next" ? " (next is -1 to 8)" : ""));
+      usable = false;
+    }
+  }
+
+  int rank = gf2Rank(all);
+  if (rank < 64) fail("all the keys together only have GF(2) rank " + to_string(rank));
+  else pass("all " + to_string(all.size()) + " keys together have full GF(2) rank");
+  size_t triples = tripleDependencies(all), quads = quadDependencies(all);
+  if (triples || quads) fail(to_string(triples) + " sets of 3 keys and " + to_string(quads) + " sets of 4 XOR to 0");
+  else pass("no 2, 3 or 4 keys XOR to 0");
+
+  if (usable) {
+    // the keys as the hash uses them, rotated by local
+    vector<u64> used;
+    TableHash hash{ &tables.at("z_x_board").keys, &tables.at("z_o_board").keys, &tables.at("z_next").keys, &tables.at("z_turn").keys };
+    for (int local = 0; local < 9; ++local) {
+      for (int board = 0; board < 512; ++board) {
+        used.push_back(TableHash::rotl((*hash.x_board)[board], 7 * local));
+        used.push_back(TableHash::rotl((*hash.o_board)[board], 7 * local));
+      }
+    }
+    for (int idx = 0; idx < 10; ++idx) used.push_back((*hash.next)[idx]);
+    for (int idx = 0; idx < 2; ++idx) used.push_back((*hash.turn)[idx]);
+    sort(used.begin(), used.end());
+    size_t repeats = size_t(adjacent_find(used.begin(), used.end()) != used.end());
+    size_t used_triples = tripleDependencies(used);
+    if (repeats || used_triples) fail("as the hash uses them (" + to_string(used.size()) + " rotated keys), " + to_string(used_triples) + " sets of 3 XOR to 0"
+      + (repeats ? ", and some keys repeat" : ""));
+    else pass("as the hash uses them (" + to_string(used.size()) + " rotated keys), no 2 or 3 XOR to 0");
+  }
+  return usable;
+}
+
+void checkPositions(const map<string, KeyTable>& tables, size_t num_positions, u64 seed, bool same_file_as_bot) {
+  TableHash hash{ &tables.at("z_x_board").keys, &tables.at("z_o_board").keys, &tables.at("z_next").keys, &tables.at("z_turn").keys };
+  cout << "positions (random self-play, seed " << seed << "):\n";
+  auto start = chrono::steady_clock::now();
+
+  Pcg32 rng(seed);
+  unordered_set<UltimateBoard, TableHash> positions(16, hash);
+  MoveVector moves;
+  size_t games = 0, mismatches = 0;
+  while (positions.size() < num_positions) {
+    UltimateBoard board;
+    ++games;
+    while (positions.size() < num_positions) {
+      positions.insert(board);
+      if (same_file_as_bot) mismatches += (hash(board) != UltimateBoard::hash()(board));
+      Board glob = board.getGlobal();
+      if (lookup2d(winState, glob.x_board, glob.o_board) != ongoing) break;
+      board.getMoves(moves);
+      if (moves.empty()) break;
+      board.mark(globalIdxToLocalIdx_idx(moves[bounded(rng, moves.size())]));
+    }
+  }
+  const double n = double(positions.size());
+  cout << "  " << positions.size() << " distinct positions from " << games << " games in "
+    << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count() << " ms\n";
+  if (same_file_as_bot) {
+    if (mismatches) fail("the tables as read don't give UltimateBoard::hash's values (" + to_string(mismatches) + " positions)");
+    else pass("the tables as read give the same hashes as UltimateBoard::hash");
+  }
+
+  vector<u64> hashes;
+  hashes.reserve(positions.size());
+  for (const UltimateBoard& board : positions) hashes.push_back(hash(board));
+  sort(hashes.begin(), hashes.end());
+  size_t full = 0;
+  for (size_t idx = 1; idx < hashes.size(); ++idx) full += (hashes[idx] == hashes[idx - 1]);
+  if (full) fail(to_string(full) + " positions hash the same as a different position");
+  else pass("no 64-bit collisions");
+
+  for (u64& h : hashes) h &= 0xffffffff;
+  sort(hashes.begin(), hashes.end());
+  size_t low = 0;
+  for (size_t idx = 1; idx < hashes.size(); ++idx) low += (hashes[idx] == hashes[idx - 1]);
+  const double buckets32 = 4294967296.0;
+  const double expected = n - buckets32 * (1 - pow(1 - 1 / buckets32, n));
+  ostringstream line;
+  line << fixed << setprecision(2) << "low 32 bits: " << low << " collisions, " << expected << " expected from random keys";
+  if (low > max_low_collision_ratio * expected + 10) fail(line.str());
+  else pass(line.str());
+
+  // the set's own buckets, as the bot's transposition table would see them
+  const size_t num_buckets = positions.bucket_count();
+  const double mean = n / num_buckets;
+  double chi2 = 0;
+  size_t longest = 0;
+  for (size_t bucket = 0; bucket < num_buckets; ++bucket) {
+    double load = double(positions.bucket_size(bucket));
+    chi2 += (load - mean) * (load - mean) / mean;
+    longest = max(longest, size_t(load));
+  }
+  const double z = (chi2 - (num_buckets - 1)) / sqrt(2.0 * (num_buckets - 1));
+  line.str("");
+  line << fixed << setprecision(2) << num_buckets << " buckets: chi-squared " << z << " sigma from uniform, longest chain " << longest;
+  if (z > max_bucket_z) fail(line.str());
+  else pass(line.str());
+}
+
+int main(int argc, char** argv) {
+  size_t num_positions = default_positions;
+  u64 seed = default_seed;
+  string path = UTTT_SOURCE;
+  for (int arg = 1; arg < argc; ++arg) {
+    string text = argv[arg];
+    if (text.rfind("--positions=", 0) == 0) num_positions = stoull(text.substr(12));
+    else if (text.rfind("--seed=", 0) == 0) seed = stoull(text.substr(7), nullptr, 0);
+    else if (text.rfind("--", 0) == 0) {
+      cerr << "usage: " << argv[0] << " [--positions=N] [--seed=N] [FILE]\n";
+      return 2;
+    }
+    else path = text;
+  }
+  cout << path << '\n';
+  map<string, KeyTable> tables = loadTables(path);
+  if (tables.empty()) {
+    cout << "  no z_ tables found\n";
+    return 1;
+  }
+  if (checkTables(tables)) checkPositions(tables, num_positions, seed, path == UTTT_SOURCE);
+  else cout << "(not hashing any positions with tables the hash can't index)\n";
+  cout << (failures ? to_string(failures) + " failed\n" : string("all passed\n"));
+  return failures ? 1 : 0;
+}